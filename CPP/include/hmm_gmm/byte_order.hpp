@@ -0,0 +1,103 @@
+/******************************************************************************
+* File Name:   byte_order.hpp
+*
+* Description: Helpers for reading and writing fixed-endian binary fields
+*              independently of the host byte order.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_BYTE_ORDER_HPP)
+#define HMM_GMM_BYTE_ORDER_HPP
+
+#include <cstdint>
+#include <cstring>
+
+namespace hmm_gmm
+{
+
+inline uint32_t load_be32(const unsigned char *p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+inline uint16_t load_be16(const unsigned char *p)
+{
+    return uint16_t((p[0] << 8) | p[1]);
+}
+
+inline uint32_t load_le32(const unsigned char *p)
+{
+    return (uint32_t(p[3]) << 24) | (uint32_t(p[2]) << 16) | (uint32_t(p[1]) << 8) | uint32_t(p[0]);
+}
+
+inline uint16_t load_le16(const unsigned char *p)
+{
+    return uint16_t((p[1] << 8) | p[0]);
+}
+
+inline uint64_t load_le64(const unsigned char *p)
+{
+    return (uint64_t(load_le32(p + 4)) << 32) | uint64_t(load_le32(p));
+}
+
+inline void store_le16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+inline void store_le32(unsigned char *p, uint32_t v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+inline void store_le64(unsigned char *p, uint64_t v)
+{
+    store_le32(p, (uint32_t)v);
+    store_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+/* true if the host stores multi-byte values little-endian */
+inline bool host_is_little_endian()
+{
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+inline void store_be32(unsigned char *p, uint32_t v)
+{
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+inline void store_be16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)(v >> 8);
+    p[1] = (unsigned char)v;
+}
+
+inline float load_be_float(const unsigned char *p)
+{
+    uint32_t bits = load_be32(p);
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+inline void store_be_float(unsigned char *p, float v)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    store_be32(p, bits);
+}
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_BYTE_ORDER_HPP */
+/* [] END OF FILE */
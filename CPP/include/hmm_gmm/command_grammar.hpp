@@ -0,0 +1,123 @@
+/******************************************************************************
+* File Name:   command_grammar.hpp
+*
+* Description: Composite grammar networks of whole-word models. The
+*              firmware recognises "marvin" in one 1 s block, sets
+*              wakeword_flag and recognises the command in the next block:
+*              two full searches of every model, and the command is only
+*              known at the end of the second block. A grammar chains the
+*              word models of a model set into one network instead,
+*
+*                  START --> wakeword --> [silence] --> on | off | up | down --> END
+*
+*              so a whole phrase is recognised in one frame-synchronous pass.
+*              The grammar is a sequence of slots; a slot holds alternative
+*              models and may be optional. The END of every model of a slot
+*              enters the START of every model of the next slot one frame
+*              later, an optional slot may be passed over, and the phrase
+*              ends with the END of the last slot that is not passed over.
+*
+*              The models of a slot are only searched once a token leaves
+*              the slot before it, so the command models are not scored
+*              before the wakeword can have ended; with a beam they are not
+*              scored while the wakeword END is far below the best state.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_COMMAND_GRAMMAR_HPP)
+#define HMM_GMM_COMMAND_GRAMMAR_HPP
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_matrix.hpp"
+#include "hmm_gmm/sparse_transitions.hpp"
+
+namespace hmm_gmm
+{
+
+/* no model: "no silence slot" for command_grammar::wakeword_command() */
+inline constexpr std::size_t GRAMMAR_NO_WORD = std::numeric_limits<std::size_t>::max();
+
+struct grammar_slot
+{
+    std::vector<std::size_t> models;    /* 0-based model indices, the alternatives */
+    bool optional = false;              /* the slot may be passed over */
+};
+
+struct grammar_word
+{
+    std::size_t slot = 0;
+    std::size_t model = 0;              /* 0-based model index */
+    std::size_t start_frame = 0;
+    std::size_t end_frame = 0;          /* last frame of the word */
+    double score = 0.0;                 /* log-likelihood of the word's frames and transitions */
+};
+
+struct grammar_result
+{
+    double score = -std::numeric_limits<double>::infinity();   /* best path through the network */
+    std::vector<grammar_word> words;    /* one per slot not passed over, empty if no path */
+};
+
+struct grammar_trace
+{
+    std::vector<std::size_t> scored;    /* per slot, state emissions read by the search */
+};
+
+class command_grammar
+{
+public:
+    /*
+     * The model must outlive the grammar; throws std::invalid_argument if a
+     * slot is empty, names a model outside the set or every slot is optional
+     */
+    command_grammar(const compiled_model &model, std::vector<grammar_slot> slots);
+
+    /*
+     * wakeword --> [silence] --> commands; no silence slot if silence is
+     * GRAMMAR_NO_WORD, and std::invalid_argument for any model outside the set
+     */
+    static command_grammar wakeword_command(const compiled_model &model, std::size_t wakeword,
+                                            std::size_t silence, const std::vector<std::size_t> &commands);
+
+    const compiled_model &model() const { return *model_; }
+    const std::vector<grammar_slot> &slots() const { return slots_; }
+
+private:
+    friend grammar_result recognise_grammar(emission_cache &, const feature_view &, const command_grammar &, double,
+                                            grammar_trace *);
+
+    struct node
+    {
+        std::size_t slot;
+        std::size_t model;
+        std::size_t transitions;        /* index into transitions_ */
+    };
+
+    const compiled_model *model_;
+    std::vector<grammar_slot> slots_;
+    std::vector<node> nodes_;                       /* slot by slot, in the order of the alternatives */
+    std::vector<std::size_t> slot_first_;           /* nodes of slot s: slot_first_[s] .. slot_first_[s + 1] - 1 */
+    std::vector<sparse_transitions> transitions_;   /* per distinct model of the grammar */
+    std::vector<std::size_t> tail_;                 /* per slot, fewest frames the slots after it need */
+};
+
+/*
+ * Viterbi search of the grammar network over one utterance, which must hold
+ * the whole phrase. A state is searched only while the rest of the phrase
+ * still fits into the remaining frames. States more than beam below the best
+ * state of their frame are dropped (an infinite beam drops none), and with a
+ * lazy cache their successors are never scored. trace, if given, receives
+ * the emissions read per slot.
+ */
+grammar_result recognise_grammar(emission_cache &cache, const feature_view &features, const command_grammar &grammar,
+                                 double beam = std::numeric_limits<double>::infinity(),
+                                 grammar_trace *trace = nullptr);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_COMMAND_GRAMMAR_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,197 @@
+/******************************************************************************
+* File Name:   compiled_model.hpp
+*
+* Description: Compiled GMM-HMM model set. HMM_<iter>.mat is converted once
+*              into a binary image that holds everything the decoder needs
+*              per frame in its final form, so loading is a mapping plus a
+*              header check and a Gaussian costs one fused multiply-add per
+*              dimension:
+*
+*              log N(x; mu, var) = gconst - 1/2 sum_d (x_d - mu_d)^2 ivar_d
+*              gconst            = -1/2 (dim log(2 pi) + sum_d log var_d)
+*
+*              Image layout (little-endian, float32, every section and
+*              every vector aligned to 64 bytes):
+*
+*              header       64 bytes, see below
+*              states       model_no * state_no state blocks:
+*                             log_weight[mix_stride]  log c_m (-Inf if c_m = 0)
+*                             gconst[mix_stride]
+*                             mix_no * { mean[stride], ivar[stride] }
+*              transitions  model_no * (state_no + 2)^2 log aij, row-major
+*                           (START = node 0, END = node state_no + 1),
+*                           -Inf for forbidden transitions, each model
+*                           padded to 64 bytes
+*
+*              stride / mix_stride are dim / mix_no rounded up to 16 floats;
+*              padding entries are 0 (mean and ivar) or -Inf (log_weight).
+*              The same image is emitted as a const C array for the PSoC6
+*              (gmm_hmm/compiled_model.h).
+*
+*              Quantised images (version 2) store the Gaussians in 16 or 8
+*              bits and are scored in that form; log_weight and gconst stay
+*              float32 (gconst is computed from the quantised variances):
+*
+*              header       64 bytes, version 2
+*              quantisation 64 bytes: u32 precision (1 float16, 2 int8),
+*                           u32 reserved, u64 scale_offset (0 for float16)
+*              scales       int8 only, 4 * stride floats: per dimension the
+*                           frame offset o_d and scale 1/s_d, and the base
+*                           A_d and step B_d of the precision codes
+*              states       log_weight[mix_stride], gconst[mix_stride],
+*                           mix_no * { mean[stride], precision[stride] },
+*                           each block padded to 64 bytes:
+*                             float16  IEEE half mean and ivar
+*                             int8     mean code q (int8) with
+*                                      mean_d = o_d + s_d q_d, and
+*                                      precision code r (uint8) with
+*                                      s_d sqrt(ivar_d) = A_d + B_d r_d
+*              transitions  as above
+*
+*              int8 scores frames prepared as x'_d = (x_d - o_d) / s_d:
+*              (x_d - mean_d)^2 ivar_d = ((x'_d - q_d) (A_d + B_d r_d))^2.
+*              A Gaussian of 39 dimensions takes 392 bytes in float32, 200
+*              in float16 and 104 in int8.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_COMPILED_MODEL_HPP)
+#define HMM_GMM_COMPILED_MODEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/hmm_model.hpp"
+#include "hmm_gmm/mapped_file.hpp"
+
+namespace hmm_gmm
+{
+
+/*
+ * Header, 64 bytes:
+ *   0  char[8] magic "HMMGMODL"
+ *   8  u32 version
+ *  12  u32 dim
+ *  16  u32 stride            floats per mean / ivar vector
+ *  20  u32 mix_no
+ *  24  u32 mix_stride        floats per log_weight / gconst row
+ *  28  u32 state_no          emitting states per model
+ *  32  u32 model_no
+ *  36  u32 state_bytes       size of one state block
+ *  40  u64 state_offset
+ *  48  u64 transition_offset
+ *  56  u64 image_size
+ */
+constexpr char COMPILED_MODEL_MAGIC[8] = {'H', 'M', 'M', 'G', 'M', 'O', 'D', 'L'};
+constexpr uint32_t COMPILED_MODEL_VERSION = 1;
+constexpr uint32_t COMPILED_MODEL_QUANTISED_VERSION = 2;
+constexpr std::size_t COMPILED_MODEL_HEADER_SIZE = 64;
+constexpr std::size_t COMPILED_MODEL_ALIGNMENT = 64;
+
+enum class model_precision : uint32_t
+{
+    float32 = 0,
+    float16 = 1,
+    int8 = 2
+};
+
+/* "float32", "float16", "int8" */
+const char *model_precision_name(model_precision precision);
+
+/*
+ * Builds the image of a model set; throws std::invalid_argument for
+ * inconsistent models or values that the precision cannot represent
+ */
+std::vector<unsigned char> compile_model_image(const hmm_set &hmm,
+                                               model_precision precision = model_precision::float32);
+
+class compiled_model
+{
+public:
+    /* Maps an image written by save(); throws std::runtime_error if it is not a valid image */
+    explicit compiled_model(const std::string &filename);
+
+    /* Compiles in memory */
+    explicit compiled_model(const hmm_set &hmm, model_precision precision = model_precision::float32);
+
+    compiled_model(compiled_model &&) noexcept = default;
+    compiled_model &operator=(compiled_model &&) noexcept = default;
+
+    std::size_t dim() const { return dim_; }
+    std::size_t stride() const { return stride_; }
+    std::size_t mix_no() const { return mix_no_; }
+    std::size_t mix_stride() const { return mix_stride_; }
+    std::size_t state_no() const { return state_no_; }
+    std::size_t model_no() const { return model_no_; }
+    std::size_t node_no() const { return state_no_ + 2; }
+    model_precision precision() const { return precision_; }
+
+    const unsigned char *image() const { return image_; }
+    std::size_t image_size() const { return image_size_; }
+    void save(const std::string &filename) const;
+
+    /* state block: log_weight row, gconst row, then the Gaussians (mean / ivar: float32 images only) */
+    const float *log_weight(std::size_t model, std::size_t state) const { return block(model, state); }
+    const float *gconst(std::size_t model, std::size_t state) const { return block(model, state) + mix_stride_; }
+    const float *mean(std::size_t model, std::size_t state, std::size_t mix) const
+    {
+        return block(model, state) + 2 * mix_stride_ + 2 * mix * stride_;
+    }
+    const float *ivar(std::size_t model, std::size_t state, std::size_t mix) const
+    {
+        return mean(model, state, mix) + stride_;
+    }
+
+    /* The Gaussians of a state in the stored precision */
+    const void *gaussians(std::size_t model, std::size_t state) const { return block(model, state) + 2 * mix_stride_; }
+
+    /*
+     * Copies a frame of dim() floats into the stride() floats that
+     * log_emission() takes: zero padded, and for int8 images scaled to the
+     * mean codes.
+     */
+    void prepare_frame(const float *frame, float *x) const;
+
+    /* (state_no + 2)^2 log transitions of a model, row-major over the nodes */
+    const float *log_transitions(std::size_t model) const
+    {
+        return transitions_ + model * transition_stride_;
+    }
+
+    /*
+     * log b_j(x) of emitting state 'state' (0-based). x must hold stride()
+     * floats as prepared by prepare_frame() (for float32 and float16 images
+     * any frame whose entries past dim() are finite).
+     */
+    double log_emission(std::size_t model, std::size_t state, const float *x) const;
+
+private:
+    void attach(const unsigned char *image, std::size_t size, const std::string &source);
+    const float *block(std::size_t model, std::size_t state) const
+    {
+        return reinterpret_cast<const float *>(states_ + (model * state_no_ + state) * state_bytes_);
+    }
+
+    mapped_file file_;
+    std::unique_ptr<unsigned char, void (*)(void *)> buffer_{nullptr, std::free};
+    const unsigned char *image_ = nullptr;
+    std::size_t image_size_ = 0;
+    std::size_t dim_ = 0, stride_ = 0, mix_no_ = 0, mix_stride_ = 0, state_no_ = 0, model_no_ = 0;
+    std::size_t state_bytes_ = 0, transition_stride_ = 0;
+    model_precision precision_ = model_precision::float32;
+    const unsigned char *states_ = nullptr;
+    const float *scales_ = nullptr;          /* int8: o_d, 1/s_d, A_d, B_d, stride floats each */
+    const float *transitions_ = nullptr;
+};
+
+/* Writes the image as a 64-byte aligned const uint32_t array for gmm_hmm/compiled_model.h */
+void write_compiled_model_c_source(const std::string &filename, const compiled_model &model,
+                                   const std::string &array_name = "hmm_gmm_model_image");
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_COMPILED_MODEL_HPP */
+/* [] END OF FILE */
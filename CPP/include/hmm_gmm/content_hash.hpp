@@ -0,0 +1,34 @@
+/******************************************************************************
+* File Name:   content_hash.hpp
+*
+* Description: 64-bit content hash (the XXH64 algorithm) used to build cache
+*              keys for generated files.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_CONTENT_HASH_HPP)
+#define HMM_GMM_CONTENT_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hmm_gmm
+{
+
+uint64_t hash64(const void *data, std::size_t length, uint64_t seed = 0);
+
+inline uint64_t hash64(const std::string &s, uint64_t seed = 0)
+{
+    return hash64(s.data(), s.size(), seed);
+}
+
+/* Hash of the whole file content. Throws std::runtime_error on I/O errors. */
+uint64_t hash_file(const std::string &filename);
+
+/* 16 lower case hex digits */
+std::string hash_to_hex(uint64_t hash);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_CONTENT_HASH_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,104 @@
+/******************************************************************************
+* File Name:   emission_cache.hpp
+*
+* Description: Per-utterance emission cache. log b_j(o_t) of every emitting
+*              state of every model is computed at most once per utterance
+*              and then read by every transition into that state and by the
+*              searches of all models, which otherwise each evaluate the
+*              Gaussians of their own states.
+*
+*              The matrix is stored frame-major: the row of frame t holds
+*              state s of model k at k * state_no + s, padded to 64 bytes.
+*              The time-synchronous search reads the states of one model at
+*              one frame, i.e. one or two cache lines, and the next frame is
+*              the next row. This is also the layout of
+*              gaussian_scorer::score_states().
+*
+*              Three fill modes:
+*
+*              lazy  an entry is computed with compiled_model::log_emission
+*                    when it is first read; states the search never reaches
+*                    (the first frames of a left-to-right model, pruned
+*                    states) cost nothing
+*              bulk  the whole matrix is scored by a gaussian_scorer when
+*                    the utterance is attached
+*              selected  every frame is scored through the shortlist of its
+*                    VQ codeword (gaussian_selection.hpp) when the utterance
+*                    is attached
+*
+*              The storage grows to the longest utterance seen and is reused,
+*              so one cache per thread decodes a corpus without allocating.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_EMISSION_CACHE_HPP)
+#define HMM_GMM_EMISSION_CACHE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/feature_matrix.hpp"
+#include "hmm_gmm/gaussian_scorer.hpp"
+#include "hmm_gmm/gaussian_selection.hpp"
+#include "hmm_gmm/log_math.hpp"
+
+namespace hmm_gmm
+{
+
+class emission_cache
+{
+public:
+    /* Lazy cache; the model must outlive the cache */
+    explicit emission_cache(const compiled_model &model);
+
+    /* Bulk cache scored by 'scorer' (built from the same model) with the given log-add tier */
+    emission_cache(const compiled_model &model, const gaussian_scorer &scorer,
+                   log_add_tier tier = log_add_tier::exact);
+
+    /* Cache scored with Gaussian selection (built for the same model) */
+    emission_cache(const compiled_model &model, const gaussian_selection &selection);
+
+    /* Starts a new utterance; throws std::invalid_argument if the dimension differs from the model */
+    void reset(const feature_view &features);
+
+    const compiled_model &model() const { return *model_; }
+    bool lazy() const { return scorer_ == nullptr && selection_ == nullptr; }
+    std::size_t frame_no() const { return frame_no_; }
+    std::size_t row_stride() const { return row_stride_; }
+
+    /* log b_s(o_t) of state s of model k (0-based) */
+    float operator()(std::size_t k, std::size_t s, std::size_t t)
+    {
+        lookups_++;
+        float &b = scores_[t * row_stride_ + k * state_no_ + s];
+        if (std::isnan(b))
+        {
+            b = evaluate(k, s, t);
+        }
+        return b;
+    }
+
+    /* State emissions computed, Gaussians evaluated for them and entries read since the cache was built */
+    std::size_t evaluations() const { return evaluations_; }
+    std::size_t gaussian_evaluations() const { return gaussian_evaluations_; }
+    std::size_t lookups() const { return lookups_; }
+
+private:
+    float evaluate(std::size_t k, std::size_t s, std::size_t t);
+
+    const compiled_model *model_;
+    const gaussian_scorer *scorer_ = nullptr;
+    const gaussian_selection *selection_ = nullptr;
+    log_add_tier tier_ = log_add_tier::exact;
+    std::size_t state_no_, row_stride_;
+    std::size_t frame_no_ = 0;
+    std::vector<float> scores_;         /* frame_no * row_stride, NaN = not computed yet (lazy) */
+    std::vector<float> frames_;         /* lazy, selected: frame_no * stride zero padded frames */
+    std::size_t evaluations_ = 0, gaussian_evaluations_ = 0, lookups_ = 0;
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_EMISSION_CACHE_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,54 @@
+/******************************************************************************
+* File Name:   feature_cache.hpp
+*
+* Description: Content-addressed cache manifest for generated feature files.
+*              Every output file is recorded with the key it was built from,
+*              hash(input content, front-end configuration). An output whose
+*              recorded key matches the current key does not need to be
+*              regenerated. Input size and modification time are stored as
+*              well, so an unchanged input does not have to be re-hashed.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_FEATURE_CACHE_HPP)
+#define HMM_GMM_FEATURE_CACHE_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace hmm_gmm
+{
+
+struct cache_entry
+{
+    uint64_t key = 0;               /* hash(content_hash, config_hash) */
+    uint64_t content_hash = 0;
+    uint64_t input_size = 0;
+    int64_t input_mtime = 0;
+};
+
+class feature_cache
+{
+public:
+    /* Loads the manifest if it exists; a missing or foreign file gives an empty cache */
+    explicit feature_cache(const std::string &manifest_path);
+
+    const cache_entry *find(const std::string &output) const;
+    void store(const std::string &output, const cache_entry &entry);
+    void clear() { entries_.clear(); }
+    std::size_t size() const { return entries_.size(); }
+
+    /* Writes the manifest through a temporary file and rename */
+    void save() const;
+
+    static uint64_t make_key(uint64_t content_hash, uint64_t config_hash);
+
+private:
+    std::string manifest_path_;
+    std::map<std::string, cache_entry> entries_;    /* keyed by output path */
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_FEATURE_CACHE_HPP */
+/* [] END OF FILE */
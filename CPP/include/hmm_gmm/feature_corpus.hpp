@@ -0,0 +1,121 @@
+/******************************************************************************
+* File Name:   feature_corpus.hpp
+*
+* Description: Packed feature corpus: all utterances of a file list in one
+*              memory mapped file instead of one HTK file per utterance.
+*              Everything is little-endian:
+*
+*              0     header (64 bytes)
+*                    char[8] magic "HMMGFEAT", u32 version, u32 dim,
+*                    u64 utterance_no, u64 manifest_offset,
+*                    u64 manifest_size, i32 samp_period, u16 parm_kind,
+*                    u16 reserved, u64 total_frames, 8 reserved bytes
+*              64    feature blocks, float32 frame-major, every block
+*                    starting on a 64 byte boundary
+*              ...   manifest, 64 byte aligned: utterance_no records of
+*                    u64 data_offset, u32 frame_no, i32 label,
+*                    u32 id_offset, u32 id_length, 8 reserved bytes;
+*                    followed by the utterance id strings
+*
+*              The file is padded to a multiple of 64 bytes, so it can be
+*              mapped as one float32 array (read_feature_corpus.m).
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_FEATURE_CORPUS_HPP)
+#define HMM_GMM_FEATURE_CORPUS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hmm_gmm/feature_matrix.hpp"
+#include "hmm_gmm/mapped_file.hpp"
+
+namespace hmm_gmm
+{
+
+constexpr std::size_t FEATURE_CORPUS_ALIGNMENT = 64;
+
+struct corpus_utterance
+{
+    int32_t label = 0;              /* model id, 1-based as in trainingfile{u,1} */
+    std::string_view id;            /* utterance id, the .mfc path of the file list */
+    feature_view features;          /* points into the mapping */
+};
+
+class feature_corpus
+{
+public:
+    /* Maps the file and validates header and manifest; throws std::runtime_error */
+    explicit feature_corpus(const std::string &filename);
+
+    std::size_t size() const { return records_.size(); }
+    std::size_t dim() const { return dim_; }
+    std::size_t total_frames() const { return total_frames_; }
+    int32_t samp_period() const { return samp_period_; }
+    int16_t parm_kind() const { return parm_kind_; }
+
+    corpus_utterance operator[](std::size_t u) const;
+
+private:
+    struct record
+    {
+        int32_t label;
+        uint32_t frame_no;
+        const float *data;
+        std::string_view id;
+    };
+
+    mapped_file file_;
+    std::size_t dim_ = 0;
+    std::size_t total_frames_ = 0;
+    int32_t samp_period_ = 0;
+    int16_t parm_kind_ = 0;
+    std::vector<record> records_;
+};
+
+/* Streams utterances into a corpus; the file appears under its name only after finish() */
+class feature_corpus_writer
+{
+public:
+    feature_corpus_writer(const std::string &filename, std::size_t dim, int32_t samp_period, int16_t parm_kind);
+    ~feature_corpus_writer();
+
+    feature_corpus_writer(const feature_corpus_writer &) = delete;
+    feature_corpus_writer &operator=(const feature_corpus_writer &) = delete;
+
+    void add(int32_t label, const std::string &id, const feature_view &features);
+    void finish();
+
+private:
+    struct record
+    {
+        uint64_t data_offset;
+        uint32_t frame_no;
+        int32_t label;
+        uint32_t id_offset;
+        uint32_t id_length;
+    };
+
+    void write(const void *data, std::size_t size);
+    void pad_to_alignment();
+
+    std::string filename_;
+    std::string temporary_;
+    std::FILE *file_ = nullptr;
+    uint64_t position_ = 0;
+    std::size_t dim_;
+    int32_t samp_period_;
+    int16_t parm_kind_;
+    uint64_t total_frames_ = 0;
+    std::vector<record> records_;
+    std::string ids_;
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_FEATURE_CORPUS_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,55 @@
+/******************************************************************************
+* File Name:   feature_matrix.hpp
+*
+* Description: Feature vector sequence container. Frames are stored one after
+*              another (frame-major), which is the same memory layout as the
+*              MATLAB [dim, frame_no] feature arrays and the HTK file body.
+*              feature_view is the non-owning form, used for features that
+*              live in a memory mapped corpus.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_FEATURE_MATRIX_HPP)
+#define HMM_GMM_FEATURE_MATRIX_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace hmm_gmm
+{
+
+struct feature_matrix
+{
+    std::size_t dim = 0;
+    std::size_t frame_no = 0;
+    std::vector<float> data;        /* dim * frame_no values, frame-major */
+
+    feature_matrix() = default;
+    feature_matrix(std::size_t dim_, std::size_t frame_no_)
+        : dim(dim_), frame_no(frame_no_), data(dim_ * frame_no_, 0.0f)
+    {
+    }
+
+    float *frame(std::size_t t) { return data.data() + t * dim; }
+    const float *frame(std::size_t t) const { return data.data() + t * dim; }
+};
+
+struct feature_view
+{
+    std::size_t dim = 0;
+    std::size_t frame_no = 0;
+    const float *data = nullptr;
+
+    feature_view() = default;
+    feature_view(std::size_t dim_, std::size_t frame_no_, const float *data_)
+        : dim(dim_), frame_no(frame_no_), data(data_)
+    {
+    }
+    feature_view(const feature_matrix &m) : dim(m.dim), frame_no(m.frame_no), data(m.data.data()) {}
+
+    const float *frame(std::size_t t) const { return data + t * dim; }
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_FEATURE_MATRIX_HPP */
+/* [] END OF FILE */
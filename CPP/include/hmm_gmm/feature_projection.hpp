@@ -0,0 +1,89 @@
+/******************************************************************************
+* File Name:   feature_projection.hpp
+*
+* Description: Learned linear projection y = W (x - mean) from the 39
+*              dimensional MFCC_E_D_A vectors to out_dim < 39 dimensions.
+*              Every diagonal Gaussian then costs out_dim instead of 39
+*              operations per mixture, state, model and frame.
+*
+*              PCA keeps the directions of largest total variance. LDA keeps
+*              the directions that best separate classes (here the HMM
+*              states of every word, taken from Viterbi alignments), scaled
+*              to unit within-class variance.
+*
+*              Projections are saved as MAT-files with the variables
+*              projection_matrix [out_dim, in_dim], projection_mean
+*              [in_dim, 1] and projection_type ('pca' or 'lda'), which
+*              apply_feature_projection.m reads.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_FEATURE_PROJECTION_HPP)
+#define HMM_GMM_FEATURE_PROJECTION_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/feature_matrix.hpp"
+#include "hmm_gmm/hmm_model.hpp"
+
+namespace hmm_gmm
+{
+
+struct feature_projection
+{
+    std::string type;
+    std::size_t in_dim = 0;
+    std::size_t out_dim = 0;
+    std::vector<double> mean;       /* in_dim */
+    std::vector<double> matrix;     /* out_dim x in_dim, row-major */
+    std::vector<double> eigenvalues;    /* all in_dim, descending; not saved */
+
+    void apply(const float *in, float *out) const;
+    feature_matrix apply(const feature_view &features) const;
+
+    /*
+     * Model for the projected space without retraining: projected means and
+     * the diagonal of W diag(var) W'. Diagonal covariances are only an
+     * approximation after the projection; retraining on projected features
+     * gives the proper model.
+     */
+    hmm_set project_model(const hmm_set &hmm) const;
+};
+
+/* Sufficient statistics: total scatter plus per-class sums and counts */
+class projection_statistics
+{
+public:
+    projection_statistics(std::size_t dim, std::size_t class_no);
+
+    /* class_id is ignored for PCA; frames of class -1 are only counted in the total */
+    void add(const float *x, int class_id);
+    void merge(const projection_statistics &other);
+
+    std::size_t dim() const { return dim_; }
+    double count() const { return count_; }
+
+    feature_projection estimate_pca(std::size_t out_dim) const;
+    feature_projection estimate_lda(std::size_t out_dim) const;
+
+private:
+    std::vector<double> global_mean() const;
+    std::vector<double> total_scatter(const std::vector<double> &mu) const;
+
+    std::size_t dim_;
+    std::size_t class_no_;
+    double count_ = 0.0;
+    std::vector<double> sum_;           /* dim */
+    std::vector<double> outer_;         /* dim x dim, sum of x x' */
+    std::vector<double> class_count_;   /* class_no */
+    std::vector<double> class_sum_;     /* class_no x dim */
+};
+
+void write_feature_projection(const std::string &filename, const feature_projection &projection);
+feature_projection read_feature_projection(const std::string &filename);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_FEATURE_PROJECTION_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,42 @@
+/******************************************************************************
+* File Name:   file_list.hpp
+*
+* Description: Labelled file lists as built by hmm_gmm_speech_recognition_main.m:
+*              the N x 2 cell arrays trainingfile / testingfile of
+*              trainingfile_list.mat and testingfile_list.mat, with the model
+*              id in column 1 and the .mfc path in column 2. Plain text lists
+*              with one "<model id> <path>" pair per line are accepted too.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_FILE_LIST_HPP)
+#define HMM_GMM_FILE_LIST_HPP
+
+#include <string>
+#include <vector>
+
+namespace hmm_gmm
+{
+
+struct labelled_file
+{
+    int label = 0;                  /* model id, 1-based */
+    std::string path;               /* as stored in the list */
+};
+
+/*
+ * Reads a .mat list (variable var_name, or the first cell array if empty)
+ * or a text list. Throws std::runtime_error on malformed lists.
+ */
+std::vector<labelled_file> read_file_list(const std::string &filename, const std::string &var_name = "");
+
+/*
+ * Host path of a list entry: '\' separators of lists saved on Windows become
+ * '/', and relative paths are resolved against base_dir (the directory
+ * MATLAB ran in, ../MATLAB/source for the stock pipeline).
+ */
+std::string resolve_list_path(const std::string &path, const std::string &base_dir);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_FILE_LIST_HPP */
+/* [] END OF FILE */
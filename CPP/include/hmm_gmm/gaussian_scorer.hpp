@@ -0,0 +1,88 @@
+/******************************************************************************
+* File Name:   gaussian_scorer.hpp
+*
+* Description: Batched diagonal-Gaussian scorer. The quadratic form is
+*              expanded so that every Gaussian of every state of every model
+*              is scored against every frame of an utterance with one matrix
+*              product:
+*
+*              log c_g N_g(x) = [x^2, x, 1] . [-1/2 ivar_g, mean_g ivar_g, k_g]
+*              k_g            = log c_g + gconst_g - 1/2 sum_d mean_gd^2 ivar_gd
+*
+*              The Gaussian side is packed once into panels of 32 Gaussians
+*              (k-major, 32 floats per k) and the product runs on a cache
+*              blocked kernel: blocks of frames are expanded to [x^2, x, 1]
+*              rows, and every panel is swept with a register tile of frames
+*              x Gaussians. The kernel is selected at run time (scalar, AVX2 +
+*              FMA, AVX-512F) from what the CPU supports and what the library
+*              was built with.
+*
+*              The expansion costs some precision against the direct form
+*              (x^2 ivar and the constant cancel); for MFCC_E_D_A features the
+*              log-likelihoods agree with compiled_model::log_emission to about
+*              1e-5 relative.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_GAUSSIAN_SCORER_HPP)
+#define HMM_GMM_GAUSSIAN_SCORER_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/feature_matrix.hpp"
+#include "hmm_gmm/log_math.hpp"
+#include "hmm_gmm/simd.hpp"
+
+namespace hmm_gmm
+{
+
+class gaussian_scorer
+{
+public:
+    static constexpr std::size_t PANEL_WIDTH = 32;      /* Gaussians per packed panel */
+
+    /* Packs every Gaussian of the model set; isa must be supported (std::invalid_argument otherwise) */
+    explicit gaussian_scorer(const compiled_model &model);
+    gaussian_scorer(const compiled_model &model, simd_isa isa);
+
+    simd_isa isa() const { return isa_; }
+    std::size_t dim() const { return dim_; }
+    std::size_t mix_no() const { return mix_no_; }
+    std::size_t state_count() const { return state_count_; }            /* model_no * state_no */
+    std::size_t gaussian_no() const { return state_count_ * mix_no_; }
+    std::size_t padded_gaussian_no() const { return panel_no_ * PANEL_WIDTH; }
+    std::size_t inner_size() const { return inner_; }                   /* 2 * dim + 1 */
+
+    /*
+     * log c_g N_g(x_t) of all Gaussians and frames. Gaussian g = (model *
+     * state_no + state) * mix_no + mix is written to out[t * out_stride + g];
+     * out_stride must be at least padded_gaussian_no() and the entries past
+     * gaussian_no() are overwritten with padding values.
+     */
+    void score_gaussians(const feature_view &features, float *out, std::size_t out_stride) const;
+
+    /*
+     * log b_j(x_t) of every emitting state of every model, state s of model
+     * k at out[t * out_stride + k * state_no + s]; out_stride >= state_count().
+     * The mixtures are combined with the given log-add tier.
+     */
+    void score_states(const feature_view &features, float *out, std::size_t out_stride,
+                      log_add_tier tier = log_add_tier::exact) const;
+
+    /* Multiply-adds of score_gaussians() for frame_no frames (padding included) */
+    double multiply_adds(std::size_t frame_no) const
+    {
+        return (double)frame_no * (double)inner_ * (double)padded_gaussian_no();
+    }
+
+private:
+    simd_isa isa_;
+    std::size_t dim_, mix_no_, state_count_, inner_, panel_no_;
+    std::vector<float> panels_;                 /* panel_no * inner * PANEL_WIDTH */
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_GAUSSIAN_SCORER_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,96 @@
+/******************************************************************************
+* File Name:   gaussian_selection.hpp
+*
+* Description: Gaussian selection with a vector quantisation codebook
+*              (Bocchieri 1993). A few Gaussians dominate the log-sum of
+*              each frame, so instead of every mixture of every state of
+*              every model a frame evaluates only a shortlist:
+*
+*              offline  the Gaussian means are clustered with k-means in the
+*                       metric of the pooled inverse variances; for every
+*                       codeword v the shortlist holds the Gaussians with the
+*                       largest log c_g N_g(c_v) at the codeword, and every
+*                       state keeps log b_j(c_v) as the estimate used when
+*                       none of its Gaussians is on the list
+*              runtime  the frame is quantised to the nearest codeword (one
+*                       distance per codeword) and only the shortlist is
+*                       evaluated; the mixtures of a shortlisted state are
+*                       combined as usual, a state without shortlisted
+*                       Gaussians is floored to
+*
+*                       best_j' log b_j'(x) + log b_j(c_v) - max_j' log b_j'(c_v)
+*
+*                       i.e. the best evaluated state of the frame minus the
+*                       gap between the two states at the codeword
+*
+*              The cost per frame is codebook_size + shortlist distances
+*              instead of model_no * state_no * mix_no, independent of the
+*              number of mixtures and models.
+*
+*              Saved as a MAT-file with the variables gs_codebook
+*              [dim, codebook_size], gs_metric [dim, 1], gs_shortlist
+*              [n, 1] (0-based Gaussian indices), gs_shortlist_offset
+*              [codebook_size + 1, 1], gs_floor [model_no * state_no,
+*              codebook_size] and gs_shape [dim mix_no state_no model_no].
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_GAUSSIAN_SELECTION_HPP)
+#define HMM_GMM_GAUSSIAN_SELECTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+
+namespace hmm_gmm
+{
+
+struct gaussian_selection_config
+{
+    std::size_t codebook_size = 64;     /* codewords, at most one per Gaussian */
+    std::size_t shortlist = 32;         /* Gaussians evaluated per frame, at most all of them */
+    std::size_t iterations = 25;        /* k-means iterations */
+};
+
+class gaussian_selection
+{
+public:
+    /* Builds the codebook and the shortlists of a model set */
+    gaussian_selection(const compiled_model &model, const gaussian_selection_config &config);
+
+    /* Reads a saved selection; throws std::runtime_error if it does not belong to the model */
+    gaussian_selection(const compiled_model &model, const std::string &filename);
+
+    const compiled_model &model() const { return *model_; }
+    std::size_t codebook_size() const { return codebook_size_; }
+    std::size_t shortlist_size(std::size_t v) const { return offset_[v + 1] - offset_[v]; }
+    std::size_t gaussian_no() const { return gaussian_no_; }
+
+    /* Nearest codeword of x (stride() floats) */
+    std::size_t quantise(const float *x) const;
+
+    /*
+     * log b_j(x) of every emitting state of every model, state s of model k at
+     * out[k * state_no + s]; x holds stride() floats. Returns the number of
+     * Gaussians evaluated.
+     */
+    std::size_t score_states(const float *x, float *out) const;
+
+    void save(const std::string &filename) const;
+
+private:
+    const compiled_model *model_;
+    std::size_t dim_, stride_, state_count_, gaussian_no_, codebook_size_;
+    std::vector<float> codebook_;           /* codebook_size * stride, metric applied */
+    std::vector<float> metric_;             /* stride, sqrt of the pooled inverse variance */
+    std::vector<std::size_t> offset_;       /* codebook_size + 1 */
+    std::vector<uint32_t> shortlist_;       /* Gaussian indices, ascending per codeword */
+    std::vector<float> floor_;              /* codebook_size * state_count: log b_j(c_v) - max_j log b_j(c_v) */
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_GAUSSIAN_SELECTION_HPP */
+/* [] END OF FILE */
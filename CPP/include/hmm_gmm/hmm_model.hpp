@@ -0,0 +1,65 @@
+/******************************************************************************
+* File Name:   hmm_model.hpp
+*
+* Description: Left-to-right GMM-HMM word models as trained by
+*              hmm_gmm_training.m and saved in HMM_<iter>.mat:
+*
+*              HMM.mean   [DIM, mix, state, model]
+*              HMM.var    [DIM, mix, state, model]
+*              HMM.weight [state, mix, model]
+*              HMM.Aij    [state + 2, state + 2, model], with the non
+*                         emitting START (1) and END (state + 2) nodes
+*
+*              Each model is stored state-major here: mean/var of state s,
+*              mixture m start at (s * mix_no + m) * dim, which is the
+*              MATLAB column-major order of one model's slice.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_HMM_MODEL_HPP)
+#define HMM_GMM_HMM_MODEL_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace hmm_gmm
+{
+
+struct hmm_model
+{
+    std::size_t dim = 0;
+    std::size_t mix_no = 0;
+    std::size_t state_no = 0;       /* emitting states, START/END excluded */
+    std::vector<double> mean;       /* state_no * mix_no * dim */
+    std::vector<double> var;        /* state_no * mix_no * dim */
+    std::vector<double> weight;     /* state_no * mix_no */
+    std::vector<double> aij;        /* (state_no + 2)^2, row-major, aij[i * (state_no + 2) + j] */
+
+    std::size_t node_no() const { return state_no + 2; }
+    double transition(std::size_t from_node, std::size_t to_node) const { return aij[from_node * node_no() + to_node]; }
+    const double *mean_of(std::size_t state, std::size_t mix) const { return &mean[(state * mix_no + mix) * dim]; }
+    const double *var_of(std::size_t state, std::size_t mix) const { return &var[(state * mix_no + mix) * dim]; }
+
+    /* log b_j(x) of emitting state 'state' (0-based), as log_hmm_gmm() in hmm_gmm_testing.m */
+    double log_emission(std::size_t state, const float *x) const;
+};
+
+struct hmm_set
+{
+    std::vector<hmm_model> models;  /* model k is model_id k + 1 */
+
+    std::size_t dim() const { return models.empty() ? 0 : models[0].dim; }
+    std::size_t mix_no() const { return models.empty() ? 0 : models[0].mix_no; }
+    std::size_t state_no() const { return models.empty() ? 0 : models[0].state_no; }
+};
+
+/* Loads the HMM struct of HMM_<iter>.mat; throws std::runtime_error for malformed models */
+hmm_set read_hmm_mat(const std::string &filename, const std::string &var_name = "HMM");
+
+/* Saves in the same layout, loadable by hmm_gmm_testing.m */
+void write_hmm_mat(const std::string &filename, const hmm_set &hmm, const std::string &var_name = "HMM");
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_HMM_MODEL_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,40 @@
+/******************************************************************************
+* File Name:   htk_file.hpp
+*
+* Description: Reader and writer for the HTK parameter files (.mfc) produced
+*              by read_file_and_compute_mfcc() in run_feature_extraction.m.
+*              The 12 byte header and the float32 body are big-endian.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_HTK_FILE_HPP)
+#define HMM_GMM_HTK_FILE_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "hmm_gmm/feature_matrix.hpp"
+
+namespace hmm_gmm
+{
+
+/* parameter kind code: MFCC=6, _E=64, _D=256, _A=512, MFCC_E_D_A=6+64+256+512=838 */
+constexpr int16_t HTK_PARM_KIND_MFCC_E_D_A = 838;
+
+struct htk_header
+{
+    int32_t n_samples = 0;          /* number of frames */
+    int32_t samp_period = 0;        /* frame shift in 100 ns units */
+    int16_t samp_size = 0;          /* bytes per frame, 4 * dim */
+    int16_t parm_kind = 0;
+};
+
+/* Throws std::runtime_error if the file cannot be opened or is truncated. */
+feature_matrix read_htk_file(const std::string &filename, htk_header *header = nullptr);
+
+void write_htk_file(const std::string &filename, const feature_matrix &features,
+                    int32_t samp_period, int16_t parm_kind = HTK_PARM_KIND_MFCC_E_D_A);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_HTK_FILE_HPP */
+/* [] END OF FILE */
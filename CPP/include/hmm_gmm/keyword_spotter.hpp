@@ -0,0 +1,147 @@
+/******************************************************************************
+* File Name:   keyword_spotter.hpp
+*
+* Description: Frame-synchronous keyword spotting over an unbounded feature
+*              stream. hmm_gmm_testing.m decodes one segmented utterance and
+*              always picks a keyword; the firmware feeds it fixed 1 s blocks,
+*              so a word across a block boundary is lost. The spotter instead
+*              runs a looped network over the stream:
+*
+*                  background --> keyword k --> END --> background
+*                      ^  |
+*                      +--+ filler
+*
+*              One model of the set is the filler, trained on non-keyword
+*              audio (an extra class next to the keywords). It is used as a
+*              one-state garbage loop: a background frame scores the best of
+*              its states, g(t) = max_j log b_filler,j(o_t), plus a penalty
+*              per frame that trades misses for false alarms.
+*
+*              Every other model is a keyword whose START can be entered
+*              from the background at any frame. Each state carries the
+*              frame its token entered the keyword, so a hypothesis comes
+*              with its start and end frame. A keyword END wins when it beats
+*              the background by the threshold:
+*
+*                  E_k(t) - B(t) > threshold,   E_k(t) = max_j f_k,j(t) + log a_j,END
+*
+*              The first frame that happens is usually inside the last state
+*              of the word, and the rest of the word would then be spotted
+*              again. The best winning END is therefore held while
+*              overlapping hypotheses improve on it, and emitted once it has
+*              stayed the best for hold_frames frames or a winning END starts
+*              after it; the keyword tokens that overlap it are cleared.
+*              Tokens older than max_frames are dropped, or a keyword whose
+*              last state matches the audio better than the filler would
+*              absorb the rest of the stream.
+*
+*              Scores are kept relative to the background, which is
+*              renormalised to 0 every frame, so the stream has no length
+*              limit; all state lives in the object and frames may be pushed
+*              in chunks of any size.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_KEYWORD_SPOTTER_HPP)
+#define HMM_GMM_KEYWORD_SPOTTER_HPP
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/sparse_transitions.hpp"
+
+namespace hmm_gmm
+{
+
+struct spotter_config
+{
+    std::size_t filler = 0;         /* 0-based model index of the filler */
+    double filler_penalty = 0.0;    /* added to the background score per frame */
+    double threshold = 0.0;         /* minimum E_k - B of a detection */
+    double beam = std::numeric_limits<double>::infinity();   /* keyword states below B - beam are dropped */
+    std::size_t hold_frames = 5;    /* frames a winning END must stay the best before it is emitted */
+    std::size_t max_frames = 100;   /* longest keyword, 1 s clips; 0 = unlimited */
+};
+
+struct keyword_detection
+{
+    std::size_t keyword = 0;        /* 0-based model index */
+    std::size_t start_frame = 0;    /* first frame of the keyword, counted from the start of the stream */
+    std::size_t end_frame = 0;      /* last frame; the detection is emitted hold_frames later */
+    double score = 0.0;             /* E_k - B, the log-likelihood ratio against the background */
+};
+
+class keyword_spotter
+{
+public:
+    /*
+     * The model must outlive the spotter; throws std::invalid_argument if the
+     * filler is not a model of the set or the set has no other model
+     */
+    keyword_spotter(const compiled_model &model, const spotter_config &config);
+
+    const spotter_config &config() const { return config_; }
+    std::size_t dim() const { return model_->dim(); }
+
+    /*
+     * Advances the search by one frame of model.dim() floats and appends a
+     * the detections that became final at this frame to out. Returns the
+     * number of detections added (0, 1, or 2 when a held one is emitted
+     * together with a new one at hold_frames = 0).
+     */
+    std::size_t push(const float *frame, std::vector<keyword_detection> &out);
+
+    /*
+     * The same for a frame whose state emissions are already scored:
+     * emissions holds log b_s(o_t) of state s of model k at
+     * k * state_no + s, the row layout of emission_cache and
+     * gaussian_scorer::score_states(). Lets a long recording be scored in
+     * bulk once and spotted from the matrix.
+     */
+    std::size_t push_emissions(const float *emissions, std::vector<keyword_detection> &out);
+
+    /*
+     * End of stream: appends the held detection, if any, to out. Returns the
+     * number of detections added (0 or 1).
+     */
+    std::size_t finish(std::vector<keyword_detection> &out);
+
+    /* Starts a new stream */
+    void reset();
+
+    /* Frames pushed since the start of the stream */
+    std::size_t frame_no() const { return frame_no_; }
+
+    /*
+     * Keyword state emissions computed (push) or read (push_emissions) since
+     * construction; the filler states add state_no per frame
+     */
+    std::size_t evaluations() const { return evaluations_; }
+
+private:
+    /* One frame of the network; emission(k, s) gives log b_s(o_t) of state s of model k */
+    template <typename Emission>
+    std::size_t step(Emission emission, std::vector<keyword_detection> &out);
+
+    /* Appends the held detection and clears the tokens that overlap it; returns 1 */
+    std::size_t emit(std::vector<keyword_detection> &out);
+
+    const compiled_model *model_;
+    spotter_config config_;
+    std::size_t state_no_;
+    std::vector<std::size_t> keywords_;             /* model indices without the filler */
+    std::vector<sparse_transitions> transitions_;   /* per keyword */
+    std::vector<float> x_;                          /* prepared frame, stride floats */
+    std::vector<double> score_, next_;              /* keyword * state_no + j, relative to the background */
+    std::vector<std::size_t> start_, next_start_;   /* entry frame of the token in each state */
+    keyword_detection held_;                        /* best winning END not emitted yet */
+    bool holding_ = false;
+    std::size_t frame_no_ = 0;
+    std::size_t evaluations_ = 0;
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_KEYWORD_SPOTTER_HPP */
+/* [] END OF FILE */
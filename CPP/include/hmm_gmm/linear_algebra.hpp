@@ -0,0 +1,35 @@
+/******************************************************************************
+* File Name:   linear_algebra.hpp
+*
+* Description: Small dense symmetric matrix routines for the feature
+*              projection estimation (matrices of feature dimension, 39 x 39).
+*              Matrices are row-major std::vector<double> of n * n values.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_LINEAR_ALGEBRA_HPP)
+#define HMM_GMM_LINEAR_ALGEBRA_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace hmm_gmm
+{
+
+/*
+ * Eigen decomposition of a symmetric matrix by cyclic Jacobi rotations.
+ * Eigenvalues are returned in descending order; row k of eigenvectors is
+ * the unit eigenvector of eigenvalues[k].
+ */
+void symmetric_eigen(const std::vector<double> &a, std::size_t n,
+                     std::vector<double> &eigenvalues, std::vector<double> &eigenvectors);
+
+/* Lower triangular L with a = L * L'; throws std::runtime_error if a is not positive definite */
+std::vector<double> cholesky(const std::vector<double> &a, std::size_t n);
+
+/* Inverse of a lower triangular matrix */
+std::vector<double> invert_lower(const std::vector<double> &l, std::size_t n);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_LINEAR_ALGEBRA_HPP */
+/* [] END OF FILE */
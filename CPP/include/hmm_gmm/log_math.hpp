@@ -0,0 +1,74 @@
+/******************************************************************************
+* File Name:   log_math.hpp
+*
+* Description: Log-domain addition. One implementation of the pattern that
+*              log_mul_Gau, log_sum_alpha, log_sum_beta, log_sum_alpha_beta
+*              and log_hmm_gmm repeat (max scan, exp of the differences,
+*              log of the sum, special cases for -Inf), in three accuracy
+*              tiers:
+*
+*              exact       std::exp / std::log in double precision; the
+*                          float result is correctly rounded
+*              polynomial  float range reduction + Cephes-style minimax
+*                          polynomials for exp and log, SIMD kernels
+*                          (scalar, AVX2, AVX-512) selected at run time
+*              table       HTK-style LAdd: max + log(1 + exp(-d)) from a
+*                          table over d in [0, 16) with 1/64 steps and
+*                          linear interpolation, 0 beyond (no libm calls,
+*                          the tier meant for cores without a fast exp)
+*
+*              Absolute error against the exact value of the float inputs,
+*              with r the result (log_add_error_bound()):
+*
+*              exact       2^-24 |r| (rounding of the double result)
+*              polynomial  1e-6 + 2^-22 |r|
+*              table       8e-6 per log-add + 2^-22 |r|; a sum of n terms
+*                          folds n - 1 log-adds. The interpolation error
+*                          of log(1 + exp(-d)) is at most (1/64)^2/8 * 1/4
+*                          = 7.6e-6, the cut-off at d = 16 adds 1.2e-7.
+*
+*              -Inf terms are exact zeros of the sum; the sum of no finite
+*              terms is -Inf. +Inf and NaN inputs are not supported.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_LOG_MATH_HPP)
+#define HMM_GMM_LOG_MATH_HPP
+
+#include <cstddef>
+
+#include "hmm_gmm/simd.hpp"
+
+namespace hmm_gmm
+{
+
+enum class log_add_tier
+{
+    exact,
+    polynomial,
+    table
+};
+
+/* "exact", "polynomial", "table" */
+const char *log_add_tier_name(log_add_tier tier);
+
+/* Documented absolute error bound of a sum of 'terms' values with result r */
+double log_add_error_bound(log_add_tier tier, std::size_t terms, double r);
+
+/* log(exp(a) + exp(b)) */
+float log_add(log_add_tier tier, float a, float b);
+
+/* out[i] = log(exp(a[i]) + exp(b[i])); out may alias a or b */
+void log_add(log_add_tier tier, const float *a, const float *b, float *out, std::size_t n,
+             simd_isa isa = best_simd_isa());
+
+/*
+ * out[g] = log sum_m exp(in[g * group + m]) for g < group_no, e.g. the
+ * mixtures of every state (group = mix_no). out must not alias in.
+ */
+void log_sum_exp_groups(log_add_tier tier, const float *in, std::size_t group, std::size_t group_no, float *out,
+                        simd_isa isa = best_simd_isa());
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_LOG_MATH_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,49 @@
+/******************************************************************************
+* File Name:   mapped_file.hpp
+*
+* Description: Read-only memory mapping of a whole file. On POSIX systems the
+*              file is mapped with mmap(); elsewhere it is read into an
+*              aligned heap buffer, so callers see the same interface.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_MAPPED_FILE_HPP)
+#define HMM_GMM_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace hmm_gmm
+{
+
+class mapped_file
+{
+public:
+    mapped_file() = default;
+
+    /* Throws std::runtime_error if the file cannot be opened or mapped */
+    explicit mapped_file(const std::string &filename);
+    ~mapped_file();
+
+    mapped_file(mapped_file &&other) noexcept;
+    mapped_file &operator=(mapped_file &&other) noexcept;
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    /* Page aligned start of the file content; nullptr for an empty file */
+    const unsigned char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+    const std::string &filename() const { return filename_; }
+
+private:
+    void release();
+
+    std::string filename_;
+    const unsigned char *data_ = nullptr;
+    std::size_t size_ = 0;
+    bool mapped_ = false;           /* false: data_ is a heap buffer */
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_MAPPED_FILE_HPP */
+/* [] END OF FILE */
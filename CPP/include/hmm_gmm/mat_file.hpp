@@ -0,0 +1,89 @@
+/******************************************************************************
+* File Name:   mat_file.hpp
+*
+* Description: Reader for MATLAB Level 5 MAT-files (save -v6 / -v7, the
+*              default format of save()), enough to load the file lists
+*              (trainingfile / testingfile cell arrays) and the HMM_<iter>.mat
+*              model structs written by the MATLAB pipeline.
+*
+*              Supported: numeric and logical arrays (converted to double),
+*              char arrays, cell arrays, structs and compressed (-v7)
+*              variables. Not supported: sparse arrays, objects and -v7.3
+*              (HDF5) files.
+*
+*              The writer produces uncompressed Level 5 files (as save -v6)
+*              with double, char, cell and struct arrays.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_MAT_FILE_HPP)
+#define HMM_GMM_MAT_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hmm_gmm
+{
+
+/* mxClassID values of the MAT-file format */
+enum class mat_class : uint8_t
+{
+    unknown = 0,
+    cell = 1,
+    structure = 2,
+    object = 3,
+    character = 4,
+    sparse = 5,
+    float64 = 6,
+    float32 = 7,
+    int8 = 8,
+    uint8 = 9,
+    int16 = 10,
+    uint16 = 11,
+    int32 = 12,
+    uint32 = 13,
+    int64 = 14,
+    uint64 = 15,
+};
+
+struct mat_array
+{
+    std::string name;
+    mat_class type = mat_class::unknown;
+    bool logical = false;
+    std::vector<std::size_t> dims;      /* at least two entries */
+    std::vector<double> real;           /* numeric data, column-major */
+    std::string text;                   /* char data, column-major */
+    std::vector<std::string> field_names;
+    std::vector<mat_array> elements;    /* cell: numel entries; struct: numel * fields */
+
+    std::size_t numel() const;
+    std::size_t rows() const { return dims.empty() ? 0 : dims[0]; }
+    std::size_t cols() const { return dims.size() < 2 ? 1 : numel() / rows(); }
+    bool is_numeric() const { return type >= mat_class::float64; }
+
+    /* Checked accessors; throw std::runtime_error on a type or index mismatch */
+    const mat_array &cell(std::size_t row, std::size_t col) const;
+    const mat_array &field(const std::string &field_name, std::size_t element = 0) const;
+    double scalar() const;
+    std::string string() const;
+};
+
+/* All variables of the file. Throws std::runtime_error for unreadable files. */
+std::vector<mat_array> read_mat_file(const std::string &filename);
+
+/* One variable by name; throws std::runtime_error if it is missing. */
+mat_array read_mat_variable(const std::string &filename, const std::string &name);
+
+/* Throws std::runtime_error on I/O errors, std::invalid_argument for unsupported arrays. */
+void write_mat_file(const std::string &filename, const std::vector<mat_array> &variables);
+
+/* double array with MATLAB dims and column-major values */
+mat_array make_mat_numeric(const std::string &name, const std::vector<std::size_t> &dims, std::vector<double> values);
+mat_array make_mat_char(const std::string &name, const std::string &text);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_MAT_FILE_HPP */
+/* [] END OF FILE */
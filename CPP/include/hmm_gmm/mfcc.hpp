@@ -0,0 +1,119 @@
+/******************************************************************************
+* File Name:   mfcc.hpp
+*
+* Description: Native MFCC_E_D_A front-end. Produces the same 39 dimensional
+*              [mfcc; logpow; delta; delta-delta] vectors as wav2mfcc_e_d_a.m
+*              for the settings in run_feature_extraction.m, but frames the
+*              signal once, uses precomputed sparse mel filter weights and a
+*              real-input FFT.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_MFCC_HPP)
+#define HMM_GMM_MFCC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/feature_matrix.hpp"
+#include "hmm_gmm/real_fft.hpp"
+
+namespace hmm_gmm
+{
+
+/* Front-end settings, defaults are the values used in run_feature_extraction.m */
+struct mfcc_config
+{
+    double sample_rate = 16000.0;
+    double frame_size_sec = 0.025;
+    double frame_shift_sec = 0.010;
+    bool use_hamming = true;
+    double pre_emp = 0.0;
+    int bank_no = 26;
+    int cep_order = 12;
+    int lifter = 22;
+    int delta_win = 2;              /* delta_win_weight = ones(1, 2*delta_win+1) */
+
+    std::size_t frame_size() const;
+    std::size_t frame_shift() const;
+    std::size_t fft_size() const;
+    std::size_t static_dim() const { return (std::size_t)cep_order + 1; }
+    std::size_t feature_dim() const { return 3 * static_dim(); }
+    int32_t htk_samp_period() const;
+
+    /* Canonical text of all settings, used for cache keys and metadata */
+    std::string to_string() const;
+};
+
+class mfcc_extractor
+{
+public:
+    /* triangle weights of one filter, applied to bins first_bin.. */
+    struct mel_filter
+    {
+        std::size_t first_bin;
+        std::vector<double> weights;
+    };
+
+    explicit mfcc_extractor(const mfcc_config &config);
+
+    const mfcc_config &config() const { return config_; }
+
+    /* frame_no = floor(1 + (len - frame_size)/frame_shift), 0 for short input */
+    std::size_t frame_count(std::size_t num_samples) const;
+
+    /*
+     * Static part [mfcc(1:cep_order); logpow] of one frame. frame points at
+     * frame_size samples; previous_sample is the sample preceding the frame
+     * (0 for the first frame) and is only used for pre-emphasis.
+     */
+    void compute_static_frame(const float *frame, float previous_sample, double *out);
+
+    /* Full MFCC_E_D_A sequence of an utterance, feature_dim() x frame_count(n) */
+    feature_matrix compute(const float *samples, std::size_t num_samples);
+
+    /*
+     * Frames [first, first + count) of compute(samples, num_samples), bit for
+     * bit, computed from the samples of those frames and 2 * delta_win frames
+     * of context on either side only. Lets a long recording be processed in
+     * segments, in parallel, with one extractor per thread. count is clipped
+     * to the frames of the recording.
+     */
+    feature_matrix compute_frames(const float *samples, std::size_t num_samples, std::size_t first,
+                                  std::size_t count);
+
+    /*
+     * Weights of the slope() regression: out(t) = scale * sum_k slope(k) * in(t+k),
+     * k = -delta_win..delta_win, edges clamped to the boundary frames.
+     */
+    const std::vector<double> &delta_weights() const { return delta_weights_; }
+
+    /* Analysis tables, used to check other front-end implementations */
+    const std::vector<double> &window() const { return hamming_; }
+    const std::vector<mel_filter> &mel_filters() const { return filters_; }
+    const std::vector<double> &dct_matrix() const { return dct_; }
+    const std::vector<double> &lifter_weights() const { return lifter_; }
+
+private:
+    mfcc_config config_;
+    std::size_t frame_size_;
+    std::size_t frame_shift_;
+    real_fft fft_;
+    std::vector<double> hamming_;
+    std::vector<mel_filter> filters_;
+    std::vector<double> dct_;           /* cep_order x bank_no, row-major */
+    std::vector<double> lifter_;
+    std::vector<double> delta_weights_; /* already includes 0.01/frame_shift_sec */
+
+    /* scratch, reused for every frame */
+    std::vector<double> frame_;
+    std::vector<double> spectrum_;
+    std::vector<double> log_mel_;
+    std::vector<double> statics_;
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_MFCC_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,40 @@
+/******************************************************************************
+* File Name:   parallel.hpp
+*
+* Description: Minimal data-parallel helpers for the command line tools.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_PARALLEL_HPP)
+#define HMM_GMM_PARALLEL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace hmm_gmm
+{
+
+/* Number of hardware threads, at least 1 */
+std::size_t hardware_threads();
+
+/*
+ * Calls body(index, worker) for every index in [0, count) on up to threads
+ * workers. Indices are handed out dynamically one at a time, so uneven item
+ * costs balance out. The first exception thrown by body is rethrown after
+ * all workers have stopped.
+ */
+void parallel_for(std::size_t count, std::size_t threads,
+                  const std::function<void(std::size_t index, std::size_t worker)> &body);
+
+/*
+ * The same over the indices in order, handed out in that order. Putting the
+ * most expensive items first keeps a long item from starting last and
+ * stalling the other workers at the end (longest processing time first).
+ */
+void parallel_for(const std::vector<std::size_t> &order, std::size_t threads,
+                  const std::function<void(std::size_t index, std::size_t worker)> &body);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_PARALLEL_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,50 @@
+/******************************************************************************
+* File Name:   real_fft.hpp
+*
+* Description: Real-input FFT of a power-of-two length N. The transform runs
+*              an N/2 point complex FFT on the even/odd packed input and
+*              splits the result, so it does half the work of the complex
+*              fft(s, N) used in wav2mfcc.m.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_REAL_FFT_HPP)
+#define HMM_GMM_REAL_FFT_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace hmm_gmm
+{
+
+class real_fft
+{
+public:
+    /* n must be a power of two and at least 4 */
+    explicit real_fft(std::size_t n);
+
+    std::size_t size() const { return n_; }
+
+    /*
+     * Magnitude spectrum |X(k)|, k = 0..N/2, of the real sequence in[0..N-1].
+     * out must hold N/2 + 1 values. Not thread-safe: uses internal scratch.
+     */
+    void magnitude(const double *in, double *out);
+
+private:
+    void complex_fft();
+
+    std::size_t n_;
+    std::size_t half_;
+    std::vector<std::size_t> bit_reverse_;
+    std::vector<double> twiddle_re_;    /* exp(-2*pi*i*k/(N/2)), k < N/4 */
+    std::vector<double> twiddle_im_;
+    std::vector<double> split_re_;      /* exp(-2*pi*i*k/N), k <= N/2 */
+    std::vector<double> split_im_;
+    std::vector<double> re_;
+    std::vector<double> im_;
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_REAL_FFT_HPP */
+/* [] END OF FILE */
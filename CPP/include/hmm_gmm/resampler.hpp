@@ -0,0 +1,71 @@
+/******************************************************************************
+* File Name:   resampler.hpp
+*
+* Description: Rational polyphase resampler (up L, down M) with a Kaiser
+*              windowed sinc low-pass, used to bring 44.1/48 kHz recordings to
+*              the 16 kHz rate of the front-end. Each output sample is one dot
+*              product of taps_per_phase() coefficients with contiguous input
+*              samples; taps_per_phase() is a multiple of 8 so the dot product
+*              vectorizes without a scalar tail.
+*
+*              Output sample n is the value at input time n * M / L, so the
+*              output of a signal of N samples has ceil(N * L / M) samples and
+*              no group delay.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_RESAMPLER_HPP)
+#define HMM_GMM_RESAMPLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hmm_gmm
+{
+
+class polyphase_resampler
+{
+public:
+    /*
+     * in_rate and out_rate must be integer rates. zero_crossings is the
+     * number of sinc zero crossings on each side of the filter centre and
+     * rolloff the cutoff as a fraction of the lower Nyquist frequency.
+     */
+    polyphase_resampler(double in_rate, double out_rate, int zero_crossings = 32, double rolloff = 0.92);
+
+    std::size_t up() const { return up_; }
+    std::size_t down() const { return down_; }
+    std::size_t taps_per_phase() const { return taps_; }
+    std::size_t output_count(std::size_t input_count) const;
+
+    /* Whole signal at once, reading the input in place */
+    std::vector<float> resample(const float *in, std::size_t n) const;
+
+    /* Streaming: outputs are appended as soon as their input window is complete */
+    void process(const float *in, std::size_t n, std::vector<float> &out);
+    /* Emits the remaining outputs of the stream and resets it */
+    void finish(std::vector<float> &out);
+    void reset();
+
+private:
+    const float *phase(std::size_t p) const { return &coeffs_[p * taps_]; }
+    float output_at(const float *window_end, uint64_t n) const;
+    void emit(std::vector<float> &out, bool final);
+
+    std::size_t up_;
+    std::size_t down_;
+    std::size_t taps_;
+    std::size_t delay_;             /* filter centre, in upsampled samples */
+    std::vector<float> coeffs_;     /* up_ phases of taps_ coefficients, each reversed */
+
+    /* streaming state; history_[0] is input sample history_start_ */
+    std::vector<float> history_;
+    int64_t history_start_ = 0;
+    uint64_t input_count_ = 0;
+    uint64_t next_output_ = 0;
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_RESAMPLER_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,36 @@
+/******************************************************************************
+* File Name:   simd.hpp
+*
+* Description: Run-time selection of the SIMD kernels. Kernels for wider
+*              instruction sets live in their own translation units, built
+*              with per-file target flags (HMM_GMM_HAVE_AVX2 /
+*              HMM_GMM_HAVE_AVX512), and are only called after a CPU check,
+*              so the library itself keeps the baseline ISA.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_SIMD_HPP)
+#define HMM_GMM_SIMD_HPP
+
+namespace hmm_gmm
+{
+
+enum class simd_isa
+{
+    scalar,
+    avx2,       /* AVX2 + FMA + F16C, 8 floats per register */
+    avx512      /* AVX-512F, 16 floats per register */
+};
+
+/* Name for reports: "scalar", "avx2", "avx512" */
+const char *simd_isa_name(simd_isa isa);
+
+/* true if the library was built with the kernel and the CPU can run it */
+bool simd_isa_supported(simd_isa isa);
+
+/* Widest supported kernel, detected once */
+simd_isa best_simd_isa();
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_SIMD_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,137 @@
+/******************************************************************************
+* File Name:   sparse_transitions.hpp
+*
+* Description: Transitions of one model as predecessor lists with the
+*              reachability bounds of its states, shared by the Viterbi
+*              searches and the keyword spotter.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_SPARSE_TRANSITIONS_HPP)
+#define HMM_GMM_SPARSE_TRANSITIONS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+
+namespace hmm_gmm
+{
+
+/* earliest / to_end of a state no path can use */
+inline constexpr std::size_t UNREACHABLE = std::numeric_limits<std::size_t>::max();
+
+/*
+ * The transitions of one model as predecessor lists. The predecessors of
+ * emitting state j are pred[first[j]] .. pred[first[j + 1] - 1], in
+ * increasing order (the tie order of the dense loop), with their log aij in
+ * log_a. Only forward moves i <= j with aij > 0 are kept: two per state for
+ * the strict left-to-right models of hmm_gmm_training.m instead of n.
+ *
+ * earliest[j] is the first frame (0-based) a path can be in j, to_end[j] the
+ * fewest frames that must follow a frame in j before the path can leave to
+ * END. At frame t of T only the states with earliest[j] <= t and
+ * to_end[j] <= T - 1 - t lie on a complete path; for the left-to-right models
+ * that is the band max(1, N - (T - t)) <= j <= min(t, N) (1-based).
+ */
+struct sparse_transitions
+{
+    std::size_t n = 0;
+    std::vector<std::size_t> first;
+    std::vector<std::size_t> pred;
+    std::vector<double> log_a;
+    std::vector<double> log_entry;
+    std::vector<double> log_exit;
+    std::vector<std::size_t> earliest;
+    std::vector<std::size_t> to_end;
+};
+
+/*******************************************************************************
+* Function Name: build_sparse_transitions
+********************************************************************************
+* Summary:
+*  Collects the predecessor lists of the n emitting states from a node
+*  table (START = node 0, emitting state j = node j + 1, END = node n + 1)
+*  and derives the reachability bounds. As all moves go forward, earliest is
+*  final in one pass in increasing state order and to_end in one pass in
+*  decreasing order.
+*
+* Parameters:
+*  n:        emitting states
+*  log_node: log_node(i, j) = log aij between nodes i and j
+*  s:        receives the transitions
+*
+*******************************************************************************/
+template <typename LogNode>
+void build_sparse_transitions(std::size_t n, LogNode log_node, sparse_transitions &s)
+{
+    const double neg_inf = -std::numeric_limits<double>::infinity();
+    s.n = n;
+    s.first.assign(1, 0);
+    s.pred.clear();
+    s.log_a.clear();
+    s.log_entry.resize(n);
+    s.log_exit.resize(n);
+    s.earliest.assign(n, UNREACHABLE);
+    s.to_end.assign(n, UNREACHABLE);
+    for (std::size_t j = 0; j < n; j++)
+    {
+        s.log_entry[j] = log_node(0, j + 1);
+        s.log_exit[j] = log_node(j + 1, n + 1);
+        if (s.log_entry[j] > neg_inf)
+        {
+            s.earliest[j] = 0;
+        }
+        for (std::size_t i = 0; i <= j; i++)
+        {
+            const double a = log_node(i + 1, j + 1);
+            if (a > neg_inf)
+            {
+                s.pred.push_back(i);
+                s.log_a.push_back(a);
+                if (i < j && s.earliest[i] != UNREACHABLE)
+                {
+                    s.earliest[j] = std::min(s.earliest[j], s.earliest[i] + 1);
+                }
+            }
+        }
+        s.first.push_back(s.pred.size());
+    }
+    for (std::size_t j = n; j-- > 0;)
+    {
+        if (s.log_exit[j] > neg_inf)
+        {
+            s.to_end[j] = 0;
+        }
+        if (s.to_end[j] == UNREACHABLE)
+        {
+            continue;
+        }
+        for (std::size_t p = s.first[j]; p < s.first[j + 1]; p++)
+        {
+            if (s.pred[p] < j)
+            {
+                s.to_end[s.pred[p]] = std::min(s.to_end[s.pred[p]], s.to_end[j] + 1);
+            }
+        }
+    }
+}
+
+/* The transitions of n emitting states from the (n + 2)^2 log node table a */
+inline void emitting_transitions(const float *a, std::size_t n, sparse_transitions &s)
+{
+    const std::size_t node_no = n + 2;
+    build_sparse_transitions(n, [&](std::size_t i, std::size_t j) { return (double)a[i * node_no + j]; }, s);
+}
+
+/* The transitions of model model_index of a compiled set */
+inline void compiled_transitions(const compiled_model &model, std::size_t model_index, sparse_transitions &s)
+{
+    emitting_transitions(model.log_transitions(model_index), model.state_no(), s);
+}
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_SPARSE_TRANSITIONS_HPP */
+/* [] END OF FILE */
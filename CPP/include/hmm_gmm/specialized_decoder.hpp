@@ -0,0 +1,98 @@
+/******************************************************************************
+* File Name:   specialized_decoder.hpp
+*
+* Description: Decoder with the model sizes fixed at compile time. DIM, the
+*              number of states and the number of mixtures are fixed per
+*              deployed model, so the Gaussian, mixture and Viterbi loops are
+*              written once as templates over a shape and instantiated for
+*              the shapes we ship (see specialized_decoder.cpp). The bounds
+*              are constants there and the compiler unrolls the Gaussian
+*              loop. Any other shape runs the same template with the sizes
+*              read from the model at run time. The double-precision log-sum
+*              over the mixtures stays scalar to keep the scores identical,
+*              and it dominates, so on the host this is no faster than
+*              recognise() on an emission cache (see CPP/README.md). The
+*              template is the host model of the generated C decoder.
+*
+*              The search is frame-synchronous: all models advance one frame
+*              at a time, and a state's emission is computed only once the
+*              state is reachable. Scores are identical to
+*              recognise(const compiled_model &, ...).
+*
+*              write_specialized_c_source() emits the same decoder as C for
+*              the PSoC6 (gmm_hmm/specialized_model.h), with the model as
+*              const arrays in flash and the sizes as macros.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_SPECIALIZED_DECODER_HPP)
+#define HMM_GMM_SPECIALIZED_DECODER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/feature_matrix.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+namespace hmm_gmm
+{
+
+struct model_shape
+{
+    std::size_t dim = 0;
+    std::size_t state_no = 0;
+    std::size_t mix_no = 0;
+};
+
+/* The shapes with a compile-time instantiation in this build */
+const std::vector<model_shape> &specialized_shapes();
+
+class specialized_decoder
+{
+public:
+    /* Largest mixture count of the size-generic kernel */
+    static constexpr std::size_t MAX_GENERIC_MIX = 64;
+
+    /*
+     * Takes the instantiation of the model's shape, or the size-generic one
+     * if there is none or generic is set. Float32 images only; throws
+     * std::invalid_argument otherwise. The model must outlive the decoder.
+     */
+    explicit specialized_decoder(const compiled_model &model, bool generic = false);
+
+    const compiled_model &model() const { return *model_; }
+    bool specialized() const { return specialized_; }
+
+    /* log b_j(x) as the emission cache stores it; x holds stride() floats, zero padded */
+    float log_emission(std::size_t model, std::size_t state, const float *x) const
+    {
+        return emission_(*model_, model, state, x);
+    }
+
+    /* The best model and the scores of all models */
+    recognition_result recognise(const feature_view &features) const;
+
+private:
+    using emission_fn = float (*)(const compiled_model &, std::size_t, std::size_t, const float *);
+    using decode_fn = recognition_result (*)(const compiled_model &, const double *, const feature_view &);
+
+    const compiled_model *model_;
+    bool specialized_ = false;
+    emission_fn emission_ = nullptr;
+    decode_fn decode_ = nullptr;
+    std::vector<double> transitions_;   /* per model: log_a[n * n], log_entry[n], log_exit[n] */
+};
+
+/*
+ * Writes gmm_hmm/specialized_model.c for the model: the Gaussians and
+ * transitions as const arrays with sizes known at compile time, and the
+ * frame-synchronous decoder of specialized_model.h. Float32 images only
+ * (std::invalid_argument).
+ */
+void write_specialized_c_source(const std::string &filename, const compiled_model &model);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_SPECIALIZED_DECODER_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,73 @@
+/******************************************************************************
+* File Name:   streaming_mfcc.hpp
+*
+* Description: Frame-incremental MFCC_E_D_A front-end. PCM samples are pushed
+*              in chunks of any size and each 39 dimensional vector is
+*              emitted as soon as the delta and delta-delta windows have
+*              seen their lookahead (2 * delta_win frames). The output is
+*              identical to mfcc_extractor::compute() on the whole utterance,
+*              including the boundary handling of slope().
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_STREAMING_MFCC_HPP)
+#define HMM_GMM_STREAMING_MFCC_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "hmm_gmm/mfcc.hpp"
+
+namespace hmm_gmm
+{
+
+class streaming_mfcc
+{
+public:
+    explicit streaming_mfcc(const mfcc_config &config);
+
+    const mfcc_config &config() const { return extractor_.config(); }
+    std::size_t feature_dim() const { return extractor_.config().feature_dim(); }
+
+    /* Frames a vector waits for before it can be emitted */
+    std::size_t lookahead_frames() const { return 2 * win_; }
+
+    /*
+     * Consumes num_samples samples and appends every finished vector
+     * (feature_dim() floats each) to out. Returns the number of vectors added.
+     */
+    std::size_t push(const float *samples, std::size_t num_samples, std::vector<float> &out);
+
+    /* End of utterance: emits the remaining frames, boundary frames repeated */
+    std::size_t finish(std::vector<float> &out);
+
+    /* Starts a new utterance */
+    void reset();
+
+    std::size_t frames_emitted() const { return emitted_; }
+
+private:
+    double *static_at(std::size_t t) { return &statics_[(t % ring_) * sdim_]; }
+    double *delta_at(std::size_t t) { return &deltas_[(t % ring_) * sdim_]; }
+    std::size_t advance(bool final, std::vector<float> &out);
+
+    mfcc_extractor extractor_;
+    std::size_t sdim_;
+    std::size_t win_;
+    std::size_t ring_;
+    std::size_t frame_size_;
+    std::size_t frame_shift_;
+
+    std::vector<float> pending_;        /* samples not yet fully consumed */
+    float previous_sample_ = 0.0f;      /* sample before pending_[0] */
+    std::size_t skip_ = 0;              /* samples before the next frame (frame_shift > frame_size) */
+    std::vector<double> statics_;       /* ring of the latest static vectors */
+    std::vector<double> deltas_;        /* ring of the latest delta vectors */
+    std::size_t statics_done_ = 0;
+    std::size_t deltas_done_ = 0;
+    std::size_t emitted_ = 0;
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_STREAMING_MFCC_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,102 @@
+/******************************************************************************
+* File Name:   tied_mixture_model.hpp
+*
+* Description: Tied-mixture (semi-continuous) word models as trained by
+*              hmm_gmm_tied_mixture_training.m. All states of all keywords
+*              share one pool of diagonal Gaussians and keep only their own
+*              mixture weights over it:
+*
+*              HMM.pool_mean [DIM, pool]
+*              HMM.pool_var  [DIM, pool]
+*              HMM.weight    [state, pool, model]
+*              HMM.Aij       [state + 2, state + 2, model], as in hmm_model.hpp
+*
+*              The pool is evaluated once per frame, whatever the number of
+*              keywords; a state then costs one log-add per pool Gaussian
+*              that is combined. Only the top_k best pool Gaussians of the
+*              frame are combined if top_k is set: the others are far below
+*              them and their terms vanish in the log-sum.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_TIED_MIXTURE_MODEL_HPP)
+#define HMM_GMM_TIED_MIXTURE_MODEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hmm_gmm
+{
+
+struct tied_mixture_set
+{
+    std::size_t dim = 0;
+    std::size_t pool_size = 0;
+    std::size_t state_no = 0;       /* emitting states, START/END excluded */
+    std::size_t model_no = 0;
+    std::vector<double> pool_mean;  /* pool_size * dim */
+    std::vector<double> pool_var;   /* pool_size * dim */
+    std::vector<double> weight;     /* (model * state_no + state) * pool_size + p */
+    std::vector<double> aij;        /* model * node_no^2, each row-major */
+
+    std::size_t node_no() const { return state_no + 2; }
+};
+
+/* Loads the HMM struct of HMM_tied_<iter>.mat; throws std::runtime_error for malformed models */
+tied_mixture_set read_tied_mixture_mat(const std::string &filename, const std::string &var_name = "HMM");
+
+/* Saves in the same layout, loadable by hmm_gmm_testing.m */
+void write_tied_mixture_mat(const std::string &filename, const tied_mixture_set &set,
+                            const std::string &var_name = "HMM");
+
+/* Scratch of tied_mixture_model::score_states(), one per thread; grows once and is reused */
+struct tied_mixture_workspace
+{
+    std::vector<uint32_t> order;
+    std::vector<float> sum;
+};
+
+class tied_mixture_model
+{
+public:
+    /* Throws std::invalid_argument for an empty set or non-positive variances */
+    explicit tied_mixture_model(const tied_mixture_set &set);
+
+    std::size_t dim() const { return dim_; }
+    std::size_t stride() const { return stride_; }
+    std::size_t pool_size() const { return pool_size_; }
+    std::size_t state_no() const { return state_no_; }
+    std::size_t model_no() const { return model_no_; }
+    std::size_t node_no() const { return state_no_ + 2; }
+    std::size_t state_count() const { return model_no_ * state_no_; }
+
+    /* node_no()^2 log transitions of a model, row-major, as compiled_model::log_transitions() */
+    const float *log_transitions(std::size_t model) const { return &transitions_[model * node_no() * node_no()]; }
+
+    /* Floats of the pool (mean, ivar, gconst) and of the state weights */
+    std::size_t parameter_count() const { return pool_size_ * (2 * dim_ + 1) + state_count() * pool_size_; }
+
+    /* log N_p(x) of every pool Gaussian; x holds stride() floats, zero padded */
+    void score_pool(const float *x, float *pool_scores) const;
+
+    /*
+     * log b_j of every state of every model, state s of model k at
+     * out[k * state_no + s], from the pool scores of one frame. top_k = 0
+     * combines the whole pool.
+     */
+    void score_states(const float *pool_scores, std::size_t top_k, float *out,
+                      tied_mixture_workspace &workspace) const;
+
+private:
+    std::size_t dim_, stride_, pool_size_, state_no_, model_no_;
+    std::vector<float> pool_;           /* pool_size * { mean[stride], ivar[stride] } */
+    std::vector<float> gconst_;         /* pool_size */
+    std::vector<float> log_weight_;     /* pool_size * state_count, pool-major */
+    std::vector<float> transitions_;    /* model_no * node_no^2 */
+};
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_TIED_MIXTURE_MODEL_HPP */
+/* [] END OF FILE */
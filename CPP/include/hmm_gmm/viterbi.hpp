@@ -0,0 +1,202 @@
+/******************************************************************************
+* File Name:   viterbi.hpp
+*
+* Description: Reference Viterbi decoder, a direct port of
+*              hmm_gmm_viterbi_decoding_algorithm() in hmm_gmm_testing.m:
+*              the best path enters from START, moves left to right (any
+*              forward jump i <= j allowed by Aij), and leaves to END after
+*              the last frame.
+*
+*              The transitions are held as per-state predecessor lists, so
+*              a left-to-right model visits two predecessors per state, and
+*              at each frame only the states that can be reached from START
+*              and can still reach END in the remaining frames are searched.
+*              The emissions of the other states are never read.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_VITERBI_HPP)
+#define HMM_GMM_VITERBI_HPP
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_matrix.hpp"
+#include "hmm_gmm/gaussian_scorer.hpp"
+#include "hmm_gmm/hmm_model.hpp"
+#include "hmm_gmm/tied_mixture_model.hpp"
+
+namespace hmm_gmm
+{
+
+/* Most emitting states of an alignment: backpointers are one byte, 0xFF marks "no predecessor" */
+constexpr std::size_t MAX_ALIGNED_STATES = 255;
+
+/*
+ * fopt of the model for the observation sequence, -Inf if no path exists.
+ * If alignment is given it receives the 0-based emitting state of every frame,
+ * recovered by traceback from one byte of backpointer per state and frame;
+ * without it the search keeps only two rows of scores. An alignment of more
+ * than MAX_ALIGNED_STATES states throws std::invalid_argument.
+ */
+double viterbi_decode(const hmm_model &model, const feature_view &features, std::vector<int> *alignment = nullptr);
+
+/* The same search on model model_index of a compiled set (float Gaussians, precomputed constants) */
+double viterbi_decode(const compiled_model &model, std::size_t model_index, const feature_view &features,
+                      std::vector<int> *alignment = nullptr);
+
+/* The same search on the utterance attached to the cache; the emissions are shared with the other models */
+double viterbi_decode(emission_cache &cache, std::size_t model_index, std::vector<int> *alignment = nullptr);
+
+/*
+ * The same search on precomputed state log-likelihoods: state s of model k at
+ * frame t is state_scores[t * score_stride + k * state_no + s], the layout of
+ * gaussian_scorer::score_states().
+ */
+double viterbi_decode(const compiled_model &model, std::size_t model_index, const float *state_scores,
+                      std::size_t score_stride, std::size_t frame_no, std::vector<int> *alignment = nullptr);
+
+struct recognition_result
+{
+    int model = -1;                 /* 0-based index of the best model, -1 if every score is -Inf */
+    double score = 0.0;
+    std::vector<double> scores;     /* fopt of every model */
+};
+
+/* The model with the largest fopt; the first one wins ties, as in hmm_gmm_testing.m */
+recognition_result recognise(const hmm_set &hmm, const feature_view &features);
+recognition_result recognise(const compiled_model &model, const feature_view &features);
+
+/* Scores all states of all models in one batch with the scorer, then runs the searches */
+recognition_result recognise(const compiled_model &model, const gaussian_scorer &scorer,
+                             const feature_view &features, log_add_tier tier = log_add_tier::exact);
+
+/*
+ * Tied-mixture models: the pool is evaluated once per frame for all states of
+ * all models, and each state combines the top_k best pool Gaussians of the
+ * frame (0 = the whole pool)
+ */
+recognition_result recognise(const tied_mixture_model &model, const feature_view &features, std::size_t top_k = 0);
+
+/*
+ * Attaches the utterance to the cache and runs the searches of all models on
+ * it; every emission is computed at most once. Reusing one cache for a whole
+ * corpus avoids the per-utterance allocations.
+ */
+recognition_result recognise(emission_cache &cache, const feature_view &features);
+
+/*
+ * Frame-skipping decoding: only frames 0, skip, 2 skip, ... are searched and
+ * only their emissions read, and the search moves between them with the
+ * skip-step transitions (aij)^skip of the emitting states, the "frame loss"
+ * aij^dt of hmm_gmm_testing.m. Each searched emission is weighted by skip,
+ * so the scores keep the scale of a full search. skip = 1 is recognise();
+ * 0 throws std::invalid_argument.
+ */
+recognition_result recognise_frame_skip(emission_cache &cache, const feature_view &features, std::size_t skip);
+
+/*
+ * Frame-synchronous decoding with beam pruning across models. All models
+ * advance one frame at a time; after each frame every state more than beam
+ * below the best state of any model is dropped, and if more than max_active
+ * states remain only the best max_active are kept (ties to the lower model
+ * and state). A model without active states is not searched any further,
+ * and with a lazy cache the emissions of dropped states are never computed.
+ * With no beam and no cap the scores are those of recognise().
+ */
+struct beam_config
+{
+    double beam = std::numeric_limits<double>::infinity();     /* log-likelihood below the best state */
+    std::size_t max_active = 0;                                 /* states kept per frame, 0: no limit */
+};
+
+struct beam_trace
+{
+    std::vector<std::size_t> active_states;     /* per frame, after pruning, over all models */
+    std::vector<std::size_t> active_models;     /* per frame, models with an active state */
+};
+
+/* Pruned models score -Inf; trace, if given, receives the counters of the utterance */
+recognition_result recognise_beam(emission_cache &cache, const feature_view &features, const beam_config &config,
+                                  beam_trace *trace = nullptr);
+
+/*
+ * Early decision. The partial score of model k after frame t is
+ * max_i f_k,i(t) + log a_i,END, its fopt if the utterance ended there. The
+ * policy commits to a model once it has led the runner-up by at least
+ * margin for frames consecutive frames; an infinite margin never commits.
+ */
+struct early_decision_config
+{
+    double margin = std::numeric_limits<double>::infinity();   /* log-likelihood over the runner-up */
+    std::size_t frames = 1;                                     /* consecutive frames in the lead */
+};
+
+class early_decision_policy
+{
+public:
+    explicit early_decision_policy(const early_decision_config &config) : config_(config) {}
+
+    /* Starts a new utterance */
+    void reset()
+    {
+        leader_ = -1;
+        streak_ = 0;
+    }
+
+    /* Takes the partial scores of the next frame; returns the committed model, or -1 */
+    int update(const double *scores, std::size_t model_no);
+
+private:
+    early_decision_config config_;
+    int leader_ = -1;
+    std::size_t streak_ = 0;
+};
+
+struct early_decision_result
+{
+    recognition_result decision;        /* scores: the partial scores of the decision frame */
+    std::size_t decision_frame = 0;     /* frames scored, frame_no if the policy did not commit */
+    bool early = false;                 /* committed before the last frame */
+};
+
+/*
+ * Frame-synchronous decoding of all models that feeds the partial scores
+ * of every frame to an early_decision_policy and stops at its commit; with
+ * a lazy cache the remaining frames are never scored. Without a commit the
+ * decision is that of recognise(). partial, if given, receives the partial
+ * scores of the frames searched, frame-major (decision_frame x model_no).
+ */
+early_decision_result recognise_early(emission_cache &cache, const feature_view &features,
+                                      const early_decision_config &config, std::vector<double> *partial = nullptr);
+
+/*
+ * Two-pass decoding. The first pass scores every model with a cheap model set
+ * of the same topology (e.g. the single-mixture HMM_5.mat); a model is
+ * rescored with the full model set only if it is among the top_k first-pass
+ * scores and within margin * frame_no of the best one. The best first-pass
+ * model is always rescored.
+ */
+struct two_pass_config
+{
+    std::size_t top_k = 2;                                          /* 0: no limit */
+    double margin = std::numeric_limits<double>::infinity();        /* log-likelihood per frame */
+};
+
+struct two_pass_result
+{
+    recognition_result first_pass;      /* cheap scores of every model */
+    recognition_result rescored;        /* the decision; -Inf for the models that were not rescored */
+    std::vector<std::size_t> candidates;    /* rescored models, best first-pass score first */
+};
+
+/* Throws std::invalid_argument if the two model sets differ in model or state count */
+two_pass_result recognise_two_pass(emission_cache &first_pass, emission_cache &rescoring,
+                                   const feature_view &features, const two_pass_config &config);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_VITERBI_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,71 @@
+/******************************************************************************
+* File Name:   wav_file.hpp
+*
+* Description: RIFF/WAVE reader. The file is memory mapped and the first
+*              channel is decoded straight from the mapping into the
+*              caller's buffer. 8/16/24/32-bit PCM and 32-bit float data
+*              (plain or WAVE_FORMAT_EXTENSIBLE) are accepted, and every
+*              format is returned on the int16 scale. That scale is the one
+*              of audioread(..., 'native') for the 16-bit files used by
+*              run_feature_extraction.m, so the log energy of the features
+*              does not depend on the sample width of the recording.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_WAV_FILE_HPP)
+#define HMM_GMM_WAV_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/mapped_file.hpp"
+
+namespace hmm_gmm
+{
+
+enum class wav_sample_format
+{
+    pcm8,
+    pcm16,
+    pcm24,
+    pcm32,
+    float32,
+};
+
+struct wav_data
+{
+    double sample_rate = 0.0;
+    std::vector<float> samples;     /* first channel only */
+};
+
+class wav_reader
+{
+public:
+    /* Maps the file and parses the chunk list; throws std::runtime_error on unsupported formats */
+    explicit wav_reader(const std::string &filename);
+
+    double sample_rate() const { return sample_rate_; }
+    unsigned channels() const { return channels_; }
+    wav_sample_format format() const { return format_; }
+    std::size_t frame_count() const { return frame_count_; }
+
+    /* Decodes frames [first, first + count) of the first channel to the int16 scale */
+    void decode(std::size_t first, std::size_t count, float *out) const;
+
+private:
+    mapped_file file_;
+    const unsigned char *data_ = nullptr;
+    std::size_t block_align_ = 0;
+    std::size_t frame_count_ = 0;
+    double sample_rate_ = 0.0;
+    unsigned channels_ = 0;
+    wav_sample_format format_ = wav_sample_format::pcm16;
+};
+
+/* Whole first channel at the native rate. Throws std::runtime_error on I/O errors and unsupported formats. */
+wav_data read_wav_file(const std::string &filename);
+
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_WAV_FILE_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,304 @@
+/******************************************************************************
+* File Name:   command_grammar.cpp
+*
+* Description: Composite grammar networks and their Viterbi search, see
+*              command_grammar.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/command_grammar.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+/* The word a token passed through in one slot, GRAMMAR_NO_WORD if it has not entered the slot or passed over it */
+struct word_link
+{
+    std::size_t model = GRAMMAR_NO_WORD;
+    std::size_t start = 0;
+    double entry = 0.0;     /* score of the token when it entered the word */
+};
+
+} /* namespace */
+
+
+command_grammar::command_grammar(const compiled_model &model, std::vector<grammar_slot> slots)
+    : model_(&model), slots_(std::move(slots))
+{
+    if (slots_.empty())
+    {
+        throw std::invalid_argument("a grammar needs at least one slot");
+    }
+    std::vector<std::size_t> compiled(model.model_no(), GRAMMAR_NO_WORD);
+    bool required = false;
+    slot_first_.push_back(0);
+    for (std::size_t s = 0; s < slots_.size(); s++)
+    {
+        if (slots_[s].models.empty())
+        {
+            throw std::invalid_argument("slot " + std::to_string(s + 1) + " of the grammar has no model");
+        }
+        required = required || !slots_[s].optional;
+        for (std::size_t m : slots_[s].models)
+        {
+            if (m >= model.model_no())
+            {
+                throw std::invalid_argument("model " + std::to_string(m + 1) + " of slot " + std::to_string(s + 1) +
+                                            " is not in the set of " + std::to_string(model.model_no()) + " models");
+            }
+            if (compiled[m] == GRAMMAR_NO_WORD)
+            {
+                compiled[m] = transitions_.size();
+                transitions_.emplace_back();
+                compiled_transitions(model, m, transitions_.back());
+            }
+            nodes_.push_back({s, m, compiled[m]});
+        }
+        slot_first_.push_back(nodes_.size());
+    }
+    if (!required)
+    {
+        throw std::invalid_argument("every slot of the grammar is optional");
+    }
+
+    /* the shortest word of a slot is the fewest frames from START to END of one of its models */
+    tail_.assign(slots_.size(), 0);
+    for (std::size_t s = slots_.size() - 1; s-- > 0;)
+    {
+        std::size_t shortest = UNREACHABLE;
+        for (std::size_t v = slot_first_[s + 1]; v < slot_first_[s + 2]; v++)
+        {
+            const sparse_transitions &tr = transitions_[nodes_[v].transitions];
+            for (std::size_t j = 0; j < tr.n; j++)
+            {
+                if (tr.earliest[j] != UNREACHABLE && tr.to_end[j] == 0)
+                {
+                    shortest = std::min(shortest, tr.earliest[j] + 1);
+                }
+            }
+        }
+        tail_[s] = tail_[s + 1] + ((slots_[s + 1].optional || shortest == UNREACHABLE) ? 0 : shortest);
+    }
+}
+
+command_grammar command_grammar::wakeword_command(const compiled_model &model, std::size_t wakeword,
+                                                  std::size_t silence, const std::vector<std::size_t> &commands)
+{
+    std::vector<grammar_slot> slots;
+    slots.push_back({{wakeword}, false});
+    if (silence != GRAMMAR_NO_WORD)
+    {
+        slots.push_back({{silence}, true});
+    }
+    slots.push_back({commands, false});
+    return command_grammar(model, std::move(slots));
+}
+
+
+/*******************************************************************************
+* Function Name: recognise_grammar
+********************************************************************************
+* Summary:
+*  Token passing over the network, one frame at a time. Inside a word the
+*  recursion is that of viterbi_search() over the predecessor lists; a
+*  state may also be entered from the exit of the slot before it,
+*
+*    X_s(t) = max(max_{k in s, j} f_k,j(t) + log a_j,END,  X_s-1(t) if s is optional)
+*
+*  at frame t + 1 with log a_START,j, where X_-1 is the START of the network
+*  before the first frame. A state is searched only if the rest of its word
+*  (to_end) and the shortest words of the required slots after it fit into
+*  the remaining frames; as in recognise_beam() no complete path needs the
+*  others, and they would otherwise set the beam. Each token carries the
+*  word, entry frame and entry score of every slot it has passed through.
+*  After each frame, states and exits below the best state minus the beam
+*  are dropped; a state is scored only if a predecessor or the exit before
+*  it survived. The phrase is the token of X_S-1 at the last frame.
+*
+* Parameters:
+*  cache:    emission cache of the grammar's model set
+*  features: the utterance
+*  grammar:  the network
+*  beam:     log-likelihood below the best state of the frame
+*  trace:    optional, receives the emissions read per slot
+*
+* Return:
+*  The best phrase and its score; no words if no path reaches the END
+*
+*******************************************************************************/
+grammar_result recognise_grammar(emission_cache &cache, const feature_view &features, const command_grammar &grammar,
+                                 double beam, grammar_trace *trace)
+{
+    const double neg_inf = -std::numeric_limits<double>::infinity();
+    if (&cache.model() != grammar.model_)
+    {
+        throw std::invalid_argument("the emission cache and the grammar use different models");
+    }
+    cache.reset(features);
+    const std::size_t n = grammar.model_->state_no();
+    const std::size_t frame_no = cache.frame_no();
+    const std::size_t slot_no = grammar.slots_.size();
+    const std::size_t node_no = grammar.nodes_.size();
+    if (trace)
+    {
+        trace->scored.assign(slot_no, 0);
+    }
+
+    grammar_result result;
+    if (frame_no == 0 || n == 0)
+    {
+        return result;
+    }
+
+    std::vector<double> previous(node_no * n, neg_inf), current(node_no * n);
+    std::vector<word_link> previous_links(node_no * n * slot_no), current_links(node_no * n * slot_no);
+    std::vector<double> previous_exit(slot_no, neg_inf), current_exit(slot_no);
+    std::vector<word_link> previous_exit_links(slot_no * slot_no), current_exit_links(slot_no * slot_no);
+    const std::vector<word_link> no_links(slot_no);
+
+    /* X_s before the first frame: START, passed over the leading optional slots */
+    for (std::size_t s = 0; s < slot_no && grammar.slots_[s].optional; s++)
+    {
+        previous_exit[s] = 0.0;
+    }
+
+    for (std::size_t t = 0; t < frame_no; t++)
+    {
+        const std::size_t remaining = frame_no - 1 - t;
+        for (std::size_t s = 0; s < slot_no; s++)
+        {
+            const double entry = (s > 0) ? previous_exit[s - 1] : (t == 0 ? 0.0 : neg_inf);
+            const word_link *entry_links = (s > 0) ? &previous_exit_links[(s - 1) * slot_no] : no_links.data();
+            for (std::size_t v = grammar.slot_first_[s]; v < grammar.slot_first_[s + 1]; v++)
+            {
+                const sparse_transitions &tr = grammar.transitions_[grammar.nodes_[v].transitions];
+                const std::size_t model_index = grammar.nodes_[v].model;
+                for (std::size_t j = 0; j < n; j++)
+                {
+                    const std::size_t state = v * n + j;
+                    current[state] = neg_inf;
+                    if (tr.to_end[j] == UNREACHABLE || tr.to_end[j] + grammar.tail_[s] > remaining)
+                    {
+                        continue;
+                    }
+                    double f_max = neg_inf;
+                    const word_link *from = nullptr;
+                    bool entered = false;
+                    for (std::size_t p = tr.first[j]; p < tr.first[j + 1]; p++)
+                    {
+                        const std::size_t i = v * n + tr.pred[p];
+                        if (previous[i] > neg_inf && previous[i] + tr.log_a[p] > f_max)
+                        {
+                            f_max = previous[i] + tr.log_a[p];
+                            from = &previous_links[i * slot_no];
+                        }
+                    }
+                    if (entry + tr.log_entry[j] > f_max)
+                    {
+                        f_max = entry + tr.log_entry[j];
+                        from = entry_links;
+                        entered = true;
+                    }
+                    if (f_max == neg_inf)
+                    {
+                        continue;
+                    }
+                    current[state] = f_max + cache(model_index, j, t);
+                    if (trace)
+                    {
+                        trace->scored[s]++;
+                    }
+                    std::copy(from, from + slot_no, &current_links[state * slot_no]);
+                    if (entered)
+                    {
+                        current_links[state * slot_no + s] = {model_index, t, entry};
+                    }
+                }
+            }
+        }
+
+        const double threshold = *std::max_element(current.begin(), current.end()) - beam;
+        for (double &f : current)
+        {
+            if (f < threshold)
+            {
+                f = neg_inf;
+            }
+        }
+
+        for (std::size_t s = 0; s < slot_no; s++)
+        {
+            double exit = neg_inf;
+            const word_link *from = nullptr;
+            for (std::size_t v = grammar.slot_first_[s]; v < grammar.slot_first_[s + 1]; v++)
+            {
+                const sparse_transitions &tr = grammar.transitions_[grammar.nodes_[v].transitions];
+                for (std::size_t j = 0; j < n; j++)
+                {
+                    if (current[v * n + j] + tr.log_exit[j] > exit)
+                    {
+                        exit = current[v * n + j] + tr.log_exit[j];
+                        from = &current_links[(v * n + j) * slot_no];
+                    }
+                }
+            }
+            if (grammar.slots_[s].optional && s > 0 && current_exit[s - 1] > exit)
+            {
+                exit = current_exit[s - 1];
+                from = &current_exit_links[(s - 1) * slot_no];
+            }
+            current_exit[s] = (exit >= threshold) ? exit : neg_inf;
+            if (current_exit[s] > neg_inf)
+            {
+                std::copy(from, from + slot_no, &current_exit_links[s * slot_no]);
+            }
+        }
+
+        previous.swap(current);
+        previous_links.swap(current_links);
+        previous_exit.swap(current_exit);
+        previous_exit_links.swap(current_exit_links);
+    }
+
+    result.score = previous_exit[slot_no - 1];
+    if (result.score == neg_inf)
+    {
+        return result;
+    }
+    const word_link *links = &previous_exit_links[(slot_no - 1) * slot_no];
+    for (std::size_t s = 0; s < slot_no; s++)
+    {
+        if (links[s].model == GRAMMAR_NO_WORD)
+        {
+            continue;
+        }
+        grammar_word word;
+        word.slot = s;
+        word.model = links[s].model;
+        word.start_frame = links[s].start;
+        word.end_frame = frame_no - 1;
+        word.score = result.score - links[s].entry;
+        for (std::size_t next = s + 1; next < slot_no; next++)
+        {
+            if (links[next].model != GRAMMAR_NO_WORD)
+            {
+                word.end_frame = links[next].start - 1;
+                word.score = links[next].entry - links[s].entry;
+                break;
+            }
+        }
+        result.words.push_back(word);
+    }
+    return result;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,677 @@
+/******************************************************************************
+* File Name:   compiled_model.cpp
+*
+* Description: Model compiler and compiled model loader, see
+*              compiled_model.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/compiled_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "hmm_gmm/byte_order.hpp"
+#include "hmm_gmm/simd.hpp"
+
+#include "compiled_model_kernels.hpp"
+#include "mahalanobis.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr std::size_t VECTOR_FLOATS = COMPILED_MODEL_ALIGNMENT / sizeof(float);
+
+std::size_t round_up(std::size_t value, std::size_t multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+void store_le_float(unsigned char *p, float v)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    store_le32(p, bits);
+}
+
+/* Bytes of one mean / ivar entry in the state blocks */
+std::size_t element_size(model_precision precision)
+{
+    return precision == model_precision::float32 ? 4 : (precision == model_precision::float16 ? 2 : 1);
+}
+
+/* Start of the state blocks: header, quantisation block and int8 scales */
+std::size_t states_begin(model_precision precision, std::size_t stride)
+{
+    if (precision == model_precision::float32)
+    {
+        return COMPILED_MODEL_HEADER_SIZE;
+    }
+    return 2 * COMPILED_MODEL_HEADER_SIZE + (precision == model_precision::int8 ? 4 * stride * sizeof(float) : 0);
+}
+
+std::size_t state_block_bytes(model_precision precision, std::size_t stride, std::size_t mix_no,
+                              std::size_t mix_stride)
+{
+    return round_up(2 * mix_stride * sizeof(float) + 2 * mix_no * stride * element_size(precision),
+                    COMPILED_MODEL_ALIGNMENT);
+}
+
+/* IEEE half, round to nearest even; throws if v is out of range */
+uint16_t float_to_half(float v)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000u);
+    const float a = std::fabs(v);
+    if (!(a < 65520.0f))
+    {
+        throw std::invalid_argument("model value out of float16 range");
+    }
+    if (a < 0x1p-14f)
+    {
+        /* subnormal: multiples of 2^-24 */
+        return (uint16_t)(sign | (uint16_t)std::nearbyint(a * 0x1p24f));
+    }
+    std::memcpy(&bits, &a, sizeof(bits));
+    bits += 0x0fffu + ((bits >> 13) & 1u);
+    return (uint16_t)(sign | ((bits >> 13) - ((127u - 15u) << 10)));
+}
+
+float half_to_float(uint16_t h)
+{
+    const uint32_t magnitude = (uint32_t)(h & 0x7fffu) << 13;
+    float v;
+    std::memcpy(&v, &magnitude, sizeof(v));
+    v *= 0x1p112f;
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    bits |= (uint32_t)(h & 0x8000u) << 16;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+/*
+ * Distances of the gaussian_no Gaussians at 'gaussians' with the kernel of
+ * the instruction set. AVX-512 hosts run the AVX2 kernels: a state is a few
+ * short vectors, too little work to cover the warm-up of the 512-bit units,
+ * and 512-bit versions of these kernels decoded slower than float32.
+ */
+void mahalanobis_float16(simd_isa isa, const float *x, const uint16_t *gaussians, std::size_t gaussian_no,
+                         std::size_t stride, float *out)
+{
+    switch (isa)
+    {
+#if defined(HMM_GMM_HAVE_AVX2)
+    case simd_isa::avx512:
+    case simd_isa::avx2:    kernels::mahalanobis_float16_avx2(x, gaussians, gaussian_no, stride, out); break;
+#endif
+    default:                kernels::mahalanobis_float16_scalar(x, gaussians, gaussian_no, stride, out); break;
+    }
+}
+
+void mahalanobis_int8(simd_isa isa, const float *x, const unsigned char *gaussians, std::size_t gaussian_no,
+                      const float *base, const float *step, std::size_t stride, float *out)
+{
+    switch (isa)
+    {
+#if defined(HMM_GMM_HAVE_AVX2)
+    case simd_isa::avx512:
+    case simd_isa::avx2:    kernels::mahalanobis_int8_avx2(x, gaussians, gaussian_no, base, step, stride, out); break;
+#endif
+    default:                kernels::mahalanobis_int8_scalar(x, gaussians, gaussian_no, base, step, stride, out); break;
+    }
+}
+
+/* Per-dimension affine quantisation of the int8 images */
+struct int8_scales
+{
+    std::vector<double> offset, scale;          /* mean_d = offset_d + scale_d q */
+    std::vector<double> precision_min, precision_step;  /* sqrt(ivar_d) = min_d + step_d r */
+};
+
+int8_scales fit_int8_scales(const hmm_set &hmm)
+{
+    const std::size_t dim = hmm.dim(), mix_no = hmm.mix_no(), state_no = hmm.state_no();
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> mean_lo(dim, inf), mean_hi(dim, -inf), prec_lo(dim, inf), prec_hi(dim, -inf);
+    for (const hmm_model &model : hmm.models)
+    {
+        for (std::size_t s = 0; s < state_no; s++)
+        {
+            for (std::size_t m = 0; m < mix_no; m++)
+            {
+                const double *mu = model.mean_of(s, m);
+                const double *var = model.var_of(s, m);
+                for (std::size_t d = 0; d < dim; d++)
+                {
+                    if (!(var[d] > 0.0))
+                    {
+                        throw std::invalid_argument("variances must be positive");
+                    }
+                    const double p = 1.0 / std::sqrt(var[d]);
+                    mean_lo[d] = std::fmin(mean_lo[d], mu[d]);
+                    mean_hi[d] = std::fmax(mean_hi[d], mu[d]);
+                    prec_lo[d] = std::fmin(prec_lo[d], p);
+                    prec_hi[d] = std::fmax(prec_hi[d], p);
+                }
+            }
+        }
+    }
+    int8_scales q;
+    for (std::size_t d = 0; d < dim; d++)
+    {
+        const double range = mean_hi[d] - mean_lo[d];
+        q.offset.push_back((float)(0.5 * (mean_lo[d] + mean_hi[d])));
+        q.scale.push_back((float)(range > 0.0 ? range / 254.0 : 1.0));
+        q.precision_min.push_back((float)prec_lo[d]);
+        q.precision_step.push_back((float)((prec_hi[d] - prec_lo[d]) / 255.0));
+    }
+    return q;
+}
+
+} /* namespace */
+
+
+namespace kernels
+{
+
+/*******************************************************************************
+* Function Name: mahalanobis_float16_scalar
+********************************************************************************
+* Summary:
+*  mahalanobis_float32() with the parameters widened from float16.
+*
+*******************************************************************************/
+void mahalanobis_float16_scalar(const float *x, const uint16_t *gaussians, std::size_t gaussian_no, std::size_t lanes,
+                                float *out)
+{
+    for (std::size_t g = 0; g < gaussian_no; g++, gaussians += 2 * lanes)
+    {
+        const uint16_t *mu = gaussians, *iv = gaussians + lanes;
+        out[g] = lane_sum8(lanes, [=](std::size_t i) {
+            const float diff = x[i] - half_to_float(mu[i]);
+            return diff * diff * half_to_float(iv[i]);
+        });
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: mahalanobis_int8_scalar
+********************************************************************************
+* Summary:
+*  x prepared for the int8 codes: z_d = (x'_d - q_d) (A_d + B_d r_d) =
+*  (x_d - mu_d) sqrt(ivar_d). 16 lanes, one 16 byte line of codes, so the
+*  widening to float stays packed.
+*
+*******************************************************************************/
+void mahalanobis_int8_scalar(const float *x, const unsigned char *gaussians, std::size_t gaussian_no, const float *base,
+                             const float *step, std::size_t lanes, float *out)
+{
+    for (std::size_t g = 0; g < gaussian_no; g++, gaussians += 2 * lanes)
+    {
+        const int8_t *q = reinterpret_cast<const int8_t *>(gaussians);
+        const uint8_t *r = gaussians + lanes;
+        float acc[16] = {0.0f};
+        for (std::size_t d = 0; d < lanes; d += 16)
+        {
+            for (std::size_t l = 0; l < 16; l++)
+            {
+                const float z = (x[d + l] - (float)(int32_t)q[d + l]) *
+                                (base[d + l] + step[d + l] * (float)(int32_t)r[d + l]);
+                acc[l] += z * z;
+            }
+        }
+        for (std::size_t l = 0; l < 8; l++)
+        {
+            acc[l] += acc[l + 8];
+        }
+        out[g] = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+    }
+}
+
+} /* namespace kernels */
+
+
+const char *model_precision_name(model_precision precision)
+{
+    switch (precision)
+    {
+    case model_precision::float32: return "float32";
+    case model_precision::float16: return "float16";
+    case model_precision::int8:    return "int8";
+    }
+    return "unknown";
+}
+
+
+/*******************************************************************************
+* Function Name: compile_model_image
+********************************************************************************
+* Summary:
+*  Lays out the model set as described in compiled_model.hpp. gconst and the
+*  logarithms are computed in double precision and rounded once; in the
+*  quantised images gconst is computed from the variances as stored, so
+*  every Gaussian is a normalised density.
+*
+*  int8: per dimension the means are mapped linearly onto -127..127 over
+*  their range across all Gaussians, and the standard deviations' inverses
+*  onto 0..255 over theirs.
+*
+* Parameters:
+*  hmm:       model set, every model must have the same dim / mix_no / state_no
+*  precision: storage of the means and inverse variances
+*
+* Return:
+*  The image, little-endian regardless of the host
+*
+*******************************************************************************/
+std::vector<unsigned char> compile_model_image(const hmm_set &hmm, model_precision precision)
+{
+    const std::size_t dim = hmm.dim(), mix_no = hmm.mix_no(), state_no = hmm.state_no();
+    const std::size_t model_no = hmm.models.size();
+    if (model_no == 0 || dim == 0 || mix_no == 0 || state_no == 0)
+    {
+        throw std::invalid_argument("cannot compile an empty model set");
+    }
+    for (const hmm_model &m : hmm.models)
+    {
+        if (m.dim != dim || m.mix_no != mix_no || m.state_no != state_no)
+        {
+            throw std::invalid_argument("every model of a compiled set must have the same dimensions");
+        }
+    }
+
+    const std::size_t stride = round_up(dim, VECTOR_FLOATS);
+    const std::size_t mix_stride = round_up(mix_no, VECTOR_FLOATS);
+    const std::size_t state_bytes = state_block_bytes(precision, stride, mix_no, mix_stride);
+    const std::size_t element = element_size(precision);
+    const std::size_t node_no = state_no + 2;
+    const std::size_t transition_floats = round_up(node_no * node_no, VECTOR_FLOATS);
+    const std::size_t state_offset = states_begin(precision, stride);
+    const std::size_t transition_offset = state_offset + model_no * state_no * state_bytes;
+    const std::size_t image_size = transition_offset + model_no * transition_floats * sizeof(float);
+
+    std::vector<unsigned char> image(image_size, 0);
+    unsigned char *h = image.data();
+    std::memcpy(h, COMPILED_MODEL_MAGIC, sizeof(COMPILED_MODEL_MAGIC));
+    store_le32(h + 8, precision == model_precision::float32 ? COMPILED_MODEL_VERSION : COMPILED_MODEL_QUANTISED_VERSION);
+    store_le32(h + 12, (uint32_t)dim);
+    store_le32(h + 16, (uint32_t)stride);
+    store_le32(h + 20, (uint32_t)mix_no);
+    store_le32(h + 24, (uint32_t)mix_stride);
+    store_le32(h + 28, (uint32_t)state_no);
+    store_le32(h + 32, (uint32_t)model_no);
+    store_le32(h + 36, (uint32_t)state_bytes);
+    store_le64(h + 40, state_offset);
+    store_le64(h + 48, transition_offset);
+    store_le64(h + 56, image_size);
+
+    int8_scales scales;
+    if (precision != model_precision::float32)
+    {
+        const std::size_t scale_offset = 2 * COMPILED_MODEL_HEADER_SIZE;
+        store_le32(h + 64, (uint32_t)precision);
+        store_le64(h + 72, precision == model_precision::int8 ? scale_offset : 0);
+        if (precision == model_precision::int8)
+        {
+            scales = fit_int8_scales(hmm);
+            unsigned char *section = h + scale_offset;
+            for (std::size_t d = 0; d < dim; d++)
+            {
+                const double s = scales.scale[d];
+                store_le_float(section + d * sizeof(float), (float)scales.offset[d]);
+                store_le_float(section + (stride + d) * sizeof(float), (float)(1.0 / s));
+                store_le_float(section + (2 * stride + d) * sizeof(float), (float)(s * scales.precision_min[d]));
+                store_le_float(section + (3 * stride + d) * sizeof(float), (float)(s * scales.precision_step[d]));
+            }
+        }
+    }
+
+    const float neg_inf = -std::numeric_limits<float>::infinity();
+    const double log_2pi = std::log(2.0 * std::acos(-1.0));
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        const hmm_model &model = hmm.models[k];
+        for (std::size_t s = 0; s < state_no; s++)
+        {
+            unsigned char *block = image.data() + state_offset + (k * state_no + s) * state_bytes;
+            unsigned char *log_weight = block;
+            unsigned char *gconst = block + mix_stride * sizeof(float);
+            for (std::size_t m = 0; m < mix_stride; m++)
+            {
+                store_le_float(log_weight + m * sizeof(float), neg_inf);
+            }
+            for (std::size_t m = 0; m < mix_no; m++)
+            {
+                const double *mu = model.mean_of(s, m);
+                const double *var = model.var_of(s, m);
+                double log_det = 0.0;
+                unsigned char *mean = block + 2 * mix_stride * sizeof(float) + 2 * m * stride * element;
+                unsigned char *ivar = mean + stride * element;
+                for (std::size_t d = 0; d < dim; d++)
+                {
+                    if (!(var[d] > 0.0))
+                    {
+                        throw std::invalid_argument("variances must be positive");
+                    }
+                    double stored_ivar = 1.0 / var[d];
+                    switch (precision)
+                    {
+                    case model_precision::float32:
+                        store_le_float(mean + d * 4, (float)mu[d]);
+                        store_le_float(ivar + d * 4, (float)stored_ivar);
+                        break;
+                    case model_precision::float16:
+                    {
+                        const uint16_t hm = float_to_half((float)mu[d]), hv = float_to_half((float)stored_ivar);
+                        mean[d * 2] = (unsigned char)hm;
+                        mean[d * 2 + 1] = (unsigned char)(hm >> 8);
+                        ivar[d * 2] = (unsigned char)hv;
+                        ivar[d * 2 + 1] = (unsigned char)(hv >> 8);
+                        stored_ivar = half_to_float(hv);
+                        if (!(stored_ivar > 0.0))
+                        {
+                            throw std::invalid_argument("model variance out of float16 range");
+                        }
+                        break;
+                    }
+                    case model_precision::int8:
+                    {
+                        const double q = std::nearbyint((mu[d] - scales.offset[d]) / scales.scale[d]);
+                        const double step = scales.precision_step[d];
+                        const double r = step > 0.0
+                            ? std::nearbyint((1.0 / std::sqrt(var[d]) - scales.precision_min[d]) / step) : 0.0;
+                        const double p = scales.precision_min[d] + step * r;
+                        mean[d] = (unsigned char)(int8_t)std::fmax(-127.0, std::fmin(127.0, q));
+                        ivar[d] = (unsigned char)std::fmax(0.0, std::fmin(255.0, r));
+                        stored_ivar = p * p;
+                        break;
+                    }
+                    }
+                    log_det -= std::log(stored_ivar);
+                }
+                store_le_float(gconst + m * sizeof(float), (float)(-0.5 * (dim * log_2pi + log_det)));
+                store_le_float(log_weight + m * sizeof(float), (float)std::log(model.weight[s * mix_no + m]));
+            }
+        }
+
+        unsigned char *a = image.data() + transition_offset + k * transition_floats * sizeof(float);
+        for (std::size_t i = 0; i < node_no * node_no; i++)
+        {
+            store_le_float(a + i * sizeof(float), (float)std::log(model.aij[i]));
+        }
+    }
+    return image;
+}
+
+
+compiled_model::compiled_model(const std::string &filename)
+    : file_(filename)
+{
+    attach(file_.data(), file_.size(), filename);
+}
+
+
+compiled_model::compiled_model(const hmm_set &hmm, model_precision precision)
+{
+    const std::vector<unsigned char> image = compile_model_image(hmm, precision);
+    buffer_.reset(static_cast<unsigned char *>(std::aligned_alloc(COMPILED_MODEL_ALIGNMENT,
+                                                                  round_up(image.size(), COMPILED_MODEL_ALIGNMENT))));
+    if (!buffer_)
+    {
+        throw std::bad_alloc();
+    }
+    std::memcpy(buffer_.get(), image.data(), image.size());
+    attach(buffer_.get(), image.size(), "compiled model");
+}
+
+
+/*******************************************************************************
+* Function Name: attach
+********************************************************************************
+* Summary:
+*  Validates the header against the image size and sets up the section
+*  pointers. Nothing is copied or converted, so the host must be
+*  little-endian and the image 64-byte aligned (mmap and aligned_alloc give
+*  page / 64-byte alignment).
+*
+* Parameters:
+*  image:  start of the image
+*  size:   bytes available
+*  source: name used in error messages
+*
+*******************************************************************************/
+void compiled_model::attach(const unsigned char *image, std::size_t size, const std::string &source)
+{
+    if (!host_is_little_endian())
+    {
+        throw std::runtime_error("compiled models can only be used on little-endian hosts");
+    }
+    if (size < COMPILED_MODEL_HEADER_SIZE || std::memcmp(image, COMPILED_MODEL_MAGIC, sizeof(COMPILED_MODEL_MAGIC)) != 0)
+    {
+        throw std::runtime_error(source + " is not a compiled model");
+    }
+    const uint32_t version = load_le32(image + 8);
+    if (version != COMPILED_MODEL_VERSION && version != COMPILED_MODEL_QUANTISED_VERSION)
+    {
+        throw std::runtime_error(source + ": unsupported compiled model version " +
+                                 std::to_string(load_le32(image + 8)));
+    }
+    if ((reinterpret_cast<uintptr_t>(image) % COMPILED_MODEL_ALIGNMENT) != 0)
+    {
+        throw std::runtime_error(source + ": image is not 64-byte aligned");
+    }
+
+    dim_ = load_le32(image + 12);
+    stride_ = load_le32(image + 16);
+    mix_no_ = load_le32(image + 20);
+    mix_stride_ = load_le32(image + 24);
+    state_no_ = load_le32(image + 28);
+    model_no_ = load_le32(image + 32);
+    const std::size_t state_bytes = load_le32(image + 36);
+    const uint64_t state_offset = load_le64(image + 40);
+    const uint64_t transition_offset = load_le64(image + 48);
+    image_size_ = (std::size_t)load_le64(image + 56);
+
+    precision_ = model_precision::float32;
+    uint64_t scale_offset = 0;
+    if (version == COMPILED_MODEL_QUANTISED_VERSION)
+    {
+        const uint32_t stored = size >= 2 * COMPILED_MODEL_HEADER_SIZE ? load_le32(image + 64) : 0;
+        if (stored != (uint32_t)model_precision::float16 && stored != (uint32_t)model_precision::int8)
+        {
+            throw std::runtime_error(source + ": corrupt compiled model header");
+        }
+        precision_ = (model_precision)stored;
+        scale_offset = load_le64(image + 72);
+    }
+
+    state_bytes_ = state_block_bytes(precision_, stride_, mix_no_, mix_stride_);
+    transition_stride_ = round_up(node_no() * node_no(), VECTOR_FLOATS);
+    const bool consistent =
+        dim_ > 0 && mix_no_ > 0 && state_no_ > 0 && model_no_ > 0 &&
+        stride_ == round_up(dim_, VECTOR_FLOATS) && mix_stride_ == round_up(mix_no_, VECTOR_FLOATS) &&
+        state_bytes == state_bytes_ && state_offset == states_begin(precision_, stride_) &&
+        scale_offset == (precision_ == model_precision::int8 ? 2 * COMPILED_MODEL_HEADER_SIZE : 0) &&
+        transition_offset == state_offset + model_no_ * state_no_ * state_bytes &&
+        image_size_ == transition_offset + model_no_ * transition_stride_ * sizeof(float) && image_size_ <= size;
+    if (!consistent)
+    {
+        throw std::runtime_error(source + ": corrupt compiled model header");
+    }
+
+    image_ = image;
+    states_ = image + state_offset;
+    scales_ = scale_offset ? reinterpret_cast<const float *>(image + scale_offset) : nullptr;
+    transitions_ = reinterpret_cast<const float *>(image + transition_offset);
+}
+
+
+void compiled_model::save(const std::string &filename) const
+{
+    const std::string temp = filename + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char *>(image_), (std::streamsize)image_size_))
+        {
+            throw std::runtime_error("cannot write " + temp);
+        }
+    }
+    if (std::rename(temp.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(temp.c_str());
+        throw std::runtime_error("cannot rename " + temp + " to " + filename);
+    }
+}
+
+
+void compiled_model::prepare_frame(const float *frame, float *x) const
+{
+    if (precision_ == model_precision::int8)
+    {
+        for (std::size_t d = 0; d < dim_; d++)
+        {
+            x[d] = (frame[d] - scales_[d]) * scales_[stride_ + d];
+        }
+    }
+    else
+    {
+        std::memcpy(x, frame, dim_ * sizeof(float));
+    }
+    std::fill(x + dim_, x + stride_, 0.0f);
+}
+
+
+/*******************************************************************************
+* Function Name: log_emission
+********************************************************************************
+* Summary:
+*  Per Gaussian, gconst - 1/2 sum_d (x_d - mu_d)^2 ivar_d with the kernel of
+*  the stored precision and the best instruction set: float16 entries are
+*  widened in the loop (vcvtph2ps with F16C), int8 entries give
+*  z_d = (x'_d - q_d) (A_d + B_d r_d), whose square is the same term. The
+*  mixtures are combined with the max-subtraction of log_hmm_gmm() in
+*  double precision.
+*
+* Parameters:
+*  model: 0-based model index
+*  state: 0-based emitting state
+*  x:     stride() floats, see prepare_frame()
+*
+* Return:
+*  log b_j(x)
+*
+*******************************************************************************/
+double compiled_model::log_emission(std::size_t model, std::size_t state, const float *x) const
+{
+    const float *log_w = log_weight(model, state);
+    const float *g = gconst(model, state);
+    const void *gaussian = gaussians(model, state);
+    double y[64];
+    float mahalanobis[64];
+    std::vector<double> y_large;
+    std::vector<float> mahalanobis_large;
+    double *ys = y;
+    float *ds = mahalanobis;
+    if (mix_no_ > 64)
+    {
+        y_large.resize(mix_no_);
+        mahalanobis_large.resize(mix_no_);
+        ys = y_large.data();
+        ds = mahalanobis_large.data();
+    }
+
+    if (precision_ == model_precision::float32)
+    {
+        const float *mu = static_cast<const float *>(gaussian);
+        for (std::size_t m = 0; m < mix_no_; m++, mu += 2 * stride_)
+        {
+            ds[m] = kernels::mahalanobis_float32(x, mu, mu + stride_, stride_);
+        }
+    }
+    else if (precision_ == model_precision::float16)
+    {
+        mahalanobis_float16(best_simd_isa(), x, static_cast<const uint16_t *>(gaussian), mix_no_, stride_, ds);
+    }
+    else
+    {
+        mahalanobis_int8(best_simd_isa(), x, static_cast<const unsigned char *>(gaussian), mix_no_,
+                         scales_ + 2 * stride_, scales_ + 3 * stride_, stride_, ds);
+    }
+
+    double ymax = -std::numeric_limits<double>::infinity();
+    for (std::size_t m = 0; m < mix_no_; m++)
+    {
+        ys[m] = (double)log_w[m] + (double)g[m] - 0.5 * (double)ds[m];
+        if (ys[m] > ymax)
+        {
+            ymax = ys[m];
+        }
+    }
+    if (std::isinf(ymax))
+    {
+        return ymax;
+    }
+    double sum_exp = 0.0;
+    for (std::size_t m = 0; m < mix_no_; m++)
+    {
+        sum_exp += std::exp(ys[m] - ymax);
+    }
+    return ymax + std::log(sum_exp);
+}
+
+
+/*******************************************************************************
+* Function Name: write_compiled_model_c_source
+********************************************************************************
+* Summary:
+*  Emits the image as little-endian 32-bit words (the byte order of the
+*  CM4), aligned to 64 bytes so the float sections can be used in place
+*  from flash.
+*
+* Parameters:
+*  filename:   C file to write
+*  model:      compiled model
+*  array_name: name of the const array
+*
+*******************************************************************************/
+void write_compiled_model_c_source(const std::string &filename, const compiled_model &model,
+                                   const std::string &array_name)
+{
+    std::ofstream out(filename, std::ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error("cannot create " + filename);
+    }
+    const std::size_t words = model.image_size() / 4;
+    out << "/* Generated by hmm_gmm_compile_model. Do not edit. */\n"
+        << "/* " << model.model_no() << " models, " << model.state_no() << " states, " << model.mix_no()
+        << " mixtures, dim " << model.dim() << ", " << model_precision_name(model.precision()) << ", "
+        << model.image_size() << " bytes */\n"
+        << "#include \"compiled_model.h\"\n\n"
+        << "COMPILED_MODEL_ALIGNED const uint32_t " << array_name << "[" << words << "] =\n{\n";
+    char word[16];
+    for (std::size_t i = 0; i < words; i++)
+    {
+        std::snprintf(word, sizeof(word), "0x%08lXu,", (unsigned long)load_le32(model.image() + 4 * i));
+        out << ((i % 8 == 0) ? "    " : " ") << word << ((i % 8 == 7 || i + 1 == words) ? "\n" : "");
+    }
+    out << "};\n";
+    if (!out)
+    {
+        throw std::runtime_error("cannot write " + filename);
+    }
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,114 @@
+/******************************************************************************
+* File Name:   compiled_model_avx2.cpp
+*
+* Description: AVX2 + F16C kernels of the quantised compiled_model images,
+*              built with -mavx2 -mfma -mf16c and only called after a CPU
+*              check. Products and sums are kept separate (no FMA) so the
+*              results equal the scalar kernels.
+*
+*******************************************************************************/
+#include "compiled_model_kernels.hpp"
+
+#include <immintrin.h>
+
+namespace hmm_gmm
+{
+namespace kernels
+{
+
+namespace
+{
+
+/* The addition tree of lane_sum8(), ((a0 + a1) + (a2 + a3)) + ((a4 + a5) + (a6 + a7)) */
+float reduce8(__m256 acc)
+{
+    acc = _mm256_hadd_ps(acc, acc);
+    acc = _mm256_hadd_ps(acc, acc);
+    return _mm_cvtss_f32(_mm_add_ss(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1)));
+}
+
+/* 8 codes widened to float: sign-extended for q, zero-extended for r */
+__m256 widen_int8(const int8_t *q)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(q))));
+}
+
+__m256 widen_uint8(const uint8_t *r)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(r))));
+}
+
+/* 8 dimensions per step, the half entries widened with vcvtph2ps */
+float distance_float16(const float *x, const uint16_t *mu, const uint16_t *iv, std::size_t lanes)
+{
+    __m256 acc = _mm256_setzero_ps();
+    for (std::size_t d = 0; d < lanes; d += 8)
+    {
+        const __m256 m = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(mu + d)));
+        const __m256 v = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(iv + d)));
+        const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(x + d), m);
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_mul_ps(diff, diff), v));
+    }
+    return reduce8(acc);
+}
+
+/* One 16 byte line of codes per step, lanes 0..7 and 8..15 in two accumulators */
+float distance_int8(const float *x, const int8_t *q, const uint8_t *r, const float *base, const float *step,
+                    std::size_t lanes)
+{
+    __m256 acc[2] = {_mm256_setzero_ps(), _mm256_setzero_ps()};
+    for (std::size_t d = 0; d < lanes; d += 16)
+    {
+        for (std::size_t h = 0; h < 2; h++)
+        {
+            const std::size_t i = d + 8 * h;
+            const __m256 scale = _mm256_add_ps(_mm256_loadu_ps(base + i),
+                                               _mm256_mul_ps(_mm256_loadu_ps(step + i), widen_uint8(r + i)));
+            const __m256 z = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), widen_int8(q + i)), scale);
+            acc[h] = _mm256_add_ps(acc[h], _mm256_mul_ps(z, z));
+        }
+    }
+    return reduce8(_mm256_add_ps(acc[0], acc[1]));
+}
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: mahalanobis_float16_avx2
+********************************************************************************
+* Summary:
+*  One Gaussian at a time, 8 dimensions per instruction.
+*
+*******************************************************************************/
+void mahalanobis_float16_avx2(const float *x, const uint16_t *gaussians, std::size_t gaussian_no, std::size_t lanes,
+                              float *out)
+{
+    for (std::size_t g = 0; g < gaussian_no; g++, gaussians += 2 * lanes)
+    {
+        out[g] = distance_float16(x, gaussians, gaussians + lanes, lanes);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: mahalanobis_int8_avx2
+********************************************************************************
+* Summary:
+*  One Gaussian at a time, codes widened 8 per instruction with vpmovsxbd /
+*  vpmovzxbd.
+*
+*******************************************************************************/
+void mahalanobis_int8_avx2(const float *x, const unsigned char *gaussians, std::size_t gaussian_no, const float *base,
+                           const float *step, std::size_t lanes, float *out)
+{
+    for (std::size_t g = 0; g < gaussian_no; g++, gaussians += 2 * lanes)
+    {
+        out[g] = distance_int8(x, reinterpret_cast<const int8_t *>(gaussians), gaussians + lanes, base, step, lanes);
+    }
+}
+
+} /* namespace kernels */
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
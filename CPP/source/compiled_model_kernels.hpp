@@ -0,0 +1,52 @@
+/******************************************************************************
+* File Name:   compiled_model_kernels.hpp
+*
+* Description: Distance kernels of the quantised compiled_model images, one
+*              translation unit per instruction set (AVX-512 hosts use the
+*              AVX2 kernels, see compiled_model.cpp). Every kernel adds the
+*              terms in the lane order of its scalar form (8 lanes for
+*              float16 as kernels::lane_sum8(), 16 lanes folded to 8 for
+*              int8) without contraction, so the choice of kernel does not
+*              change a score.
+*
+*              out[g] = distance of Gaussian g < gaussian_no, whose
+*              parameters start at gaussians + 2 lanes g:
+*
+*              float16: sum_d (x_d - mu_d)^2 ivar_d, lanes IEEE half means
+*                       then lanes inverse variances
+*              int8:    sum_d z_d^2, z_d = (x'_d - q_d) (base_d + step_d r_d),
+*                       lanes int8 codes q then lanes uint8 codes r
+*
+*              lanes is the padded stride (a multiple of 16). The kernels
+*              take all the mixtures of a state so the dispatch is paid
+*              once per state.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_COMPILED_MODEL_KERNELS_HPP)
+#define HMM_GMM_COMPILED_MODEL_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hmm_gmm
+{
+namespace kernels
+{
+
+void mahalanobis_float16_scalar(const float *x, const uint16_t *gaussians, std::size_t gaussian_no, std::size_t lanes,
+                                float *out);
+void mahalanobis_int8_scalar(const float *x, const unsigned char *gaussians, std::size_t gaussian_no, const float *base,
+                             const float *step, std::size_t lanes, float *out);
+
+#if defined(HMM_GMM_HAVE_AVX2)
+void mahalanobis_float16_avx2(const float *x, const uint16_t *gaussians, std::size_t gaussian_no, std::size_t lanes,
+                              float *out);
+void mahalanobis_int8_avx2(const float *x, const unsigned char *gaussians, std::size_t gaussian_no, const float *base,
+                           const float *step, std::size_t lanes, float *out);
+#endif
+
+} /* namespace kernels */
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_COMPILED_MODEL_KERNELS_HPP */
+/* [] END OF FILE */
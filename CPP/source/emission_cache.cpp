@@ -0,0 +1,125 @@
+/******************************************************************************
+* File Name:   emission_cache.cpp
+*
+* Description: Per-utterance emission cache, see emission_cache.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/emission_cache.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+/* rows are padded to whole 64 byte lines */
+constexpr std::size_t ROW_ALIGNMENT = 64 / sizeof(float);
+
+std::size_t padded_row(std::size_t state_count)
+{
+    return (state_count + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT;
+}
+
+} /* namespace */
+
+
+emission_cache::emission_cache(const compiled_model &model)
+    : model_(&model), state_no_(model.state_no()), row_stride_(padded_row(model.model_no() * model.state_no()))
+{
+}
+
+
+emission_cache::emission_cache(const compiled_model &model, const gaussian_scorer &scorer, log_add_tier tier)
+    : model_(&model), scorer_(&scorer), tier_(tier), state_no_(model.state_no()),
+      row_stride_(padded_row(model.model_no() * model.state_no()))
+{
+    if (scorer.state_count() != model.model_no() * model.state_no() || scorer.dim() != model.dim() ||
+        scorer.mix_no() != model.mix_no())
+    {
+        throw std::invalid_argument("the scorer was not built from this model");
+    }
+}
+
+
+emission_cache::emission_cache(const compiled_model &model, const gaussian_selection &selection)
+    : model_(&model), selection_(&selection), state_no_(model.state_no()),
+      row_stride_(padded_row(model.model_no() * model.state_no()))
+{
+    if (&selection.model() != &model)
+    {
+        throw std::invalid_argument("the Gaussian selection was not built for this model");
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: reset
+********************************************************************************
+* Summary:
+*  Attaches the next utterance. Lazy: every entry is marked as not computed
+*  and the frames are copied once into the zero padded vectors of stride()
+*  floats that compiled_model::log_emission takes (prepare_frame). Bulk: the whole matrix is scored.
+*  Selected: every frame is scored through its shortlist.
+*
+* Parameters:
+*  features: the utterance
+*
+*******************************************************************************/
+void emission_cache::reset(const feature_view &features)
+{
+    if (features.dim != model_->dim())
+    {
+        throw std::invalid_argument("feature and model dimensions differ");
+    }
+    frame_no_ = features.frame_no;
+    if (scores_.size() < frame_no_ * row_stride_)
+    {
+        scores_.resize(frame_no_ * row_stride_);
+    }
+
+    if (scorer_)
+    {
+        scorer_->score_states(features, scores_.data(), row_stride_, tier_);
+        evaluations_ += frame_no_ * scorer_->state_count();
+        gaussian_evaluations_ += frame_no_ * scorer_->gaussian_no();
+        return;
+    }
+
+    const std::size_t stride = model_->stride();
+    if (frames_.size() < frame_no_ * stride)
+    {
+        frames_.resize(frame_no_ * stride, 0.0f);
+    }
+    for (std::size_t t = 0; t < frame_no_; t++)
+    {
+        model_->prepare_frame(features.frame(t), &frames_[t * stride]);
+    }
+
+    if (selection_)
+    {
+        for (std::size_t t = 0; t < frame_no_; t++)
+        {
+            gaussian_evaluations_ += selection_->score_states(&frames_[t * stride], &scores_[t * row_stride_]);
+        }
+        evaluations_ += frame_no_ * model_->model_no() * state_no_;
+        return;
+    }
+    std::fill(scores_.begin(), scores_.begin() + frame_no_ * row_stride_,
+              std::numeric_limits<float>::quiet_NaN());
+}
+
+
+float emission_cache::evaluate(std::size_t k, std::size_t s, std::size_t t)
+{
+    evaluations_++;
+    gaussian_evaluations_ += model_->mix_no();
+    return (float)model_->log_emission(k, s, frames_.data() + t * model_->stride());
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,107 @@
+/******************************************************************************
+* File Name:   feature_cache.cpp
+*
+* Description: Feature cache manifest, see feature_cache.hpp. The manifest is
+*              a text file, one line per output:
+*
+*              <key> <content_hash> <input_size> <input_mtime> <output path>
+*
+*******************************************************************************/
+#include "hmm_gmm/feature_cache.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "hmm_gmm/content_hash.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+const char MANIFEST_HEADER[] = "# hmm_gmm feature cache v1";
+
+} /* namespace */
+
+
+feature_cache::feature_cache(const std::string &manifest_path)
+    : manifest_path_(manifest_path)
+{
+    std::ifstream in(manifest_path);
+    std::string line;
+    if (!in || !std::getline(in, line) || line != MANIFEST_HEADER)
+    {
+        return;
+    }
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string key, content;
+        cache_entry entry;
+        if (!(fields >> key >> content >> entry.input_size >> entry.input_mtime))
+        {
+            continue;
+        }
+        std::string output;
+        fields.get();
+        std::getline(fields, output);
+        entry.key = std::stoull(key, nullptr, 16);
+        entry.content_hash = std::stoull(content, nullptr, 16);
+        entries_[output] = entry;
+    }
+}
+
+
+const cache_entry *feature_cache::find(const std::string &output) const
+{
+    auto it = entries_.find(output);
+    return (it == entries_.end()) ? nullptr : &it->second;
+}
+
+
+void feature_cache::store(const std::string &output, const cache_entry &entry)
+{
+    entries_[output] = entry;
+}
+
+
+void feature_cache::save() const
+{
+    const std::string temporary = manifest_path_ + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out)
+        {
+            throw std::runtime_error("cannot write " + temporary);
+        }
+        out << MANIFEST_HEADER << '\n';
+        for (const auto &item : entries_)
+        {
+            const cache_entry &e = item.second;
+            out << hash_to_hex(e.key) << ' ' << hash_to_hex(e.content_hash) << ' '
+                << e.input_size << ' ' << e.input_mtime << ' ' << item.first << '\n';
+        }
+        if (!out)
+        {
+            throw std::runtime_error("write failed for " + temporary);
+        }
+    }
+    if (std::rename(temporary.c_str(), manifest_path_.c_str()) != 0)
+    {
+        throw std::runtime_error("cannot replace " + manifest_path_);
+    }
+}
+
+
+uint64_t feature_cache::make_key(uint64_t content_hash, uint64_t config_hash)
+{
+    const uint64_t parts[2] = {content_hash, config_hash};
+    return hash64(parts, sizeof(parts));
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,232 @@
+/******************************************************************************
+* File Name:   feature_corpus.cpp
+*
+* Description: Packed feature corpus reader and writer, see feature_corpus.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/feature_corpus.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "hmm_gmm/byte_order.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+const char CORPUS_MAGIC[8] = {'H', 'M', 'M', 'G', 'F', 'E', 'A', 'T'};
+constexpr uint32_t CORPUS_VERSION = 1;
+constexpr std::size_t HEADER_SIZE = 64;
+constexpr std::size_t RECORD_SIZE = 32;
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: feature_corpus
+********************************************************************************
+* Summary:
+*  Maps a corpus file and builds the utterance table. Feature blocks are
+*  used in place, so the host must be little-endian; every offset and
+*  length of the manifest is checked against the file size.
+*
+* Parameters:
+*  filename: path of the corpus file
+*
+*******************************************************************************/
+feature_corpus::feature_corpus(const std::string &filename)
+    : file_(filename)
+{
+    if (!host_is_little_endian())
+    {
+        throw std::runtime_error("feature corpus views need a little-endian host");
+    }
+    const unsigned char *base = file_.data();
+    const uint64_t file_size = file_.size();
+    if (file_size < HEADER_SIZE || std::memcmp(base, CORPUS_MAGIC, sizeof(CORPUS_MAGIC)) != 0)
+    {
+        throw std::runtime_error("not a feature corpus: " + filename);
+    }
+    if (load_le32(base + 8) != CORPUS_VERSION)
+    {
+        throw std::runtime_error("unsupported feature corpus version in " + filename);
+    }
+    dim_ = load_le32(base + 12);
+    const uint64_t utterance_no = load_le64(base + 16);
+    const uint64_t manifest_offset = load_le64(base + 24);
+    const uint64_t manifest_size = load_le64(base + 32);
+    samp_period_ = (int32_t)load_le32(base + 40);
+    parm_kind_ = (int16_t)load_le16(base + 44);
+    total_frames_ = load_le64(base + 48);
+
+    if (manifest_offset > file_size || manifest_size > file_size - manifest_offset ||
+        utterance_no > manifest_size / RECORD_SIZE)
+    {
+        throw std::runtime_error("corrupt feature corpus manifest in " + filename);
+    }
+    const unsigned char *manifest = base + manifest_offset;
+    const char *ids = reinterpret_cast<const char *>(manifest + utterance_no * RECORD_SIZE);
+    const uint64_t ids_size = manifest_size - utterance_no * RECORD_SIZE;
+
+    records_.resize(utterance_no);
+    for (uint64_t u = 0; u < utterance_no; u++)
+    {
+        const unsigned char *r = manifest + u * RECORD_SIZE;
+        const uint64_t data_offset = load_le64(r);
+        const uint32_t frame_no = load_le32(r + 8);
+        const uint32_t id_offset = load_le32(r + 16);
+        const uint32_t id_length = load_le32(r + 20);
+        const uint64_t data_size = (uint64_t)frame_no * dim_ * sizeof(float);
+        if (data_offset % FEATURE_CORPUS_ALIGNMENT != 0 || data_offset > manifest_offset ||
+            data_size > manifest_offset - data_offset || (uint64_t)id_offset + id_length > ids_size)
+        {
+            throw std::runtime_error("corrupt manifest entry " + std::to_string(u) + " in " + filename);
+        }
+        records_[u].label = (int32_t)load_le32(r + 12);
+        records_[u].frame_no = frame_no;
+        records_[u].data = reinterpret_cast<const float *>(base + data_offset);
+        records_[u].id = std::string_view(ids + id_offset, id_length);
+    }
+}
+
+
+corpus_utterance feature_corpus::operator[](std::size_t u) const
+{
+    const record &r = records_.at(u);
+    corpus_utterance utterance;
+    utterance.label = r.label;
+    utterance.id = r.id;
+    utterance.features = feature_view(dim_, r.frame_no, r.data);
+    return utterance;
+}
+
+
+feature_corpus_writer::feature_corpus_writer(const std::string &filename, std::size_t dim,
+                                             int32_t samp_period, int16_t parm_kind)
+    : filename_(filename), temporary_(filename + ".tmp"), dim_(dim), samp_period_(samp_period),
+      parm_kind_(parm_kind)
+{
+    file_ = std::fopen(temporary_.c_str(), "wb");
+    if (!file_)
+    {
+        throw std::runtime_error("cannot create " + temporary_);
+    }
+    /* header placeholder, written by finish() */
+    const unsigned char header[HEADER_SIZE] = {};
+    write(header, sizeof(header));
+}
+
+
+feature_corpus_writer::~feature_corpus_writer()
+{
+    if (file_)
+    {
+        std::fclose(file_);
+        std::remove(temporary_.c_str());
+    }
+}
+
+
+void feature_corpus_writer::write(const void *data, std::size_t size)
+{
+    if (size > 0 && std::fwrite(data, 1, size, file_) != size)
+    {
+        throw std::runtime_error("write failed for " + temporary_);
+    }
+    position_ += size;
+}
+
+
+void feature_corpus_writer::pad_to_alignment()
+{
+    static const unsigned char zeros[FEATURE_CORPUS_ALIGNMENT] = {};
+    write(zeros, (FEATURE_CORPUS_ALIGNMENT - position_ % FEATURE_CORPUS_ALIGNMENT) % FEATURE_CORPUS_ALIGNMENT);
+}
+
+
+void feature_corpus_writer::add(int32_t label, const std::string &id, const feature_view &features)
+{
+    if (features.dim != dim_)
+    {
+        throw std::invalid_argument("feature dimension " + std::to_string(features.dim) + " of " + id +
+                                    " does not match the corpus dimension " + std::to_string(dim_));
+    }
+    pad_to_alignment();
+    records_.push_back({position_, (uint32_t)features.frame_no, label, (uint32_t)ids_.size(), (uint32_t)id.size()});
+    ids_ += id;
+
+    const std::size_t count = features.dim * features.frame_no;
+    if (host_is_little_endian())
+    {
+        write(features.data, count * sizeof(float));
+    }
+    else
+    {
+        std::vector<unsigned char> bytes(count * sizeof(float));
+        for (std::size_t i = 0; i < count; i++)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &features.data[i], sizeof(bits));
+            store_le32(&bytes[4 * i], bits);
+        }
+        write(bytes.data(), bytes.size());
+    }
+    total_frames_ += features.frame_no;
+}
+
+
+/*******************************************************************************
+* Function Name: finish
+********************************************************************************
+* Summary:
+*  Appends the manifest and the id strings, fills in the header and renames
+*  the temporary file to the corpus name.
+*
+*******************************************************************************/
+void feature_corpus_writer::finish()
+{
+    pad_to_alignment();
+    const uint64_t manifest_offset = position_;
+    for (const record &r : records_)
+    {
+        unsigned char raw[RECORD_SIZE] = {};
+        store_le64(raw, r.data_offset);
+        store_le32(raw + 8, r.frame_no);
+        store_le32(raw + 12, (uint32_t)r.label);
+        store_le32(raw + 16, r.id_offset);
+        store_le32(raw + 20, r.id_length);
+        write(raw, sizeof(raw));
+    }
+    write(ids_.data(), ids_.size());
+    const uint64_t manifest_size = position_ - manifest_offset;
+    pad_to_alignment();
+
+    unsigned char header[HEADER_SIZE] = {};
+    std::memcpy(header, CORPUS_MAGIC, sizeof(CORPUS_MAGIC));
+    store_le32(header + 8, CORPUS_VERSION);
+    store_le32(header + 12, (uint32_t)dim_);
+    store_le64(header + 16, records_.size());
+    store_le64(header + 24, manifest_offset);
+    store_le64(header + 32, manifest_size);
+    store_le32(header + 40, (uint32_t)samp_period_);
+    store_le16(header + 44, (uint16_t)parm_kind_);
+    store_le64(header + 48, total_frames_);
+    if (std::fseek(file_, 0, SEEK_SET) != 0 || std::fwrite(header, 1, sizeof(header), file_) != sizeof(header))
+    {
+        throw std::runtime_error("write failed for " + temporary_);
+    }
+    const bool closed = std::fclose(file_) == 0;
+    file_ = nullptr;
+    if (!closed || std::rename(temporary_.c_str(), filename_.c_str()) != 0)
+    {
+        std::remove(temporary_.c_str());
+        throw std::runtime_error("cannot write " + filename_);
+    }
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
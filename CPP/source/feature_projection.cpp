@@ -0,0 +1,394 @@
+/******************************************************************************
+* File Name:   feature_projection.cpp
+*
+* Description: PCA / LDA feature projection, see feature_projection.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/feature_projection.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "hmm_gmm/linear_algebra.hpp"
+#include "hmm_gmm/mat_file.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+/* Relative ridge added to the within-class scatter for near-constant dimensions */
+constexpr double WITHIN_CLASS_RIDGE = 1e-6;
+
+void check_out_dim(std::size_t out_dim, std::size_t dim)
+{
+    if (out_dim == 0 || out_dim > dim)
+    {
+        throw std::invalid_argument("projection dimension must be in 1.." + std::to_string(dim));
+    }
+}
+
+} /* namespace */
+
+
+void feature_projection::apply(const float *in, float *out) const
+{
+    double centred[256];
+    std::vector<double> large;
+    double *c = centred;
+    if (in_dim > 256)
+    {
+        large.resize(in_dim);
+        c = large.data();
+    }
+    for (std::size_t d = 0; d < in_dim; d++)
+    {
+        c[d] = in[d] - mean[d];
+    }
+    for (std::size_t k = 0; k < out_dim; k++)
+    {
+        const double *w = &matrix[k * in_dim];
+        double y = 0.0;
+        for (std::size_t d = 0; d < in_dim; d++)
+        {
+            y += w[d] * c[d];
+        }
+        out[k] = (float)y;
+    }
+}
+
+
+feature_matrix feature_projection::apply(const feature_view &features) const
+{
+    if (features.dim != in_dim)
+    {
+        throw std::invalid_argument("projection expects " + std::to_string(in_dim) + " dimensional features");
+    }
+    feature_matrix out(out_dim, features.frame_no);
+    for (std::size_t t = 0; t < features.frame_no; t++)
+    {
+        apply(features.frame(t), out.frame(t));
+    }
+    return out;
+}
+
+
+hmm_set feature_projection::project_model(const hmm_set &hmm) const
+{
+    if (hmm.dim() != in_dim)
+    {
+        throw std::invalid_argument("model dimension does not match the projection");
+    }
+    hmm_set out = hmm;
+    for (std::size_t model = 0; model < out.models.size(); model++)
+    {
+        hmm_model &m = out.models[model];
+        const hmm_model &src = hmm.models[model];
+        m.dim = out_dim;
+        m.mean.assign(m.state_no * m.mix_no * out_dim, 0.0);
+        m.var.assign(m.state_no * m.mix_no * out_dim, 0.0);
+        for (std::size_t g = 0; g < m.state_no * m.mix_no; g++)
+        {
+            const double *mu = &src.mean[g * in_dim];
+            const double *v = &src.var[g * in_dim];
+            for (std::size_t k = 0; k < out_dim; k++)
+            {
+                const double *w = &matrix[k * in_dim];
+                double pm = 0.0, pv = 0.0;
+                for (std::size_t d = 0; d < in_dim; d++)
+                {
+                    pm += w[d] * (mu[d] - mean[d]);
+                    pv += w[d] * w[d] * v[d];
+                }
+                m.mean[g * out_dim + k] = pm;
+                m.var[g * out_dim + k] = pv;
+            }
+        }
+    }
+    return out;
+}
+
+
+projection_statistics::projection_statistics(std::size_t dim, std::size_t class_no)
+    : dim_(dim), class_no_(class_no), sum_(dim, 0.0), outer_(dim * dim, 0.0),
+      class_count_(class_no, 0.0), class_sum_(class_no * dim, 0.0)
+{
+}
+
+
+void projection_statistics::add(const float *x, int class_id)
+{
+    count_ += 1.0;
+    for (std::size_t i = 0; i < dim_; i++)
+    {
+        const double xi = x[i];
+        sum_[i] += xi;
+        double *row = &outer_[i * dim_];
+        for (std::size_t j = 0; j <= i; j++)
+        {
+            row[j] += xi * x[j];
+        }
+    }
+    if (class_id >= 0 && (std::size_t)class_id < class_no_)
+    {
+        class_count_[class_id] += 1.0;
+        double *cs = &class_sum_[(std::size_t)class_id * dim_];
+        for (std::size_t i = 0; i < dim_; i++)
+        {
+            cs[i] += x[i];
+        }
+    }
+}
+
+
+void projection_statistics::merge(const projection_statistics &other)
+{
+    if (other.dim_ != dim_ || other.class_no_ != class_no_)
+    {
+        throw std::invalid_argument("cannot merge projection statistics of different shape");
+    }
+    count_ += other.count_;
+    for (std::size_t i = 0; i < sum_.size(); i++)         sum_[i] += other.sum_[i];
+    for (std::size_t i = 0; i < outer_.size(); i++)       outer_[i] += other.outer_[i];
+    for (std::size_t i = 0; i < class_count_.size(); i++) class_count_[i] += other.class_count_[i];
+    for (std::size_t i = 0; i < class_sum_.size(); i++)   class_sum_[i] += other.class_sum_[i];
+}
+
+
+std::vector<double> projection_statistics::global_mean() const
+{
+    if (count_ < 2.0)
+    {
+        throw std::runtime_error("not enough frames to estimate a projection");
+    }
+    std::vector<double> mu(dim_);
+    for (std::size_t i = 0; i < dim_; i++)
+    {
+        mu[i] = sum_[i] / count_;
+    }
+    return mu;
+}
+
+
+/* sum (x - mu)(x - mu)' from the accumulated lower triangle */
+std::vector<double> projection_statistics::total_scatter(const std::vector<double> &mu) const
+{
+    std::vector<double> s(dim_ * dim_);
+    for (std::size_t i = 0; i < dim_; i++)
+    {
+        for (std::size_t j = 0; j <= i; j++)
+        {
+            const double v = outer_[i * dim_ + j] - count_ * mu[i] * mu[j];
+            s[i * dim_ + j] = v;
+            s[j * dim_ + i] = v;
+        }
+    }
+    return s;
+}
+
+
+/*******************************************************************************
+* Function Name: estimate_pca
+********************************************************************************
+* Summary:
+*  Rows of W are the out_dim leading eigenvectors of the total covariance.
+*
+*******************************************************************************/
+feature_projection projection_statistics::estimate_pca(std::size_t out_dim) const
+{
+    check_out_dim(out_dim, dim_);
+    feature_projection p;
+    p.type = "pca";
+    p.in_dim = dim_;
+    p.out_dim = out_dim;
+    p.mean = global_mean();
+    std::vector<double> cov = total_scatter(p.mean);
+    for (double &v : cov)
+    {
+        v /= count_;
+    }
+    std::vector<double> vectors;
+    symmetric_eigen(cov, dim_, p.eigenvalues, vectors);
+    p.matrix.assign(vectors.begin(), vectors.begin() + out_dim * dim_);
+    return p;
+}
+
+
+/*******************************************************************************
+* Function Name: estimate_lda
+********************************************************************************
+* Summary:
+*  Solves Sb v = lambda Sw v through the Cholesky factor Sw = L L':
+*  the eigenvectors u of L^-1 Sb L^-T give v = L^-T u. Rows of W are the
+*  out_dim leading v, scaled so the projected within-class covariance is
+*  the identity.
+*
+*******************************************************************************/
+feature_projection projection_statistics::estimate_lda(std::size_t out_dim) const
+{
+    check_out_dim(out_dim, dim_);
+    feature_projection p;
+    p.type = "lda";
+    p.in_dim = dim_;
+    p.out_dim = out_dim;
+    p.mean = global_mean();
+
+    /* within-class scatter Sw = sum x x' - sum_c n_c mu_c mu_c' over labelled frames */
+    std::vector<double> within = total_scatter(p.mean);
+    std::vector<double> between(dim_ * dim_, 0.0);
+    double labelled = 0.0;
+    std::size_t classes = 0;
+    for (std::size_t c = 0; c < class_no_; c++)
+    {
+        const double n = class_count_[c];
+        if (n <= 0.0)
+        {
+            continue;
+        }
+        labelled += n;
+        classes++;
+        const double *cs = &class_sum_[c * dim_];
+        for (std::size_t i = 0; i < dim_; i++)
+        {
+            for (std::size_t j = 0; j < dim_; j++)
+            {
+                const double di = cs[i] / n - p.mean[i];
+                const double dj = cs[j] / n - p.mean[j];
+                between[i * dim_ + j] += n * di * dj;
+            }
+        }
+    }
+    if (classes < 2 || labelled < count_)
+    {
+        throw std::runtime_error("LDA needs a class label for every frame and at least two classes");
+    }
+    double trace = 0.0;
+    for (std::size_t i = 0; i < dim_ * dim_; i++)
+    {
+        within[i] -= between[i];
+    }
+    for (std::size_t i = 0; i < dim_; i++)
+    {
+        trace += within[i * dim_ + i];
+    }
+    for (std::size_t i = 0; i < dim_; i++)
+    {
+        within[i * dim_ + i] += WITHIN_CLASS_RIDGE * trace / dim_;
+    }
+
+    const std::vector<double> l_inv = invert_lower(cholesky(within, dim_), dim_);
+    /* M = L^-1 Sb L^-T */
+    std::vector<double> tmp(dim_ * dim_, 0.0), m(dim_ * dim_, 0.0);
+    for (std::size_t i = 0; i < dim_; i++)
+    {
+        for (std::size_t j = 0; j < dim_; j++)
+        {
+            double s = 0.0;
+            for (std::size_t k = 0; k <= i; k++)
+            {
+                s += l_inv[i * dim_ + k] * between[k * dim_ + j];
+            }
+            tmp[i * dim_ + j] = s;
+        }
+    }
+    for (std::size_t i = 0; i < dim_; i++)
+    {
+        for (std::size_t j = 0; j < dim_; j++)
+        {
+            double s = 0.0;
+            for (std::size_t k = 0; k <= j; k++)
+            {
+                s += tmp[i * dim_ + k] * l_inv[j * dim_ + k];
+            }
+            m[i * dim_ + j] = s;
+        }
+    }
+    for (std::size_t i = 0; i < dim_; i++)
+    {
+        for (std::size_t j = 0; j < i; j++)
+        {
+            const double avg = 0.5 * (m[i * dim_ + j] + m[j * dim_ + i]);
+            m[i * dim_ + j] = avg;
+            m[j * dim_ + i] = avg;
+        }
+    }
+
+    std::vector<double> u;
+    symmetric_eigen(m, dim_, p.eigenvalues, u);
+    /* v = L^-T u, times sqrt(N) for unit within-class variance */
+    const double scale = std::sqrt(count_);
+    p.matrix.assign(out_dim * dim_, 0.0);
+    for (std::size_t k = 0; k < out_dim; k++)
+    {
+        for (std::size_t d = 0; d < dim_; d++)
+        {
+            double s = 0.0;
+            for (std::size_t i = d; i < dim_; i++)
+            {
+                s += l_inv[i * dim_ + d] * u[k * dim_ + i];
+            }
+            p.matrix[k * dim_ + d] = s * scale;
+        }
+    }
+    return p;
+}
+
+
+void write_feature_projection(const std::string &filename, const feature_projection &projection)
+{
+    /* MATLAB column-major [out_dim, in_dim] */
+    std::vector<double> w(projection.out_dim * projection.in_dim);
+    for (std::size_t k = 0; k < projection.out_dim; k++)
+    {
+        for (std::size_t d = 0; d < projection.in_dim; d++)
+        {
+            w[k + projection.out_dim * d] = projection.matrix[k * projection.in_dim + d];
+        }
+    }
+    write_mat_file(filename, {
+        make_mat_numeric("projection_matrix", {projection.out_dim, projection.in_dim}, std::move(w)),
+        make_mat_numeric("projection_mean", {projection.in_dim, 1}, projection.mean),
+        make_mat_char("projection_type", projection.type),
+    });
+}
+
+
+feature_projection read_feature_projection(const std::string &filename)
+{
+    const std::vector<mat_array> variables = read_mat_file(filename);
+    auto find = [&](const std::string &name) -> const mat_array & {
+        for (const mat_array &v : variables)
+        {
+            if (v.name == name)
+            {
+                return v;
+            }
+        }
+        throw std::runtime_error(name + " missing in " + filename);
+    };
+    feature_projection p;
+    const mat_array &w = find("projection_matrix");
+    const mat_array &mu = find("projection_mean");
+    p.type = find("projection_type").string();
+    if (!w.is_numeric() || !mu.is_numeric() || w.dims.size() != 2 || mu.numel() != w.cols())
+    {
+        throw std::runtime_error("malformed projection in " + filename);
+    }
+    p.out_dim = w.rows();
+    p.in_dim = w.cols();
+    p.mean = mu.real;
+    p.matrix.resize(p.out_dim * p.in_dim);
+    for (std::size_t k = 0; k < p.out_dim; k++)
+    {
+        for (std::size_t d = 0; d < p.in_dim; d++)
+        {
+            p.matrix[k * p.in_dim + d] = w.real[k + p.out_dim * d];
+        }
+    }
+    return p;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
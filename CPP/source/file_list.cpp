@@ -0,0 +1,123 @@
+/******************************************************************************
+* File Name:   file_list.cpp
+*
+* Description: Labelled file lists, see file_list.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/file_list.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "hmm_gmm/mat_file.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+bool has_mat_extension(const std::string &filename)
+{
+    std::string ext = std::filesystem::path(filename).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return ext == ".mat";
+}
+
+std::vector<labelled_file> read_mat_list(const std::string &filename, const std::string &var_name)
+{
+    const std::vector<mat_array> variables = read_mat_file(filename);
+    const mat_array *list = nullptr;
+    for (const mat_array &v : variables)
+    {
+        if ((var_name.empty() && v.type == mat_class::cell) || (!var_name.empty() && v.name == var_name))
+        {
+            list = &v;
+            break;
+        }
+    }
+    if (!list)
+    {
+        throw std::runtime_error("no file list " + (var_name.empty() ? std::string("cell array") : var_name) +
+                                 " in " + filename);
+    }
+    if (list->type != mat_class::cell || (list->numel() > 0 && list->cols() != 2))
+    {
+        throw std::runtime_error(list->name + " in " + filename + " is not an N x 2 cell array");
+    }
+
+    std::vector<labelled_file> files(list->rows());
+    for (std::size_t u = 0; u < files.size(); u++)
+    {
+        files[u].label = (int)list->cell(u, 0).scalar();
+        files[u].path = list->cell(u, 1).string();
+    }
+    return files;
+}
+
+std::vector<labelled_file> read_text_list(const std::string &filename)
+{
+    std::ifstream in(filename);
+    if (!in)
+    {
+        throw std::runtime_error("cannot open file list " + filename);
+    }
+    std::vector<labelled_file> files;
+    std::string line;
+    std::size_t line_no = 0;
+    while (std::getline(in, line))
+    {
+        line_no++;
+        std::istringstream fields(line);
+        labelled_file f;
+        if (line.empty() || line[0] == '#' || !(fields >> f.label))
+        {
+            if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#')
+            {
+                continue;
+            }
+            throw std::runtime_error(filename + ":" + std::to_string(line_no) + ": expected <model id> <path>");
+        }
+        fields >> std::ws;
+        std::getline(fields, f.path);
+        while (!f.path.empty() && (f.path.back() == '\r' || f.path.back() == ' '))
+        {
+            f.path.pop_back();
+        }
+        if (f.path.empty())
+        {
+            throw std::runtime_error(filename + ":" + std::to_string(line_no) + ": missing path");
+        }
+        files.push_back(f);
+    }
+    return files;
+}
+
+} /* namespace */
+
+
+std::vector<labelled_file> read_file_list(const std::string &filename, const std::string &var_name)
+{
+    return has_mat_extension(filename) ? read_mat_list(filename, var_name) : read_text_list(filename);
+}
+
+
+std::string resolve_list_path(const std::string &path, const std::string &base_dir)
+{
+    std::string p = path;
+    std::replace(p.begin(), p.end(), '\\', '/');
+    const std::filesystem::path native(p);
+    if (native.is_absolute() || base_dir.empty())
+    {
+        return native.lexically_normal().string();
+    }
+    return (std::filesystem::path(base_dir) / native).lexically_normal().string();
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,227 @@
+/******************************************************************************
+* File Name:   gaussian_scorer.cpp
+*
+* Description: Batched diagonal-Gaussian scorer, see gaussian_scorer.hpp.
+*              Packing, kernel dispatch and the portable scalar kernel.
+*
+*******************************************************************************/
+#include "hmm_gmm/gaussian_scorer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "gaussian_scorer_kernels.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr std::size_t PANEL = gaussian_scorer::PANEL_WIDTH;
+
+/* frames expanded per block: 64 rows of [x^2, x, 1] stay in L1 next to one panel */
+constexpr std::size_t FRAME_BLOCK = 64;
+
+} /* namespace */
+
+
+namespace kernels
+{
+
+/*******************************************************************************
+* Function Name: gemm_panels_scalar
+********************************************************************************
+* Summary:
+*  Portable kernel: a tile of 4 rows x 32 Gaussians is accumulated in local
+*  arrays, which the compiler keeps in vector registers of the baseline ISA.
+*
+*******************************************************************************/
+void gemm_panels_scalar(const float *rows, std::size_t row_no, std::size_t inner, const float *panels,
+                        std::size_t panel_no, float *out, std::size_t out_stride)
+{
+    constexpr std::size_t TILE = 4;
+    for (std::size_t p = 0; p < panel_no; p++)
+    {
+        const float *panel = panels + p * inner * PANEL;
+        for (std::size_t r0 = 0; r0 < row_no; r0 += TILE)
+        {
+            const std::size_t tile = std::min(TILE, row_no - r0);
+            float acc[TILE][PANEL] = {};
+            for (std::size_t k = 0; k < inner; k++)
+            {
+                const float *w = panel + k * PANEL;
+                for (std::size_t r = 0; r < tile; r++)
+                {
+                    const float a = rows[(r0 + r) * inner + k];
+                    for (std::size_t l = 0; l < PANEL; l++)
+                    {
+                        acc[r][l] += a * w[l];
+                    }
+                }
+            }
+            for (std::size_t r = 0; r < tile; r++)
+            {
+                std::copy(acc[r], acc[r] + PANEL, out + (r0 + r) * out_stride + p * PANEL);
+            }
+        }
+    }
+}
+
+} /* namespace kernels */
+
+
+gaussian_scorer::gaussian_scorer(const compiled_model &model)
+    : gaussian_scorer(model, best_simd_isa())
+{
+}
+
+
+/*******************************************************************************
+* Function Name: gaussian_scorer
+********************************************************************************
+* Summary:
+*  Packs [-1/2 ivar, mean ivar, k] of every Gaussian into k-major panels of
+*  PANEL_WIDTH Gaussians. The constant folds the log mixture weight, gconst
+*  and -1/2 sum mean^2 ivar (summed in double). Padding Gaussians are all
+*  zero, so their score is 0.
+*
+* Parameters:
+*  model: compiled model set
+*  isa:   kernel to use
+*
+*******************************************************************************/
+gaussian_scorer::gaussian_scorer(const compiled_model &model, simd_isa isa)
+    : isa_(isa), dim_(model.dim()), mix_no_(model.mix_no()), state_count_(model.model_no() * model.state_no()),
+      inner_(2 * model.dim() + 1), panel_no_((state_count_ * model.mix_no() + PANEL - 1) / PANEL)
+{
+    if (model.precision() != model_precision::float32)
+    {
+        throw std::invalid_argument("the batched scorer needs a float32 model");
+    }
+    if (!simd_isa_supported(isa))
+    {
+        throw std::invalid_argument(std::string("the ") + simd_isa_name(isa) + " kernel is not available");
+    }
+    panels_.assign(panel_no_ * inner_ * PANEL, 0.0f);
+    for (std::size_t k = 0; k < model.model_no(); k++)
+    {
+        for (std::size_t s = 0; s < model.state_no(); s++)
+        {
+            for (std::size_t m = 0; m < mix_no_; m++)
+            {
+                const std::size_t g = ((k * model.state_no() + s) * mix_no_) + m;
+                float *panel = &panels_[(g / PANEL) * inner_ * PANEL];
+                const std::size_t lane = g % PANEL;
+                const float *mu = model.mean(k, s, m);
+                const float *iv = model.ivar(k, s, m);
+                double quadratic = 0.0;
+                for (std::size_t d = 0; d < dim_; d++)
+                {
+                    panel[d * PANEL + lane] = -0.5f * iv[d];
+                    panel[(dim_ + d) * PANEL + lane] = mu[d] * iv[d];
+                    quadratic += (double)mu[d] * mu[d] * iv[d];
+                }
+                panel[2 * dim_ * PANEL + lane] =
+                    (float)((double)model.log_weight(k, s)[m] + (double)model.gconst(k, s)[m] - 0.5 * quadratic);
+            }
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: score_gaussians
+********************************************************************************
+* Summary:
+*  Expands FRAME_BLOCK frames at a time to [x^2, x, 1] rows and multiplies
+*  the block with all panels using the selected kernel.
+*
+* Parameters:
+*  features:   utterance, dim must match the model
+*  out:        frame_no rows of at least padded_gaussian_no() floats
+*  out_stride: floats between rows of out
+*
+*******************************************************************************/
+void gaussian_scorer::score_gaussians(const feature_view &features, float *out, std::size_t out_stride) const
+{
+    if (features.dim != dim_)
+    {
+        throw std::invalid_argument("feature and model dimensions differ");
+    }
+    if (out_stride < padded_gaussian_no())
+    {
+        throw std::invalid_argument("output stride is smaller than the padded Gaussian count");
+    }
+
+    std::vector<float> rows(FRAME_BLOCK * inner_);
+    for (std::size_t t0 = 0; t0 < features.frame_no; t0 += FRAME_BLOCK)
+    {
+        const std::size_t row_no = std::min(FRAME_BLOCK, features.frame_no - t0);
+        for (std::size_t r = 0; r < row_no; r++)
+        {
+            const float *x = features.frame(t0 + r);
+            float *row = &rows[r * inner_];
+            for (std::size_t d = 0; d < dim_; d++)
+            {
+                row[d] = x[d] * x[d];
+                row[dim_ + d] = x[d];
+            }
+            row[2 * dim_] = 1.0f;
+        }
+
+        float *block_out = out + t0 * out_stride;
+        switch (isa_)
+        {
+#if defined(HMM_GMM_HAVE_AVX512)
+        case simd_isa::avx512:
+            kernels::gemm_panels_avx512(rows.data(), row_no, inner_, panels_.data(), panel_no_, block_out, out_stride);
+            break;
+#endif
+#if defined(HMM_GMM_HAVE_AVX2)
+        case simd_isa::avx2:
+            kernels::gemm_panels_avx2(rows.data(), row_no, inner_, panels_.data(), panel_no_, block_out, out_stride);
+            break;
+#endif
+        default:
+            kernels::gemm_panels_scalar(rows.data(), row_no, inner_, panels_.data(), panel_no_, block_out, out_stride);
+            break;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: score_states
+********************************************************************************
+* Summary:
+*  Scores all Gaussians, then combines the mixtures of each state with
+*  log_sum_exp_groups(). A state whose mixtures all have zero weight scores
+*  -Inf.
+*
+* Parameters:
+*  features:   utterance, dim must match the model
+*  out:        frame_no rows of at least state_count() floats
+*  out_stride: floats between rows of out
+*  tier:       log-add accuracy tier
+*
+*******************************************************************************/
+void gaussian_scorer::score_states(const feature_view &features, float *out, std::size_t out_stride,
+                                   log_add_tier tier) const
+{
+    const std::size_t stride = padded_gaussian_no();
+    std::vector<float> gaussians(features.frame_no * stride);
+    score_gaussians(features, gaussians.data(), stride);
+
+    const simd_isa isa = (isa_ == simd_isa::scalar) ? simd_isa::scalar : best_simd_isa();
+    for (std::size_t t = 0; t < features.frame_no; t++)
+    {
+        log_sum_exp_groups(tier, &gaussians[t * stride], mix_no_, state_count_, out + t * out_stride, isa);
+    }
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
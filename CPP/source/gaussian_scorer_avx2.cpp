@@ -0,0 +1,90 @@
+/******************************************************************************
+* File Name:   gaussian_scorer_avx2.cpp
+*
+* Description: AVX2 + FMA kernel of gaussian_scorer, built with -mavx2 -mfma
+*              and only called after a CPU check.
+*
+*******************************************************************************/
+#include "gaussian_scorer_kernels.hpp"
+
+#include <immintrin.h>
+
+namespace hmm_gmm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr std::size_t PANEL = 32;
+
+/* ROWS x 16 Gaussians: 2 * ROWS accumulators, two panel loads and one broadcast per k */
+template <std::size_t ROWS>
+void tile(const float *rows, std::size_t inner, const float *panel, float *out, std::size_t out_stride)
+{
+    __m256 acc[ROWS][2];
+    for (std::size_t r = 0; r < ROWS; r++)
+    {
+        acc[r][0] = _mm256_setzero_ps();
+        acc[r][1] = _mm256_setzero_ps();
+    }
+    for (std::size_t k = 0; k < inner; k++)
+    {
+        const __m256 w0 = _mm256_loadu_ps(panel + k * PANEL);
+        const __m256 w1 = _mm256_loadu_ps(panel + k * PANEL + 8);
+        for (std::size_t r = 0; r < ROWS; r++)
+        {
+            const __m256 a = _mm256_broadcast_ss(rows + r * inner + k);
+            acc[r][0] = _mm256_fmadd_ps(a, w0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(a, w1, acc[r][1]);
+        }
+    }
+    for (std::size_t r = 0; r < ROWS; r++)
+    {
+        _mm256_storeu_ps(out + r * out_stride, acc[r][0]);
+        _mm256_storeu_ps(out + r * out_stride + 8, acc[r][1]);
+    }
+}
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: gemm_panels_avx2
+********************************************************************************
+* Summary:
+*  Each 32 wide panel is processed as two 16 wide halves with a 4 row x 16
+*  tile (8 ymm accumulators, enough independent FMAs to hide the latency);
+*  the last 1..3 rows use a smaller tile.
+*
+*******************************************************************************/
+void gemm_panels_avx2(const float *rows, std::size_t row_no, std::size_t inner, const float *panels,
+                      std::size_t panel_no, float *out, std::size_t out_stride)
+{
+    for (std::size_t p = 0; p < panel_no; p++)
+    {
+        for (std::size_t half = 0; half < 2; half++)
+        {
+            const float *panel = panels + p * inner * PANEL + half * 16;
+            float *panel_out = out + p * PANEL + half * 16;
+            std::size_t r = 0;
+            for (; r + 4 <= row_no; r += 4)
+            {
+                tile<4>(rows + r * inner, inner, panel, panel_out + r * out_stride, out_stride);
+            }
+            switch (row_no - r)
+            {
+            case 3: tile<3>(rows + r * inner, inner, panel, panel_out + r * out_stride, out_stride); break;
+            case 2: tile<2>(rows + r * inner, inner, panel, panel_out + r * out_stride, out_stride); break;
+            case 1: tile<1>(rows + r * inner, inner, panel, panel_out + r * out_stride, out_stride); break;
+            default: break;
+            }
+        }
+    }
+}
+
+} /* namespace kernels */
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
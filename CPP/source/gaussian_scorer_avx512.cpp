@@ -0,0 +1,97 @@
+/******************************************************************************
+* File Name:   gaussian_scorer_avx512.cpp
+*
+* Description: AVX-512F kernel of gaussian_scorer, built with -mavx512f and
+*              only called after a CPU check.
+*
+*******************************************************************************/
+#include "gaussian_scorer_kernels.hpp"
+
+#include <immintrin.h>
+
+namespace hmm_gmm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr std::size_t PANEL = 32;
+
+/* ROWS x 32 Gaussians: 2 * ROWS zmm accumulators */
+template <std::size_t ROWS>
+void tile(const float *rows, std::size_t inner, const float *panel, float *out, std::size_t out_stride)
+{
+    __m512 acc[ROWS][2];
+    for (std::size_t r = 0; r < ROWS; r++)
+    {
+        acc[r][0] = _mm512_setzero_ps();
+        acc[r][1] = _mm512_setzero_ps();
+    }
+    for (std::size_t k = 0; k < inner; k++)
+    {
+        const __m512 w0 = _mm512_loadu_ps(panel + k * PANEL);
+        const __m512 w1 = _mm512_loadu_ps(panel + k * PANEL + 16);
+        for (std::size_t r = 0; r < ROWS; r++)
+        {
+            const __m512 a = _mm512_set1_ps(rows[r * inner + k]);
+            acc[r][0] = _mm512_fmadd_ps(a, w0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_ps(a, w1, acc[r][1]);
+        }
+    }
+    for (std::size_t r = 0; r < ROWS; r++)
+    {
+        _mm512_storeu_ps(out + r * out_stride, acc[r][0]);
+        _mm512_storeu_ps(out + r * out_stride + 16, acc[r][1]);
+    }
+}
+
+template <std::size_t ROWS>
+void remainder(std::size_t row_count, const float *rows, std::size_t inner, const float *panel, float *out,
+               std::size_t out_stride)
+{
+    if constexpr (ROWS > 0)
+    {
+        if (row_count == ROWS)
+        {
+            tile<ROWS>(rows, inner, panel, out, out_stride);
+        }
+        else
+        {
+            remainder<ROWS - 1>(row_count, rows, inner, panel, out, out_stride);
+        }
+    }
+}
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: gemm_panels_avx512
+********************************************************************************
+* Summary:
+*  8 row x 32 Gaussian tiles, 16 of the 32 zmm registers as accumulators;
+*  the last 1..7 rows use a smaller tile.
+*
+*******************************************************************************/
+void gemm_panels_avx512(const float *rows, std::size_t row_no, std::size_t inner, const float *panels,
+                        std::size_t panel_no, float *out, std::size_t out_stride)
+{
+    for (std::size_t p = 0; p < panel_no; p++)
+    {
+        const float *panel = panels + p * inner * PANEL;
+        float *panel_out = out + p * PANEL;
+        std::size_t r = 0;
+        for (; r + 8 <= row_no; r += 8)
+        {
+            tile<8>(rows + r * inner, inner, panel, panel_out + r * out_stride, out_stride);
+        }
+        remainder<7>(row_no - r, rows + r * inner, inner, panel, panel_out + r * out_stride, out_stride);
+    }
+}
+
+} /* namespace kernels */
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,41 @@
+/******************************************************************************
+* File Name:   gaussian_scorer_kernels.hpp
+*
+* Description: Matrix product kernels of gaussian_scorer, one translation
+*              unit per instruction set so each can be compiled with its own
+*              target flags:
+*
+*              out[r * out_stride + p * 32 + l] =
+*                  sum_k rows[r * inner + k] * panels[(p * inner + k) * 32 + l]
+*
+*              for r < row_no, p < panel_no, l < 32.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_GAUSSIAN_SCORER_KERNELS_HPP)
+#define HMM_GMM_GAUSSIAN_SCORER_KERNELS_HPP
+
+#include <cstddef>
+
+namespace hmm_gmm
+{
+namespace kernels
+{
+
+void gemm_panels_scalar(const float *rows, std::size_t row_no, std::size_t inner, const float *panels,
+                        std::size_t panel_no, float *out, std::size_t out_stride);
+
+#if defined(HMM_GMM_HAVE_AVX2)
+void gemm_panels_avx2(const float *rows, std::size_t row_no, std::size_t inner, const float *panels,
+                      std::size_t panel_no, float *out, std::size_t out_stride);
+#endif
+
+#if defined(HMM_GMM_HAVE_AVX512)
+void gemm_panels_avx512(const float *rows, std::size_t row_no, std::size_t inner, const float *panels,
+                        std::size_t panel_no, float *out, std::size_t out_stride);
+#endif
+
+} /* namespace kernels */
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_GAUSSIAN_SCORER_KERNELS_HPP */
+/* [] END OF FILE */
@@ -0,0 +1,474 @@
+/******************************************************************************
+* File Name:   gaussian_selection.cpp
+*
+* Description: Gaussian selection with a VQ codebook, see
+*              gaussian_selection.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/gaussian_selection.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "hmm_gmm/mat_file.hpp"
+
+#include "mahalanobis.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr double NEG_INF = -std::numeric_limits<double>::infinity();
+
+double squared_distance(const float *a, const float *b, std::size_t n)
+{
+    double d = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double diff = (double)a[i] - b[i];
+        d += diff * diff;
+    }
+    return d;
+}
+
+/* log c_g + gconst_g - 1/2 sum_d (x_d - mu_gd)^2 ivar_gd, x of stride floats */
+double log_weighted_gaussian(const compiled_model &model, std::size_t g, const float *x)
+{
+    const std::size_t mix = g % model.mix_no();
+    const std::size_t state = g / model.mix_no();
+    const std::size_t k = state / model.state_no(), s = state % model.state_no();
+    const float *mu = model.mean(k, s, mix);
+    const float *iv = model.ivar(k, s, mix);
+    const float mahalanobis = kernels::mahalanobis_float32(x, mu, iv, model.stride());
+    return (double)model.log_weight(k, s)[mix] + (double)model.gconst(k, s)[mix] - 0.5 * (double)mahalanobis;
+}
+
+/* log sum exp of n values with the max subtraction of log_hmm_gmm() */
+double log_sum_exp(const double *y, std::size_t n)
+{
+    const double ymax = *std::max_element(y, y + n);
+    if (std::isinf(ymax))
+    {
+        return ymax;
+    }
+    double sum_exp = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        sum_exp += std::exp(y[i] - ymax);
+    }
+    return ymax + std::log(sum_exp);
+}
+
+/*******************************************************************************
+* Function Name: cluster_means
+********************************************************************************
+* Summary:
+*  k-means of the points (the scaled Gaussian means). Initialised with the
+*  point nearest to the centroid of all points and then, one at a time, the
+*  point farthest from the codewords chosen so far, so the result is
+*  deterministic. Empty cells keep their codeword.
+*
+* Parameters:
+*  points:     point_no * stride floats
+*  point_no:   number of points
+*  stride:     floats per point
+*  size:       codewords, <= point_no
+*  iterations: Lloyd iterations (stops early when no point changes cell)
+*
+* Return:
+*  size * stride codewords
+*
+*******************************************************************************/
+std::vector<float> cluster_means(const std::vector<float> &points, std::size_t point_no, std::size_t stride,
+                                 std::size_t size, std::size_t iterations)
+{
+    std::vector<double> centroid(stride, 0.0);
+    for (std::size_t p = 0; p < point_no; p++)
+    {
+        for (std::size_t d = 0; d < stride; d++)
+        {
+            centroid[d] += points[p * stride + d] / (double)point_no;
+        }
+    }
+    std::vector<float> c(centroid.begin(), centroid.end());
+    std::size_t first = 0;
+    double first_distance = std::numeric_limits<double>::infinity();
+    for (std::size_t p = 0; p < point_no; p++)
+    {
+        const double d = squared_distance(&points[p * stride], c.data(), stride);
+        if (d < first_distance)
+        {
+            first_distance = d;
+            first = p;
+        }
+    }
+
+    std::vector<float> codebook(size * stride);
+    std::vector<double> nearest(point_no, std::numeric_limits<double>::infinity());
+    std::size_t chosen = first;
+    for (std::size_t v = 0; v < size; v++)
+    {
+        std::copy(&points[chosen * stride], &points[chosen * stride] + stride, &codebook[v * stride]);
+        double farthest = -1.0;
+        for (std::size_t p = 0; p < point_no; p++)
+        {
+            nearest[p] = std::min(nearest[p], squared_distance(&points[p * stride], &codebook[v * stride], stride));
+            if (nearest[p] > farthest)
+            {
+                farthest = nearest[p];
+                chosen = p;
+            }
+        }
+    }
+
+    std::vector<std::size_t> cell(point_no, size);
+    std::vector<double> sum(size * stride);
+    std::vector<std::size_t> count(size);
+    for (std::size_t it = 0; it < iterations; it++)
+    {
+        bool changed = false;
+        for (std::size_t p = 0; p < point_no; p++)
+        {
+            std::size_t best = 0;
+            double best_distance = std::numeric_limits<double>::infinity();
+            for (std::size_t v = 0; v < size; v++)
+            {
+                const double d = squared_distance(&points[p * stride], &codebook[v * stride], stride);
+                if (d < best_distance)
+                {
+                    best_distance = d;
+                    best = v;
+                }
+            }
+            changed |= (cell[p] != best);
+            cell[p] = best;
+        }
+        if (!changed)
+        {
+            break;
+        }
+        std::fill(sum.begin(), sum.end(), 0.0);
+        std::fill(count.begin(), count.end(), 0);
+        for (std::size_t p = 0; p < point_no; p++)
+        {
+            count[cell[p]]++;
+            for (std::size_t d = 0; d < stride; d++)
+            {
+                sum[cell[p] * stride + d] += points[p * stride + d];
+            }
+        }
+        for (std::size_t v = 0; v < size; v++)
+        {
+            for (std::size_t d = 0; count[v] > 0 && d < stride; d++)
+            {
+                codebook[v * stride + d] = (float)(sum[v * stride + d] / (double)count[v]);
+            }
+        }
+    }
+    return codebook;
+}
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: gaussian_selection
+********************************************************************************
+* Summary:
+*  Builds the selection of a model set: pooled metric, k-means codebook of
+*  the scaled means, and per codeword the 'shortlist' Gaussians with the
+*  largest weighted log-likelihood at the codeword plus the state floors.
+*  Gaussians with zero weight are never selected.
+*
+* Parameters:
+*  model:  compiled model set; must outlive the selection
+*  config: codebook size, shortlist length, k-means iterations
+*
+*******************************************************************************/
+gaussian_selection::gaussian_selection(const compiled_model &model, const gaussian_selection_config &config)
+    : model_(&model), dim_(model.dim()), stride_(model.stride()), state_count_(model.model_no() * model.state_no()),
+      gaussian_no_(state_count_ * model.mix_no()), codebook_size_(0)
+{
+    if (model.precision() != model_precision::float32)
+    {
+        throw std::invalid_argument("Gaussian selection needs a float32 model");
+    }
+    if (config.codebook_size == 0 || config.shortlist == 0)
+    {
+        throw std::invalid_argument("codebook size and shortlist length must be positive");
+    }
+    const std::size_t mix_no = model.mix_no();
+    std::vector<uint32_t> active;
+    std::vector<double> pooled_var(dim_, 0.0);
+    for (std::size_t g = 0; g < gaussian_no_; g++)
+    {
+        const std::size_t k = g / mix_no / model.state_no(), s = g / mix_no % model.state_no();
+        if (std::isinf(model.log_weight(k, s)[g % mix_no]))
+        {
+            continue;
+        }
+        active.push_back((uint32_t)g);
+        const float *iv = model.ivar(k, s, g % mix_no);
+        for (std::size_t d = 0; d < dim_; d++)
+        {
+            pooled_var[d] += 1.0 / iv[d];
+        }
+    }
+    if (active.empty())
+    {
+        throw std::invalid_argument("the model has no Gaussian with a positive weight");
+    }
+
+    /* metric: 1 / sqrt(pooled variance), 0 in the padding */
+    metric_.assign(stride_, 0.0f);
+    for (std::size_t d = 0; d < dim_; d++)
+    {
+        metric_[d] = (float)std::sqrt((double)active.size() / pooled_var[d]);
+    }
+    std::vector<float> points(active.size() * stride_, 0.0f);
+    for (std::size_t p = 0; p < active.size(); p++)
+    {
+        const std::size_t g = active[p];
+        const float *mu = model.mean(g / mix_no / model.state_no(), g / mix_no % model.state_no(), g % mix_no);
+        for (std::size_t d = 0; d < dim_; d++)
+        {
+            points[p * stride_ + d] = mu[d] * metric_[d];
+        }
+    }
+    codebook_size_ = std::min(config.codebook_size, active.size());
+    codebook_ = cluster_means(points, active.size(), stride_, codebook_size_, config.iterations);
+
+    const std::size_t shortlist = std::min(config.shortlist, active.size());
+    offset_.assign(1, 0);
+    floor_.resize(codebook_size_ * state_count_);
+    std::vector<float> c(stride_, 0.0f);
+    std::vector<double> y(gaussian_no_);
+    std::vector<uint32_t> order;
+    for (std::size_t v = 0; v < codebook_size_; v++)
+    {
+        for (std::size_t d = 0; d < dim_; d++)
+        {
+            c[d] = codebook_[v * stride_ + d] / metric_[d];
+        }
+        for (std::size_t g = 0; g < gaussian_no_; g++)
+        {
+            y[g] = log_weighted_gaussian(model, g, c.data());
+        }
+
+        order = active;
+        std::nth_element(order.begin(), order.begin() + (shortlist - 1), order.end(),
+                         [&](uint32_t a, uint32_t b) { return y[a] > y[b] || (y[a] == y[b] && a < b); });
+        std::sort(order.begin(), order.begin() + shortlist);
+        shortlist_.insert(shortlist_.end(), order.begin(), order.begin() + shortlist);
+        offset_.push_back(shortlist_.size());
+
+        float *floor = &floor_[v * state_count_];
+        double best = NEG_INF;
+        for (std::size_t j = 0; j < state_count_; j++)
+        {
+            const double b = log_sum_exp(&y[j * mix_no], mix_no);
+            floor[j] = (float)b;
+            best = std::max(best, b);
+        }
+        for (std::size_t j = 0; j < state_count_; j++)
+        {
+            floor[j] = (float)((double)floor[j] - best);
+        }
+    }
+}
+
+
+gaussian_selection::gaussian_selection(const compiled_model &model, const std::string &filename)
+    : model_(&model), dim_(model.dim()), stride_(model.stride()), state_count_(model.model_no() * model.state_no()),
+      gaussian_no_(state_count_ * model.mix_no()), codebook_size_(0)
+{
+    if (model.precision() != model_precision::float32)
+    {
+        throw std::invalid_argument("Gaussian selection needs a float32 model");
+    }
+    const std::vector<mat_array> variables = read_mat_file(filename);
+    auto find = [&](const std::string &name) -> const mat_array & {
+        for (const mat_array &v : variables)
+        {
+            if (v.name == name && v.is_numeric())
+            {
+                return v;
+            }
+        }
+        throw std::runtime_error(name + " missing in " + filename);
+    };
+    const mat_array &shape = find("gs_shape");
+    if (shape.numel() != 4 || shape.real[0] != dim_ || shape.real[1] != model.mix_no() ||
+        shape.real[2] != model.state_no() || shape.real[3] != model.model_no())
+    {
+        throw std::runtime_error(filename + " was built for a different model");
+    }
+    const mat_array &codebook = find("gs_codebook");
+    const mat_array &metric = find("gs_metric");
+    const mat_array &shortlist = find("gs_shortlist");
+    const mat_array &offset = find("gs_shortlist_offset");
+    const mat_array &floor = find("gs_floor");
+    codebook_size_ = codebook.cols();
+    if (codebook.rows() != dim_ || metric.numel() != dim_ || offset.numel() != codebook_size_ + 1 ||
+        floor.numel() != codebook_size_ * state_count_ || codebook_size_ == 0)
+    {
+        throw std::runtime_error("malformed Gaussian selection in " + filename);
+    }
+
+    metric_.assign(stride_, 0.0f);
+    codebook_.assign(codebook_size_ * stride_, 0.0f);
+    for (std::size_t d = 0; d < dim_; d++)
+    {
+        metric_[d] = (float)metric.real[d];
+    }
+    for (std::size_t v = 0; v < codebook_size_; v++)
+    {
+        for (std::size_t d = 0; d < dim_; d++)
+        {
+            codebook_[v * stride_ + d] = (float)codebook.real[v * dim_ + d] * metric_[d];
+        }
+    }
+    offset_.assign(offset.real.begin(), offset.real.end());
+    if (offset_.front() != 0 || offset_.back() != shortlist.numel() ||
+        !std::is_sorted(offset_.begin(), offset_.end()))
+    {
+        throw std::runtime_error("malformed Gaussian selection in " + filename);
+    }
+    for (double g : shortlist.real)
+    {
+        if (!(g >= 0.0 && g < (double)gaussian_no_))
+        {
+            throw std::runtime_error("malformed Gaussian selection in " + filename);
+        }
+        shortlist_.push_back((uint32_t)g);
+    }
+    /* score_states() groups the mixtures of a state by adjacency: each shortlist must be strictly ascending */
+    for (std::size_t v = 0; v < codebook_size_; v++)
+    {
+        for (std::size_t i = offset_[v] + 1; i < offset_[v + 1]; i++)
+        {
+            if (shortlist_[i] <= shortlist_[i - 1])
+            {
+                throw std::runtime_error("malformed Gaussian selection in " + filename + ": shortlist of codeword " +
+                                         std::to_string(v + 1) + " is not strictly ascending");
+            }
+        }
+    }
+    floor_.assign(floor.real.begin(), floor.real.end());
+}
+
+
+std::size_t gaussian_selection::quantise(const float *x) const
+{
+    std::size_t best = 0;
+    double best_distance = std::numeric_limits<double>::infinity();
+    for (std::size_t v = 0; v < codebook_size_; v++)
+    {
+        const float *c = &codebook_[v * stride_];
+        const double distance = kernels::lane_sum8(stride_, [&](std::size_t i) {
+            const float diff = x[i] * metric_[i] - c[i];
+            return diff * diff;
+        });
+        if (distance < best_distance)
+        {
+            best_distance = distance;
+            best = v;
+        }
+    }
+    return best;
+}
+
+
+/*******************************************************************************
+* Function Name: score_states
+********************************************************************************
+* Summary:
+*  Quantises the frame, evaluates the shortlist of its codeword (ascending
+*  Gaussian indices, so the mixtures of a state are adjacent) and floors the
+*  states without a shortlisted Gaussian relative to the best evaluated one.
+*
+* Parameters:
+*  x:   stride() floats, padding zero
+*  out: model_no * state_no state log-likelihoods
+*
+* Return:
+*  Gaussians evaluated
+*
+*******************************************************************************/
+std::size_t gaussian_selection::score_states(const float *x, float *out) const
+{
+    const std::size_t v = quantise(x);
+    const std::size_t mix_no = model_->mix_no();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::fill(out, out + state_count_, nan);
+
+    double y_small[64];
+    std::vector<double> y_large;
+    double *y = y_small;
+    if (mix_no > 64)
+    {
+        y_large.resize(mix_no);
+        y = y_large.data();
+    }
+    double best = NEG_INF;
+    const uint32_t *g = shortlist_.data() + offset_[v];
+    const uint32_t *end = shortlist_.data() + offset_[v + 1];
+    while (g != end)
+    {
+        /* the shortlisted mixtures of one state */
+        const std::size_t state = *g / mix_no;
+        std::size_t n = 0;
+        for (; g != end && *g / mix_no == state && n < mix_no; g++)
+        {
+            y[n++] = log_weighted_gaussian(*model_, *g, x);
+        }
+        const double b = log_sum_exp(y, n);
+        out[state] = (float)b;
+        best = std::max(best, b);
+    }
+
+    const float *floor = &floor_[v * state_count_];
+    for (std::size_t j = 0; j < state_count_; j++)
+    {
+        if (std::isnan(out[j]))
+        {
+            out[j] = (float)(best + (double)floor[j]);
+        }
+    }
+    return offset_[v + 1] - offset_[v];
+}
+
+
+void gaussian_selection::save(const std::string &filename) const
+{
+    std::vector<double> codebook(codebook_size_ * dim_);
+    for (std::size_t v = 0; v < codebook_size_; v++)
+    {
+        for (std::size_t d = 0; d < dim_; d++)
+        {
+            codebook[v * dim_ + d] = (double)codebook_[v * stride_ + d] / metric_[d];
+        }
+    }
+    write_mat_file(filename, {
+        make_mat_numeric("gs_codebook", {dim_, codebook_size_}, std::move(codebook)),
+        make_mat_numeric("gs_metric", {dim_, 1}, std::vector<double>(metric_.begin(), metric_.begin() + dim_)),
+        make_mat_numeric("gs_shortlist", {shortlist_.size(), 1},
+                         std::vector<double>(shortlist_.begin(), shortlist_.end())),
+        make_mat_numeric("gs_shortlist_offset", {offset_.size(), 1},
+                         std::vector<double>(offset_.begin(), offset_.end())),
+        make_mat_numeric("gs_floor", {state_count_, codebook_size_},
+                         std::vector<double>(floor_.begin(), floor_.end())),
+        make_mat_numeric("gs_shape", {1, 4},
+                         {(double)dim_, (double)model_->mix_no(), (double)model_->state_no(),
+                          (double)model_->model_no()}),
+    });
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
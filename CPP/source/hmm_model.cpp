@@ -0,0 +1,198 @@
+/******************************************************************************
+* File Name:   hmm_model.cpp
+*
+* Description: GMM-HMM word models, see hmm_model.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/hmm_model.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "hmm_gmm/mat_file.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+/* Size along dimension i; MATLAB drops trailing singleton dimensions */
+std::size_t dim_or_one(const mat_array &a, std::size_t i)
+{
+    return (i < a.dims.size()) ? a.dims[i] : 1;
+}
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: log_emission
+********************************************************************************
+* Summary:
+*  log sum_m c_m N(x; mean_m, var_m) with the max-subtraction of
+*  log_hmm_gmm() / log_mul_Gau(), evaluated in double precision.
+*
+*******************************************************************************/
+double hmm_model::log_emission(std::size_t state, const float *x) const
+{
+    const double log_2pi = std::log(2.0 * std::acos(-1.0));
+    double y[64];
+    std::vector<double> y_large;
+    double *ys = y;
+    if (mix_no > 64)
+    {
+        y_large.resize(mix_no);
+        ys = y_large.data();
+    }
+
+    double ymax = -std::numeric_limits<double>::infinity();
+    for (std::size_t m = 0; m < mix_no; m++)
+    {
+        const double *mu = mean_of(state, m);
+        const double *v = var_of(state, m);
+        double log_det = 0.0;
+        double mahalanobis = 0.0;
+        for (std::size_t d = 0; d < dim; d++)
+        {
+            const double diff = x[d] - mu[d];
+            log_det += std::log(v[d]);
+            mahalanobis += diff * diff / v[d];
+        }
+        ys[m] = -0.5 * (dim * log_2pi + log_det + mahalanobis) + std::log(weight[state * mix_no + m]);
+        if (ys[m] > ymax)
+        {
+            ymax = ys[m];
+        }
+    }
+    if (std::isinf(ymax))
+    {
+        return ymax;
+    }
+    double sum_exp = 0.0;
+    for (std::size_t m = 0; m < mix_no; m++)
+    {
+        sum_exp += std::exp(ys[m] - ymax);
+    }
+    return ymax + std::log(sum_exp);
+}
+
+
+/*******************************************************************************
+* Function Name: read_hmm_mat
+********************************************************************************
+* Summary:
+*  Reads the HMM struct and splits it into per-model blocks, transposing
+*  weight and Aij from MATLAB column-major to the row-major layout above.
+*
+* Parameters:
+*  filename: HMM_<iter>.mat
+*  var_name: name of the struct variable
+*
+* Return:
+*  hmm_set with one hmm_model per word
+*
+*******************************************************************************/
+hmm_set read_hmm_mat(const std::string &filename, const std::string &var_name)
+{
+    const mat_array hmm = read_mat_variable(filename, var_name);
+    const mat_array &mean = hmm.field("mean");
+    const mat_array &var = hmm.field("var");
+    const mat_array &weight = hmm.field("weight");
+    const mat_array &aij = hmm.field("Aij");
+    if (!mean.is_numeric() || !var.is_numeric() || !weight.is_numeric() || !aij.is_numeric())
+    {
+        throw std::runtime_error("non numeric HMM fields in " + filename);
+    }
+
+    const std::size_t dim = dim_or_one(mean, 0);
+    const std::size_t mix_no = dim_or_one(mean, 1);
+    const std::size_t state_no = dim_or_one(mean, 2);
+    const std::size_t model_no = dim_or_one(mean, 3);
+    const std::size_t node_no = state_no + 2;
+    if (var.dims != mean.dims || weight.numel() != state_no * mix_no * model_no ||
+        aij.numel() != node_no * node_no * model_no || dim_or_one(aij, 0) != node_no)
+    {
+        throw std::runtime_error("inconsistent HMM field sizes in " + filename);
+    }
+
+    hmm_set set;
+    set.models.resize(model_no);
+    const std::size_t block = dim * mix_no * state_no;
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        hmm_model &m = set.models[k];
+        m.dim = dim;
+        m.mix_no = mix_no;
+        m.state_no = state_no;
+        m.mean.assign(mean.real.begin() + k * block, mean.real.begin() + (k + 1) * block);
+        m.var.assign(var.real.begin() + k * block, var.real.begin() + (k + 1) * block);
+        m.weight.resize(state_no * mix_no);
+        for (std::size_t s = 0; s < state_no; s++)
+        {
+            for (std::size_t x = 0; x < mix_no; x++)
+            {
+                m.weight[s * mix_no + x] = weight.real[s + state_no * (x + mix_no * k)];
+            }
+        }
+        m.aij.resize(node_no * node_no);
+        for (std::size_t i = 0; i < node_no; i++)
+        {
+            for (std::size_t j = 0; j < node_no; j++)
+            {
+                m.aij[i * node_no + j] = aij.real[i + node_no * (j + node_no * k)];
+            }
+        }
+    }
+    return set;
+}
+
+
+void write_hmm_mat(const std::string &filename, const hmm_set &hmm, const std::string &var_name)
+{
+    const std::size_t dim = hmm.dim();
+    const std::size_t mix_no = hmm.mix_no();
+    const std::size_t state_no = hmm.state_no();
+    const std::size_t model_no = hmm.models.size();
+    const std::size_t node_no = state_no + 2;
+
+    std::vector<double> mean, var;
+    std::vector<double> weight(state_no * mix_no * model_no);
+    std::vector<double> aij(node_no * node_no * model_no);
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        const hmm_model &m = hmm.models[k];
+        mean.insert(mean.end(), m.mean.begin(), m.mean.end());
+        var.insert(var.end(), m.var.begin(), m.var.end());
+        for (std::size_t s = 0; s < state_no; s++)
+        {
+            for (std::size_t x = 0; x < mix_no; x++)
+            {
+                weight[s + state_no * (x + mix_no * k)] = m.weight[s * mix_no + x];
+            }
+        }
+        for (std::size_t i = 0; i < node_no; i++)
+        {
+            for (std::size_t j = 0; j < node_no; j++)
+            {
+                aij[i + node_no * (j + node_no * k)] = m.aij[i * node_no + j];
+            }
+        }
+    }
+
+    mat_array s;
+    s.name = var_name;
+    s.type = mat_class::structure;
+    s.dims = {1, 1};
+    s.field_names = {"mean", "var", "Aij", "weight"};
+    s.elements.push_back(make_mat_numeric("", {dim, mix_no, state_no, model_no}, std::move(mean)));
+    s.elements.push_back(make_mat_numeric("", {dim, mix_no, state_no, model_no}, std::move(var)));
+    s.elements.push_back(make_mat_numeric("", {node_no, node_no, model_no}, std::move(aij)));
+    s.elements.push_back(make_mat_numeric("", {state_no, mix_no, model_no}, std::move(weight)));
+    write_mat_file(filename, {s});
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,135 @@
+/******************************************************************************
+* File Name:   htk_file.cpp
+*
+* Description: HTK parameter file I/O, see htk_file.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/htk_file.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "hmm_gmm/byte_order.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr std::size_t HTK_HEADER_SIZE = 12;
+
+struct file_closer
+{
+    void operator()(std::FILE *f) const { std::fclose(f); }
+};
+using file_ptr = std::unique_ptr<std::FILE, file_closer>;
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: read_htk_file
+********************************************************************************
+* Summary:
+*  Reads an HTK parameter file the same way hmm_gmm_training.m does:
+*  dim = sampSize / 4 and nSamples frames of big-endian float32.
+*
+* Parameters:
+*  filename: path of the .mfc file
+*  header:   optional, receives the decoded header
+*
+* Return:
+*  feature_matrix with dim x nSamples values
+*
+*******************************************************************************/
+feature_matrix read_htk_file(const std::string &filename, htk_header *header)
+{
+    file_ptr f(std::fopen(filename.c_str(), "rb"));
+    if (!f)
+    {
+        throw std::runtime_error("cannot open HTK file " + filename);
+    }
+
+    unsigned char raw_header[HTK_HEADER_SIZE];
+    if (std::fread(raw_header, 1, HTK_HEADER_SIZE, f.get()) != HTK_HEADER_SIZE)
+    {
+        throw std::runtime_error("truncated HTK header in " + filename);
+    }
+
+    htk_header h;
+    h.n_samples = (int32_t)load_be32(raw_header);
+    h.samp_period = (int32_t)load_be32(raw_header + 4);
+    h.samp_size = (int16_t)load_be16(raw_header + 8);
+    h.parm_kind = (int16_t)load_be16(raw_header + 10);
+    if (h.n_samples < 0 || h.samp_size <= 0 || (h.samp_size % 4) != 0)
+    {
+        throw std::runtime_error("invalid HTK header in " + filename);
+    }
+
+    feature_matrix features((std::size_t)h.samp_size / 4, (std::size_t)h.n_samples);
+    std::vector<unsigned char> body((std::size_t)h.samp_size * (std::size_t)h.n_samples);
+    if (std::fread(body.data(), 1, body.size(), f.get()) != body.size())
+    {
+        throw std::runtime_error("truncated HTK data in " + filename);
+    }
+    for (std::size_t i = 0; i < features.data.size(); i++)
+    {
+        features.data[i] = load_be_float(&body[4 * i]);
+    }
+
+    if (header != nullptr)
+    {
+        *header = h;
+    }
+    return features;
+}
+
+
+/*******************************************************************************
+* Function Name: write_htk_file
+********************************************************************************
+* Summary:
+*  Writes the 'htk' output format of read_file_and_compute_mfcc(): big-endian
+*  header followed by big-endian float32 frames.
+*
+* Parameters:
+*  filename:    output path
+*  features:    feature sequence
+*  samp_period: frame shift in 100 ns units, round(frame_shift_sec*1E7)
+*  parm_kind:   HTK parameter kind code
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void write_htk_file(const std::string &filename, const feature_matrix &features,
+                    int32_t samp_period, int16_t parm_kind)
+{
+    file_ptr f(std::fopen(filename.c_str(), "wb"));
+    if (!f)
+    {
+        throw std::runtime_error("cannot create HTK file " + filename);
+    }
+
+    std::vector<unsigned char> buffer(HTK_HEADER_SIZE + 4 * features.data.size());
+    store_be32(&buffer[0], (uint32_t)features.frame_no);
+    store_be32(&buffer[4], (uint32_t)samp_period);
+    store_be16(&buffer[8], (uint16_t)(features.dim * 4));
+    store_be16(&buffer[10], (uint16_t)parm_kind);
+    for (std::size_t i = 0; i < features.data.size(); i++)
+    {
+        store_be_float(&buffer[HTK_HEADER_SIZE + 4 * i], features.data[i]);
+    }
+
+    if (std::fwrite(buffer.data(), 1, buffer.size(), f.get()) != buffer.size())
+    {
+        throw std::runtime_error("write failed for HTK file " + filename);
+    }
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,213 @@
+/******************************************************************************
+* File Name:   keyword_spotter.cpp
+*
+* Description: Frame-synchronous keyword spotter, see keyword_spotter.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/keyword_spotter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace hmm_gmm
+{
+
+keyword_spotter::keyword_spotter(const compiled_model &model, const spotter_config &config)
+    : model_(&model), config_(config), state_no_(model.state_no()), x_(model.stride(), 0.0f)
+{
+    if (config.filler >= model.model_no())
+    {
+        throw std::invalid_argument("filler model " + std::to_string(config.filler + 1) + " is not in the set of " +
+                                    std::to_string(model.model_no()) + " models");
+    }
+    if (model.model_no() < 2)
+    {
+        throw std::invalid_argument("keyword spotting needs a keyword model next to the filler");
+    }
+    for (std::size_t k = 0; k < model.model_no(); k++)
+    {
+        if (k != config.filler)
+        {
+            keywords_.push_back(k);
+        }
+    }
+    transitions_.resize(keywords_.size());
+    for (std::size_t w = 0; w < keywords_.size(); w++)
+    {
+        compiled_transitions(model, keywords_[w], transitions_[w]);
+    }
+    score_.resize(keywords_.size() * state_no_);
+    next_.resize(score_.size());
+    start_.resize(score_.size());
+    next_start_.resize(score_.size());
+    reset();
+}
+
+void keyword_spotter::reset()
+{
+    std::fill(score_.begin(), score_.end(), -std::numeric_limits<double>::infinity());
+    std::fill(start_.begin(), start_.end(), (std::size_t)0);
+    holding_ = false;
+    frame_no_ = 0;
+}
+
+/*******************************************************************************
+* Function Name: keyword_spotter::push
+********************************************************************************
+* Summary:
+*  One frame of the looped network. The background path of the previous
+*  frame has score 0, so a keyword START entered now scores log a_START,j.
+*  Inside a keyword the recursion is that of viterbi_search() over the
+*  predecessor lists, carrying the entry frame of the winning token; a state
+*  is scored only if one of its predecessors (or the entry) is alive and the
+*  token is at most max_frames old. Then
+*
+*    B(t)   = g(t) + filler_penalty
+*    E_k(t) = max_j f_k,j(t) + log a_j,END
+*
+*  and the best E_k(t) - B(t) above the threshold replaces the held
+*  detection if the two overlap and it scores higher. If it starts after the
+*  held detection, or the held end frame is hold_frames behind, the held
+*  detection is emitted. Finally every score is made relative to B(t).
+*
+* Parameters:
+*  frame: model dim() floats
+*  out:   receives the detection
+*
+* Return:
+*  Number of detections added
+*
+*******************************************************************************/
+std::size_t keyword_spotter::push(const float *frame, std::vector<keyword_detection> &out)
+{
+    const compiled_model &model = *model_;
+    model.prepare_frame(frame, x_.data());
+    return step([&](std::size_t k, std::size_t s) { return model.log_emission(k, s, x_.data()); }, out);
+}
+
+std::size_t keyword_spotter::push_emissions(const float *emissions, std::vector<keyword_detection> &out)
+{
+    const std::size_t n = state_no_;
+    return step([&](std::size_t k, std::size_t s) { return (double)emissions[k * n + s]; }, out);
+}
+
+template <typename Emission>
+std::size_t keyword_spotter::step(Emission emission, std::vector<keyword_detection> &out)
+{
+    const double neg_inf = -std::numeric_limits<double>::infinity();
+    const std::size_t n = state_no_;
+
+    double garbage = neg_inf;
+    for (std::size_t j = 0; j < n; j++)
+    {
+        garbage = std::max(garbage, emission(config_.filler, j));
+    }
+    const double background = garbage + config_.filler_penalty;
+    const double floor = background - config_.beam;
+    const std::size_t oldest = (config_.max_frames && frame_no_ + 1 >= config_.max_frames)
+                                   ? frame_no_ + 1 - config_.max_frames : 0;
+
+    keyword_detection best;
+    double best_end = neg_inf;
+    for (std::size_t w = 0; w < keywords_.size(); w++)
+    {
+        const sparse_transitions &s = transitions_[w];
+        const double *prev = &score_[w * n];
+        const std::size_t *prev_start = &start_[w * n];
+        double *cur = &next_[w * n];
+        std::size_t *cur_start = &next_start_[w * n];
+        for (std::size_t j = 0; j < n; j++)
+        {
+            double value = s.log_entry[j];
+            std::size_t start = frame_no_;
+            for (std::size_t p = s.first[j]; p < s.first[j + 1]; p++)
+            {
+                const double candidate = prev[s.pred[p]] + s.log_a[p];
+                if (candidate > value)
+                {
+                    value = candidate;
+                    start = prev_start[s.pred[p]];
+                }
+            }
+            if (value > neg_inf && start >= oldest)
+            {
+                value += emission(keywords_[w], j);
+                evaluations_++;
+                if (value < floor)
+                {
+                    value = neg_inf;
+                }
+            }
+            else
+            {
+                value = neg_inf;
+            }
+            cur[j] = value;
+            cur_start[j] = start;
+            if (value + s.log_exit[j] > best_end)
+            {
+                best_end = value + s.log_exit[j];
+                best.keyword = keywords_[w];
+                best.start_frame = start;
+            }
+        }
+    }
+
+    std::size_t detections = 0;
+    if (best_end > neg_inf && best_end - background > config_.threshold)
+    {
+        best.end_frame = frame_no_;
+        best.score = best_end - background;
+        if (holding_ && best.start_frame > held_.end_frame)
+        {
+            /* a later word: the held one cannot change any more */
+            detections += emit(out);
+        }
+        if (!holding_ || best.score > held_.score)
+        {
+            held_ = best;
+            holding_ = true;
+        }
+    }
+    if (holding_ && frame_no_ - held_.end_frame >= config_.hold_frames)
+    {
+        detections += emit(out);
+    }
+
+    if (background > neg_inf)
+    {
+        for (double &value : next_)
+        {
+            value -= background;
+        }
+    }
+    score_.swap(next_);
+    start_.swap(next_start_);
+    frame_no_++;
+    return detections;
+}
+
+std::size_t keyword_spotter::finish(std::vector<keyword_detection> &out)
+{
+    return holding_ ? emit(out) : 0;
+}
+
+std::size_t keyword_spotter::emit(std::vector<keyword_detection> &out)
+{
+    out.push_back(held_);
+    holding_ = false;
+    /* tokens that entered before the end of the keyword would spot it again */
+    for (std::size_t i = 0; i < next_.size(); i++)
+    {
+        if (next_start_[i] <= held_.end_frame)
+        {
+            next_[i] = -std::numeric_limits<double>::infinity();
+        }
+    }
+    return 1;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,167 @@
+/******************************************************************************
+* File Name:   linear_algebra.cpp
+*
+* Description: Dense symmetric matrix routines, see linear_algebra.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/linear_algebra.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr int JACOBI_MAX_SWEEPS = 100;
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: symmetric_eigen
+********************************************************************************
+* Summary:
+*  Cyclic Jacobi method: sweeps of plane rotations zeroing every off-diagonal
+*  element until the off-diagonal norm is negligible. Accurate to working
+*  precision for symmetric matrices and fast enough for n <= 100.
+*
+*******************************************************************************/
+void symmetric_eigen(const std::vector<double> &a_in, std::size_t n,
+                     std::vector<double> &eigenvalues, std::vector<double> &eigenvectors)
+{
+    std::vector<double> a = a_in;
+    std::vector<double> v(n * n, 0.0);      /* columns are the eigenvectors */
+    for (std::size_t i = 0; i < n; i++)
+    {
+        v[i * n + i] = 1.0;
+    }
+
+    double scale = 0.0;
+    for (double x : a)
+    {
+        scale += x * x;
+    }
+    for (int sweep = 0; sweep < JACOBI_MAX_SWEEPS; sweep++)
+    {
+        double off = 0.0;
+        for (std::size_t p = 0; p < n; p++)
+        {
+            for (std::size_t q = p + 1; q < n; q++)
+            {
+                off += a[p * n + q] * a[p * n + q];
+            }
+        }
+        if (off <= 1e-30 * scale)
+        {
+            break;
+        }
+        for (std::size_t p = 0; p < n; p++)
+        {
+            for (std::size_t q = p + 1; q < n; q++)
+            {
+                const double apq = a[p * n + q];
+                if (apq == 0.0)
+                {
+                    continue;
+                }
+                const double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+                const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+                for (std::size_t k = 0; k < n; k++)
+                {
+                    const double akp = a[k * n + p];
+                    const double akq = a[k * n + q];
+                    a[k * n + p] = c * akp - s * akq;
+                    a[k * n + q] = s * akp + c * akq;
+                }
+                for (std::size_t k = 0; k < n; k++)
+                {
+                    const double apk = a[p * n + k];
+                    const double aqk = a[q * n + k];
+                    a[p * n + k] = c * apk - s * aqk;
+                    a[q * n + k] = s * apk + c * aqk;
+                }
+                for (std::size_t k = 0; k < n; k++)
+                {
+                    const double vkp = v[k * n + p];
+                    const double vkq = v[k * n + q];
+                    v[k * n + p] = c * vkp - s * vkq;
+                    v[k * n + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t x, std::size_t y) { return a[x * n + x] > a[y * n + y]; });
+    eigenvalues.resize(n);
+    eigenvectors.resize(n * n);
+    for (std::size_t k = 0; k < n; k++)
+    {
+        eigenvalues[k] = a[order[k] * n + order[k]];
+        for (std::size_t i = 0; i < n; i++)
+        {
+            eigenvectors[k * n + i] = v[i * n + order[k]];
+        }
+    }
+}
+
+
+std::vector<double> cholesky(const std::vector<double> &a, std::size_t n)
+{
+    std::vector<double> l(n * n, 0.0);
+    for (std::size_t j = 0; j < n; j++)
+    {
+        double d = a[j * n + j];
+        for (std::size_t k = 0; k < j; k++)
+        {
+            d -= l[j * n + k] * l[j * n + k];
+        }
+        if (!(d > 0.0))
+        {
+            throw std::runtime_error("matrix is not positive definite");
+        }
+        l[j * n + j] = std::sqrt(d);
+        for (std::size_t i = j + 1; i < n; i++)
+        {
+            double s = a[i * n + j];
+            for (std::size_t k = 0; k < j; k++)
+            {
+                s -= l[i * n + k] * l[j * n + k];
+            }
+            l[i * n + j] = s / l[j * n + j];
+        }
+    }
+    return l;
+}
+
+
+std::vector<double> invert_lower(const std::vector<double> &l, std::size_t n)
+{
+    std::vector<double> inv(n * n, 0.0);
+    for (std::size_t j = 0; j < n; j++)
+    {
+        inv[j * n + j] = 1.0 / l[j * n + j];
+        for (std::size_t i = j + 1; i < n; i++)
+        {
+            double s = 0.0;
+            for (std::size_t k = j; k < i; k++)
+            {
+                s -= l[i * n + k] * inv[k * n + j];
+            }
+            inv[i * n + j] = s / l[i * n + i];
+        }
+    }
+    return inv;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
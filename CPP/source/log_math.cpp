@@ -0,0 +1,389 @@
+/******************************************************************************
+* File Name:   log_math.cpp
+*
+* Description: Log-domain addition in three accuracy tiers, see
+*              log_math.hpp. Tier dispatch, the exact and table tiers and
+*              the portable polynomial kernels.
+*
+*******************************************************************************/
+#include "hmm_gmm/log_math.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "log_math_kernels.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr float NEG_INF = -std::numeric_limits<float>::infinity();
+
+/* groups are processed in chunks so the scratch buffers stay on the stack and in L1 */
+constexpr std::size_t CHUNK = 256;
+
+/* log(1 + exp(-d)) for d = k / TABLE_STEPS, k = 0..TABLE_SIZE; 0 for d >= TABLE_RANGE */
+constexpr int TABLE_STEPS = 64;
+constexpr float TABLE_RANGE = 16.0f;
+constexpr int TABLE_SIZE = (int)(TABLE_RANGE * TABLE_STEPS);
+
+struct log_add_table
+{
+    float value[TABLE_SIZE + 1];
+
+    log_add_table()
+    {
+        for (int k = 0; k <= TABLE_SIZE; k++)
+        {
+            value[k] = (float)std::log1p(std::exp(-(double)k / TABLE_STEPS));
+        }
+    }
+};
+
+const log_add_table &table()
+{
+    static const log_add_table instance;
+    return instance;
+}
+
+float as_float(uint32_t bits)
+{
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+uint32_t as_bits(float v)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+/* max + log(1 + exp(min - max)) with linear interpolation in the table */
+float table_log_add(float a, float b)
+{
+    const float m = std::max(a, b);
+    if (m == NEG_INF)
+    {
+        return NEG_INF;
+    }
+    const float d = m - std::min(a, b);
+    if (!(d < TABLE_RANGE))
+    {
+        return m;
+    }
+    const float position = d * TABLE_STEPS;
+    const int k = (int)position;
+    const float frac = position - (float)k;
+    const float *v = table().value;
+    return m + (v[k] + frac * (v[k + 1] - v[k]));
+}
+
+void exp_polynomial(const float *x, float *y, std::size_t n, simd_isa isa)
+{
+    switch (isa)
+    {
+#if defined(HMM_GMM_HAVE_AVX512)
+    case simd_isa::avx512: kernels::exp_polynomial_avx512(x, y, n); break;
+#endif
+#if defined(HMM_GMM_HAVE_AVX2)
+    case simd_isa::avx2:   kernels::exp_polynomial_avx2(x, y, n); break;
+#endif
+    default:               kernels::exp_polynomial_scalar(x, y, n); break;
+    }
+}
+
+void log_polynomial(const float *x, float *y, std::size_t n, simd_isa isa)
+{
+    switch (isa)
+    {
+#if defined(HMM_GMM_HAVE_AVX512)
+    case simd_isa::avx512: kernels::log_polynomial_avx512(x, y, n); break;
+#endif
+#if defined(HMM_GMM_HAVE_AVX2)
+    case simd_isa::avx2:   kernels::log_polynomial_avx2(x, y, n); break;
+#endif
+    default:               kernels::log_polynomial_scalar(x, y, n); break;
+    }
+}
+
+} /* namespace */
+
+
+namespace kernels
+{
+
+void exp_polynomial_scalar(const float *x, float *y, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const float v = std::min(std::max(x[i], EXP_LO), EXP_HI);
+        const float fn = std::floor(v * LOG2E + 0.5f);
+        const float r = (v - fn * LN2_HI) - fn * LN2_LO;
+        const float p = ((((EXP_P0 * r + EXP_P1) * r + EXP_P2) * r + EXP_P3) * r + EXP_P4) * r + EXP_P5;
+        const float e = (p * (r * r) + r) + 1.0f;
+        y[i] = e * as_float((uint32_t)((int32_t)fn + 127) << 23);
+    }
+}
+
+
+void log_polynomial_scalar(const float *x, float *y, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const uint32_t bits = as_bits(x[i]);
+        float e = (float)((int32_t)((bits >> 23) & 0xffu) - 126);
+        float m = as_float((bits & 0x807fffffu) | 0x3f000000u);   /* [0.5, 1) */
+        if (m < SQRT_HALF)
+        {
+            e -= 1.0f;
+            m = (m + m) - 1.0f;
+        }
+        else
+        {
+            m = m - 1.0f;
+        }
+        const float z = m * m;
+        float p = LOG_P0;
+        p = p * m + LOG_P1;
+        p = p * m + LOG_P2;
+        p = p * m + LOG_P3;
+        p = p * m + LOG_P4;
+        p = p * m + LOG_P5;
+        p = p * m + LOG_P6;
+        p = p * m + LOG_P7;
+        p = p * m + LOG_P8;
+        const float r = (p * m * z + e * LN2_LO) - 0.5f * z;
+        y[i] = (m + r) + e * LN2_HI;
+    }
+}
+
+} /* namespace kernels */
+
+
+const char *log_add_tier_name(log_add_tier tier)
+{
+    switch (tier)
+    {
+    case log_add_tier::polynomial:  return "polynomial";
+    case log_add_tier::table:       return "table";
+    default:                        return "exact";
+    }
+}
+
+
+double log_add_error_bound(log_add_tier tier, std::size_t terms, double r)
+{
+    const double magnitude = std::isfinite(r) ? std::fabs(r) : 0.0;
+    switch (tier)
+    {
+    case log_add_tier::polynomial:
+        return 1e-6 + std::ldexp(magnitude, -22);
+    case log_add_tier::table:
+        return 8e-6 * (double)(terms > 1 ? terms - 1 : 0) + std::ldexp(magnitude, -22);
+    default:
+        return std::ldexp(magnitude, -24) + std::numeric_limits<float>::denorm_min();
+    }
+}
+
+
+float log_add(log_add_tier tier, float a, float b)
+{
+    float out;
+    log_add(tier, &a, &b, &out, 1, simd_isa::scalar);
+    return out;
+}
+
+
+/*******************************************************************************
+* Function Name: log_add
+********************************************************************************
+* Summary:
+*  out = max + log(1 + exp(min - max)). The polynomial tier evaluates the
+*  exp and the log over whole chunks with the SIMD kernels; lanes whose
+*  maximum is -Inf are patched afterwards.
+*
+* Parameters:
+*  tier:   accuracy tier
+*  a, b:   n values each
+*  out:    n results, may alias a or b
+*  n:      number of pairs
+*  isa:    kernel of the polynomial tier
+*
+*******************************************************************************/
+void log_add(log_add_tier tier, const float *a, const float *b, float *out, std::size_t n, simd_isa isa)
+{
+    if (tier == log_add_tier::exact)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double m = std::max(a[i], b[i]);
+            out[i] = (m == NEG_INF) ? NEG_INF
+                                    : (float)(m + std::log1p(std::exp((double)std::min(a[i], b[i]) - m)));
+        }
+        return;
+    }
+    if (tier == log_add_tier::table)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            out[i] = table_log_add(a[i], b[i]);
+        }
+        return;
+    }
+
+    float m[CHUNK], d[CHUNK];
+    for (std::size_t i0 = 0; i0 < n; i0 += CHUNK)
+    {
+        const std::size_t count = std::min(CHUNK, n - i0);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const float x = a[i0 + i], y = b[i0 + i];
+            m[i] = std::max(x, y);
+            d[i] = (m[i] == NEG_INF) ? NEG_INF : std::min(x, y) - m[i];
+        }
+        exp_polynomial(d, d, count, isa);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            d[i] += 1.0f;
+        }
+        log_polynomial(d, d, count, isa);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            out[i0 + i] = (m[i] == NEG_INF) ? NEG_INF : m[i] + d[i];
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: log_sum_exp_groups
+********************************************************************************
+* Summary:
+*  exact:      max scan, sum of exp(y - max) and log in double
+*  polynomial: max scan per group, then one exp kernel call over all the
+*              differences of a chunk of groups and one log kernel call over
+*              the sums, so both transcendentals run on full SIMD registers
+*  table:      pairwise fold with the LAdd table, like HTK, but relative to
+*              the maximum term
+*
+* Parameters:
+*  tier:     accuracy tier
+*  in:       group_no * group values
+*  group:    terms per sum
+*  group_no: number of sums
+*  out:      group_no results
+*  isa:      kernel of the polynomial tier
+*
+*******************************************************************************/
+void log_sum_exp_groups(log_add_tier tier, const float *in, std::size_t group, std::size_t group_no, float *out,
+                        simd_isa isa)
+{
+    if (group == 1)
+    {
+        std::copy(in, in + group_no, out);
+        return;
+    }
+    if (group == 0)
+    {
+        std::fill(out, out + group_no, NEG_INF);
+        return;
+    }
+
+    if (tier == log_add_tier::table)
+    {
+        for (std::size_t g = 0; g < group_no; g++)
+        {
+            /* folded relative to the maximum so the partial sums stay small and round finely */
+            const float *y = in + g * group;
+            const std::size_t imax = (std::size_t)(std::max_element(y, y + group) - y);
+            if (y[imax] == NEG_INF)
+            {
+                out[g] = NEG_INF;
+                continue;
+            }
+            float acc = 0.0f;
+            for (std::size_t m = 0; m < group; m++)
+            {
+                if (m != imax)
+                {
+                    acc = table_log_add(acc, y[m] - y[imax]);
+                }
+            }
+            out[g] = y[imax] + acc;
+        }
+        return;
+    }
+
+    if (tier == log_add_tier::exact)
+    {
+        for (std::size_t g = 0; g < group_no; g++)
+        {
+            const float *y = in + g * group;
+            const float ymax = *std::max_element(y, y + group);
+            if (ymax == NEG_INF)
+            {
+                out[g] = NEG_INF;
+                continue;
+            }
+            double sum_exp = 0.0;
+            for (std::size_t m = 0; m < group; m++)
+            {
+                sum_exp += std::exp((double)y[m] - ymax);
+            }
+            out[g] = (float)(ymax + std::log(sum_exp));
+        }
+        return;
+    }
+
+    const std::size_t groups_per_chunk = std::max<std::size_t>(1, CHUNK / group);
+    std::vector<float> large;
+    float small[CHUNK];
+    float *d = small;
+    if (group > CHUNK)
+    {
+        large.resize(group);
+        d = large.data();
+    }
+    float ymax[CHUNK], sum[CHUNK];
+    for (std::size_t g0 = 0; g0 < group_no; g0 += groups_per_chunk)
+    {
+        const std::size_t count = std::min(groups_per_chunk, group_no - g0);
+        const float *y = in + g0 * group;
+        for (std::size_t g = 0; g < count; g++)
+        {
+            ymax[g] = *std::max_element(y + g * group, y + (g + 1) * group);
+            const float offset = (ymax[g] == NEG_INF) ? 0.0f : ymax[g];
+            for (std::size_t m = 0; m < group; m++)
+            {
+                d[g * group + m] = y[g * group + m] - offset;
+            }
+        }
+        exp_polynomial(d, d, count * group, isa);
+        for (std::size_t g = 0; g < count; g++)
+        {
+            float s = 0.0f;
+            for (std::size_t m = 0; m < group; m++)
+            {
+                s += d[g * group + m];
+            }
+            sum[g] = s;
+        }
+        log_polynomial(sum, sum, count, isa);
+        for (std::size_t g = 0; g < count; g++)
+        {
+            out[g0 + g] = (ymax[g] == NEG_INF) ? NEG_INF : ymax[g] + sum[g];
+        }
+    }
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
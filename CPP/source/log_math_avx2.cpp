@@ -0,0 +1,98 @@
+/******************************************************************************
+* File Name:   log_math_avx2.cpp
+*
+* Description: AVX2 + FMA polynomial exp / log kernels of log_math, built with
+*              -mavx2 -mfma and only called after a CPU check. Same
+*              polynomials as the scalar kernels, evaluated with FMA.
+*
+*******************************************************************************/
+#include "log_math_kernels.hpp"
+
+#include <immintrin.h>
+
+namespace hmm_gmm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr std::size_t WIDTH = 8;
+
+__m256 exp_vector(__m256 x)
+{
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(EXP_LO)), _mm256_set1_ps(EXP_HI));
+    const __m256 fn = _mm256_floor_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(LOG2E), _mm256_set1_ps(0.5f)));
+    __m256 r = _mm256_fnmadd_ps(fn, _mm256_set1_ps(LN2_HI), x);
+    r = _mm256_fnmadd_ps(fn, _mm256_set1_ps(LN2_LO), r);
+    __m256 p = _mm256_set1_ps(EXP_P0);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P1));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P2));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P3));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P4));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P5));
+    const __m256 e = _mm256_add_ps(_mm256_fmadd_ps(p, _mm256_mul_ps(r, r), r), _mm256_set1_ps(1.0f));
+    const __m256i n = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(fn), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(e, _mm256_castsi256_ps(n));
+}
+
+__m256 log_vector(__m256 x)
+{
+    const __m256i bits = _mm256_castps_si256(x);
+    __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                  _mm256_set1_epi32(0x3f000000)));
+    /* m < sqrt(1/2): e -= 1, m = 2m - 1; otherwise m = m - 1 */
+    const __m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(SQRT_HALF), _CMP_LT_OQ);
+    e = _mm256_sub_ps(e, _mm256_and_ps(small, _mm256_set1_ps(1.0f)));
+    m = _mm256_sub_ps(_mm256_add_ps(m, _mm256_and_ps(small, m)), _mm256_set1_ps(1.0f));
+    const __m256 z = _mm256_mul_ps(m, m);
+    __m256 p = _mm256_set1_ps(LOG_P0);
+    p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(LOG_P1));
+    p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(LOG_P2));
+    p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(LOG_P3));
+    p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(LOG_P4));
+    p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(LOG_P5));
+    p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(LOG_P6));
+    p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(LOG_P7));
+    p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(LOG_P8));
+    __m256 r = _mm256_fmadd_ps(_mm256_mul_ps(p, m), z, _mm256_mul_ps(e, _mm256_set1_ps(LN2_LO)));
+    r = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, r);
+    return _mm256_fmadd_ps(e, _mm256_set1_ps(LN2_HI), _mm256_add_ps(m, r));
+}
+
+} /* namespace */
+
+
+void exp_polynomial_avx2(const float *x, float *y, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH)
+    {
+        _mm256_storeu_ps(y + i, exp_vector(_mm256_loadu_ps(x + i)));
+    }
+    if (i < n)
+    {
+        exp_polynomial_scalar(x + i, y + i, n - i);
+    }
+}
+
+
+void log_polynomial_avx2(const float *x, float *y, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH)
+    {
+        _mm256_storeu_ps(y + i, log_vector(_mm256_loadu_ps(x + i)));
+    }
+    if (i < n)
+    {
+        log_polynomial_scalar(x + i, y + i, n - i);
+    }
+}
+
+} /* namespace kernels */
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
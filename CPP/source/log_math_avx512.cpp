@@ -0,0 +1,98 @@
+/******************************************************************************
+* File Name:   log_math_avx512.cpp
+*
+* Description: AVX-512F polynomial exp / log kernels of log_math, built with
+*              -mavx512f and only called after a CPU check. Same
+*              polynomials as the scalar kernels, evaluated with FMA.
+*
+*******************************************************************************/
+#include "log_math_kernels.hpp"
+
+#include <immintrin.h>
+
+namespace hmm_gmm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr std::size_t WIDTH = 16;
+
+__m512 exp_vector(__m512 x)
+{
+    x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(EXP_LO)), _mm512_set1_ps(EXP_HI));
+    const __m512 fn = _mm512_roundscale_ps(_mm512_fmadd_ps(x, _mm512_set1_ps(LOG2E), _mm512_set1_ps(0.5f)), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    __m512 r = _mm512_fnmadd_ps(fn, _mm512_set1_ps(LN2_HI), x);
+    r = _mm512_fnmadd_ps(fn, _mm512_set1_ps(LN2_LO), r);
+    __m512 p = _mm512_set1_ps(EXP_P0);
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXP_P1));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXP_P2));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXP_P3));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXP_P4));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXP_P5));
+    const __m512 e = _mm512_add_ps(_mm512_fmadd_ps(p, _mm512_mul_ps(r, r), r), _mm512_set1_ps(1.0f));
+    const __m512i n = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(fn), _mm512_set1_epi32(127)), 23);
+    return _mm512_mul_ps(e, _mm512_castsi512_ps(n));
+}
+
+__m512 log_vector(__m512 x)
+{
+    const __m512i bits = _mm512_castps_si512(x);
+    __m512 e = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(126)));
+    __m512 m = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)),
+                                                  _mm512_set1_epi32(0x3f000000)));
+    /* m < sqrt(1/2): e -= 1, m = 2m - 1; otherwise m = m - 1 */
+    const __mmask16 small = _mm512_cmp_ps_mask(m, _mm512_set1_ps(SQRT_HALF), _CMP_LT_OQ);
+    e = _mm512_mask_sub_ps(e, small, e, _mm512_set1_ps(1.0f));
+    m = _mm512_sub_ps(_mm512_mask_add_ps(m, small, m, m), _mm512_set1_ps(1.0f));
+    const __m512 z = _mm512_mul_ps(m, m);
+    __m512 p = _mm512_set1_ps(LOG_P0);
+    p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(LOG_P1));
+    p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(LOG_P2));
+    p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(LOG_P3));
+    p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(LOG_P4));
+    p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(LOG_P5));
+    p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(LOG_P6));
+    p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(LOG_P7));
+    p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(LOG_P8));
+    __m512 r = _mm512_fmadd_ps(_mm512_mul_ps(p, m), z, _mm512_mul_ps(e, _mm512_set1_ps(LN2_LO)));
+    r = _mm512_fnmadd_ps(_mm512_set1_ps(0.5f), z, r);
+    return _mm512_fmadd_ps(e, _mm512_set1_ps(LN2_HI), _mm512_add_ps(m, r));
+}
+
+} /* namespace */
+
+
+void exp_polynomial_avx512(const float *x, float *y, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH)
+    {
+        _mm512_storeu_ps(y + i, exp_vector(_mm512_loadu_ps(x + i)));
+    }
+    if (i < n)
+    {
+        exp_polynomial_scalar(x + i, y + i, n - i);
+    }
+}
+
+
+void log_polynomial_avx512(const float *x, float *y, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH)
+    {
+        _mm512_storeu_ps(y + i, log_vector(_mm512_loadu_ps(x + i)));
+    }
+    if (i < n)
+    {
+        log_polynomial_scalar(x + i, y + i, n - i);
+    }
+}
+
+} /* namespace kernels */
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
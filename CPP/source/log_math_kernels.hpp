@@ -0,0 +1,69 @@
+/******************************************************************************
+* File Name:   log_math_kernels.hpp
+*
+* Description: Polynomial exp / log kernels of log_math, one translation unit
+*              per instruction set:
+*
+*              exp: x = n ln2 + r, |r| <= ln2/2, exp(r) from a degree 7
+*                   polynomial, 2^n from the exponent bits. x is clamped to
+*                   [-87.3, 88]: -Inf gives 2^-126, a negligible term of
+*                   a sum that always contains exp(0) = 1.
+*              log: x = m 2^e, m in [sqrt(1/2), sqrt(2)), log(m) from a
+*                   degree 10 polynomial in m - 1. x must be a positive
+*                   normal float.
+*
+*              Relative error of exp and absolute error of log below 2e-7.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_LOG_MATH_KERNELS_HPP)
+#define HMM_GMM_LOG_MATH_KERNELS_HPP
+
+#include <cstddef>
+
+namespace hmm_gmm
+{
+namespace kernels
+{
+
+/* Cephes expf / logf coefficients, shared so every kernel computes the same polynomials */
+constexpr float EXP_HI = 88.0f;
+constexpr float EXP_LO = -87.3365478515625f;
+constexpr float LOG2E = 1.44269504088896341f;
+constexpr float LN2_HI = 0.693359375f;
+constexpr float LN2_LO = -2.12194440e-4f;
+constexpr float EXP_P0 = 1.9875691500e-4f;
+constexpr float EXP_P1 = 1.3981999507e-3f;
+constexpr float EXP_P2 = 8.3334519073e-3f;
+constexpr float EXP_P3 = 4.1665795894e-2f;
+constexpr float EXP_P4 = 1.6666665459e-1f;
+constexpr float EXP_P5 = 5.0000001201e-1f;
+constexpr float SQRT_HALF = 0.707106781186547524f;
+constexpr float LOG_P0 = 7.0376836292e-2f;
+constexpr float LOG_P1 = -1.1514610310e-1f;
+constexpr float LOG_P2 = 1.1676998740e-1f;
+constexpr float LOG_P3 = -1.2420140846e-1f;
+constexpr float LOG_P4 = 1.4249322787e-1f;
+constexpr float LOG_P5 = -1.6668057665e-1f;
+constexpr float LOG_P6 = 2.0000714765e-1f;
+constexpr float LOG_P7 = -2.4999993993e-1f;
+constexpr float LOG_P8 = 3.3333331174e-1f;
+
+/* y[i] = exp(x[i]), y[i] = log(x[i]); y may alias x */
+void exp_polynomial_scalar(const float *x, float *y, std::size_t n);
+void log_polynomial_scalar(const float *x, float *y, std::size_t n);
+
+#if defined(HMM_GMM_HAVE_AVX2)
+void exp_polynomial_avx2(const float *x, float *y, std::size_t n);
+void log_polynomial_avx2(const float *x, float *y, std::size_t n);
+#endif
+
+#if defined(HMM_GMM_HAVE_AVX512)
+void exp_polynomial_avx512(const float *x, float *y, std::size_t n);
+void log_polynomial_avx512(const float *x, float *y, std::size_t n);
+#endif
+
+} /* namespace kernels */
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_LOG_MATH_KERNELS_HPP */
+/* [] END OF FILE */
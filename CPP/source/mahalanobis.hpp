@@ -0,0 +1,57 @@
+/******************************************************************************
+* File Name:   mahalanobis.hpp
+*
+* Description: The 8-lane Gaussian distance kernel shared by every scorer
+*              that reads the padded layout of compiled_model
+*              (compiled_model, gaussian_selection, tied_mixture_model and
+*              specialized_decoder). Lane l accumulates the dimensions
+*              d = l (mod 8) and the lanes are added in one fixed tree, so
+*              the compiler maps the loop to packed multiply-adds and every
+*              caller gets the same float sum for the same Gaussian. The
+*              "bit-identical" checks of the decoders rely on there being
+*              only this one copy.
+*
+*******************************************************************************/
+#if !defined(HMM_GMM_MAHALANOBIS_HPP)
+#define HMM_GMM_MAHALANOBIS_HPP
+
+#include <cstddef>
+
+namespace hmm_gmm
+{
+namespace kernels
+{
+
+/* sum_i term(i) over i < lanes (a multiple of 8) in 8 float lanes */
+template <typename Term>
+inline float lane_sum8(std::size_t lanes, Term term)
+{
+    float acc[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (std::size_t d = 0; d < lanes; d += 8)
+    {
+        for (std::size_t l = 0; l < 8; l++)
+        {
+            acc[l] += term(d + l);
+        }
+    }
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+/*
+ * sum_d (x_d - mu_d)^2 ivar_d of one Gaussian. lanes is the padded stride,
+ * or any multiple of 8 that covers the dimensions since the padding only
+ * adds zeros.
+ */
+inline float mahalanobis_float32(const float *x, const float *mu, const float *iv, std::size_t lanes)
+{
+    return lane_sum8(lanes, [=](std::size_t i) {
+        const float diff = x[i] - mu[i];
+        return diff * diff * iv[i];
+    });
+}
+
+} /* namespace kernels */
+} /* namespace hmm_gmm */
+
+#endif /* HMM_GMM_MAHALANOBIS_HPP */
+/* [] END OF FILE */
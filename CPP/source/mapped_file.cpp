@@ -0,0 +1,144 @@
+/******************************************************************************
+* File Name:   mapped_file.cpp
+*
+* Description: Read-only file mapping, see mapped_file.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/mapped_file.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HMM_GMM_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define HMM_GMM_HAVE_MMAP 0
+#endif
+
+namespace hmm_gmm
+{
+
+#if !HMM_GMM_HAVE_MMAP
+namespace
+{
+
+/* alignment of the fallback buffer, at least the 64-byte alignment of the containers */
+constexpr std::size_t BUFFER_ALIGNMENT = 4096;
+
+} /* namespace */
+#endif
+
+
+mapped_file::mapped_file(const std::string &filename)
+    : filename_(filename)
+{
+#if HMM_GMM_HAVE_MMAP
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot open " + filename);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("cannot stat " + filename);
+    }
+    size_ = (std::size_t)st.st_size;
+    if (size_ > 0)
+    {
+        void *p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("cannot map " + filename);
+        }
+        data_ = static_cast<const unsigned char *>(p);
+        mapped_ = true;
+    }
+    ::close(fd);
+#else
+    std::FILE *f = std::fopen(filename.c_str(), "rb");
+    if (!f)
+    {
+        throw std::runtime_error("cannot open " + filename);
+    }
+    std::fseek(f, 0, SEEK_END);
+    const long length = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (length > 0)
+    {
+        size_ = (std::size_t)length;
+        const std::size_t padded = (size_ + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT;
+        unsigned char *buffer = static_cast<unsigned char *>(std::aligned_alloc(BUFFER_ALIGNMENT, padded));
+        if (!buffer || std::fread(buffer, 1, size_, f) != size_)
+        {
+            std::free(buffer);
+            std::fclose(f);
+            throw std::runtime_error("cannot read " + filename);
+        }
+        data_ = buffer;
+    }
+    std::fclose(f);
+#endif
+}
+
+
+mapped_file::~mapped_file()
+{
+    release();
+}
+
+
+mapped_file::mapped_file(mapped_file &&other) noexcept
+    : filename_(std::move(other.filename_)), data_(other.data_), size_(other.size_), mapped_(other.mapped_)
+{
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+
+mapped_file &mapped_file::operator=(mapped_file &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        filename_ = std::move(other.filename_);
+        data_ = other.data_;
+        size_ = other.size_;
+        mapped_ = other.mapped_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+
+void mapped_file::release()
+{
+    if (data_)
+    {
+#if HMM_GMM_HAVE_MMAP
+        if (mapped_)
+        {
+            ::munmap(const_cast<unsigned char *>(data_), size_);
+        }
+        else
+#endif
+        {
+            std::free(const_cast<unsigned char *>(data_));
+        }
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
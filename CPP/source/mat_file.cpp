@@ -0,0 +1,658 @@
+/******************************************************************************
+* File Name:   mat_file.cpp
+*
+* Description: MAT-file Level 5 reader, see mat_file.hpp. Layout reference:
+*              "MATLAB 7 MAT-File Format" (MathWorks), section 1.
+*
+*******************************************************************************/
+#include "hmm_gmm/mat_file.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "hmm_gmm/byte_order.hpp"
+#include "hmm_gmm/mapped_file.hpp"
+
+#if defined(HMM_GMM_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr std::size_t MAT_HEADER_SIZE = 128;
+
+/* data types of data element tags */
+enum mat_data_type : uint32_t
+{
+    MI_INT8 = 1,
+    MI_UINT8 = 2,
+    MI_INT16 = 3,
+    MI_UINT16 = 4,
+    MI_INT32 = 5,
+    MI_UINT32 = 6,
+    MI_SINGLE = 7,
+    MI_DOUBLE = 9,
+    MI_INT64 = 12,
+    MI_UINT64 = 13,
+    MI_MATRIX = 14,
+    MI_COMPRESSED = 15,
+    MI_UTF8 = 16,
+    MI_UTF16 = 17,
+    MI_UTF32 = 18,
+};
+
+constexpr uint32_t ARRAY_FLAG_COMPLEX = 0x0800;
+constexpr uint32_t ARRAY_FLAG_LOGICAL = 0x0200;
+
+struct data_element
+{
+    uint32_t type;
+    const unsigned char *data;
+    std::size_t size;
+};
+
+/* Sequential reader of data elements in a byte range of either byte order */
+class element_reader
+{
+public:
+    element_reader(const unsigned char *begin, std::size_t size, bool big_endian, const std::string &filename)
+        : p_(begin), end_(begin + size), big_endian_(big_endian), filename_(filename)
+    {
+    }
+
+    bool at_end() const { return p_ + 8 > end_; }
+
+    uint32_t load32(const unsigned char *p) const { return big_endian_ ? load_be32(p) : load_le32(p); }
+    uint16_t load16(const unsigned char *p) const { return big_endian_ ? load_be16(p) : load_le16(p); }
+
+    data_element next()
+    {
+        if (at_end())
+        {
+            fail("truncated data element");
+        }
+        data_element e;
+        const uint32_t first = load32(p_);
+        if ((first >> 16) != 0)
+        {
+            /* small data element: type and size share the first word, data in the second */
+            e.type = first & 0xffff;
+            e.size = first >> 16;
+            e.data = p_ + 4;
+            if (e.size > 4)
+            {
+                fail("invalid small data element");
+            }
+            p_ += 8;
+            return e;
+        }
+        e.type = first;
+        e.size = load32(p_ + 4);
+        e.data = p_ + 8;
+        if (e.size > (std::size_t)(end_ - e.data))
+        {
+            fail("data element exceeds file size");
+        }
+        /* compressed elements are not padded to 8 bytes */
+        const std::size_t padded = (e.type == MI_COMPRESSED) ? e.size : (e.size + 7) / 8 * 8;
+        p_ = e.data + std::min(padded, (std::size_t)(end_ - e.data));
+        return e;
+    }
+
+    [[noreturn]] void fail(const std::string &what) const
+    {
+        throw std::runtime_error(what + " in MAT-file " + filename_);
+    }
+
+    bool big_endian() const { return big_endian_; }
+    const std::string &filename() const { return filename_; }
+
+private:
+    const unsigned char *p_;
+    const unsigned char *end_;
+    bool big_endian_;
+    const std::string &filename_;
+};
+
+std::size_t element_width(uint32_t type)
+{
+    switch (type)
+    {
+    case MI_INT8: case MI_UINT8: case MI_UTF8: return 1;
+    case MI_INT16: case MI_UINT16: case MI_UTF16: return 2;
+    case MI_INT32: case MI_UINT32: case MI_SINGLE: case MI_UTF32: return 4;
+    case MI_DOUBLE: case MI_INT64: case MI_UINT64: return 8;
+    default: return 0;
+    }
+}
+
+/* Numeric data of any storage type as double; MATLAB stores doubles in the smallest integer type that fits */
+std::vector<double> decode_numeric(const element_reader &r, const data_element &e)
+{
+    const std::size_t width = element_width(e.type);
+    if (width == 0)
+    {
+        r.fail("unsupported numeric data type " + std::to_string(e.type));
+    }
+    const std::size_t n = e.size / width;
+    std::vector<double> out(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const unsigned char *p = e.data + i * width;
+        uint64_t bits = 0;
+        if (width == 1)
+        {
+            bits = p[0];
+        }
+        else if (width == 2)
+        {
+            bits = r.load16(p);
+        }
+        else if (width == 4)
+        {
+            bits = r.load32(p);
+        }
+        else
+        {
+            const uint64_t a = r.load32(p);
+            const uint64_t b = r.load32(p + 4);
+            bits = r.big_endian() ? ((a << 32) | b) : ((b << 32) | a);
+        }
+        switch (e.type)
+        {
+        case MI_INT8: out[i] = (int8_t)bits; break;
+        case MI_UINT8: case MI_UTF8: out[i] = (uint8_t)bits; break;
+        case MI_INT16: out[i] = (int16_t)bits; break;
+        case MI_UINT16: case MI_UTF16: out[i] = (uint16_t)bits; break;
+        case MI_INT32: out[i] = (int32_t)bits; break;
+        case MI_UINT32: case MI_UTF32: out[i] = (uint32_t)bits; break;
+        case MI_INT64: out[i] = (double)(int64_t)bits; break;
+        case MI_UINT64: out[i] = (double)bits; break;
+        case MI_SINGLE:
+        {
+            const uint32_t b32 = (uint32_t)bits;
+            float f;
+            std::memcpy(&f, &b32, sizeof(f));
+            out[i] = f;
+            break;
+        }
+        case MI_DOUBLE:
+        {
+            double d;
+            std::memcpy(&d, &bits, sizeof(d));
+            out[i] = d;
+            break;
+        }
+        }
+    }
+    return out;
+}
+
+std::string decode_text(const element_reader &r, const data_element &e)
+{
+    if (e.type == MI_UTF8 || e.type == MI_INT8 || e.type == MI_UINT8)
+    {
+        return std::string(reinterpret_cast<const char *>(e.data), e.size);
+    }
+    /* UTF-16 / UTF-32 code units, re-encoded as UTF-8 */
+    std::string text;
+    for (double v : decode_numeric(r, e))
+    {
+        const uint32_t c = (uint32_t)v;
+        if (c < 0x80)
+        {
+            text += (char)c;
+        }
+        else if (c < 0x800)
+        {
+            text += (char)(0xc0 | (c >> 6));
+            text += (char)(0x80 | (c & 0x3f));
+        }
+        else
+        {
+            text += (char)(0xe0 | (c >> 12));
+            text += (char)(0x80 | ((c >> 6) & 0x3f));
+            text += (char)(0x80 | (c & 0x3f));
+        }
+    }
+    return text;
+}
+
+mat_array parse_matrix(const element_reader &parent, const data_element &e);
+
+std::vector<unsigned char> inflate_element(const element_reader &r, const data_element &e)
+{
+#if defined(HMM_GMM_HAVE_ZLIB)
+    std::vector<unsigned char> out(std::max<std::size_t>(4 * e.size, 1024));
+    z_stream z;
+    std::memset(&z, 0, sizeof(z));
+    if (inflateInit(&z) != Z_OK)
+    {
+        r.fail("zlib initialisation failed");
+    }
+    z.next_in = const_cast<Bytef *>(e.data);
+    z.avail_in = (uInt)e.size;
+    int status = Z_OK;
+    while (status != Z_STREAM_END)
+    {
+        if (z.total_out == out.size())
+        {
+            out.resize(out.size() * 2);
+        }
+        z.next_out = out.data() + z.total_out;
+        z.avail_out = (uInt)(out.size() - z.total_out);
+        status = inflate(&z, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END)
+        {
+            inflateEnd(&z);
+            r.fail("corrupt compressed variable");
+        }
+    }
+    out.resize(z.total_out);
+    inflateEnd(&z);
+    return out;
+#else
+    (void)e;
+    r.fail("compressed variables need zlib (rebuild with zlib or save with -v6)");
+#endif
+}
+
+/*******************************************************************************
+* Function Name: parse_matrix
+********************************************************************************
+* Summary:
+*  Decodes one miMATRIX element: array flags, dimensions, name, then the
+*  class specific sub-elements (real/imaginary data, characters, cell
+*  entries or struct field names and values).
+*
+*******************************************************************************/
+mat_array parse_matrix(const element_reader &parent, const data_element &e)
+{
+    mat_array a;
+    if (e.size == 0)
+    {
+        a.dims = {0, 0};
+        return a;
+    }
+    element_reader r(e.data, e.size, parent.big_endian(), parent.filename());
+
+    const data_element flags = r.next();
+    if (flags.type != MI_UINT32 || flags.size < 8)
+    {
+        r.fail("invalid array flags");
+    }
+    const uint32_t flag_word = r.load32(flags.data);
+    a.type = (mat_class)(flag_word & 0xff);
+    a.logical = (flag_word & ARRAY_FLAG_LOGICAL) != 0;
+    const bool complex = (flag_word & ARRAY_FLAG_COMPLEX) != 0;
+
+    const data_element dims = r.next();
+    for (double d : decode_numeric(r, dims))
+    {
+        a.dims.push_back((std::size_t)d);
+    }
+    if (a.dims.size() < 2)
+    {
+        r.fail("invalid dimensions");
+    }
+    a.name = decode_text(r, r.next());
+
+    switch (a.type)
+    {
+    case mat_class::cell:
+        for (std::size_t i = 0; i < a.numel(); i++)
+        {
+            const data_element item = r.next();
+            if (item.type != MI_MATRIX)
+            {
+                r.fail("invalid cell element");
+            }
+            a.elements.push_back(parse_matrix(r, item));
+        }
+        break;
+
+    case mat_class::structure:
+    {
+        const data_element name_length = r.next();
+        const std::size_t field_length = (std::size_t)decode_numeric(r, name_length).at(0);
+        const data_element names = r.next();
+        if (field_length == 0)
+        {
+            break;
+        }
+        for (std::size_t off = 0; off + field_length <= names.size; off += field_length)
+        {
+            const char *s = reinterpret_cast<const char *>(names.data + off);
+            a.field_names.emplace_back(s, strnlen(s, field_length));
+        }
+        for (std::size_t i = 0; i < a.numel() * a.field_names.size(); i++)
+        {
+            const data_element item = r.next();
+            if (item.type != MI_MATRIX)
+            {
+                r.fail("invalid struct field");
+            }
+            a.elements.push_back(parse_matrix(r, item));
+        }
+        break;
+    }
+
+    case mat_class::character:
+        a.text = decode_text(r, r.next());
+        break;
+
+    case mat_class::sparse:
+    case mat_class::object:
+    case mat_class::unknown:
+        r.fail("unsupported array class of variable '" + a.name + "'");
+
+    default:
+        a.real = decode_numeric(r, r.next());
+        if (complex)
+        {
+            r.next();               /* imaginary part, not used */
+        }
+        if (a.real.size() != a.numel())
+        {
+            r.fail("size mismatch in variable '" + a.name + "'");
+        }
+        break;
+    }
+    return a;
+}
+
+void append_element(std::vector<unsigned char> &out, uint32_t type, const void *data, std::size_t size)
+{
+    unsigned char tag[8];
+    store_le32(tag, type);
+    store_le32(tag + 4, (uint32_t)size);
+    out.insert(out.end(), tag, tag + 8);
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    out.insert(out.end(), p, p + size);
+    out.resize((out.size() + 7) / 8 * 8, 0);
+}
+
+/* miMATRIX element of one array, little-endian */
+void append_matrix(std::vector<unsigned char> &out, const mat_array &a)
+{
+    std::vector<unsigned char> body;
+    unsigned char flags[8] = {};
+    store_le32(flags, (uint32_t)a.type | (a.logical ? ARRAY_FLAG_LOGICAL : 0));
+    append_element(body, MI_UINT32, flags, sizeof(flags));
+
+    std::vector<unsigned char> dims(4 * a.dims.size());
+    for (std::size_t i = 0; i < a.dims.size(); i++)
+    {
+        store_le32(&dims[4 * i], (uint32_t)a.dims[i]);
+    }
+    append_element(body, MI_INT32, dims.data(), dims.size());
+    append_element(body, MI_INT8, a.name.data(), a.name.size());
+
+    switch (a.type)
+    {
+    case mat_class::float64:
+    {
+        std::vector<unsigned char> values(8 * a.real.size());
+        for (std::size_t i = 0; i < a.real.size(); i++)
+        {
+            uint64_t bits;
+            std::memcpy(&bits, &a.real[i], sizeof(bits));
+            store_le64(&values[8 * i], bits);
+        }
+        append_element(body, MI_DOUBLE, values.data(), values.size());
+        break;
+    }
+    case mat_class::character:
+    {
+        std::vector<unsigned char> chars(2 * a.text.size());
+        for (std::size_t i = 0; i < a.text.size(); i++)
+        {
+            store_le16(&chars[2 * i], (uint16_t)(unsigned char)a.text[i]);
+        }
+        append_element(body, MI_UINT16, chars.data(), chars.size());
+        break;
+    }
+    case mat_class::cell:
+        for (const mat_array &e : a.elements)
+        {
+            append_matrix(body, e);
+        }
+        break;
+    case mat_class::structure:
+    {
+        std::size_t length = 1;
+        for (const std::string &f : a.field_names)
+        {
+            length = std::max(length, f.size() + 1);
+        }
+        const int32_t field_length = (int32_t)((length + 7) / 8 * 8);
+        unsigned char raw[4];
+        store_le32(raw, (uint32_t)field_length);
+        append_element(body, MI_INT32, raw, sizeof(raw));
+        std::vector<unsigned char> names(a.field_names.size() * field_length, 0);
+        for (std::size_t f = 0; f < a.field_names.size(); f++)
+        {
+            std::memcpy(&names[f * field_length], a.field_names[f].data(), a.field_names[f].size());
+        }
+        append_element(body, MI_INT8, names.data(), names.size());
+        for (const mat_array &e : a.elements)
+        {
+            append_matrix(body, e);
+        }
+        break;
+    }
+    default:
+        throw std::invalid_argument("cannot write array class of '" + a.name + "'");
+    }
+    append_element(out, MI_MATRIX, body.data(), body.size());
+}
+
+} /* namespace */
+
+
+std::size_t mat_array::numel() const
+{
+    std::size_t n = dims.empty() ? 0 : 1;
+    for (std::size_t d : dims)
+    {
+        n *= d;
+    }
+    return n;
+}
+
+
+const mat_array &mat_array::cell(std::size_t row, std::size_t col) const
+{
+    if (type != mat_class::cell)
+    {
+        throw std::runtime_error("'" + name + "' is not a cell array");
+    }
+    if (row >= rows() || col >= cols())
+    {
+        throw std::runtime_error("cell index out of range in '" + name + "'");
+    }
+    return elements[col * rows() + row];
+}
+
+
+const mat_array &mat_array::field(const std::string &field_name, std::size_t element) const
+{
+    if (type != mat_class::structure)
+    {
+        throw std::runtime_error("'" + name + "' is not a struct");
+    }
+    for (std::size_t f = 0; f < field_names.size(); f++)
+    {
+        if (field_names[f] == field_name && element < numel())
+        {
+            return elements[element * field_names.size() + f];
+        }
+    }
+    throw std::runtime_error("struct '" + name + "' has no field " + field_name);
+}
+
+
+double mat_array::scalar() const
+{
+    if (!is_numeric() || real.empty())
+    {
+        throw std::runtime_error("'" + name + "' is not a numeric scalar");
+    }
+    return real[0];
+}
+
+
+std::string mat_array::string() const
+{
+    if (type != mat_class::character)
+    {
+        throw std::runtime_error("'" + name + "' is not a char array");
+    }
+    return text;
+}
+
+
+/*******************************************************************************
+* Function Name: read_mat_file
+********************************************************************************
+* Summary:
+*  Maps the file, checks the 128 byte header (the endian indicator decides
+*  the byte order) and decodes every top level variable, inflating
+*  miCOMPRESSED elements first.
+*
+* Parameters:
+*  filename: path of the .mat file
+*
+* Return:
+*  variables in file order
+*
+*******************************************************************************/
+std::vector<mat_array> read_mat_file(const std::string &filename)
+{
+    const mapped_file file(filename);
+    if (file.size() < MAT_HEADER_SIZE)
+    {
+        throw std::runtime_error("not a MAT-file: " + filename);
+    }
+    const unsigned char *header = file.data();
+    if (std::memcmp(header, "MATLAB 7.3", 10) == 0)
+    {
+        throw std::runtime_error("MAT-file v7.3 (HDF5) is not supported, save with -v7: " + filename);
+    }
+    bool big_endian;
+    if (header[126] == 'I' && header[127] == 'M')
+    {
+        big_endian = false;
+    }
+    else if (header[126] == 'M' && header[127] == 'I')
+    {
+        big_endian = true;
+    }
+    else
+    {
+        throw std::runtime_error("not a Level 5 MAT-file: " + filename);
+    }
+
+    std::vector<mat_array> variables;
+    element_reader r(header + MAT_HEADER_SIZE, file.size() - MAT_HEADER_SIZE, big_endian, filename);
+    while (!r.at_end())
+    {
+        const data_element e = r.next();
+        if (e.type == MI_COMPRESSED)
+        {
+            const std::vector<unsigned char> raw = inflate_element(r, e);
+            element_reader inner(raw.data(), raw.size(), big_endian, filename);
+            const data_element m = inner.next();
+            if (m.type == MI_MATRIX)
+            {
+                variables.push_back(parse_matrix(inner, m));
+            }
+        }
+        else if (e.type == MI_MATRIX)
+        {
+            variables.push_back(parse_matrix(r, e));
+        }
+    }
+    return variables;
+}
+
+
+mat_array read_mat_variable(const std::string &filename, const std::string &name)
+{
+    for (mat_array &v : read_mat_file(filename))
+    {
+        if (v.name == name)
+        {
+            return std::move(v);
+        }
+    }
+    throw std::runtime_error("variable '" + name + "' not found in " + filename);
+}
+
+
+void write_mat_file(const std::string &filename, const std::vector<mat_array> &variables)
+{
+    std::vector<unsigned char> out(MAT_HEADER_SIZE, ' ');
+    const char text[] = "MATLAB 5.0 MAT-file, written by hmm_gmm";
+    std::memcpy(out.data(), text, sizeof(text) - 1);
+    std::fill(out.begin() + 116, out.begin() + 124, 0);     /* no subsystem data */
+    store_le16(&out[124], 0x0100);
+    out[126] = 'I';
+    out[127] = 'M';
+    for (const mat_array &v : variables)
+    {
+        append_matrix(out, v);
+    }
+
+    std::FILE *f = std::fopen(filename.c_str(), "wb");
+    if (!f)
+    {
+        throw std::runtime_error("cannot create " + filename);
+    }
+    const bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    if (std::fclose(f) != 0 || !ok)
+    {
+        throw std::runtime_error("write failed for " + filename);
+    }
+}
+
+
+mat_array make_mat_numeric(const std::string &name, const std::vector<std::size_t> &dims, std::vector<double> values)
+{
+    mat_array a;
+    a.name = name;
+    a.type = mat_class::float64;
+    a.dims = dims;
+    while (a.dims.size() < 2)
+    {
+        a.dims.push_back(1);
+    }
+    a.real = std::move(values);
+    if (a.real.size() != a.numel())
+    {
+        throw std::invalid_argument("size mismatch for MAT variable " + name);
+    }
+    return a;
+}
+
+
+mat_array make_mat_char(const std::string &name, const std::string &text)
+{
+    mat_array a;
+    a.name = name;
+    a.type = mat_class::character;
+    a.dims = {1, text.size()};
+    a.text = text;
+    return a;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,355 @@
+/******************************************************************************
+* File Name:   mfcc.cpp
+*
+* Description: MFCC_E_D_A front-end, see mfcc.hpp. The formulas follow
+*              wav2mfcc.m, wav2logpow.m and slope() in wav2mfcc_e_d_a.m.
+*
+*******************************************************************************/
+#include "hmm_gmm/mfcc.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace hmm_gmm
+{
+
+std::size_t mfcc_config::frame_size() const
+{
+    return (std::size_t)std::lround(sample_rate * frame_size_sec);
+}
+
+std::size_t mfcc_config::frame_shift() const
+{
+    return (std::size_t)std::lround(sample_rate * frame_shift_sec);
+}
+
+std::size_t mfcc_config::fft_size() const
+{
+    std::size_t fft_n = 2;
+    while (fft_n < frame_size())
+    {
+        fft_n *= 2;
+    }
+    return fft_n;
+}
+
+int32_t mfcc_config::htk_samp_period() const
+{
+    return (int32_t)std::lround(frame_shift_sec * 1E7);
+}
+
+std::string mfcc_config::to_string() const
+{
+    char text[256];
+    std::snprintf(text, sizeof(text),
+                  "MFCC_E_D_A fs=%.17g frame_size_sec=%.17g frame_shift_sec=%.17g use_hamming=%d "
+                  "pre_emp=%.17g bank_no=%d cep_order=%d lifter=%d delta_win=%d",
+                  sample_rate, frame_size_sec, frame_shift_sec, use_hamming ? 1 : 0,
+                  pre_emp, bank_no, cep_order, lifter, delta_win);
+    return text;
+}
+
+
+mfcc_extractor::mfcc_extractor(const mfcc_config &config)
+    : config_(config),
+      frame_size_(config.frame_size()),
+      frame_shift_(config.frame_shift()),
+      fft_(std::max<std::size_t>(config.fft_size(), 4))
+{
+    if (frame_size_ < 2 || frame_shift_ == 0 || config.bank_no <= 0 || config.cep_order <= 0
+        || config.lifter <= 0 || config.delta_win <= 0)
+    {
+        throw std::invalid_argument("invalid mfcc_config");
+    }
+
+    const double pi = std::acos(-1.0);
+    const double fs = config.sample_rate;
+    const std::size_t fft_n = fft_.size();
+    const int bank_no = config.bank_no;
+    const int cep_order = config.cep_order;
+
+    /* hamming window */
+    hamming_.resize(frame_size_);
+    for (std::size_t k = 0; k < frame_size_; k++)
+    {
+        hamming_[k] = 0.54 - 0.46 * std::cos(2.0 * pi * (double)k / (double)(frame_size_ - 1));
+    }
+
+    /* Mel scale filter bank, triangle weights evaluated once instead of per frame */
+    const double max_mf = 2595.0 * std::log10(1.0 + 0.5 * fs / 700.0);
+    const double delta_mf = max_mf / (double)(bank_no + 1);
+    std::vector<double> f((std::size_t)bank_no + 2);
+    for (int m = 0; m < bank_no + 2; m++)
+    {
+        f[(std::size_t)m] = (std::pow(10.0, (double)m * delta_mf / 2595.0) - 1.0) * 700.0;
+    }
+    filters_.resize((std::size_t)bank_no);
+    for (int m = 0; m < bank_no; m++)
+    {
+        /* Matlab convention: 1-based bin indices */
+        const double kmin = f[(std::size_t)m] / fs * (double)fft_n + 1.0;
+        const double kcen = f[(std::size_t)m + 1] / fs * (double)fft_n + 1.0;
+        const double kmax = f[(std::size_t)m + 2] / fs * (double)fft_n + 1.0;
+        const long k_first = (long)std::ceil(kmin);
+        const long k_last = std::min((long)std::floor(kmax), (long)(fft_n / 2 + 1));
+
+        mel_filter &filter = filters_[(std::size_t)m];
+        filter.first_bin = (std::size_t)(k_first - 1);
+        for (long k = k_first; k <= k_last; k++)
+        {
+            const double mel_k = 2595.0 * std::log10(1.0 + (double)(k - 1) / (double)fft_n * fs / 700.0);
+            double w;
+            if ((double)k < kcen)
+            {
+                w = (mel_k - (double)m * delta_mf) / delta_mf;
+            }
+            else
+            {
+                w = 1.0 - (mel_k - delta_mf * (double)(m + 1)) / delta_mf;
+            }
+            filter.weights.push_back(w);
+        }
+    }
+
+    /* inverse cosine transform */
+    dct_.resize((std::size_t)cep_order * (std::size_t)bank_no);
+    for (int k = 0; k < cep_order; k++)
+    {
+        for (int m = 0; m < bank_no; m++)
+        {
+            dct_[(std::size_t)k * (std::size_t)bank_no + (std::size_t)m] =
+                std::sqrt(2.0 / bank_no) * std::cos((double)(k + 1) * pi / bank_no * ((double)m + 0.5));
+        }
+    }
+
+    /* lifter weighting */
+    lifter_.resize((std::size_t)cep_order);
+    for (int n = 0; n < cep_order; n++)
+    {
+        lifter_[(std::size_t)n] = 1.0 + (config.lifter / 2.0) * std::sin(pi * (double)(n + 1) / config.lifter);
+    }
+
+    /* slope() with window = ones(1, 2*delta_win+1), in unit of 10ms */
+    const int win = config.delta_win;
+    double denominator = 0.0;
+    for (int k = -win; k <= win; k++)
+    {
+        denominator += (double)(k * k);
+    }
+    const double unit_scale = 0.01 / config.frame_shift_sec;
+    for (int k = -win; k <= win; k++)
+    {
+        delta_weights_.push_back(unit_scale * (double)k / denominator);
+    }
+
+    frame_.assign(fft_n, 0.0);
+    spectrum_.resize(fft_n / 2 + 1);
+    log_mel_.resize((std::size_t)bank_no);
+}
+
+
+std::size_t mfcc_extractor::frame_count(std::size_t num_samples) const
+{
+    if (num_samples < frame_size_)
+    {
+        return 0;
+    }
+    return 1 + (num_samples - frame_size_) / frame_shift_;
+}
+
+
+/*******************************************************************************
+* Function Name: compute_static_frame
+********************************************************************************
+* Summary:
+*  One pass over the frame: log energy of the raw samples (wav2logpow), then
+*  pre-emphasis, hamming window, magnitude spectrum, sparse mel filter bank,
+*  log, DCT and liftering (wav2mfcc).
+*
+* Parameters:
+*  frame:           frame_size samples
+*  previous_sample: sample before frame(1), used by pre-emphasis only
+*  out:             static_dim() values [mfcc; logpow]
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void mfcc_extractor::compute_static_frame(const float *frame, float previous_sample, double *out)
+{
+    const double pre_emp = config_.pre_emp;
+    double energy = 0.0;
+    double prev = (double)previous_sample;
+    for (std::size_t k = 0; k < frame_size_; k++)
+    {
+        const double s = (double)frame[k];
+        energy += s * s;
+        double e = s - pre_emp * prev;
+        prev = s;
+        if (config_.use_hamming)
+        {
+            e *= hamming_[k];
+        }
+        frame_[k] = e;
+    }
+    /* frame_[frame_size_..fft_n) stays zero: fft(s, fftN) zero padding */
+
+    fft_.magnitude(frame_.data(), spectrum_.data());
+
+    for (std::size_t m = 0; m < filters_.size(); m++)
+    {
+        const mel_filter &filter = filters_[m];
+        const double *power = &spectrum_[filter.first_bin];
+        double mel_power = 0.0;
+        for (std::size_t k = 0; k < filter.weights.size(); k++)
+        {
+            mel_power += power[k] * filter.weights[k];
+        }
+        log_mel_[m] = std::log(mel_power);
+    }
+
+    const std::size_t bank_no = filters_.size();
+    const std::size_t cep_order = lifter_.size();
+    for (std::size_t k = 0; k < cep_order; k++)
+    {
+        const double *row = &dct_[k * bank_no];
+        double c = 0.0;
+        for (std::size_t m = 0; m < bank_no; m++)
+        {
+            c += row[m] * log_mel_[m];
+        }
+        out[k] = lifter_[k] * c;
+    }
+    out[cep_order] = std::log(energy);
+}
+
+
+/*******************************************************************************
+* Function Name: compute
+********************************************************************************
+* Summary:
+*  Equivalent of wav2mfcc_e_d_a(): static features for every frame followed
+*  by the delta and delta-delta regressions with boundary frames repeated.
+*
+* Parameters:
+*  samples:     speech samples (int16 scale, as audioread 'native')
+*  num_samples: length of samples
+*
+* Return:
+*  feature_matrix of feature_dim() x frame_count(num_samples)
+*
+*******************************************************************************/
+feature_matrix mfcc_extractor::compute(const float *samples, std::size_t num_samples)
+{
+    const std::size_t frame_no = frame_count(num_samples);
+    const std::size_t sdim = config_.static_dim();
+    feature_matrix features(3 * sdim, frame_no);
+    if (frame_no == 0)
+    {
+        return features;
+    }
+
+    /* statics and deltas are kept in double, as in MATLAB, and rounded once */
+    statics_.resize(2 * sdim * frame_no);
+    double *statics = statics_.data();
+    double *deltas = statics + sdim * frame_no;
+
+    for (std::size_t fr = 0; fr < frame_no; fr++)
+    {
+        const std::size_t start = fr * frame_shift_;
+        const float previous = (start == 0) ? 0.0f : samples[start - 1];
+        compute_static_frame(samples + start, previous, statics + fr * sdim);
+    }
+
+    const long win = config_.delta_win;
+    const long last = (long)frame_no - 1;
+    auto regress = [&](const double *in, double *out) {
+        for (long fr = 0; fr <= last; fr++)
+        {
+            double *o = out + (std::size_t)fr * sdim;
+            std::fill(o, o + sdim, 0.0);
+            for (long k = -win; k <= win; k++)
+            {
+                const double w = delta_weights_[(std::size_t)(k + win)];
+                const double *src = in + (std::size_t)std::clamp(fr + k, 0L, last) * sdim;
+                for (std::size_t d = 0; d < sdim; d++)
+                {
+                    o[d] += w * src[d];
+                }
+            }
+        }
+    };
+
+    regress(statics, deltas);
+    for (std::size_t fr = 0; fr < frame_no; fr++)
+    {
+        float *dst = features.frame(fr);
+        for (std::size_t d = 0; d < sdim; d++)
+        {
+            dst[d] = (float)statics[fr * sdim + d];
+            dst[sdim + d] = (float)deltas[fr * sdim + d];
+        }
+    }
+
+    /* delta-delta overwrites the statics buffer, they are no longer needed */
+    regress(deltas, statics);
+    for (std::size_t fr = 0; fr < frame_no; fr++)
+    {
+        float *dst = features.frame(fr) + 2 * sdim;
+        for (std::size_t d = 0; d < sdim; d++)
+        {
+            dst[d] = (float)statics[fr * sdim + d];
+        }
+    }
+    return features;
+}
+
+
+/*******************************************************************************
+* Function Name: compute_frames
+********************************************************************************
+* Summary:
+*  The delta-delta of frame t reads the statics of t - 2 * delta_win ..
+*  t + 2 * delta_win, and the statics of a frame read its own samples and
+*  the one before it (pre-emphasis). compute() is therefore run on the
+*  samples of frames first - 2 * delta_win - 1 .. first + count - 1 +
+*  2 * delta_win, clamped to the recording: the extra frame in front gives
+*  the first needed frame its preceding sample, and the clamped regression
+*  edges fall on context frames only, unless they are the true edges of the
+*  recording, where compute() clamps as well.
+*
+* Parameters:
+*  samples:     the whole recording
+*  num_samples: length of samples
+*  first:       first frame wanted
+*  count:       frames wanted
+*
+* Return:
+*  feature_matrix of feature_dim() x min(count, frame_count(num_samples) - first)
+*
+*******************************************************************************/
+feature_matrix mfcc_extractor::compute_frames(const float *samples, std::size_t num_samples, std::size_t first,
+                                              std::size_t count)
+{
+    const std::size_t total = frame_count(num_samples);
+    if (first >= total || count == 0)
+    {
+        return feature_matrix(config_.feature_dim(), 0);
+    }
+    count = std::min(count, total - first);
+    const std::size_t context = 2 * (std::size_t)config_.delta_win;
+    const std::size_t begin = (first > context) ? first - context - 1 : 0;
+    const std::size_t end = std::min(total, first + count + context);
+    const std::size_t sample_end = std::min(num_samples, (end - 1) * frame_shift_ + frame_size_);
+
+    const feature_matrix local = compute(samples + begin * frame_shift_, sample_end - begin * frame_shift_);
+    feature_matrix features(local.dim, count);
+    std::copy(local.frame(first - begin), local.frame(first - begin + count), features.data.begin());
+    return features;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,90 @@
+/******************************************************************************
+* File Name:   parallel.cpp
+*
+* Description: Data-parallel helpers, see parallel.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hmm_gmm
+{
+
+std::size_t hardware_threads()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+void parallel_for(std::size_t count, std::size_t threads,
+                  const std::function<void(std::size_t index, std::size_t worker)> &body)
+{
+    threads = std::max<std::size_t>(1, std::min(threads, count));
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&](std::size_t id) {
+        for (;;)
+        {
+            const std::size_t i = next.fetch_add(1);
+            if (i >= count || failed.load())
+            {
+                return;
+            }
+            try
+            {
+                body(i, id);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    if (threads == 1)
+    {
+        worker(0);
+    }
+    else
+    {
+        std::vector<std::thread> pool;
+        for (std::size_t t = 0; t < threads; t++)
+        {
+            pool.emplace_back(worker, t);
+        }
+        for (std::thread &t : pool)
+        {
+            t.join();
+        }
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+
+void parallel_for(const std::vector<std::size_t> &order, std::size_t threads,
+                  const std::function<void(std::size_t index, std::size_t worker)> &body)
+{
+    parallel_for(order.size(), threads, [&](std::size_t i, std::size_t worker) { body(order[i], worker); });
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
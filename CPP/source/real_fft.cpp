@@ -0,0 +1,128 @@
+/******************************************************************************
+* File Name:   real_fft.cpp
+*
+* Description: Real-input FFT, see real_fft.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/real_fft.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace hmm_gmm
+{
+
+real_fft::real_fft(std::size_t n)
+    : n_(n), half_(n / 2)
+{
+    if (n < 4 || (n & (n - 1)) != 0)
+    {
+        throw std::invalid_argument("real_fft size must be a power of two >= 4");
+    }
+
+    std::size_t bits = 0;
+    while ((std::size_t(1) << bits) < half_)
+    {
+        bits++;
+    }
+    bit_reverse_.resize(half_);
+    for (std::size_t i = 0; i < half_; i++)
+    {
+        std::size_t r = 0;
+        for (std::size_t b = 0; b < bits; b++)
+        {
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        bit_reverse_[i] = r;
+    }
+
+    const double pi = std::acos(-1.0);
+    twiddle_re_.resize(half_ / 2);
+    twiddle_im_.resize(half_ / 2);
+    for (std::size_t k = 0; k < half_ / 2; k++)
+    {
+        twiddle_re_[k] = std::cos(2.0 * pi * (double)k / (double)half_);
+        twiddle_im_[k] = -std::sin(2.0 * pi * (double)k / (double)half_);
+    }
+    split_re_.resize(half_ + 1);
+    split_im_.resize(half_ + 1);
+    for (std::size_t k = 0; k <= half_; k++)
+    {
+        split_re_[k] = std::cos(2.0 * pi * (double)k / (double)n_);
+        split_im_[k] = -std::sin(2.0 * pi * (double)k / (double)n_);
+    }
+    re_.resize(half_);
+    im_.resize(half_);
+}
+
+
+/* In-place iterative radix-2 FFT of (re_, im_), input already bit-reversed */
+void real_fft::complex_fft()
+{
+    for (std::size_t len = 2; len <= half_; len <<= 1)
+    {
+        const std::size_t step = half_ / len;
+        const std::size_t hl = len / 2;
+        for (std::size_t start = 0; start < half_; start += len)
+        {
+            for (std::size_t k = 0; k < hl; k++)
+            {
+                const double wr = twiddle_re_[k * step];
+                const double wi = twiddle_im_[k * step];
+                const std::size_t a = start + k;
+                const std::size_t b = a + hl;
+                const double tr = re_[b] * wr - im_[b] * wi;
+                const double ti = re_[b] * wi + im_[b] * wr;
+                re_[b] = re_[a] - tr;
+                im_[b] = im_[a] - ti;
+                re_[a] += tr;
+                im_[a] += ti;
+            }
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: magnitude
+********************************************************************************
+* Summary:
+*  Packs z(n) = x(2n) + i*x(2n+1), transforms it with an N/2 point FFT and
+*  recovers X(k) = (Z(k) + Z*(N/2-k))/2 - i*W^k*(Z(k) - Z*(N/2-k))/2.
+*
+* Parameters:
+*  in:  N real input samples
+*  out: N/2+1 magnitudes, the same values as abs(fft(in, N))(1:N/2+1)
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void real_fft::magnitude(const double *in, double *out)
+{
+    for (std::size_t i = 0; i < half_; i++)
+    {
+        const std::size_t r = bit_reverse_[i];
+        re_[r] = in[2 * i];
+        im_[r] = in[2 * i + 1];
+    }
+    complex_fft();
+
+    for (std::size_t k = 0; k <= half_; k++)
+    {
+        const std::size_t k1 = (k == half_) ? 0 : k;
+        const std::size_t k2 = (k == 0) ? 0 : half_ - k;
+        /* even part E = (Z(k) + conj(Z(N/2-k)))/2, odd part O = (Z(k) - conj(Z(N/2-k)))/(2i) */
+        const double er = 0.5 * (re_[k1] + re_[k2]);
+        const double ei = 0.5 * (im_[k1] - im_[k2]);
+        const double or_ = 0.5 * (im_[k1] + im_[k2]);
+        const double oi = -0.5 * (re_[k1] - re_[k2]);
+        const double xr = er + split_re_[k] * or_ - split_im_[k] * oi;
+        const double xi = ei + split_re_[k] * oi + split_im_[k] * or_;
+        out[k] = std::sqrt(xr * xr + xi * xi);
+    }
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,233 @@
+/******************************************************************************
+* File Name:   resampler.cpp
+*
+* Description: Polyphase resampler, see resampler.hpp.
+*
+*              With the upsampled signal xu (xu[i * L] = x[i], zero otherwise)
+*              and the prototype filter h centred at D,
+*
+*              y[n] = sum_j h[j] * xu[n * M + D - j]
+*
+*              only taps j = p + k * L with p = (n * M + D) mod L meet input
+*              samples, namely x[base - k] with base = (n * M + D) / L. Phase p
+*              is stored reversed so the sum runs forward over
+*              x[base - taps + 1 .. base].
+*
+*******************************************************************************/
+#include "hmm_gmm/resampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr double KAISER_BETA = 8.6;     /* about 85 dB stop band attenuation */
+constexpr std::size_t TAP_MULTIPLE = 8;
+
+double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50 && term > 1e-12 * sum; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/* Eight independent accumulators, so the compiler can keep them in SIMD lanes */
+inline float dot(const float *a, const float *b, std::size_t n)
+{
+    float acc[TAP_MULTIPLE] = {};
+    for (std::size_t i = 0; i < n; i += TAP_MULTIPLE)
+    {
+        for (std::size_t j = 0; j < TAP_MULTIPLE; j++)
+        {
+            acc[j] += a[i + j] * b[i + j];
+        }
+    }
+    return ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+}
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: polyphase_resampler
+********************************************************************************
+* Summary:
+*  Reduces out_rate / in_rate to L / M and designs the prototype low-pass
+*  at the upsampled rate: cutoff rolloff / (2 max(L, M)) cycles per sample,
+*  zero_crossings sinc lobes per side, Kaiser window, gain L.
+*
+*******************************************************************************/
+polyphase_resampler::polyphase_resampler(double in_rate, double out_rate, int zero_crossings, double rolloff)
+{
+    const long long in_hz = std::llround(in_rate);
+    const long long out_hz = std::llround(out_rate);
+    if (in_hz <= 0 || out_hz <= 0 || std::fabs(in_rate - in_hz) > 1e-6 || std::fabs(out_rate - out_hz) > 1e-6)
+    {
+        throw std::invalid_argument("resampling needs positive integer rates");
+    }
+    if (zero_crossings < 1 || rolloff <= 0.0 || rolloff > 1.0)
+    {
+        throw std::invalid_argument("invalid resampler filter settings");
+    }
+    const long long g = std::gcd(in_hz, out_hz);
+    up_ = (std::size_t)(out_hz / g);
+    down_ = (std::size_t)(in_hz / g);
+
+    const double pi = std::acos(-1.0);
+    const double ratio = (double)std::max(up_, down_);
+    const double cutoff = rolloff / (2.0 * ratio);
+    const double span = 2.0 * zero_crossings * ratio / rolloff;     /* filter length in upsampled samples */
+    taps_ = (std::size_t)std::ceil(span / up_);
+    taps_ = (taps_ + TAP_MULTIPLE - 1) / TAP_MULTIPLE * TAP_MULTIPLE;
+    const std::size_t length = taps_ * up_;
+    delay_ = length / 2;
+
+    std::vector<double> h(length);
+    const double half = (double)delay_;
+    const double window_norm = bessel_i0(KAISER_BETA);
+    for (std::size_t j = 0; j < length; j++)
+    {
+        const double x = (double)j - half;
+        const double sinc = (x == 0.0) ? 1.0 : std::sin(2.0 * pi * cutoff * x) / (pi * x);
+        const double r = x / half;
+        const double window = (std::fabs(r) < 1.0) ? bessel_i0(KAISER_BETA * std::sqrt(1.0 - r * r)) / window_norm : 0.0;
+        h[j] = (x == 0.0 ? 2.0 * cutoff : sinc) * window * (double)up_;
+    }
+
+    coeffs_.resize(length);
+    for (std::size_t p = 0; p < up_; p++)
+    {
+        for (std::size_t k = 0; k < taps_; k++)
+        {
+            coeffs_[p * taps_ + (taps_ - 1 - k)] = (float)h[p + k * up_];
+        }
+    }
+    reset();
+}
+
+
+std::size_t polyphase_resampler::output_count(std::size_t input_count) const
+{
+    return (std::size_t)(((uint64_t)input_count * up_ + down_ - 1) / down_);
+}
+
+
+/* window_end points one past input sample base of output n */
+float polyphase_resampler::output_at(const float *window_end, uint64_t n) const
+{
+    const std::size_t p = (std::size_t)((n * down_ + delay_) % up_);
+    return dot(window_end - taps_, phase(p), taps_);
+}
+
+
+/*******************************************************************************
+* Function Name: resample
+********************************************************************************
+* Summary:
+*  Resamples a complete signal. Outputs whose input window lies inside the
+*  signal read it in place; only the first and last few outputs go through
+*  a zero padded copy of the signal edges.
+*
+*******************************************************************************/
+std::vector<float> polyphase_resampler::resample(const float *in, std::size_t n) const
+{
+    const std::size_t count = output_count(n);
+    std::vector<float> out(count);
+
+    const std::size_t pad = taps_;
+    std::vector<float> head(2 * pad, 0.0f);     /* [pad zeros | first pad samples] */
+    std::copy(in, in + std::min(n, pad), head.begin() + pad);
+    std::vector<float> tail(3 * pad, 0.0f);     /* [last pad samples | zeros] */
+    const std::size_t tail_first = (n > pad) ? n - pad : 0;
+    std::copy(in + tail_first, in + n, tail.begin());
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        const uint64_t base = (i * down_ + delay_) / up_;    /* newest input sample of the window */
+        const float *end;
+        if (base + 1 < taps_)
+        {
+            end = head.data() + pad + base + 1;
+        }
+        else if (base < n)
+        {
+            end = in + base + 1;
+        }
+        else
+        {
+            end = tail.data() + (base + 1 - tail_first);
+        }
+        out[i] = output_at(end, i);
+    }
+    return out;
+}
+
+
+void polyphase_resampler::reset()
+{
+    /* taps - 1 zeros stand for the samples before the start of the stream */
+    history_.assign(taps_ - 1, 0.0f);
+    history_start_ = -(int64_t)(taps_ - 1);
+    input_count_ = 0;
+    next_output_ = 0;
+}
+
+
+void polyphase_resampler::process(const float *in, std::size_t n, std::vector<float> &out)
+{
+    history_.insert(history_.end(), in, in + n);
+    input_count_ += n;
+    emit(out, false);
+}
+
+
+void polyphase_resampler::finish(std::vector<float> &out)
+{
+    emit(out, true);
+    reset();
+}
+
+
+void polyphase_resampler::emit(std::vector<float> &out, bool final)
+{
+    const uint64_t total = final ? output_count(input_count_) : UINT64_MAX;
+    while (next_output_ < total)
+    {
+        const uint64_t base = (next_output_ * down_ + delay_) / up_;
+        if (base >= input_count_)
+        {
+            if (!final)
+            {
+                break;
+            }
+            /* past the end of the stream: zero samples */
+            history_.resize((std::size_t)((int64_t)base + 1 - history_start_), 0.0f);
+        }
+        out.push_back(output_at(history_.data() + ((int64_t)base + 1 - history_start_), next_output_));
+        next_output_++;
+    }
+
+    /* drop input samples no later output can reach */
+    const int64_t keep_from = (int64_t)((next_output_ * down_ + delay_) / up_) - (int64_t)(taps_ - 1);
+    if (keep_from > history_start_)
+    {
+        const std::size_t drop = std::min((std::size_t)(keep_from - history_start_), history_.size());
+        history_.erase(history_.begin(), history_.begin() + drop);
+        history_start_ += (int64_t)drop;
+    }
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
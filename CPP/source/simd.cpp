@@ -0,0 +1,81 @@
+/******************************************************************************
+* File Name:   simd.cpp
+*
+* Description: Run-time SIMD kernel selection, see simd.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/simd.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+bool cpu_supports(simd_isa isa)
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    switch (isa)
+    {
+    case simd_isa::avx2:    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+                                   __builtin_cpu_supports("f16c");
+    case simd_isa::avx512:  return __builtin_cpu_supports("avx512f");
+    default:                return true;
+    }
+#else
+    return isa == simd_isa::scalar;
+#endif
+}
+
+simd_isa detect_best_isa()
+{
+    if (simd_isa_supported(simd_isa::avx512))
+    {
+        return simd_isa::avx512;
+    }
+    if (simd_isa_supported(simd_isa::avx2))
+    {
+        return simd_isa::avx2;
+    }
+    return simd_isa::scalar;
+}
+
+} /* namespace */
+
+
+const char *simd_isa_name(simd_isa isa)
+{
+    switch (isa)
+    {
+    case simd_isa::avx2:    return "avx2";
+    case simd_isa::avx512:  return "avx512";
+    default:                return "scalar";
+    }
+}
+
+
+bool simd_isa_supported(simd_isa isa)
+{
+    switch (isa)
+    {
+#if defined(HMM_GMM_HAVE_AVX2)
+    case simd_isa::avx2:    return cpu_supports(isa);
+#endif
+#if defined(HMM_GMM_HAVE_AVX512)
+    case simd_isa::avx512:  return cpu_supports(isa);
+#endif
+    case simd_isa::scalar:  return true;
+    default:                return false;
+    }
+}
+
+
+simd_isa best_simd_isa()
+{
+    static const simd_isa best = detect_best_isa();
+    return best;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
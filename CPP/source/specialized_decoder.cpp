@@ -0,0 +1,580 @@
+/******************************************************************************
+* File Name:   specialized_decoder.cpp
+*
+* Description: Compile-time specialised decoder and its C generator, see
+*              specialized_decoder.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/specialized_decoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "mahalanobis.hpp"
+
+/*
+ * Shapes instantiated in the library, X(dim, state_no, mix_no): the
+ * MFCC_E_D_A front-end (39) with the 13 states of the MATLAB training and
+ * every mixture count hmm_gmm_training.m produces. A build can instantiate
+ * others with -D'HMM_GMM_SPECIALIZED_SHAPES(X)=...'.
+ */
+#if !defined(HMM_GMM_SPECIALIZED_SHAPES)
+#define HMM_GMM_SPECIALIZED_SHAPES(X) \
+    X(39, 13, 1) X(39, 13, 2) X(39, 13, 3) X(39, 13, 4) X(39, 13, 8)
+#endif
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr std::size_t VECTOR_FLOATS = COMPILED_MODEL_ALIGNMENT / sizeof(float);
+
+constexpr std::size_t round_up(std::size_t value, std::size_t multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+/* Sizes as compile-time constants... */
+template <std::size_t Dim, std::size_t StateNo, std::size_t MixNo>
+struct fixed_shape
+{
+    static constexpr std::size_t dim = Dim;
+    static constexpr std::size_t stride = round_up(Dim, VECTOR_FLOATS);
+    static constexpr std::size_t lanes = round_up(Dim, 8);
+    static constexpr std::size_t state_no = StateNo;
+    static constexpr std::size_t mix_no = MixNo;
+    static constexpr std::size_t max_mix = MixNo;
+};
+
+/* ...or read from the model */
+struct runtime_shape
+{
+    std::size_t dim, stride, lanes, state_no, mix_no;
+    static constexpr std::size_t max_mix = specialized_decoder::MAX_GENERIC_MIX;
+};
+
+template <typename Shape>
+float log_emission(const Shape &shape, const compiled_model &model, std::size_t k, std::size_t j, const float *x)
+{
+    const float *log_w = model.log_weight(k, j);
+    const float *g = model.gconst(k, j);
+    const float *mu = model.mean(k, j, 0);
+    double y[Shape::max_mix];
+    double ymax = -std::numeric_limits<double>::infinity();
+    for (std::size_t m = 0; m < shape.mix_no; m++, mu += 2 * shape.stride)
+    {
+        /* compiled_model's kernel, so the sums are bit-identical; lanes ends at the last group holding a dimension */
+        y[m] = (double)log_w[m] + (double)g[m] -
+               0.5 * (double)kernels::mahalanobis_float32(x, mu, mu + shape.stride, shape.lanes);
+        ymax = (y[m] > ymax) ? y[m] : ymax;
+    }
+    if (shape.mix_no == 1 || std::isinf(ymax))
+    {
+        return (float)ymax;
+    }
+    double sum_exp = 0.0;
+    for (std::size_t m = 0; m < shape.mix_no; m++)
+    {
+        sum_exp += std::exp(y[m] - ymax);
+    }
+    return (float)(ymax + std::log(sum_exp));
+}
+
+/*******************************************************************************
+* Function Name: decode
+********************************************************************************
+* Summary:
+*  The recursion of viterbi_search() for all models at once, one frame at a
+*  time over two rows of model_no * state_no scores. A state's emission is
+*  computed only if a path reaches it, which also skips the states the
+*  first frames cannot reach yet.
+*
+* Parameters:
+*  shape:       sizes
+*  model:       float32 model set
+*  transitions: per model log_a[n * n], log_entry[n], log_exit[n]
+*  features:    the utterance
+*
+* Return:
+*  The best model and the scores of all models
+*
+*******************************************************************************/
+template <typename Shape>
+recognition_result decode(const Shape &shape, const compiled_model &model, const double *transitions,
+                          const feature_view &features)
+{
+    const double neg_inf = -std::numeric_limits<double>::infinity();
+    const std::size_t n = shape.state_no;
+    const std::size_t model_no = model.model_no();
+    const std::size_t block = n * n + 2 * n;
+    recognition_result result;
+    result.score = neg_inf;
+    result.scores.assign(model_no, neg_inf);
+    if (features.frame_no == 0)
+    {
+        return result;
+    }
+
+    std::vector<double> previous(model_no * n), current(model_no * n);
+    std::vector<float> x(shape.stride, 0.0f);
+    std::copy(features.frame(0), features.frame(0) + shape.dim, x.begin());
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        const double *log_entry = transitions + k * block + n * n;
+        for (std::size_t j = 0; j < n; j++)
+        {
+            previous[k * n + j] = (log_entry[j] > neg_inf)
+                                      ? log_entry[j] + (double)log_emission(shape, model, k, j, x.data())
+                                      : neg_inf;
+        }
+    }
+    for (std::size_t t = 1; t < features.frame_no; t++)
+    {
+        std::copy(features.frame(t), features.frame(t) + shape.dim, x.begin());
+        for (std::size_t k = 0; k < model_no; k++)
+        {
+            const double *log_a = transitions + k * block;
+            const double *from = &previous[k * n];
+            double *to = &current[k * n];
+            for (std::size_t j = 0; j < n; j++)
+            {
+                double f_max = neg_inf;
+                for (std::size_t i = 0; i <= j; i++)
+                {
+                    const double f = from[i] + log_a[i * n + j];
+                    f_max = (f > f_max) ? f : f_max;
+                }
+                to[j] = (f_max > neg_inf) ? f_max + (double)log_emission(shape, model, k, j, x.data()) : neg_inf;
+            }
+        }
+        previous.swap(current);
+    }
+
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        const double *log_exit = transitions + k * block + n * n + n;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            result.scores[k] = std::max(result.scores[k], previous[k * n + i] + log_exit[i]);
+        }
+        if (result.scores[k] > result.score)
+        {
+            result.score = result.scores[k];
+            result.model = (int)k;
+        }
+    }
+    return result;
+}
+
+template <std::size_t Dim, std::size_t StateNo, std::size_t MixNo>
+float fixed_emission(const compiled_model &model, std::size_t k, std::size_t j, const float *x)
+{
+    return log_emission(fixed_shape<Dim, StateNo, MixNo>{}, model, k, j, x);
+}
+
+template <std::size_t Dim, std::size_t StateNo, std::size_t MixNo>
+recognition_result fixed_decode(const compiled_model &model, const double *transitions, const feature_view &features)
+{
+    return decode(fixed_shape<Dim, StateNo, MixNo>{}, model, transitions, features);
+}
+
+runtime_shape shape_of(const compiled_model &model)
+{
+    return runtime_shape{model.dim(), model.stride(), (model.dim() + 7) / 8 * 8, model.state_no(), model.mix_no()};
+}
+
+float generic_emission(const compiled_model &model, std::size_t k, std::size_t j, const float *x)
+{
+    return log_emission(shape_of(model), model, k, j, x);
+}
+
+recognition_result generic_decode(const compiled_model &model, const double *transitions,
+                                  const feature_view &features)
+{
+    return decode(shape_of(model), model, transitions, features);
+}
+
+struct specialization
+{
+    model_shape shape;
+    float (*emission)(const compiled_model &, std::size_t, std::size_t, const float *);
+    recognition_result (*decode)(const compiled_model &, const double *, const feature_view &);
+};
+
+#define HMM_GMM_SPECIALIZATION(dim, state_no, mix_no) \
+    {{dim, state_no, mix_no}, &fixed_emission<dim, state_no, mix_no>, &fixed_decode<dim, state_no, mix_no>},
+
+const specialization SPECIALIZATIONS[] = {HMM_GMM_SPECIALIZED_SHAPES(HMM_GMM_SPECIALIZATION)};
+
+#undef HMM_GMM_SPECIALIZATION
+
+} /* namespace */
+
+
+const std::vector<model_shape> &specialized_shapes()
+{
+    static const std::vector<model_shape> shapes = [] {
+        std::vector<model_shape> list;
+        for (const specialization &s : SPECIALIZATIONS)
+        {
+            list.push_back(s.shape);
+        }
+        return list;
+    }();
+    return shapes;
+}
+
+
+specialized_decoder::specialized_decoder(const compiled_model &model, bool generic) : model_(&model)
+{
+    if (model.precision() != model_precision::float32)
+    {
+        throw std::invalid_argument("the specialized decoder needs a float32 model");
+    }
+    emission_ = &generic_emission;
+    decode_ = &generic_decode;
+    for (const specialization &s : SPECIALIZATIONS)
+    {
+        if (!generic && s.shape.dim == model.dim() && s.shape.state_no == model.state_no() &&
+            s.shape.mix_no == model.mix_no())
+        {
+            emission_ = s.emission;
+            decode_ = s.decode;
+            specialized_ = true;
+        }
+    }
+    if (!specialized_ && model.mix_no() > MAX_GENERIC_MIX)
+    {
+        throw std::invalid_argument("the specialized decoder takes at most 64 mixtures");
+    }
+
+    const std::size_t n = model.state_no();
+    const std::size_t node_no = model.node_no();
+    transitions_.resize(model.model_no() * (n * n + 2 * n));
+    double *out = transitions_.data();
+    for (std::size_t k = 0; k < model.model_no(); k++)
+    {
+        const float *a = model.log_transitions(k);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            for (std::size_t j = 0; j < n; j++)
+            {
+                out[i * n + j] = a[(i + 1) * node_no + j + 1];
+            }
+            out[n * n + i] = a[i + 1];
+            out[n * n + n + i] = a[(i + 1) * node_no + node_no - 1];
+        }
+        out += n * n + 2 * n;
+    }
+}
+
+
+recognition_result specialized_decoder::recognise(const feature_view &features) const
+{
+    if (features.dim != model_->dim())
+    {
+        throw std::invalid_argument("feature and model dimensions differ");
+    }
+    return decode_(*model_, transitions_.data(), features);
+}
+
+
+namespace
+{
+
+void write_float(std::ostream &out, float v)
+{
+    char text[32];
+    if (std::isinf(v))
+    {
+        out << (v < 0.0f ? "-INFINITY" : "INFINITY");
+        return;
+    }
+    /* 9 significant digits round-trip a float; integral values need a '.' before the suffix */
+    std::snprintf(text, sizeof(text), "%.9g", v);
+    out << text << (std::strpbrk(text, ".en") ? "f" : ".0f");
+}
+
+/* { v0, v1, ... } with 6 values per line at the given indent */
+void write_floats(std::ostream &out, const float *v, std::size_t n, const std::string &indent)
+{
+    out << "{";
+    for (std::size_t i = 0; i < n; i++)
+    {
+        out << ((i % 6 == 0) ? "\n" + indent + "    " : " ");
+        write_float(out, v[i]);
+        out << ((i + 1 < n) ? "," : "");
+    }
+    out << "\n" << indent << "}";
+}
+
+/* The decoder part of specialized_model.c; the sizes are the SPECIALIZED_* macros */
+const char *const SPECIALIZED_C_DECODER = R"(
+/***************************Global Variables*********************************/
+const specialized_model_info_t specialized_model_info =
+{
+    SPECIALIZED_DIM, SPECIALIZED_STATE_NO, SPECIALIZED_MIX_NO, SPECIALIZED_MODEL_NO
+};
+
+/* two rows of Viterbi scores in RAM */
+static float delta[2][SPECIALIZED_MODEL_NO][SPECIALIZED_STATE_NO];
+static uint32_t current_row;
+static uint32_t frame_no;
+
+/****************************************************************************/
+
+
+float specialized_model_log_emission(uint32_t model_index, uint32_t state, const float *frame)
+{
+    const specialized_state_t *s = &specialized_states[model_index][state];
+    float y[SPECIALIZED_MIX_NO];
+    float ymax = -INFINITY;
+    float sum_exp = 0.0f;
+    uint32_t m;
+    uint32_t d;
+
+    for (m = 0u; m < SPECIALIZED_MIX_NO; m++)
+    {
+        /* two accumulators so consecutive VFMA instructions of the CM4 do not wait on each other */
+        float acc0 = 0.0f;
+        float acc1 = 0.0f;
+        for (d = 0u; d + 1u < SPECIALIZED_DIM; d += 2u)
+        {
+            const float diff0 = frame[d] - s->mean[m][d];
+            const float diff1 = frame[d + 1u] - s->mean[m][d + 1u];
+            acc0 += diff0 * diff0 * s->ivar[m][d];
+            acc1 += diff1 * diff1 * s->ivar[m][d + 1u];
+        }
+        if ((SPECIALIZED_DIM & 1u) != 0u)
+        {
+            const float diff = frame[SPECIALIZED_DIM - 1u] - s->mean[m][SPECIALIZED_DIM - 1u];
+            acc0 += diff * diff * s->ivar[m][SPECIALIZED_DIM - 1u];
+        }
+        y[m] = s->log_weight[m] + s->gconst[m] - 0.5f * (acc0 + acc1);
+        if (y[m] > ymax)
+        {
+            ymax = y[m];
+        }
+    }
+    if (isinf(ymax))
+    {
+        return ymax;
+    }
+    for (m = 0u; m < SPECIALIZED_MIX_NO; m++)
+    {
+        sum_exp += expf(y[m] - ymax);
+    }
+    return ymax + logf(sum_exp);
+}
+
+
+void specialized_model_reset(void)
+{
+    current_row = 0u;
+    frame_no = 0u;
+}
+
+
+void specialized_model_push_frame(const float *frame)
+{
+    const uint32_t from = current_row;
+    const uint32_t to = current_row ^ 1u;
+    uint32_t k;
+    uint32_t i;
+    uint32_t j;
+
+    for (k = 0u; k < SPECIALIZED_MODEL_NO; k++)
+    {
+        for (j = 0u; j < SPECIALIZED_STATE_NO; j++)
+        {
+            float f_max = -INFINITY;
+            if (frame_no == 0u)
+            {
+                f_max = specialized_log_entry[k][j];
+            }
+            else
+            {
+                for (i = 0u; i <= j; i++)
+                {
+                    const float f = delta[from][k][i] + specialized_log_a[k][i][j];
+                    f_max = (f > f_max) ? f : f_max;
+                }
+            }
+            delta[to][k][j] = (f_max > -INFINITY) ? f_max + specialized_model_log_emission(k, j, frame) : -INFINITY;
+        }
+    }
+    current_row = to;
+    frame_no++;
+}
+
+
+void specialized_model_partial_scores(float *scores)
+{
+    uint32_t k;
+    uint32_t i;
+
+    for (k = 0u; k < SPECIALIZED_MODEL_NO; k++)
+    {
+        float fopt = -INFINITY;
+        for (i = 0u; (i < SPECIALIZED_STATE_NO) && (frame_no > 0u); i++)
+        {
+            const float f = delta[current_row][k][i] + specialized_log_exit[k][i];
+            fopt = (f > fopt) ? f : fopt;
+        }
+        scores[k] = fopt;
+    }
+}
+
+
+int32_t specialized_model_result(float *score)
+{
+    float scores[SPECIALIZED_MODEL_NO];
+    float best = -INFINITY;
+    int32_t best_model = -1;
+    uint32_t k;
+
+    specialized_model_partial_scores(scores);
+    for (k = 0u; k < SPECIALIZED_MODEL_NO; k++)
+    {
+        if (scores[k] > best)
+        {
+            best = scores[k];
+            best_model = (int32_t)k;
+        }
+    }
+    if (score != NULL)
+    {
+        *score = best;
+    }
+    return best_model;
+}
+
+/* [] END OF FILE */
+)";
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: write_specialized_c_source
+********************************************************************************
+* Summary:
+*  Emits the sizes as macros, the state blocks (log weights, gconst, means
+*  and inverse variances without the stride padding) and the transitions
+*  between emitting states as const arrays, followed by the decoder, whose
+*  loop bounds are the macros. Scores are float, as on the CM4.
+*
+* Parameters:
+*  filename: C file to write
+*  model:    float32 compiled model
+*
+*******************************************************************************/
+void write_specialized_c_source(const std::string &filename, const compiled_model &model)
+{
+    if (model.precision() != model_precision::float32)
+    {
+        throw std::invalid_argument("specialized C sources are generated from float32 models");
+    }
+    std::ofstream out(filename, std::ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error("cannot create " + filename);
+    }
+    const std::size_t n = model.state_no();
+    const std::size_t node_no = model.node_no();
+    out << "/* Generated by hmm_gmm_compile_model --specialized-c. Do not edit. */\n"
+        << "/* " << model.model_no() << " models, " << n << " states, " << model.mix_no() << " mixtures, dim "
+        << model.dim() << " */\n"
+        << "#include \"specialized_model.h\"\n\n"
+        << "#include <math.h>\n#include <stddef.h>\n\n"
+        << "/***************************Macro Declarations*******************************/\n"
+        << "#define SPECIALIZED_DIM         (" << model.dim() << "u)\n"
+        << "#define SPECIALIZED_STATE_NO    (" << n << "u)\n"
+        << "#define SPECIALIZED_MIX_NO      (" << model.mix_no() << "u)\n"
+        << "#define SPECIALIZED_MODEL_NO    (" << model.model_no() << "u)\n\n"
+        << "/****************************************************************************/\n\n"
+        << "/***************************Type Definitions*********************************/\n"
+        << "typedef struct\n{\n"
+        << "    float log_weight[SPECIALIZED_MIX_NO];\n"
+        << "    float gconst[SPECIALIZED_MIX_NO];\n"
+        << "    float mean[SPECIALIZED_MIX_NO][SPECIALIZED_DIM];\n"
+        << "    float ivar[SPECIALIZED_MIX_NO][SPECIALIZED_DIM];\n"
+        << "} specialized_state_t;\n\n"
+        << "/****************************************************************************/\n\n"
+        << "/***************************Model Constants**********************************/\n"
+        << "static const specialized_state_t specialized_states[SPECIALIZED_MODEL_NO][SPECIALIZED_STATE_NO] =\n{";
+
+    std::vector<float> row;
+    for (std::size_t k = 0; k < model.model_no(); k++)
+    {
+        out << (k ? "," : "") << "\n    {";
+        for (std::size_t j = 0; j < n; j++)
+        {
+            out << (j ? "," : "") << "\n        {\n            ";
+            write_floats(out, model.log_weight(k, j), model.mix_no(), "            ");
+            out << ",\n            ";
+            write_floats(out, model.gconst(k, j), model.mix_no(), "            ");
+            for (const bool ivar : {false, true})
+            {
+                out << ",\n            {";
+                for (std::size_t m = 0; m < model.mix_no(); m++)
+                {
+                    out << (m ? "," : "") << "\n                ";
+                    write_floats(out, ivar ? model.ivar(k, j, m) : model.mean(k, j, m), model.dim(),
+                                 "                ");
+                }
+                out << "\n            }";
+            }
+            out << "\n        }";
+        }
+        out << "\n    }";
+    }
+    out << "\n};\n";
+
+    const char *names[] = {"specialized_log_a", "specialized_log_entry", "specialized_log_exit"};
+    for (int table = 0; table < 3; table++)
+    {
+        out << "\nstatic const float " << names[table] << "[SPECIALIZED_MODEL_NO][SPECIALIZED_STATE_NO]"
+            << (table == 0 ? "[SPECIALIZED_STATE_NO]" : "") << " =\n{";
+        for (std::size_t k = 0; k < model.model_no(); k++)
+        {
+            const float *a = model.log_transitions(k);
+            out << (k ? "," : "") << "\n    ";
+            if (table == 0)
+            {
+                out << "{";
+                for (std::size_t i = 0; i < n; i++)
+                {
+                    out << (i ? "," : "") << "\n        ";
+                    write_floats(out, a + (i + 1) * node_no + 1, n, "        ");
+                }
+                out << "\n    }";
+                continue;
+            }
+            row.resize(n);
+            for (std::size_t i = 0; i < n; i++)
+            {
+                row[i] = (table == 1) ? a[i + 1] : a[(i + 1) * node_no + node_no - 1];
+            }
+            write_floats(out, row.data(), n, "    ");
+        }
+        out << "\n};\n";
+    }
+    out << "\n/****************************************************************************/\n"
+        << SPECIALIZED_C_DECODER;
+    if (!out)
+    {
+        throw std::runtime_error("cannot write " + filename);
+    }
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
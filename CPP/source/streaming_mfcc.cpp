@@ -0,0 +1,170 @@
+/******************************************************************************
+* File Name:   streaming_mfcc.cpp
+*
+* Description: Frame-incremental MFCC_E_D_A front-end, see streaming_mfcc.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/streaming_mfcc.hpp"
+
+#include <algorithm>
+
+namespace hmm_gmm
+{
+
+streaming_mfcc::streaming_mfcc(const mfcc_config &config)
+    : extractor_(config),
+      sdim_(config.static_dim()),
+      win_((std::size_t)config.delta_win),
+      ring_(4 * (std::size_t)config.delta_win + 2),
+      frame_size_(config.frame_size()),
+      frame_shift_(config.frame_shift()),
+      statics_(ring_ * config.static_dim()),
+      deltas_(ring_ * config.static_dim())
+{
+    pending_.reserve(2 * frame_size_);
+}
+
+
+void streaming_mfcc::reset()
+{
+    pending_.clear();
+    previous_sample_ = 0.0f;
+    skip_ = 0;
+    statics_done_ = 0;
+    deltas_done_ = 0;
+    emitted_ = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: push
+********************************************************************************
+* Summary:
+*  Appends the chunk to the pending samples, computes the static vector of
+*  every complete frame and drops the samples no later frame overlaps. With
+*  frame_shift > frame_size the next frame starts after the pending samples;
+*  the gap is dropped from the following chunks.
+*
+* Parameters:
+*  samples:     new PCM samples (int16 scale)
+*  num_samples: chunk length, may be 0
+*  out:         receives the finished vectors
+*
+* Return:
+*  number of vectors appended to out
+*
+*******************************************************************************/
+std::size_t streaming_mfcc::push(const float *samples, std::size_t num_samples, std::vector<float> &out)
+{
+    if (skip_ > 0 && num_samples > 0)
+    {
+        const std::size_t dropped = std::min(skip_, num_samples);
+        previous_sample_ = samples[dropped - 1];
+        samples += dropped;
+        num_samples -= dropped;
+        skip_ -= dropped;
+    }
+    pending_.insert(pending_.end(), samples, samples + num_samples);
+
+    std::size_t emitted = 0;
+    std::size_t pos = 0;
+    while (pos + frame_size_ <= pending_.size())
+    {
+        const float previous = (pos == 0) ? previous_sample_ : pending_[pos - 1];
+        extractor_.compute_static_frame(&pending_[pos], previous, static_at(statics_done_));
+        statics_done_++;
+        emitted += advance(false, out);
+        pos += frame_shift_;
+    }
+
+    if (pos > 0)
+    {
+        const std::size_t consumed = std::min(pos, pending_.size());
+        skip_ = pos - consumed;
+        previous_sample_ = pending_[consumed - 1];
+        pending_.erase(pending_.begin(), pending_.begin() + (std::ptrdiff_t)consumed);
+    }
+    return emitted;
+}
+
+
+std::size_t streaming_mfcc::finish(std::vector<float> &out)
+{
+    const std::size_t emitted = advance(true, out);
+    reset();
+    return emitted;
+}
+
+
+/*******************************************************************************
+* Function Name: advance
+********************************************************************************
+* Summary:
+*  Computes every delta and delta-delta whose regression window is complete.
+*  Frames before the first one take its value, as slope() does; at the end
+*  of the utterance (final) frames after the last one take its value.
+*
+* Parameters:
+*  final: true once no more samples will arrive
+*  out:   receives the finished vectors
+*
+* Return:
+*  number of vectors appended to out
+*
+*******************************************************************************/
+std::size_t streaming_mfcc::advance(bool final, std::vector<float> &out)
+{
+    const std::vector<double> &w = extractor_.delta_weights();
+    const long win = (long)win_;
+
+    while (deltas_done_ < statics_done_ && (final || deltas_done_ + win_ < statics_done_))
+    {
+        const long t = (long)deltas_done_;
+        const long last = (long)statics_done_ - 1;
+        double *d = delta_at(deltas_done_);
+        std::fill(d, d + sdim_, 0.0);
+        for (long k = -win; k <= win; k++)
+        {
+            const double *s = static_at((std::size_t)std::clamp(t + k, 0L, last));
+            for (std::size_t i = 0; i < sdim_; i++)
+            {
+                d[i] += w[(std::size_t)(k + win)] * s[i];
+            }
+        }
+        deltas_done_++;
+    }
+
+    std::size_t emitted = 0;
+    while (emitted_ < deltas_done_ && (final || emitted_ + win_ < deltas_done_))
+    {
+        const long t = (long)emitted_;
+        const long last = (long)deltas_done_ - 1;
+        const std::size_t base = out.size();
+        out.resize(base + 3 * sdim_);
+        float *dst = &out[base];
+
+        const double *s = static_at(emitted_);
+        const double *d = delta_at(emitted_);
+        for (std::size_t i = 0; i < sdim_; i++)
+        {
+            dst[i] = (float)s[i];
+            dst[sdim_ + i] = (float)d[i];
+        }
+        for (std::size_t i = 0; i < sdim_; i++)
+        {
+            double acc = 0.0;
+            for (long k = -win; k <= win; k++)
+            {
+                acc += w[(std::size_t)(k + win)] * delta_at((std::size_t)std::clamp(t + k, 0L, last))[i];
+            }
+            dst[2 * sdim_ + i] = (float)acc;
+        }
+        emitted_++;
+        emitted++;
+    }
+    return emitted;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
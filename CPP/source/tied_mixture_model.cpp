@@ -0,0 +1,269 @@
+/******************************************************************************
+* File Name:   tied_mixture_model.cpp
+*
+* Description: Tied-mixture word models, see tied_mixture_model.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/tied_mixture_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "hmm_gmm/mat_file.hpp"
+
+#include "mahalanobis.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr std::size_t VECTOR_FLOATS = 16;
+
+/* Size along dimension i; MATLAB drops trailing singleton dimensions */
+std::size_t dim_or_one(const mat_array &a, std::size_t i)
+{
+    return (i < a.dims.size()) ? a.dims[i] : 1;
+}
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: read_tied_mixture_mat
+********************************************************************************
+* Summary:
+*  Reads the HMM struct of a tied-mixture model set. The pool is stored
+*  Gaussian-major as in MATLAB; weight and Aij are transposed to row-major.
+*
+* Parameters:
+*  filename: HMM_tied_<iter>.mat
+*  var_name: name of the struct variable
+*
+* Return:
+*  The model set
+*
+*******************************************************************************/
+tied_mixture_set read_tied_mixture_mat(const std::string &filename, const std::string &var_name)
+{
+    const mat_array hmm = read_mat_variable(filename, var_name);
+    const mat_array &mean = hmm.field("pool_mean");
+    const mat_array &var = hmm.field("pool_var");
+    const mat_array &weight = hmm.field("weight");
+    const mat_array &aij = hmm.field("Aij");
+    if (!mean.is_numeric() || !var.is_numeric() || !weight.is_numeric() || !aij.is_numeric())
+    {
+        throw std::runtime_error("non numeric tied-mixture HMM fields in " + filename);
+    }
+
+    tied_mixture_set set;
+    set.dim = dim_or_one(mean, 0);
+    set.pool_size = dim_or_one(mean, 1);
+    set.state_no = dim_or_one(weight, 0);
+    set.model_no = dim_or_one(weight, 2);
+    const std::size_t node_no = set.node_no();
+    if (var.dims != mean.dims || dim_or_one(weight, 1) != set.pool_size ||
+        aij.numel() != node_no * node_no * set.model_no || dim_or_one(aij, 0) != node_no)
+    {
+        throw std::runtime_error("inconsistent tied-mixture HMM field sizes in " + filename);
+    }
+
+    set.pool_mean = mean.real;
+    set.pool_var = var.real;
+    set.weight.resize(set.model_no * set.state_no * set.pool_size);
+    set.aij.resize(set.model_no * node_no * node_no);
+    for (std::size_t k = 0; k < set.model_no; k++)
+    {
+        for (std::size_t s = 0; s < set.state_no; s++)
+        {
+            for (std::size_t p = 0; p < set.pool_size; p++)
+            {
+                set.weight[(k * set.state_no + s) * set.pool_size + p] =
+                    weight.real[s + set.state_no * (p + set.pool_size * k)];
+            }
+        }
+        for (std::size_t i = 0; i < node_no; i++)
+        {
+            for (std::size_t j = 0; j < node_no; j++)
+            {
+                set.aij[(k * node_no + i) * node_no + j] = aij.real[i + node_no * (j + node_no * k)];
+            }
+        }
+    }
+    return set;
+}
+
+
+void write_tied_mixture_mat(const std::string &filename, const tied_mixture_set &set, const std::string &var_name)
+{
+    const std::size_t node_no = set.node_no();
+    std::vector<double> weight(set.weight.size());
+    std::vector<double> aij(set.aij.size());
+    for (std::size_t k = 0; k < set.model_no; k++)
+    {
+        for (std::size_t s = 0; s < set.state_no; s++)
+        {
+            for (std::size_t p = 0; p < set.pool_size; p++)
+            {
+                weight[s + set.state_no * (p + set.pool_size * k)] =
+                    set.weight[(k * set.state_no + s) * set.pool_size + p];
+            }
+        }
+        for (std::size_t i = 0; i < node_no; i++)
+        {
+            for (std::size_t j = 0; j < node_no; j++)
+            {
+                aij[i + node_no * (j + node_no * k)] = set.aij[(k * node_no + i) * node_no + j];
+            }
+        }
+    }
+
+    mat_array s;
+    s.name = var_name;
+    s.type = mat_class::structure;
+    s.dims = {1, 1};
+    s.field_names = {"pool_mean", "pool_var", "Aij", "weight"};
+    s.elements.push_back(make_mat_numeric("", {set.dim, set.pool_size}, set.pool_mean));
+    s.elements.push_back(make_mat_numeric("", {set.dim, set.pool_size}, set.pool_var));
+    s.elements.push_back(make_mat_numeric("", {node_no, node_no, set.model_no}, std::move(aij)));
+    s.elements.push_back(make_mat_numeric("", {set.state_no, set.pool_size, set.model_no}, std::move(weight)));
+    write_mat_file(filename, {s});
+}
+
+
+/*******************************************************************************
+* Function Name: tied_mixture_model
+********************************************************************************
+* Summary:
+*  Packs the pool like the state blocks of compiled_model (mean / ivar
+*  vectors zero padded to 16 floats, gconst computed in double) and the log
+*  weights pool-major, so that combining one pool Gaussian touches one
+*  contiguous row of all states.
+*
+* Parameters:
+*  set: model set
+*
+*******************************************************************************/
+tied_mixture_model::tied_mixture_model(const tied_mixture_set &set)
+    : dim_(set.dim), stride_((set.dim + VECTOR_FLOATS - 1) / VECTOR_FLOATS * VECTOR_FLOATS),
+      pool_size_(set.pool_size), state_no_(set.state_no), model_no_(set.model_no)
+{
+    if (dim_ == 0 || pool_size_ == 0 || state_no_ == 0 || model_no_ == 0)
+    {
+        throw std::invalid_argument("cannot use an empty tied-mixture model set");
+    }
+    const double log_2pi = std::log(2.0 * std::acos(-1.0));
+    pool_.assign(pool_size_ * 2 * stride_, 0.0f);
+    gconst_.resize(pool_size_);
+    for (std::size_t p = 0; p < pool_size_; p++)
+    {
+        double log_det = 0.0;
+        for (std::size_t d = 0; d < dim_; d++)
+        {
+            const double var = set.pool_var[p * dim_ + d];
+            if (!(var > 0.0))
+            {
+                throw std::invalid_argument("variances must be positive");
+            }
+            log_det += std::log(var);
+            pool_[2 * p * stride_ + d] = (float)set.pool_mean[p * dim_ + d];
+            pool_[(2 * p + 1) * stride_ + d] = (float)(1.0 / var);
+        }
+        gconst_[p] = (float)(-0.5 * (dim_ * log_2pi + log_det));
+    }
+
+    log_weight_.resize(pool_size_ * state_count());
+    for (std::size_t j = 0; j < state_count(); j++)
+    {
+        for (std::size_t p = 0; p < pool_size_; p++)
+        {
+            log_weight_[p * state_count() + j] = (float)std::log(set.weight[j * pool_size_ + p]);
+        }
+    }
+    transitions_.resize(set.aij.size());
+    for (std::size_t i = 0; i < set.aij.size(); i++)
+    {
+        transitions_[i] = (float)std::log(set.aij[i]);
+    }
+}
+
+
+void tied_mixture_model::score_pool(const float *x, float *pool_scores) const
+{
+    for (std::size_t p = 0; p < pool_size_; p++)
+    {
+        const float *mu = &pool_[2 * p * stride_];
+        pool_scores[p] = gconst_[p] - 0.5f * kernels::mahalanobis_float32(x, mu, mu + stride_, stride_);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: score_states
+********************************************************************************
+* Summary:
+*  log b_j = log sum_p w_jp N_p over the combined pool Gaussians, with the
+*  max-subtraction of log_hmm_gmm(): a max pass and an exp-sum pass, each
+*  over the weight rows of the combined Gaussians, i.e. over all states at
+*  once.
+*
+* Parameters:
+*  pool_scores: score_pool() of the frame
+*  top_k:       pool Gaussians combined, the best of the frame; 0 = all
+*  out:         state_count() log-likelihoods
+*  workspace:   scratch
+*
+*******************************************************************************/
+void tied_mixture_model::score_states(const float *pool_scores, std::size_t top_k, float *out,
+                                      tied_mixture_workspace &workspace) const
+{
+    const std::size_t states = state_count();
+    const std::size_t used = (top_k == 0 || top_k > pool_size_) ? pool_size_ : top_k;
+    std::vector<uint32_t> &order = workspace.order;
+    order.resize(pool_size_);
+    for (std::size_t p = 0; p < pool_size_; p++)
+    {
+        order[p] = (uint32_t)p;
+    }
+    if (used < pool_size_)
+    {
+        std::nth_element(order.begin(), order.begin() + used, order.end(),
+                         [&](uint32_t a, uint32_t b) { return pool_scores[a] > pool_scores[b]; });
+    }
+
+    std::fill(out, out + states, -std::numeric_limits<float>::infinity());
+    for (std::size_t r = 0; r < used; r++)
+    {
+        const float *log_w = &log_weight_[order[r] * states];
+        const float n = pool_scores[order[r]];
+        for (std::size_t j = 0; j < states; j++)
+        {
+            out[j] = std::max(out[j], log_w[j] + n);
+        }
+    }
+    std::vector<float> &sum = workspace.sum;
+    sum.assign(states, 0.0f);
+    for (std::size_t r = 0; r < used; r++)
+    {
+        const float *log_w = &log_weight_[order[r] * states];
+        const float n = pool_scores[order[r]];
+        for (std::size_t j = 0; j < states; j++)
+        {
+            sum[j] += std::isinf(out[j]) ? 0.0f : std::exp(log_w[j] + n - out[j]);
+        }
+    }
+    for (std::size_t j = 0; j < states; j++)
+    {
+        if (!std::isinf(out[j]))
+        {
+            out[j] += std::log(sum[j]);
+        }
+    }
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
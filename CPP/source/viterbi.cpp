@@ -0,0 +1,805 @@
+/******************************************************************************
+* File Name:   viterbi.cpp
+*
+* Description: Reference Viterbi decoder, see viterbi.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/viterbi.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "hmm_gmm/sparse_transitions.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+/* Backpointer of a state without predecessor: unreachable, or the first frame */
+constexpr std::uint8_t NO_PREDECESSOR = 0xFF;
+
+/*******************************************************************************
+* Function Name: viterbi_search
+********************************************************************************
+* Summary:
+*  fjt(j, t) = max_{i <= j} fjt(i, t-1) + log aij(i, j) + log b_j(o_t), with
+*  fjt(j, 1) = log aij(START, j) + log b_j(o_1) and
+*  fopt = max_i fjt(i, T) + log aij(i, END). Emissions are computed once per
+*  state and frame, in increasing frame order; the strict '>' keeps the first
+*  maximum like the MATLAB code.
+*
+*  Only the predecessor lists are visited, and a state outside the feasible
+*  band of the frame (see sparse_transitions) is set to -Inf without reading
+*  its emission. No complete path runs through such a state, so fopt and the
+*  alignment are those of the dense search.
+*
+* Parameters:
+*  s:         the model's transitions
+*  frame_no:  observation frames
+*  emission:  emission(j, t) = log b_j(o_t)
+*  alignment: optional, receives the best state sequence
+*
+* Return:
+*  fopt
+*
+* Two rows of n scores are kept. The best predecessors are stored only when
+* the alignment is asked for, one byte per state and frame, and the state
+* sequence is recovered by traceback from the best final state; without
+* alignment the search is score-only. Throws std::invalid_argument if an
+* alignment is asked for a model of more than MAX_ALIGNED_STATES states.
+*
+*******************************************************************************/
+template <typename Emission>
+double viterbi_search(const sparse_transitions &s, std::size_t frame_no, Emission emission,
+                      std::vector<int> *alignment)
+{
+    const double neg_inf = -std::numeric_limits<double>::infinity();
+    const std::size_t n = s.n;
+    if (frame_no == 0)
+    {
+        if (alignment)
+        {
+            alignment->clear();
+        }
+        return neg_inf;
+    }
+
+    if (alignment && n > MAX_ALIGNED_STATES)
+    {
+        throw std::invalid_argument("state alignments support at most 255 emitting states");
+    }
+    std::vector<double> previous(n), current(n);
+    std::vector<std::uint8_t> back;
+    if (alignment)
+    {
+        back.assign(frame_no * n, NO_PREDECESSOR);
+    }
+
+    for (std::size_t j = 0; j < n; j++)
+    {
+        const bool active = s.earliest[j] == 0 && s.to_end[j] <= frame_no - 1;
+        previous[j] = active ? s.log_entry[j] + emission(j, 0) : neg_inf;
+    }
+    for (std::size_t t = 1; t < frame_no; t++)
+    {
+        const std::size_t remaining = frame_no - 1 - t;
+        for (std::size_t j = 0; j < n; j++)
+        {
+            if (s.earliest[j] > t || s.to_end[j] > remaining)
+            {
+                current[j] = neg_inf;
+                continue;
+            }
+            double f_max = neg_inf;
+            int i_max = -1;
+            for (std::size_t p = s.first[j]; p < s.first[j + 1]; p++)
+            {
+                const std::size_t i = s.pred[p];
+                if (previous[i] > neg_inf)
+                {
+                    const double f = previous[i] + s.log_a[p];
+                    if (f > f_max)
+                    {
+                        f_max = f;
+                        i_max = (int)i;
+                    }
+                }
+            }
+            current[j] = (i_max >= 0) ? f_max + emission(j, t) : neg_inf;
+            if (alignment && i_max >= 0)
+            {
+                back[t * n + j] = (std::uint8_t)i_max;
+            }
+        }
+        previous.swap(current);
+    }
+
+    double fopt = neg_inf;
+    int iopt = -1;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double f = previous[i] + s.log_exit[i];
+        if (f > fopt)
+        {
+            fopt = f;
+            iopt = (int)i;
+        }
+    }
+
+    if (alignment)
+    {
+        alignment->assign(frame_no, -1);
+        int state = iopt;
+        for (std::size_t t = frame_no; t-- > 0 && state >= 0;)
+        {
+            (*alignment)[t] = state;
+            const std::uint8_t i = (t > 0) ? back[t * n + state] : NO_PREDECESSOR;
+            state = (i == NO_PREDECESSOR) ? -1 : (int)i;
+        }
+    }
+    return fopt;
+}
+
+} /* namespace */
+
+
+double viterbi_decode(const hmm_model &model, const feature_view &features, std::vector<int> *alignment)
+{
+    sparse_transitions s;
+    build_sparse_transitions(model.state_no,
+                             [&](std::size_t i, std::size_t j) { return std::log(model.transition(i, j)); }, s);
+    return viterbi_search(s, features.frame_no,
+                          [&](std::size_t j, std::size_t t) { return model.log_emission(j, features.frame(t)); },
+                          alignment);
+}
+
+
+
+double viterbi_decode(const compiled_model &model, std::size_t model_index, const feature_view &features,
+                      std::vector<int> *alignment)
+{
+    emission_cache cache(model);
+    cache.reset(features);
+    return viterbi_decode(cache, model_index, alignment);
+}
+
+
+double viterbi_decode(emission_cache &cache, std::size_t model_index, std::vector<int> *alignment)
+{
+    sparse_transitions s;
+    compiled_transitions(cache.model(), model_index, s);
+    return viterbi_search(s, cache.frame_no(),
+                          [&](std::size_t j, std::size_t t) { return (double)cache(model_index, j, t); },
+                          alignment);
+}
+
+
+double viterbi_decode(const compiled_model &model, std::size_t model_index, const float *state_scores,
+                      std::size_t score_stride, std::size_t frame_no, std::vector<int> *alignment)
+{
+    sparse_transitions s;
+    compiled_transitions(model, model_index, s);
+    const float *scores = state_scores + model_index * model.state_no();
+    return viterbi_search(s, frame_no,
+                          [&](std::size_t j, std::size_t t) { return (double)scores[t * score_stride + j]; },
+                          alignment);
+}
+
+
+recognition_result recognise(emission_cache &cache, const feature_view &features)
+{
+    cache.reset(features);
+    const std::size_t model_no = cache.model().model_no();
+    recognition_result result;
+    result.score = -std::numeric_limits<double>::infinity();
+    result.scores.resize(model_no);
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        result.scores[k] = viterbi_decode(cache, k);
+        if (result.scores[k] > result.score)
+        {
+            result.score = result.scores[k];
+            result.model = (int)k;
+        }
+    }
+    return result;
+}
+
+
+namespace
+{
+
+/*
+ * The transitions of model model_index over skip frames: entry and exit as
+ * in the node table, and between emitting states the skip-step
+ * probabilities (A_e)^skip of the emitting submatrix A_e, the aij^dt of
+ * hmm_gmm_testing.m (START has no predecessor and END no successor, so no
+ * path of A^skip between emitting states passes through them).
+ */
+void skip_transitions(const compiled_model &model, std::size_t model_index, std::size_t skip, sparse_transitions &s)
+{
+    const std::size_t n = model.state_no();
+    const std::size_t node_no = n + 2;
+    const float *a = model.log_transitions(model_index);
+    std::vector<double> step(n * n), power(n * n), product(n * n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j < n; j++)
+        {
+            step[i * n + j] = std::exp((double)a[(i + 1) * node_no + j + 1]);
+        }
+    }
+    power = step;
+    for (std::size_t r = 1; r < skip; r++)
+    {
+        std::fill(product.begin(), product.end(), 0.0);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            for (std::size_t m = 0; m < n; m++)
+            {
+                for (std::size_t j = 0; j < n; j++)
+                {
+                    product[i * n + j] += power[i * n + m] * step[m * n + j];
+                }
+            }
+        }
+        power.swap(product);
+    }
+    build_sparse_transitions(n,
+                             [&](std::size_t i, std::size_t j) {
+                                 if (i == 0 || j == n + 1)
+                                 {
+                                     return (double)a[i * node_no + j];
+                                 }
+                                 return std::log(power[(i - 1) * n + j - 1]);
+                             },
+                             s);
+}
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: recognise_frame_skip
+********************************************************************************
+* Summary:
+*  Searches frames 0, skip, 2 skip, ... of the utterance with the skip-step
+*  transitions between them. Only their emissions are read, so a lazy cache
+*  scores 1 / skip of the matrix. Each searched emission stands for the
+*  skip frames up to the next one and is weighted by skip.
+*
+* Parameters:
+*  cache:    emission cache of the model set
+*  features: the utterance
+*  skip:     1 searches every frame (recognise())
+*
+* Return:
+*  The best model and the scores of all models
+*
+*******************************************************************************/
+recognition_result recognise_frame_skip(emission_cache &cache, const feature_view &features, std::size_t skip)
+{
+    if (skip == 0)
+    {
+        throw std::invalid_argument("the frame skip factor must be at least 1");
+    }
+    cache.reset(features);
+    const std::size_t model_no = cache.model().model_no();
+    const std::size_t frame_no = (cache.frame_no() + skip - 1) / skip;
+    const double weight = (double)skip;
+    sparse_transitions s;
+    recognition_result result;
+    result.score = -std::numeric_limits<double>::infinity();
+    result.scores.resize(model_no);
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        skip_transitions(cache.model(), k, skip, s);
+        result.scores[k] = viterbi_search(s, frame_no,
+                                          [&](std::size_t j, std::size_t t) {
+                                              return weight * cache(k, j, t * skip);
+                                          },
+                                          nullptr);
+        if (result.scores[k] > result.score)
+        {
+            result.score = result.scores[k];
+            result.model = (int)k;
+        }
+    }
+    return result;
+}
+
+
+recognition_result recognise(const compiled_model &model, const feature_view &features)
+{
+    emission_cache cache(model);
+    return recognise(cache, features);
+}
+
+
+/*******************************************************************************
+* Function Name: recognise
+********************************************************************************
+* Summary:
+*  Tied-mixture models: the pool is scored once per frame and combined into
+*  the state log-likelihoods of every model (frame-major, as the bulk
+*  emission cache), then the searches of all models read them.
+*
+* Parameters:
+*  model:    tied-mixture model set
+*  features: the utterance
+*  top_k:    pool Gaussians combined per frame, 0 = all
+*
+* Return:
+*  The best model and the scores of all models
+*
+*******************************************************************************/
+recognition_result recognise(const tied_mixture_model &model, const feature_view &features, std::size_t top_k)
+{
+    if (features.dim != model.dim())
+    {
+        throw std::invalid_argument("feature and model dimensions differ");
+    }
+    const std::size_t states = model.state_count();
+    std::vector<float> x(model.stride(), 0.0f), pool_scores(model.pool_size());
+    std::vector<float> scores(features.frame_no * states);
+    tied_mixture_workspace workspace;
+    for (std::size_t t = 0; t < features.frame_no; t++)
+    {
+        std::copy(features.frame(t), features.frame(t) + features.dim, x.begin());
+        model.score_pool(x.data(), pool_scores.data());
+        model.score_states(pool_scores.data(), top_k, &scores[t * states], workspace);
+    }
+
+    const std::size_t n = model.state_no();
+    sparse_transitions s;
+    recognition_result result;
+    result.score = -std::numeric_limits<double>::infinity();
+    result.scores.resize(model.model_no());
+    for (std::size_t k = 0; k < model.model_no(); k++)
+    {
+        emitting_transitions(model.log_transitions(k), n, s);
+        const float *model_scores = &scores[k * n];
+        result.scores[k] = viterbi_search(s, features.frame_no,
+                                          [&](std::size_t j, std::size_t t) {
+                                              return (double)model_scores[t * states + j];
+                                          },
+                                          nullptr);
+        if (result.scores[k] > result.score)
+        {
+            result.score = result.scores[k];
+            result.model = (int)k;
+        }
+    }
+    return result;
+}
+
+
+recognition_result recognise(const compiled_model &model, const gaussian_scorer &scorer,
+                             const feature_view &features, log_add_tier tier)
+{
+    emission_cache cache(model, scorer, tier);
+    return recognise(cache, features);
+}
+
+
+namespace
+{
+
+/*******************************************************************************
+* Function Name: prune_frame
+********************************************************************************
+* Summary:
+*  Beam and histogram pruning of one frame of the lockstep search: drops
+*  the states below best - beam, then, above max_active survivors, the
+*  states below the max_active-th best score; of the states tied with it
+*  the first ones in model and state order are kept.
+*
+* Parameters:
+*  row:     model_no * n state scores of the frame, -Inf = inactive
+*  n:       states per model
+*  config:  beam and cap
+*  sorted:  scratch
+*  active:  receives, per model, whether a state survived
+*
+* Return:
+*  Number of active states
+*
+*******************************************************************************/
+std::size_t prune_frame(std::vector<double> &row, std::size_t n, const beam_config &config,
+                        std::vector<double> &sorted, std::vector<char> &active)
+{
+    const double neg_inf = -std::numeric_limits<double>::infinity();
+    const double best = *std::max_element(row.begin(), row.end());
+    const double threshold = best - config.beam;
+    sorted.clear();
+    for (double &f : row)
+    {
+        if (f < threshold)
+        {
+            f = neg_inf;
+        }
+        else if (f > neg_inf)
+        {
+            sorted.push_back(f);
+        }
+    }
+
+    std::size_t count = sorted.size();
+    if (config.max_active != 0 && count > config.max_active)
+    {
+        std::nth_element(sorted.begin(), sorted.begin() + (config.max_active - 1), sorted.end(),
+                         std::greater<double>());
+        const double kth = sorted[config.max_active - 1];
+        std::size_t ties = config.max_active;
+        for (double f : row)
+        {
+            ties -= (f > kth);
+        }
+        count = 0;
+        for (double &f : row)
+        {
+            if (f > kth || (f == kth && ties-- > 0))
+            {
+                count++;
+            }
+            else
+            {
+                f = neg_inf;
+            }
+        }
+    }
+
+    for (std::size_t k = 0; k < active.size(); k++)
+    {
+        active[k] = std::any_of(row.begin() + k * n, row.begin() + (k + 1) * n, [&](double f) { return f > neg_inf; });
+    }
+    return count;
+}
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: recognise_beam
+********************************************************************************
+* Summary:
+*  The recursion of viterbi_search() for all models at once, one frame at a
+*  time, with prune_frame() after each frame. A state is searched only if
+*  it lies in its model's feasible band and has an active predecessor, so
+*  its emission is read only then.
+*
+* Parameters:
+*  cache:    emission cache of the model set
+*  features: the utterance
+*  config:   beam and cap
+*  trace:    optional, receives the active states and models per frame
+*
+* Return:
+*  The best model and the scores of all models, -Inf for the pruned ones
+*
+*******************************************************************************/
+recognition_result recognise_beam(emission_cache &cache, const feature_view &features, const beam_config &config,
+                                  beam_trace *trace)
+{
+    const double neg_inf = -std::numeric_limits<double>::infinity();
+    cache.reset(features);
+    const compiled_model &model = cache.model();
+    const std::size_t model_no = model.model_no();
+    const std::size_t n = model.state_no();
+    const std::size_t frame_no = cache.frame_no();
+    std::vector<sparse_transitions> transitions(model_no);
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        compiled_transitions(model, k, transitions[k]);
+    }
+    if (trace)
+    {
+        trace->active_states.clear();
+        trace->active_models.clear();
+    }
+
+    recognition_result result;
+    result.score = neg_inf;
+    result.scores.assign(model_no, neg_inf);
+    if (frame_no == 0 || n == 0)
+    {
+        return result;
+    }
+
+    std::vector<double> previous(model_no * n), current(model_no * n), sorted;
+    std::vector<char> active(model_no);
+    for (std::size_t t = 0; t < frame_no; t++)
+    {
+        const std::size_t remaining = frame_no - 1 - t;
+        for (std::size_t k = 0; k < model_no; k++)
+        {
+            const sparse_transitions &s = transitions[k];
+            double *f_cur = &current[k * n];
+            const double *f_prev = &previous[k * n];
+            for (std::size_t j = 0; j < n; j++)
+            {
+                f_cur[j] = neg_inf;
+                if ((t > 0 && !active[k]) || s.earliest[j] > t || s.to_end[j] > remaining)
+                {
+                    continue;
+                }
+                double f_max = neg_inf;
+                if (t == 0)
+                {
+                    f_max = s.log_entry[j];
+                }
+                for (std::size_t p = s.first[j]; t > 0 && p < s.first[j + 1]; p++)
+                {
+                    if (f_prev[s.pred[p]] > neg_inf)
+                    {
+                        f_max = std::max(f_max, f_prev[s.pred[p]] + s.log_a[p]);
+                    }
+                }
+                if (f_max > neg_inf)
+                {
+                    f_cur[j] = f_max + cache(k, j, t);
+                }
+            }
+        }
+        const std::size_t count = prune_frame(current, n, config, sorted, active);
+        if (trace)
+        {
+            trace->active_states.push_back(count);
+            trace->active_models.push_back((std::size_t)std::count(active.begin(), active.end(), 1));
+        }
+        previous.swap(current);
+    }
+
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        const sparse_transitions &s = transitions[k];
+        for (std::size_t i = 0; i < n; i++)
+        {
+            result.scores[k] = std::max(result.scores[k], previous[k * n + i] + s.log_exit[i]);
+        }
+        if (result.scores[k] > result.score)
+        {
+            result.score = result.scores[k];
+            result.model = (int)k;
+        }
+    }
+    return result;
+}
+
+
+int early_decision_policy::update(const double *scores, std::size_t model_no)
+{
+    const double neg_inf = -std::numeric_limits<double>::infinity();
+    int leader = -1;
+    double best = neg_inf, second = neg_inf;
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        if (scores[k] > best)
+        {
+            second = best;
+            best = scores[k];
+            leader = (int)k;
+        }
+        else if (scores[k] > second)
+        {
+            second = scores[k];
+        }
+    }
+    if (leader < 0 || std::isinf(config_.margin) || best - second < config_.margin)
+    {
+        leader_ = -1;
+        streak_ = 0;
+        return -1;
+    }
+    streak_ = (leader == leader_) ? streak_ + 1 : 1;
+    leader_ = leader;
+    return (streak_ >= std::max<std::size_t>(config_.frames, 1)) ? leader : -1;
+}
+
+
+/*******************************************************************************
+* Function Name: recognise_early
+********************************************************************************
+* Summary:
+*  The lockstep search of recognise_beam() without pruning: all models
+*  advance one frame over their predecessor lists and feasible band. After
+*  frame t the partial scores max_i f_k,i(t) + log a_i,END go to the policy.
+*  The band only drops states that cannot reach END by the last frame, and
+*  a path ending at t never needs them, so the partial scores are exact. The
+*  decision is the best partial score (ties to the lower model) of the
+*  frame the policy commits at, or of the last frame.
+*
+* Parameters:
+*  cache:    emission cache of the model set
+*  features: the utterance
+*  config:   margin and consecutive frames of the policy
+*  partial:  receives the partial scores per frame, may be null
+*
+* Return:
+*  The decision and the frames it took
+*
+*******************************************************************************/
+early_decision_result recognise_early(emission_cache &cache, const feature_view &features,
+                                      const early_decision_config &config, std::vector<double> *partial)
+{
+    const double neg_inf = -std::numeric_limits<double>::infinity();
+    cache.reset(features);
+    const compiled_model &model = cache.model();
+    const std::size_t model_no = model.model_no();
+    const std::size_t n = model.state_no();
+    const std::size_t frame_no = cache.frame_no();
+    std::vector<sparse_transitions> transitions(model_no);
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        compiled_transitions(model, k, transitions[k]);
+    }
+    if (partial)
+    {
+        partial->clear();
+    }
+
+    early_decision_result result;
+    result.decision.score = neg_inf;
+    result.decision.scores.assign(model_no, neg_inf);
+    result.decision_frame = frame_no;
+    if (frame_no == 0 || n == 0)
+    {
+        return result;
+    }
+
+    early_decision_policy policy(config);
+    policy.reset();
+    std::vector<double> previous(model_no * n), current(model_no * n), scores(model_no);
+    for (std::size_t t = 0; t < frame_no; t++)
+    {
+        const std::size_t remaining = frame_no - 1 - t;
+        for (std::size_t k = 0; k < model_no; k++)
+        {
+            const sparse_transitions &s = transitions[k];
+            double *f_cur = &current[k * n];
+            const double *f_prev = &previous[k * n];
+            scores[k] = neg_inf;
+            for (std::size_t j = 0; j < n; j++)
+            {
+                f_cur[j] = neg_inf;
+                if (s.earliest[j] > t || s.to_end[j] > remaining)
+                {
+                    continue;
+                }
+                double f_max = (t == 0) ? s.log_entry[j] : neg_inf;
+                for (std::size_t p = s.first[j]; t > 0 && p < s.first[j + 1]; p++)
+                {
+                    if (f_prev[s.pred[p]] > neg_inf)
+                    {
+                        f_max = std::max(f_max, f_prev[s.pred[p]] + s.log_a[p]);
+                    }
+                }
+                if (f_max > neg_inf)
+                {
+                    f_cur[j] = f_max + cache(k, j, t);
+                    scores[k] = std::max(scores[k], f_cur[j] + s.log_exit[j]);
+                }
+            }
+        }
+        if (partial)
+        {
+            partial->insert(partial->end(), scores.begin(), scores.end());
+        }
+        previous.swap(current);
+
+        const int committed = policy.update(scores.data(), model_no);
+        if (committed >= 0 || t + 1 == frame_no)
+        {
+            result.decision.scores = scores;
+            for (std::size_t k = 0; k < model_no; k++)
+            {
+                if (scores[k] > result.decision.score)
+                {
+                    result.decision.score = scores[k];
+                    result.decision.model = (int)k;
+                }
+            }
+            result.decision_frame = t + 1;
+            result.early = (t + 1 < frame_no);
+            break;
+        }
+    }
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: recognise_two_pass
+********************************************************************************
+* Summary:
+*  Runs the searches of all models on the first-pass cache, orders the
+*  models by score (ties by index), keeps the candidates that pass top_k and
+*  margin, and runs only their searches on the rescoring cache. With a lazy
+*  rescoring cache the states of the pruned models are never scored.
+*
+* Parameters:
+*  first_pass: emission cache of the cheap model set
+*  rescoring:  emission cache of the full model set
+*  features:   the utterance
+*  config:     candidate limits
+*
+* Return:
+*  Both score sets and the candidates
+*
+*******************************************************************************/
+two_pass_result recognise_two_pass(emission_cache &first_pass, emission_cache &rescoring,
+                                   const feature_view &features, const two_pass_config &config)
+{
+    const std::size_t model_no = rescoring.model().model_no();
+    if (first_pass.model().model_no() != model_no || first_pass.model().state_no() != rescoring.model().state_no())
+    {
+        throw std::invalid_argument("the first-pass and rescoring models differ in model or state count");
+    }
+
+    two_pass_result result;
+    result.first_pass = recognise(first_pass, features);
+    std::vector<std::size_t> order(model_no);
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        order[k] = k;
+    }
+    const std::vector<double> &cheap = result.first_pass.scores;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return cheap[a] > cheap[b]; });
+    const double threshold = cheap[order[0]] - config.margin * (double)features.frame_no;
+    for (std::size_t r = 0; r < model_no; r++)
+    {
+        const bool within = (r == 0) || (cheap[order[r]] > -std::numeric_limits<double>::infinity() &&
+                                         cheap[order[r]] >= threshold);
+        if ((config.top_k != 0 && r >= config.top_k) || !within)
+        {
+            break;
+        }
+        result.candidates.push_back(order[r]);
+    }
+
+    rescoring.reset(features);
+    result.rescored.score = -std::numeric_limits<double>::infinity();
+    result.rescored.scores.assign(model_no, -std::numeric_limits<double>::infinity());
+    for (std::size_t k : result.candidates)
+    {
+        result.rescored.scores[k] = viterbi_decode(rescoring, k);
+    }
+    /* in model order, so ties go to the first model as in hmm_gmm_testing.m */
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        if (result.rescored.scores[k] > result.rescored.score)
+        {
+            result.rescored.score = result.rescored.scores[k];
+            result.rescored.model = (int)k;
+        }
+    }
+    return result;
+}
+
+
+recognition_result recognise(const hmm_set &hmm, const feature_view &features)
+{
+    recognition_result result;
+    result.score = -std::numeric_limits<double>::infinity();
+    result.scores.resize(hmm.models.size());
+    for (std::size_t k = 0; k < hmm.models.size(); k++)
+    {
+        result.scores[k] = viterbi_decode(hmm.models[k], features);
+        if (result.scores[k] > result.score)
+        {
+            result.score = result.scores[k];
+            result.model = (int)k;
+        }
+    }
+    return result;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,183 @@
+/******************************************************************************
+* File Name:   wav_file.cpp
+*
+* Description: RIFF/WAVE reader, see wav_file.hpp.
+*
+*******************************************************************************/
+#include "hmm_gmm/wav_file.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "hmm_gmm/byte_order.hpp"
+
+namespace hmm_gmm
+{
+
+namespace
+{
+
+constexpr unsigned WAVE_FORMAT_PCM = 0x0001;
+constexpr unsigned WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr unsigned WAVE_FORMAT_EXTENSIBLE = 0xfffe;
+
+/* Scale factors to the int16 range */
+constexpr float PCM24_SCALE = 1.0f / 256.0f;
+constexpr float PCM32_SCALE = 1.0f / 65536.0f;
+constexpr float FLOAT_SCALE = 32768.0f;
+
+} /* namespace */
+
+
+/*******************************************************************************
+* Function Name: wav_reader
+********************************************************************************
+* Summary:
+*  Maps the file and walks the RIFF chunk list. The format comes from the
+*  'fmt ' chunk (for WAVE_FORMAT_EXTENSIBLE from the sub-format GUID); the
+*  'data' chunk is used in place.
+*
+* Parameters:
+*  filename: path of the .wav file
+*
+*******************************************************************************/
+wav_reader::wav_reader(const std::string &filename)
+    : file_(filename)
+{
+    const unsigned char *bytes = file_.data();
+    const std::size_t size = file_.size();
+    if (size < 12 || std::memcmp(bytes, "RIFF", 4) != 0 || std::memcmp(bytes + 8, "WAVE", 4) != 0)
+    {
+        throw std::runtime_error("not a RIFF/WAVE file: " + filename);
+    }
+
+    unsigned bits_per_sample = 0;
+    unsigned format_tag = 0;
+    bool have_format = false;
+    std::size_t pos = 12;
+    while (pos + 8 <= size)
+    {
+        const unsigned char *chunk = bytes + pos;
+        const std::size_t chunk_size = load_le32(chunk + 4);
+        const std::size_t body = pos + 8;
+        const std::size_t available = (chunk_size <= size - body) ? chunk_size : size - body;
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16)
+        {
+            format_tag = load_le16(bytes + body);
+            channels_ = load_le16(bytes + body + 2);
+            sample_rate_ = (double)load_le32(bytes + body + 4);
+            block_align_ = load_le16(bytes + body + 12);
+            bits_per_sample = load_le16(bytes + body + 14);
+            if (format_tag == WAVE_FORMAT_EXTENSIBLE && available >= 26)
+            {
+                format_tag = load_le16(bytes + body + 24);
+            }
+            have_format = true;
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            if (!have_format)
+            {
+                throw std::runtime_error("'data' chunk before 'fmt ' in " + filename);
+            }
+            if (format_tag == WAVE_FORMAT_PCM && bits_per_sample == 8)         format_ = wav_sample_format::pcm8;
+            else if (format_tag == WAVE_FORMAT_PCM && bits_per_sample == 16)   format_ = wav_sample_format::pcm16;
+            else if (format_tag == WAVE_FORMAT_PCM && bits_per_sample == 24)   format_ = wav_sample_format::pcm24;
+            else if (format_tag == WAVE_FORMAT_PCM && bits_per_sample == 32)   format_ = wav_sample_format::pcm32;
+            else if (format_tag == WAVE_FORMAT_IEEE_FLOAT && bits_per_sample == 32) format_ = wav_sample_format::float32;
+            else
+            {
+                throw std::runtime_error("unsupported WAV format " + std::to_string(format_tag) + ", " +
+                                         std::to_string(bits_per_sample) + " bit: " + filename);
+            }
+            if (channels_ == 0 || block_align_ < channels_ * (bits_per_sample / 8) || sample_rate_ <= 0.0)
+            {
+                throw std::runtime_error("invalid WAV format chunk in " + filename);
+            }
+            data_ = bytes + body;
+            frame_count_ = available / block_align_;
+            return;
+        }
+        pos = body + chunk_size + (chunk_size & 1u);
+    }
+    throw std::runtime_error("no 'data' chunk in " + filename);
+}
+
+
+/*******************************************************************************
+* Function Name: decode
+********************************************************************************
+* Summary:
+*  Converts frames of the first channel to float on the int16 scale. One
+*  loop per sample format keeps the inner loops free of format branches.
+*
+* Parameters:
+*  first: index of the first frame
+*  count: number of frames, first + count <= frame_count()
+*  out:   receives count samples
+*
+*******************************************************************************/
+void wav_reader::decode(std::size_t first, std::size_t count, float *out) const
+{
+    if (first > frame_count_ || count > frame_count_ - first)
+    {
+        throw std::out_of_range("WAV frame range out of bounds");
+    }
+    const unsigned char *p = data_ + first * block_align_;
+    const std::size_t stride = block_align_;
+    switch (format_)
+    {
+    case wav_sample_format::pcm8:
+        for (std::size_t i = 0; i < count; i++, p += stride)
+        {
+            out[i] = (float)((int)p[0] - 128) * 256.0f;
+        }
+        break;
+    case wav_sample_format::pcm16:
+        for (std::size_t i = 0; i < count; i++, p += stride)
+        {
+            out[i] = (float)(int16_t)load_le16(p);
+        }
+        break;
+    case wav_sample_format::pcm24:
+        for (std::size_t i = 0; i < count; i++, p += stride)
+        {
+            /* sign extend through the top byte of a 32-bit word */
+            const int32_t v = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8;
+            out[i] = (float)v * PCM24_SCALE;
+        }
+        break;
+    case wav_sample_format::pcm32:
+        for (std::size_t i = 0; i < count; i++, p += stride)
+        {
+            out[i] = (float)(int32_t)load_le32(p) * PCM32_SCALE;
+        }
+        break;
+    case wav_sample_format::float32:
+        for (std::size_t i = 0; i < count; i++, p += stride)
+        {
+            const uint32_t bits = load_le32(p);
+            float v;
+            std::memcpy(&v, &bits, sizeof(v));
+            out[i] = v * FLOAT_SCALE;
+        }
+        break;
+    }
+}
+
+
+wav_data read_wav_file(const std::string &filename)
+{
+    const wav_reader reader(filename);
+    wav_data wav;
+    wav.sample_rate = reader.sample_rate();
+    wav.samples.resize(reader.frame_count());
+    reader.decode(0, reader.frame_count(), wav.samples.data());
+    return wav;
+}
+
+} /* namespace hmm_gmm */
+
+/* [] END OF FILE */
@@ -0,0 +1,254 @@
+/******************************************************************************
+* File Name:   hmm_gmm_compile_model.cpp
+*
+* Description: Compiles HMM_<iter>.mat into the binary model image of
+*              compiled_model.hpp and checks it against the reference
+*              decoder.
+*
+*              hmm_gmm_compile_model compile [--c-source f.c] [--array-name n] [--specialized-c f.c]
+*                                            [--precision p] [--gate test.feat] <HMM.mat> <model.hmmb>
+*              hmm_gmm_compile_model info <model.hmmb>
+*              hmm_gmm_compile_model check <HMM.mat> <model.hmmb> <test.feat>
+*
+*              A float16 or int8 model compiled with --gate is decoded
+*              against the float32 model on the test corpus first and is
+*              not written if the accuracy drops by more than
+*              --max-accuracy-drop percentage points. --specialized-c writes
+*              the decoder of gmm_hmm/specialized_model.h specialised for the
+*              model (float32 only).
+*
+*******************************************************************************/
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/hmm_model.hpp"
+#include "hmm_gmm/parallel.hpp"
+#include "hmm_gmm/specialized_decoder.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    std::string c_source;
+    std::string array_name = "hmm_gmm_model_image";
+    std::string specialized_c;
+    std::size_t threads = 0;
+    model_precision precision = model_precision::float32;
+    std::string gate;
+    double max_accuracy_drop = 0.5;
+    std::vector<std::string> positional;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_compile_model compile [--c-source f.c] [--array-name n] [--specialized-c f.c]\n"
+        "                                     [--precision p] [--gate test.feat] <HMM.mat> <model.hmmb>\n"
+        "       hmm_gmm_compile_model info <model.hmmb>\n"
+        "       hmm_gmm_compile_model check [--threads n] <HMM.mat> <model.hmmb> <test.feat>\n"
+        "  --c-source <file>          also write the image as a const C array (PSoC6 flash)\n"
+        "  --array-name <n>           name of that array (hmm_gmm_model_image)\n"
+        "  --specialized-c <file>     also write the decoder specialised for this model (PSoC6)\n"
+        "  --precision <p>            means and variances in float32|float16|int8 (float32)\n"
+        "  --gate <test.feat>         reject the model if it loses accuracy against float32\n"
+        "  --max-accuracy-drop <pct>  percentage points the gate allows (0.5)\n"
+        "  --threads <n>              worker threads for check and the gate (all hardware threads)\n");
+}
+
+model_precision parse_precision(const std::string &name)
+{
+    for (model_precision precision : {model_precision::float32, model_precision::float16, model_precision::int8})
+    {
+        if (name == model_precision_name(precision))
+        {
+            return precision;
+        }
+    }
+    throw std::invalid_argument("unknown precision " + name);
+}
+
+void print_info(const compiled_model &model)
+{
+    std::printf("%zu model(s), %zu states, %zu mixture(s), dim %zu (stride %zu), %s, %zu bytes\n",
+                model.model_no(), model.state_no(), model.mix_no(), model.dim(), model.stride(),
+                model_precision_name(model.precision()), model.image_size());
+}
+
+/* Accuracy in percent of the compiled decoder on a corpus */
+double accuracy(const compiled_model &model, const feature_corpus &corpus, std::size_t threads)
+{
+    std::vector<int> hits(corpus.size(), 0);
+    parallel_for(corpus.size(), threads, [&](std::size_t u, std::size_t) {
+        hits[u] = recognise(model, corpus[u].features).model + 1 == corpus[u].label;
+    });
+    std::size_t correct = 0;
+    for (int hit : hits)
+    {
+        correct += (std::size_t)hit;
+    }
+    return corpus.size() ? 100.0 * correct / corpus.size() : 0.0;
+}
+
+int compile(const options &opt)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const hmm_set hmm = read_hmm_mat(opt.positional[0]);
+    const compiled_model model(hmm, opt.precision);
+    if (opt.precision != model_precision::float32)
+    {
+        const compiled_model reference(hmm);
+        std::printf("footprint: %zu bytes, %.2fx smaller than float32 (%zu bytes)\n", model.image_size(),
+                    (double)reference.image_size() / model.image_size(), reference.image_size());
+        if (!opt.gate.empty())
+        {
+            const feature_corpus corpus(opt.gate);
+            const std::size_t threads = opt.threads ? opt.threads : hardware_threads();
+            const double baseline = accuracy(reference, corpus, threads);
+            const double quantised = accuracy(model, corpus, threads);
+            const bool pass = baseline - quantised <= opt.max_accuracy_drop;
+            std::printf("gate:      float32 %.2f%%, %s %.2f%% (drop %.2f, limit %.2f) on %zu utterances: %s\n",
+                        baseline, model_precision_name(opt.precision), quantised, baseline - quantised,
+                        opt.max_accuracy_drop, corpus.size(), pass ? "accepted" : "rejected");
+            if (!pass)
+            {
+                return 1;
+            }
+        }
+    }
+    model.save(opt.positional[1]);
+    if (!opt.c_source.empty())
+    {
+        write_compiled_model_c_source(opt.c_source, model, opt.array_name);
+    }
+    if (!opt.specialized_c.empty())
+    {
+        write_specialized_c_source(opt.specialized_c, model);
+    }
+    print_info(model);
+    std::printf("compiled in %.3f s\n",
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return 0;
+}
+
+/* Reference (MAT, double) and compiled decoders on the same corpus */
+int check(const options &opt)
+{
+    auto start = std::chrono::steady_clock::now();
+    const hmm_set hmm = read_hmm_mat(opt.positional[0]);
+    const double mat_load = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    const compiled_model model(opt.positional[1]);
+    const double compiled_load = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const feature_corpus corpus(opt.positional[2]);
+    if (model.model_no() != hmm.models.size() || model.dim() != hmm.dim())
+    {
+        throw std::invalid_argument(opt.positional[1] + " was not compiled from " + opt.positional[0]);
+    }
+    const std::size_t threads = opt.threads ? opt.threads : hardware_threads();
+
+    std::vector<recognition_result> reference(corpus.size()), compiled(corpus.size());
+    start = std::chrono::steady_clock::now();
+    parallel_for(corpus.size(), threads, [&](std::size_t u, std::size_t) {
+        reference[u] = recognise(hmm, corpus[u].features);
+    });
+    const double reference_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    parallel_for(corpus.size(), threads, [&](std::size_t u, std::size_t) {
+        compiled[u] = recognise(model, corpus[u].features);
+    });
+    const double compiled_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t changed = 0, reference_hits = 0, compiled_hits = 0;
+    double max_error = 0.0;
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        const int label = corpus[u].label;
+        changed += (reference[u].model != compiled[u].model);
+        reference_hits += (reference[u].model + 1 == label);
+        compiled_hits += (compiled[u].model + 1 == label);
+        for (std::size_t k = 0; k < reference[u].scores.size(); k++)
+        {
+            const double r = reference[u].scores[k], c = compiled[u].scores[k];
+            if (std::isfinite(r) || std::isfinite(c))
+            {
+                const double e = std::fabs(r - c) / std::fmax(1.0, std::fabs(r));
+                max_error = std::fmax(max_error, std::isfinite(e) ? e : HUGE_VAL);
+            }
+        }
+    }
+    const double percent = corpus.size() ? 100.0 / corpus.size() : 0.0;
+    std::printf("load:      MAT %.3f ms, compiled %.3f ms\n", 1e3 * mat_load, 1e3 * compiled_load);
+    std::printf("decode:    reference %.3f s, compiled %.3f s (%.2fx), %zu frames\n",
+                reference_time, compiled_time, compiled_time > 0.0 ? reference_time / compiled_time : 0.0,
+                corpus.total_frames());
+    std::printf("accuracy:  reference %.2f%%, compiled %.2f%%\n", reference_hits * percent, compiled_hits * percent);
+    std::printf("decisions: %zu of %zu changed, max relative fopt error %.3g\n", changed, corpus.size(), max_error);
+    return changed == 0 ? 0 : 1;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        usage();
+        return 2;
+    }
+    const std::string command = argv[1];
+    options opt;
+    try
+    {
+        for (int i = 2; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--c-source" && i + 1 < argc)                opt.c_source = argv[++i];
+            else if (arg == "--array-name" && i + 1 < argc)         opt.array_name = argv[++i];
+            else if (arg == "--specialized-c" && i + 1 < argc)      opt.specialized_c = argv[++i];
+            else if (arg == "--threads" && i + 1 < argc)            opt.threads = std::strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--precision" && i + 1 < argc)          opt.precision = parse_precision(argv[++i]);
+            else if (arg == "--gate" && i + 1 < argc)               opt.gate = argv[++i];
+            else if (arg == "--max-accuracy-drop" && i + 1 < argc)  opt.max_accuracy_drop = std::strtod(argv[++i], nullptr);
+            else if (!arg.empty() && arg[0] == '-')
+            {
+                std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+                usage();
+                return 2;
+            }
+            else
+            {
+                opt.positional.push_back(arg);
+            }
+        }
+
+        const std::size_t n = opt.positional.size();
+        if (command == "compile" && n == 2)  return compile(opt);
+        if (command == "check" && n == 3)    return check(opt);
+        if (command == "info" && n == 1)
+        {
+            print_info(compiled_model(opt.positional[0]));
+            return 0;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_compile_model: %s\n", e.what());
+        return 1;
+    }
+    usage();
+    return 2;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,257 @@
+/******************************************************************************
+* File Name:   hmm_gmm_corpus.cpp
+*
+* Description: Converts between HTK feature files and the packed feature
+*              corpus (feature_corpus.hpp).
+*
+*              hmm_gmm_corpus pack [--var name] [--base-dir dir] <list> <out.feat>
+*              hmm_gmm_corpus unpack <in.feat> <outdir>
+*              hmm_gmm_corpus info <in.feat>
+*              hmm_gmm_corpus bench [--var name] [--base-dir dir] <in.feat> [list]
+*
+*              <list> is trainingfile_list.mat / testingfile_list.mat or a
+*              text list with "<model id> <path>" lines.
+*
+*******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/file_list.hpp"
+#include "hmm_gmm/htk_file.hpp"
+
+namespace fs = std::filesystem;
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    std::string var_name;
+    std::string base_dir;
+    std::vector<std::string> positional;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_corpus pack [--var name] [--base-dir dir] <list> <out.feat>\n"
+        "       hmm_gmm_corpus unpack <in.feat> <outdir>\n"
+        "       hmm_gmm_corpus info <in.feat>\n"
+        "       hmm_gmm_corpus bench [--var name] [--base-dir dir] <in.feat> [list]\n"
+        "  <list>           trainingfile_list.mat, testingfile_list.mat or \"<model id> <path>\" lines\n"
+        "  --var <name>     cell array variable of the .mat list (first cell array)\n"
+        "  --base-dir <dir> directory relative list paths are resolved against (.)\n");
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* Utterance id: the list path with '/' separators */
+std::string utterance_id(const std::string &path)
+{
+    std::string id = path;
+    for (char &c : id)
+    {
+        if (c == '\\')
+        {
+            c = '/';
+        }
+    }
+    return id;
+}
+
+/* Output path of an utterance below outdir: the id without root, drive and leading ".." */
+fs::path unpack_path(const fs::path &outdir, std::string_view id)
+{
+    fs::path relative;
+    for (const fs::path &part : fs::path(std::string(id)).relative_path())
+    {
+        if (part != ".." && part != ".")
+        {
+            relative /= part;
+        }
+    }
+    return outdir / relative;
+}
+
+int pack(const options &opt)
+{
+    const std::vector<labelled_file> list = read_file_list(opt.positional[0], opt.var_name);
+    const auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<feature_corpus_writer> writer;
+    std::size_t packed = 0;
+    std::size_t missing = 0;
+    std::size_t frames = 0;
+    for (const labelled_file &f : list)
+    {
+        const std::string path = resolve_list_path(f.path, opt.base_dir);
+        if (!fs::exists(path))
+        {
+            /* hmm_gmm_training.m skips files it cannot open */
+            std::fprintf(stderr, "hmm_gmm_corpus: skipping missing %s\n", path.c_str());
+            missing++;
+            continue;
+        }
+        htk_header header;
+        const feature_matrix features = read_htk_file(path, &header);
+        if (!writer)
+        {
+            writer = std::make_unique<feature_corpus_writer>(opt.positional[1], features.dim,
+                                                             header.samp_period, header.parm_kind);
+        }
+        writer->add(f.label, utterance_id(f.path), features);
+        packed++;
+        frames += features.frame_no;
+    }
+    if (!writer)
+    {
+        throw std::runtime_error("no readable feature files in " + opt.positional[0]);
+    }
+    writer->finish();
+    std::printf("%zu utterance(s), %zu frames packed in %.3f s, %zu missing\n",
+                packed, frames, seconds_since(start), missing);
+    return 0;
+}
+
+int unpack(const options &opt)
+{
+    const feature_corpus corpus(opt.positional[0]);
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        const corpus_utterance utt = corpus[u];
+        const fs::path out = unpack_path(opt.positional[1], utt.id);
+        fs::create_directories(out.parent_path());
+        feature_matrix features(utt.features.dim, utt.features.frame_no);
+        std::copy(utt.features.data, utt.features.data + features.data.size(), features.data.begin());
+        write_htk_file(out.string(), features, corpus.samp_period(), corpus.parm_kind());
+    }
+    std::printf("%zu utterance(s) written to %s\n", corpus.size(), opt.positional[1].c_str());
+    return 0;
+}
+
+int info(const options &opt)
+{
+    const feature_corpus corpus(opt.positional[0]);
+    std::map<int32_t, std::pair<std::size_t, std::size_t>> per_label;   /* utterances, frames */
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        const corpus_utterance utt = corpus[u];
+        per_label[utt.label].first++;
+        per_label[utt.label].second += utt.features.frame_no;
+    }
+    std::printf("%zu utterance(s), %zu frames, dim %zu, parmKind %d, frame period %.1f ms\n",
+                corpus.size(), corpus.total_frames(), corpus.dim(), corpus.parm_kind(), corpus.samp_period() * 1e-4);
+    for (const auto &item : per_label)
+    {
+        std::printf("  model %d: %zu utterance(s), %zu frames\n", item.first, item.second.first, item.second.second);
+    }
+    return 0;
+}
+
+/* One pass over all feature values; the checksum keeps the reads from being optimised away */
+int bench(const options &opt)
+{
+    auto start = std::chrono::steady_clock::now();
+    const feature_corpus corpus(opt.positional[0]);
+    double corpus_sum = 0.0;
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        const feature_view f = corpus[u].features;
+        for (std::size_t i = 0; i < f.dim * f.frame_no; i++)
+        {
+            corpus_sum += f.data[i];
+        }
+    }
+    const double corpus_time = seconds_since(start);
+    std::printf("corpus: %zu utterance(s) in %.4f s, %.0f utterances/s (checksum %.6e)\n",
+                corpus.size(), corpus_time, corpus.size() / corpus_time, corpus_sum);
+
+    if (opt.positional.size() > 1)
+    {
+        const std::vector<labelled_file> list = read_file_list(opt.positional[1], opt.var_name);
+        start = std::chrono::steady_clock::now();
+        double htk_sum = 0.0;
+        std::size_t read = 0;
+        for (const labelled_file &f : list)
+        {
+            const std::string path = resolve_list_path(f.path, opt.base_dir);
+            if (!fs::exists(path))
+            {
+                continue;
+            }
+            const feature_matrix features = read_htk_file(path);
+            for (float v : features.data)
+            {
+                htk_sum += v;
+            }
+            read++;
+        }
+        const double htk_time = seconds_since(start);
+        std::printf("HTK:    %zu utterance(s) in %.4f s, %.0f utterances/s (checksum %.6e)\n",
+                    read, htk_time, read / htk_time, htk_sum);
+        std::printf("speed-up %.1fx%s\n", htk_time / corpus_time,
+                    (htk_sum == corpus_sum) ? "" : ", checksums differ");
+    }
+    return 0;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        usage();
+        return 2;
+    }
+    const std::string command = argv[1];
+    options opt;
+    for (int i = 2; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if ((arg == "--var" || arg == "--base-dir") && i + 1 < argc)
+        {
+            (arg == "--var" ? opt.var_name : opt.base_dir) = argv[++i];
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            opt.positional.push_back(arg);
+        }
+    }
+
+    const std::size_t n = opt.positional.size();
+    try
+    {
+        if (command == "pack" && n == 2)        return pack(opt);
+        if (command == "unpack" && n == 2)      return unpack(opt);
+        if (command == "info" && n == 1)        return info(opt);
+        if (command == "bench" && (n == 1 || n == 2)) return bench(opt);
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_corpus: %s\n", e.what());
+        return 1;
+    }
+    usage();
+    return 2;
+}
+
+/* [] END OF FILE */
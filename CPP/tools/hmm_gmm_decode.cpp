@@ -0,0 +1,344 @@
+/******************************************************************************
+* File Name:   hmm_gmm_decode.cpp
+*
+* Description: Isolated-word decoding of a packed feature corpus with a
+*              compiled model set, the C++ counterpart of hmm_gmm_testing.m:
+*
+*              hmm_gmm_decode [options] <model.hmmb> <test.feat>
+*
+*              One emission cache is reused for the whole corpus and shared
+*              by the searches of all models. Reports the accuracy (labels
+*              of the corpus), the decoding time and real-time factor, and
+*              how many entries of the emission matrix were computed. With
+*              --first-pass, the models are pre-scored with a cheaper model
+*              set and only the candidates are rescored; the pruning ratio
+*              and the difference to single-pass decoding are reported.
+*              --beam / --max-active decode all models in lockstep with
+*              beam and histogram pruning (recognise_beam) and report the
+*              active states and models per frame and the difference to
+*              the full search.
+*              --alignments writes the best state sequence of every
+*              utterance; only the decided model is searched again with
+*              backpointers, all other searches are score-only.
+*
+*******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/gaussian_scorer.hpp"
+#include "hmm_gmm/gaussian_selection.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    std::string emissions = "lazy";
+    std::string tier = "exact";
+    std::string selection;
+    std::string first_pass;
+    std::string alignments;
+    two_pass_config two_pass;
+    beam_config beam;
+    bool beam_search = false;
+    std::size_t repeat = 1;
+    std::vector<std::string> positional;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_decode [options] <model.hmmb> <test.feat>\n"
+        "  --emissions <m>   lazy: computed when the search first reads them (default)\n"
+        "                    bulk: whole matrix per utterance with the batched scorer\n"
+        "                    selected: shortlist of Gaussian selection, needs --selection\n"
+        "  --tier <t>        log-add tier of the bulk scorer: exact|polynomial|table (exact)\n"
+        "  --selection <f>   Gaussian selection written by hmm_gmm_gaussian_selection build\n"
+        "  --first-pass <f>  two-pass decoding: score every model with this cheaper model set\n"
+        "                    (same models and states, e.g. the single-mixture HMM_5) first\n"
+        "  --top-k <n>       two-pass: rescore at most n models, 0 = no limit (2)\n"
+        "  --margin <x>      two-pass: rescore only models within x per frame of the best (no limit)\n"
+        "  --beam <x>        lockstep search: drop states more than x below the best state of the frame\n"
+        "  --max-active <n>  lockstep search: keep at most n states per frame over all models\n"
+        "  --repeat <n>      timed passes over the corpus, the fastest is reported (1)\n"
+        "  --alignments <f>  write the state sequence of the decided model for every utterance\n");
+}
+
+log_add_tier parse_tier(const std::string &name)
+{
+    for (log_add_tier tier : {log_add_tier::exact, log_add_tier::polynomial, log_add_tier::table})
+    {
+        if (name == log_add_tier_name(tier))
+        {
+            return tier;
+        }
+    }
+    throw std::invalid_argument("unknown log-add tier " + name);
+}
+
+/*
+ * One line per utterance: index, label, decided model (1-based as the
+ * labels), score, and the path as runs of 1-based emitting state x frames
+ */
+void write_alignments(const std::string &filename, const feature_corpus &corpus, emission_cache &cache,
+                      const std::vector<int> &decisions)
+{
+    std::ofstream out(filename, std::ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error("cannot create " + filename);
+    }
+    char line[96];
+    std::vector<int> alignment;
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        double score = -std::numeric_limits<double>::infinity();
+        alignment.clear();
+        if (decisions[u] >= 0)
+        {
+            cache.reset(corpus[u].features);
+            score = viterbi_decode(cache, (std::size_t)decisions[u], &alignment);
+        }
+        std::snprintf(line, sizeof(line), "%zu %d %d %.6f", u, corpus[u].label, decisions[u] + 1, score);
+        out << line;
+        for (std::size_t t = 0; t < alignment.size();)
+        {
+            std::size_t run = 1;
+            while (t + run < alignment.size() && alignment[t + run] == alignment[t])
+            {
+                run++;
+            }
+            out << ' ' << alignment[t] + 1 << 'x' << run;
+            t += run;
+        }
+        out << '\n';
+    }
+    if (!out)
+    {
+        throw std::runtime_error("cannot write " + filename);
+    }
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    options opt;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--emissions" && i + 1 < argc)    opt.emissions = argv[++i];
+        else if (arg == "--tier" && i + 1 < argc)    opt.tier = argv[++i];
+        else if (arg == "--selection" && i + 1 < argc) opt.selection = argv[++i];
+        else if (arg == "--first-pass" && i + 1 < argc) opt.first_pass = argv[++i];
+        else if (arg == "--top-k" && i + 1 < argc)   opt.two_pass.top_k = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--margin" && i + 1 < argc)  opt.two_pass.margin = std::strtod(argv[++i], nullptr);
+        else if (arg == "--beam" && i + 1 < argc)
+        {
+            opt.beam.beam = std::strtod(argv[++i], nullptr);
+            opt.beam_search = true;
+        }
+        else if (arg == "--max-active" && i + 1 < argc)
+        {
+            opt.beam.max_active = std::strtoul(argv[++i], nullptr, 10);
+            opt.beam_search = true;
+        }
+        else if (arg == "--repeat" && i + 1 < argc)  opt.repeat = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--alignments" && i + 1 < argc) opt.alignments = argv[++i];
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            opt.positional.push_back(arg);
+        }
+    }
+    if (!opt.selection.empty())
+    {
+        opt.emissions = "selected";
+    }
+    if (opt.positional.size() != 2 || opt.repeat == 0 ||
+        (opt.emissions != "lazy" && opt.emissions != "bulk" && opt.emissions != "selected") ||
+        (opt.emissions == "selected" && opt.selection.empty()) || (opt.beam_search && !opt.first_pass.empty()))
+    {
+        usage();
+        return 2;
+    }
+
+    try
+    {
+        const compiled_model model(opt.positional[0]);
+        const feature_corpus corpus(opt.positional[1]);
+        std::unique_ptr<gaussian_scorer> scorer;
+        std::unique_ptr<gaussian_selection> selection;
+        std::unique_ptr<emission_cache> cache;
+        if (opt.emissions == "selected")
+        {
+            selection = std::make_unique<gaussian_selection>(model, opt.selection);
+            cache = std::make_unique<emission_cache>(model, *selection);
+        }
+        else if (opt.emissions == "bulk")
+        {
+            scorer = std::make_unique<gaussian_scorer>(model);
+            cache = std::make_unique<emission_cache>(model, *scorer, parse_tier(opt.tier));
+        }
+        else
+        {
+            cache = std::make_unique<emission_cache>(model);
+        }
+
+        /* the fastest of 'repeat' passes over the corpus */
+        auto run = [&](auto &&decide, std::vector<int> &decisions) {
+            double best = 0.0;
+            for (std::size_t r = 0; r < opt.repeat; r++)
+            {
+                decisions.clear();
+                const auto start = std::chrono::steady_clock::now();
+                for (std::size_t u = 0; u < corpus.size(); u++)
+                {
+                    decisions.push_back(decide(corpus[u].features));
+                }
+                const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                best = (r == 0 || elapsed < best) ? elapsed : best;
+            }
+            return best;
+        };
+        auto correct = [&](const std::vector<int> &decisions) {
+            std::size_t n = 0;
+            for (std::size_t u = 0; u < corpus.size(); u++)
+            {
+                n += (decisions[u] + 1 == corpus[u].label);
+            }
+            return n;
+        };
+
+        std::unique_ptr<compiled_model> first_model;
+        std::unique_ptr<emission_cache> first_cache;
+        std::size_t rescored = 0;
+        std::size_t active_states = 0, active_models = 0, max_active_states = 0, searched_frames = 0;
+        beam_trace trace;
+        std::vector<int> decisions;
+        double best;
+        if (opt.beam_search)
+        {
+            best = run([&](const feature_view &f) {
+                           const recognition_result result = recognise_beam(*cache, f, opt.beam, &trace);
+                           for (std::size_t t = 0; t < trace.active_states.size(); t++)
+                           {
+                               active_states += trace.active_states[t];
+                               active_models += trace.active_models[t];
+                               max_active_states = std::max(max_active_states, trace.active_states[t]);
+                           }
+                           searched_frames += trace.active_states.size();
+                           return result.model;
+                       },
+                       decisions);
+        }
+        else if (opt.first_pass.empty())
+        {
+            best = run([&](const feature_view &f) { return recognise(*cache, f).model; }, decisions);
+        }
+        else
+        {
+            first_model = std::make_unique<compiled_model>(opt.first_pass);
+            first_cache = std::make_unique<emission_cache>(*first_model);
+            best = run([&](const feature_view &f) {
+                           const two_pass_result result = recognise_two_pass(*first_cache, *cache, f, opt.two_pass);
+                           rescored += result.candidates.size();
+                           return result.rescored.model;
+                       },
+                       decisions);
+        }
+
+        /* samp_period is in HTK units of 100 ns */
+        const double audio = (double)corpus.total_frames() * corpus.samp_period() * 1e-7;
+        const double matrix = (double)corpus.total_frames() * model.model_no() * model.state_no() * opt.repeat;
+        const double n = corpus.size() ? (double)corpus.size() : 1.0;
+        std::printf("%zu utterances, %zu frames, %zu models x %zu states x %zu mixtures\n", corpus.size(),
+                    corpus.total_frames(), model.model_no(), model.state_no(), model.mix_no());
+        std::printf("accuracy        %.2f %% (%zu / %zu)\n", 100.0 * correct(decisions) / n, correct(decisions),
+                    corpus.size());
+        std::printf("decoding time   %.4f s (%s emissions%s%s%s%s)\n", best, opt.emissions.c_str(),
+                    scorer ? ", " : "", scorer ? opt.tier.c_str() : "", first_cache ? ", two-pass" : "",
+                    opt.beam_search ? ", beam" : "");
+        if (audio > 0.0)
+        {
+            std::printf("real-time       %.5f (%.1f s of audio)\n", best / audio, audio);
+        }
+        std::printf("emissions       %zu computed (%.1f %% of the matrix), %zu reads\n", cache->evaluations(),
+                    matrix > 0.0 ? 100.0 * cache->evaluations() / matrix : 0.0, cache->lookups());
+        std::printf("Gaussians       %zu evaluated (%.1f %% of all)\n", cache->gaussian_evaluations(),
+                    matrix > 0.0 ? 100.0 * cache->gaussian_evaluations() / (matrix * model.mix_no()) : 0.0);
+
+        if (opt.beam_search)
+        {
+            const double frames = searched_frames ? (double)searched_frames : 1.0;
+            std::printf("beam            %g, max active %zu: %.1f of %zu states active per frame (max %zu), "
+                        "%.2f of %zu models\n", opt.beam.beam, opt.beam.max_active, active_states / frames,
+                        model.model_no() * model.state_no(), max_active_states, active_models / frames,
+                        model.model_no());
+            std::vector<int> full;
+            const double full_time = run([&](const feature_view &f) { return recognise(*cache, f).model; }, full);
+            std::size_t changed = 0;
+            for (std::size_t u = 0; u < corpus.size(); u++)
+            {
+                changed += (full[u] != decisions[u]);
+            }
+            std::printf("full search     accuracy %.2f %%, %.4f s; beam %+.2f %%, %.2fx, %zu decisions changed\n",
+                        100.0 * correct(full) / n, full_time,
+                        100.0 * ((double)correct(decisions) - (double)correct(full)) / n,
+                        best > 0.0 ? full_time / best : 0.0, changed);
+        }
+        if (first_cache)
+        {
+            /* the same emission mode in a single pass, for the pruning report */
+            const double models = (double)corpus.size() * model.model_no() * opt.repeat;
+            std::printf("first pass      %zu mixture(s), %zu Gaussians evaluated\n", first_model->mix_no(),
+                        first_cache->gaussian_evaluations());
+            std::printf("rescored        %zu of %.0f models (pruning ratio %.1f %%)\n", rescored, models,
+                        models > 0.0 ? 100.0 * (1.0 - rescored / models) : 0.0);
+            std::vector<int> single;
+            const double single_time = run([&](const feature_view &f) { return recognise(*cache, f).model; }, single);
+            std::size_t changed = 0;
+            for (std::size_t u = 0; u < corpus.size(); u++)
+            {
+                changed += (single[u] != decisions[u]);
+            }
+            std::printf("single pass     accuracy %.2f %%, %.4f s; two-pass %+.2f %%, %.2fx, %zu decisions changed\n",
+                        100.0 * correct(single) / n, single_time,
+                        100.0 * ((double)correct(decisions) - (double)correct(single)) / n,
+                        best > 0.0 ? single_time / best : 0.0, changed);
+        }
+        if (!opt.alignments.empty())
+        {
+            write_alignments(opt.alignments, corpus, *cache, decisions);
+            std::printf("alignments      written to %s\n", opt.alignments.c_str());
+        }
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_decode: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
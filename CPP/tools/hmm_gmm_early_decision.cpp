@@ -0,0 +1,217 @@
+/******************************************************************************
+* File Name:   hmm_gmm_early_decision.cpp
+*
+* Description: Accuracy and decision latency of early-decision decoding
+*              (recognise_early in viterbi.hpp). The corpus is decoded once
+*              per margin and frame count of the policy:
+*
+*              hmm_gmm_early_decision [options] <model.hmmb> <test.feat>
+*
+*              Reports per setting the accuracy, the decisions changed
+*              against the full search, how many utterances were decided
+*              early, the decision latency from the start of the utterance
+*              and the frames and emissions scored. --trace prints the
+*              per-frame partial scores of one utterance.
+*
+*******************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    std::string margins = "5,10,20,40";
+    std::string frames = "1,3,5";
+    long trace = -1;                /* utterance index, -1 = none */
+    std::vector<std::string> positional;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_early_decision [options] <model.hmmb> <test.feat>\n"
+        "  --margin <list>   log-likelihood leads over the runner-up (5,10,20,40)\n"
+        "  --frames <list>   consecutive frames the lead must hold (1,3,5)\n"
+        "  --trace <u>       print the partial scores of utterance u (0-based) per frame\n");
+}
+
+std::vector<double> parse_list(const std::string &text, bool integral)
+{
+    std::vector<double> values;
+    std::size_t start = 0;
+    while (start <= text.size())
+    {
+        const std::size_t end = std::min(text.find(',', start), text.size());
+        char *stop = nullptr;
+        const std::string item = text.substr(start, end - start);
+        const double value = std::strtod(item.c_str(), &stop);
+        if (item.empty() || *stop != '\0' || !(value >= 0.0) || (integral && (value < 1.0 || value != std::floor(value))))
+        {
+            throw std::invalid_argument("bad list " + text);
+        }
+        values.push_back(value);
+        start = end + 1;
+    }
+    return values;
+}
+
+/* Nearest-rank percentile of sorted values */
+double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    const std::size_t rank = (std::size_t)std::ceil(p / 100.0 * (double)sorted.size());
+    return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+void print_trace(emission_cache &cache, const feature_corpus &corpus, std::size_t u, double frame_ms)
+{
+    if (u >= corpus.size())
+    {
+        throw std::invalid_argument("no utterance " + std::to_string(u));
+    }
+    const std::size_t model_no = cache.model().model_no();
+    std::vector<double> partial;
+    recognise_early(cache, corpus[u].features, early_decision_config(), &partial);
+    std::printf("utterance %zu, label %d, %zu frames: partial scores per frame, leader and lead\n", u,
+                corpus[u].label, corpus[u].features.frame_no);
+    for (std::size_t t = 0; t * model_no < partial.size(); t++)
+    {
+        const double *scores = &partial[t * model_no];
+        std::vector<double> sorted(scores, scores + model_no);
+        std::sort(sorted.begin(), sorted.end(), std::greater<double>());
+        if (std::isinf(sorted[0]))
+        {
+            continue;
+        }
+        std::printf("%5zu %7.0f ms", t, (t + 1) * frame_ms);
+        for (std::size_t k = 0; k < model_no; k++)
+        {
+            std::printf(" %10.2f", scores[k]);
+        }
+        const std::size_t leader = (std::size_t)(std::max_element(scores, scores + model_no) - scores);
+        std::printf("  %2zu %8.2f\n", leader + 1, model_no > 1 ? sorted[0] - sorted[1] : 0.0);
+    }
+    std::printf("\n");
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    options opt;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--margin" && i + 1 < argc)       opt.margins = argv[++i];
+        else if (arg == "--frames" && i + 1 < argc)  opt.frames = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc)   opt.trace = std::strtol(argv[++i], nullptr, 10);
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            opt.positional.push_back(arg);
+        }
+    }
+    if (opt.positional.size() != 2)
+    {
+        usage();
+        return 2;
+    }
+
+    try
+    {
+        const std::vector<double> margins = parse_list(opt.margins, false);
+        const std::vector<double> frames = parse_list(opt.frames, true);
+        const compiled_model model(opt.positional[0]);
+        const feature_corpus corpus(opt.positional[1]);
+        emission_cache cache(model);
+        /* samp_period is in HTK units of 100 ns */
+        const double frame_ms = corpus.samp_period() * 1e-4;
+
+        if (opt.trace >= 0)
+        {
+            print_trace(cache, corpus, (std::size_t)opt.trace, frame_ms);
+        }
+
+        std::vector<int> full;
+        std::size_t full_evaluations = cache.evaluations();
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            full.push_back(recognise(cache, corpus[u].features).model);
+        }
+        full_evaluations = cache.evaluations() - full_evaluations;
+        std::size_t full_correct = 0;
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            full_correct += (full[u] + 1 == corpus[u].label);
+        }
+
+        std::printf("%zu utterances, %zu frames, %zu models x %zu states x %zu mixtures\n", corpus.size(),
+                    corpus.total_frames(), model.model_no(), model.state_no(), model.mix_no());
+        std::printf("full search: accuracy %.2f %%, decision at the end of the utterance (mean %.0f ms)\n\n",
+                    corpus.size() ? 100.0 * full_correct / corpus.size() : 0.0,
+                    corpus.size() ? frame_ms * corpus.total_frames() / corpus.size() : 0.0);
+        std::printf("%8s %6s %10s %8s %7s %29s %8s %10s\n", "margin", "frames", "accuracy", "changed", "early",
+                    "decision [ms] p50 / p90 / max", "frames", "emissions");
+
+        for (double margin : margins)
+        {
+            for (double k : frames)
+            {
+                early_decision_config config;
+                config.margin = margin;
+                config.frames = (std::size_t)k;
+                const std::size_t evaluations = cache.evaluations();
+                std::size_t correct = 0, changed = 0, early = 0, scored = 0;
+                std::vector<double> latency;
+                for (std::size_t u = 0; u < corpus.size(); u++)
+                {
+                    const early_decision_result r = recognise_early(cache, corpus[u].features, config);
+                    correct += (r.decision.model + 1 == corpus[u].label);
+                    changed += (r.decision.model != full[u]);
+                    early += r.early;
+                    scored += r.decision_frame;
+                    latency.push_back(frame_ms * r.decision_frame);
+                }
+                std::sort(latency.begin(), latency.end());
+                std::printf("%8g %6zu %9.2f%% %8zu %6.1f%% %9.0f / %6.0f / %6.0f %7.1f%% %9.1f%%\n", margin,
+                            config.frames, corpus.size() ? 100.0 * correct / corpus.size() : 0.0, changed,
+                            corpus.size() ? 100.0 * early / corpus.size() : 0.0, percentile(latency, 50.0),
+                            percentile(latency, 90.0), latency.empty() ? 0.0 : latency.back(),
+                            corpus.total_frames() ? 100.0 * scored / corpus.total_frames() : 0.0,
+                            full_evaluations ? 100.0 * (cache.evaluations() - evaluations) / full_evaluations
+                                             : 0.0);
+            }
+        }
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_early_decision: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
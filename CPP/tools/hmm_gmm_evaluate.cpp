@@ -0,0 +1,267 @@
+/******************************************************************************
+* File Name:   hmm_gmm_evaluate.cpp
+*
+* Description: Parallel evaluation of a compiled model set on a packed test
+*              corpus, the batch counterpart of hmm_gmm_testing.m:
+*
+*              hmm_gmm_evaluate [options] <model.hmmb> <test.feat>
+*
+*              The utterances are decoded on a pool of workers, longest
+*              first, each worker with its own emission cache. Results are
+*              stored per utterance and reduced in corpus order, so every
+*              number except the timings is the same for any thread count.
+*              Reports the accuracy, the confusion matrix, the latency
+*              percentiles of the utterances and the real-time factor.
+*
+*******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/gaussian_scorer.hpp"
+#include "hmm_gmm/parallel.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    std::string emissions = "lazy";
+    std::string tier = "exact";
+    std::string schedule = "longest";
+    std::string results;
+    std::size_t threads = 0;        /* 0 = all hardware threads */
+    std::vector<std::string> positional;
+};
+
+struct utterance_result
+{
+    recognition_result decision;
+    double seconds = 0.0;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_evaluate [options] <model.hmmb> <test.feat>\n"
+        "  --threads <n>     worker threads (all hardware threads)\n"
+        "  --emissions <m>   lazy|bulk, as hmm_gmm_decode (lazy)\n"
+        "  --tier <t>        log-add tier of the bulk scorer: exact|polynomial|table (exact)\n"
+        "  --schedule <s>    longest: longest utterances first (default), corpus: corpus order\n"
+        "  --results <f>     write index, label, decision, score, frames and latency per utterance\n");
+}
+
+log_add_tier parse_tier(const std::string &name)
+{
+    for (log_add_tier tier : {log_add_tier::exact, log_add_tier::polynomial, log_add_tier::table})
+    {
+        if (name == log_add_tier_name(tier))
+        {
+            return tier;
+        }
+    }
+    throw std::invalid_argument("unknown log-add tier " + name);
+}
+
+/* Nearest-rank percentile of sorted values */
+double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    const std::size_t rank = (std::size_t)std::ceil(p / 100.0 * (double)sorted.size());
+    return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+void print_confusion(const feature_corpus &corpus, const std::vector<utterance_result> &results,
+                     std::size_t model_no)
+{
+    /* rows: label 1..model_no, columns: decision 1..model_no and "none" (every score -Inf) */
+    std::vector<std::size_t> confusion(model_no * (model_no + 1), 0);
+    std::size_t unlabelled = 0;
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        const int32_t label = corpus[u].label;
+        if (label < 1 || (std::size_t)label > model_no)
+        {
+            unlabelled++;
+            continue;
+        }
+        const int decision = results[u].decision.model;
+        confusion[(std::size_t)(label - 1) * (model_no + 1) + (decision < 0 ? model_no : (std::size_t)decision)]++;
+    }
+
+    std::printf("\nconfusion matrix (rows: label, columns: decision)\n%6s", "");
+    for (std::size_t k = 0; k < model_no; k++)
+    {
+        std::printf(" %6zu", k + 1);
+    }
+    std::printf(" %6s %8s\n", "none", "correct");
+    for (std::size_t l = 0; l < model_no; l++)
+    {
+        const std::size_t *row = &confusion[l * (model_no + 1)];
+        const std::size_t total = std::accumulate(row, row + model_no + 1, (std::size_t)0);
+        std::printf("%6zu", l + 1);
+        for (std::size_t k = 0; k <= model_no; k++)
+        {
+            std::printf(" %6zu", row[k]);
+        }
+        std::printf(" %7.2f%%\n", total ? 100.0 * row[l] / total : 0.0);
+    }
+    if (unlabelled)
+    {
+        std::printf("%zu utterance(s) with a label outside 1..%zu left out\n", unlabelled, model_no);
+    }
+}
+
+void write_results(const std::string &filename, const feature_corpus &corpus,
+                   const std::vector<utterance_result> &results)
+{
+    std::ofstream out(filename, std::ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error("cannot create " + filename);
+    }
+    char line[128];
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        std::snprintf(line, sizeof(line), "%zu %d %d %.6f %zu %.3f\n", u, corpus[u].label,
+                      results[u].decision.model + 1, results[u].decision.score, corpus[u].features.frame_no,
+                      1e3 * results[u].seconds);
+        out << line;
+    }
+    if (!out)
+    {
+        throw std::runtime_error("cannot write " + filename);
+    }
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    options opt;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc)        opt.threads = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--emissions" && i + 1 < argc) opt.emissions = argv[++i];
+        else if (arg == "--tier" && i + 1 < argc)      opt.tier = argv[++i];
+        else if (arg == "--schedule" && i + 1 < argc)  opt.schedule = argv[++i];
+        else if (arg == "--results" && i + 1 < argc)   opt.results = argv[++i];
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            opt.positional.push_back(arg);
+        }
+    }
+    if (opt.positional.size() != 2 || (opt.emissions != "lazy" && opt.emissions != "bulk") ||
+        (opt.schedule != "longest" && opt.schedule != "corpus"))
+    {
+        usage();
+        return 2;
+    }
+
+    try
+    {
+        const compiled_model model(opt.positional[0]);
+        const feature_corpus corpus(opt.positional[1]);
+        const std::size_t threads = std::max<std::size_t>(1, std::min(opt.threads ? opt.threads : hardware_threads(),
+                                                                      corpus.size()));
+
+        /* one cache per worker, reused for all its utterances; the scorer is shared read-only */
+        std::unique_ptr<gaussian_scorer> scorer;
+        std::vector<std::unique_ptr<emission_cache>> caches;
+        if (opt.emissions == "bulk")
+        {
+            scorer = std::make_unique<gaussian_scorer>(model);
+        }
+        for (std::size_t w = 0; w < threads; w++)
+        {
+            caches.push_back(scorer ? std::make_unique<emission_cache>(model, *scorer, parse_tier(opt.tier))
+                                    : std::make_unique<emission_cache>(model));
+        }
+
+        std::vector<std::size_t> order(corpus.size());
+        std::iota(order.begin(), order.end(), (std::size_t)0);
+        if (opt.schedule == "longest")
+        {
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                return corpus[a].features.frame_no > corpus[b].features.frame_no;
+            });
+        }
+
+        std::vector<utterance_result> results(corpus.size());
+        const auto start = std::chrono::steady_clock::now();
+        parallel_for(order, threads, [&](std::size_t u, std::size_t worker) {
+            const auto begin = std::chrono::steady_clock::now();
+            results[u].decision = recognise(*caches[worker], corpus[u].features);
+            results[u].seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        });
+        const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        /* reduction in corpus order */
+        std::size_t correct = 0;
+        double busy = 0.0;
+        std::vector<double> latency(corpus.size());
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            correct += (results[u].decision.model + 1 == corpus[u].label);
+            busy += results[u].seconds;
+            latency[u] = results[u].seconds;
+        }
+        std::sort(latency.begin(), latency.end());
+
+        /* samp_period is in HTK units of 100 ns */
+        const double audio = (double)corpus.total_frames() * corpus.samp_period() * 1e-7;
+        std::printf("%zu utterances, %zu frames (%.1f s of audio), %zu models x %zu states x %zu mixtures\n",
+                    corpus.size(), corpus.total_frames(), audio, model.model_no(), model.state_no(), model.mix_no());
+        std::printf("accuracy        %.2f %% (%zu / %zu)\n", corpus.size() ? 100.0 * correct / corpus.size() : 0.0,
+                    correct, corpus.size());
+        std::printf("wall time       %.4f s on %zu thread(s), %s (%s emissions)\n", wall, threads,
+                    opt.schedule == "longest" ? "longest first" : "corpus order", opt.emissions.c_str());
+        if (audio > 0.0)
+        {
+            std::printf("real-time       %.5f wall, %.5f per thread (sum of the utterance times)\n", wall / audio,
+                        busy / audio);
+        }
+        std::printf("latency [ms]    p50 %.3f, p90 %.3f, p99 %.3f, max %.3f, mean %.3f\n",
+                    1e3 * percentile(latency, 50.0), 1e3 * percentile(latency, 90.0), 1e3 * percentile(latency, 99.0),
+                    latency.empty() ? 0.0 : 1e3 * latency.back(), corpus.size() ? 1e3 * busy / corpus.size() : 0.0);
+        print_confusion(corpus, results, model.model_no());
+
+        if (!opt.results.empty())
+        {
+            write_results(opt.results, corpus, results);
+        }
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_evaluate: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
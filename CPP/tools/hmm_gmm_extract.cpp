@@ -0,0 +1,404 @@
+/******************************************************************************
+* File Name:   hmm_gmm_extract.cpp
+*
+* Description: Command line replacement for run_feature_extraction.m. Converts
+*              a WAV file, or every WAV file below a directory, to HTK
+*              MFCC_E_D_A parameter files.
+*
+*              hmm_gmm_extract [options] <in.wav|indir> <out.mfc|outdir>
+*
+*              Recordings are resampled to the front-end rate (16 kHz) with a
+*              polyphase filter unless --target-rate 0 is given.
+*
+*              Directories are processed in parallel. Rebuilds are incremental:
+*              outdir/.hmm_gmm_extract.cache records for every output the
+*              hash of its input content and of the front-end settings, and
+*              outputs whose key is unchanged are skipped.
+*
+*******************************************************************************/
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/content_hash.hpp"
+#include "hmm_gmm/feature_cache.hpp"
+#include "hmm_gmm/htk_file.hpp"
+#include "hmm_gmm/mfcc.hpp"
+#include "hmm_gmm/parallel.hpp"
+#include "hmm_gmm/resampler.hpp"
+#include "hmm_gmm/wav_file.hpp"
+
+namespace fs = std::filesystem;
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    mfcc_config config;
+    double dither = 0.05;           /* noise variance added in read_file_and_compute_mfcc */
+    double target_rate = 16000.0;   /* 0 = analyse every file at its own rate */
+    unsigned long seed = 0;
+    std::string in_filter = "\\.[Ww][Aa][Vv]";
+    std::string out_ext = ".mfc";
+    std::size_t threads = 0;        /* 0 = all hardware threads */
+    bool use_cache = true;
+    bool rehash = false;
+};
+
+const char CACHE_MANIFEST[] = ".hmm_gmm_extract.cache";
+
+/* Bump when the output of the extractor changes for identical settings */
+const char EXTRACTOR_VERSION[] = "hmm_gmm_extract 3";
+
+struct job
+{
+    fs::path in;
+    fs::path out;
+    std::string key_name;           /* output path relative to outdir */
+    cache_entry entry;
+    bool skipped = false;
+    double seconds = 0.0;
+    std::string error;              /* empty if the file was extracted or skipped */
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_extract [options] <in.wav|indir> <out.mfc|outdir>\n"
+        "  --frame-size-sec <s>   frame length (0.025)\n"
+        "  --frame-shift-sec <s>  frame shift (0.010)\n"
+        "  --bank-no <n>          number of mel filters (26)\n"
+        "  --cep-order <n>        number of cepstra (12)\n"
+        "  --lifter <n>           lifter coefficient (22)\n"
+        "  --pre-emp <a>          pre-emphasis coefficient (0)\n"
+        "  --no-hamming           disable the hamming window\n"
+        "  --dither <var>         variance of the added gaussian noise (0.05, 0 = off)\n"
+        "  --seed <n>             dither seed (0)\n"
+        "  --target-rate <hz>     resample to this rate first (16000, 0 = keep the file rate)\n"
+        "  --threads <n>          worker threads (all hardware threads)\n"
+        "  --no-cache             re-extract every file, do not write the cache\n"
+        "  --rehash               hash every input even if size and mtime are unchanged\n");
+}
+
+uint64_t fnv1a(const std::string &s)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : s)
+    {
+        h = (h ^ c) * 1099511628211ull;
+    }
+    return h;
+}
+
+/*
+ * Per worker front-end state: extractors per analysis rate (frame sizes follow
+ * fs), resamplers per input rate and the decode buffer, all reused across files
+ */
+class extractor_cache
+{
+public:
+    explicit extractor_cache(const mfcc_config &config) : config_(config) {}
+
+    std::vector<float> decode_buffer;
+
+    polyphase_resampler &resampler(double in_rate, double out_rate)
+    {
+        auto it = resamplers_.find(in_rate);
+        if (it == resamplers_.end())
+        {
+            it = resamplers_.emplace(in_rate, std::make_unique<polyphase_resampler>(in_rate, out_rate)).first;
+        }
+        return *it->second;
+    }
+
+    mfcc_extractor &get(double sample_rate)
+    {
+        auto it = extractors_.find(sample_rate);
+        if (it == extractors_.end())
+        {
+            mfcc_config c = config_;
+            c.sample_rate = sample_rate;
+            it = extractors_.emplace(sample_rate, std::make_unique<mfcc_extractor>(c)).first;
+        }
+        return *it->second;
+    }
+
+private:
+    mfcc_config config_;
+    std::map<double, std::unique_ptr<mfcc_extractor>> extractors_;
+    std::map<double, std::unique_ptr<polyphase_resampler>> resamplers_;
+};
+
+/* Decodes the recording straight from the mapping, resampled to opt.target_rate if set */
+wav_data load_audio(const options &opt, extractor_cache &cache, const fs::path &in)
+{
+    const wav_reader reader(in.string());
+    wav_data wav;
+    if (opt.target_rate <= 0.0 || reader.sample_rate() == opt.target_rate)
+    {
+        wav.sample_rate = reader.sample_rate();
+        wav.samples.resize(reader.frame_count());
+        reader.decode(0, reader.frame_count(), wav.samples.data());
+        return wav;
+    }
+    std::vector<float> &native = cache.decode_buffer;
+    native.resize(reader.frame_count());
+    reader.decode(0, reader.frame_count(), native.data());
+    wav.sample_rate = opt.target_rate;
+    wav.samples = cache.resampler(reader.sample_rate(), opt.target_rate).resample(native.data(), native.size());
+    return wav;
+}
+
+/*
+ * Returns the duration of the input in seconds. The dither noise is seeded
+ * from name, the output path relative to outdir, so files of the same name in
+ * different sub-directories get different noise.
+ */
+double process_file(const options &opt, extractor_cache &cache, const fs::path &in, const fs::path &out,
+                    const std::string &name)
+{
+    wav_data wav = load_audio(opt, cache, in);
+    if (opt.dither > 0.0)
+    {
+        /* Add small amount of noise to prevent NaN for perfectly zero input */
+        std::mt19937_64 rng(opt.seed ^ fnv1a(name));
+        std::normal_distribution<float> noise(0.0f, (float)std::sqrt(opt.dither));
+        for (float &s : wav.samples)
+        {
+            s += noise(rng);
+        }
+    }
+
+    mfcc_extractor &extractor = cache.get(wav.sample_rate);
+    feature_matrix features = extractor.compute(wav.samples.data(), wav.samples.size());
+    write_htk_file(out.string(), features, extractor.config().htk_samp_period());
+    return (double)wav.samples.size() / wav.sample_rate;
+}
+
+/* compute_feature_vectors(): recurse into sub-directories, mirror them in outdir */
+void collect_jobs(const options &opt, const fs::path &indir, const fs::path &outdir, const fs::path &relative,
+                  std::vector<job> &jobs)
+{
+    fs::create_directories(outdir / relative);
+    const std::regex filter(opt.in_filter);
+    for (const fs::directory_entry &entry : fs::directory_iterator(indir))
+    {
+        const fs::path &p = entry.path();
+        if (entry.is_directory())
+        {
+            collect_jobs(opt, p, outdir, relative / p.filename(), jobs);
+        }
+        else if (std::regex_search(p.filename().string(), filter))
+        {
+            job j;
+            j.in = p;
+            fs::path name = relative / p.stem();
+            name += opt.out_ext;
+            j.out = outdir / name;
+            j.key_name = name.generic_string();
+            jobs.push_back(j);
+        }
+    }
+}
+
+uint64_t config_hash(const options &opt)
+{
+    char extra[128];
+    std::snprintf(extra, sizeof(extra), " dither=%.17g seed=%lu target_rate=%.17g ext=",
+                  opt.dither, opt.seed, opt.target_rate);
+    return hash64(std::string(EXTRACTOR_VERSION) + " " + opt.config.to_string() + extra + opt.out_ext);
+}
+
+/* Size, mtime and content hash of the input; the hash is reused when size and mtime match the cache */
+cache_entry describe_input(const options &opt, const fs::path &in, const cache_entry *cached)
+{
+    cache_entry entry;
+    entry.input_size = (uint64_t)fs::file_size(in);
+    entry.input_mtime = (int64_t)fs::last_write_time(in).time_since_epoch().count();
+    if (cached && !opt.rehash && cached->input_size == entry.input_size && cached->input_mtime == entry.input_mtime)
+    {
+        entry.content_hash = cached->content_hash;
+    }
+    else
+    {
+        entry.content_hash = hash_file(in.string());
+    }
+    return entry;
+}
+
+/* Files that cannot be extracted are reported and left out of the manifest; returns their number */
+std::size_t process_directory(const options &opt, const fs::path &indir, const fs::path &outdir,
+                              std::size_t &files, std::size_t &skipped, double &seconds)
+{
+    std::vector<job> jobs;
+    collect_jobs(opt, indir, outdir, fs::path(), jobs);
+
+    feature_cache cache((outdir / CACHE_MANIFEST).string());
+    if (!opt.use_cache)
+    {
+        cache.clear();
+    }
+    const uint64_t settings = config_hash(opt);
+
+    const std::size_t threads = opt.threads ? opt.threads : hardware_threads();
+    std::vector<extractor_cache> extractors;
+    for (std::size_t w = 0; w < threads; w++)
+    {
+        extractors.emplace_back(opt.config);
+    }
+    parallel_for(jobs.size(), threads, [&](std::size_t i, std::size_t worker) {
+        job &j = jobs[i];
+        try
+        {
+            const cache_entry *cached = opt.use_cache ? cache.find(j.key_name) : nullptr;
+            j.entry = describe_input(opt, j.in, cached);
+            j.entry.key = feature_cache::make_key(j.entry.content_hash, settings);
+            if (cached && cached->key == j.entry.key && fs::exists(j.out))
+            {
+                j.skipped = true;
+                return;
+            }
+            j.seconds = process_file(opt, extractors[worker], j.in, j.out, j.key_name);
+        }
+        catch (const std::exception &e)
+        {
+            /* one bad file must not cost the manifest entries of the others */
+            j.error = e.what();
+        }
+    });
+
+    /* The manifest is rebuilt from this run, so entries of deleted inputs drop out */
+    feature_cache updated((outdir / CACHE_MANIFEST).string());
+    updated.clear();
+    std::size_t failed = 0;
+    for (const job &j : jobs)
+    {
+        if (!j.error.empty())
+        {
+            std::fprintf(stderr, "hmm_gmm_extract: %s: %s\n", j.in.string().c_str(), j.error.c_str());
+            failed++;
+            continue;
+        }
+        updated.store(j.key_name, j.entry);
+        if (j.skipped)
+        {
+            skipped++;
+        }
+        else
+        {
+            files++;
+            seconds += j.seconds;
+        }
+    }
+    if (opt.use_cache)
+    {
+        updated.save();
+    }
+    return failed;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    options opt;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        auto value = [&]() -> const char * {
+            if (i + 1 >= argc)
+            {
+                usage();
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--frame-size-sec")       opt.config.frame_size_sec = std::atof(value());
+        else if (arg == "--frame-shift-sec") opt.config.frame_shift_sec = std::atof(value());
+        else if (arg == "--bank-no")         opt.config.bank_no = std::atoi(value());
+        else if (arg == "--cep-order")       opt.config.cep_order = std::atoi(value());
+        else if (arg == "--lifter")          opt.config.lifter = std::atoi(value());
+        else if (arg == "--pre-emp")         opt.config.pre_emp = std::atof(value());
+        else if (arg == "--no-hamming")      opt.config.use_hamming = false;
+        else if (arg == "--dither")          opt.dither = std::atof(value());
+        else if (arg == "--seed")            opt.seed = std::strtoul(value(), nullptr, 10);
+        else if (arg == "--target-rate")     opt.target_rate = std::atof(value());
+        else if (arg == "--threads")         opt.threads = std::strtoul(value(), nullptr, 10);
+        else if (arg == "--no-cache")        opt.use_cache = false;
+        else if (arg == "--rehash")          opt.rehash = true;
+        else if (arg == "-h" || arg == "--help")
+        {
+            usage();
+            return 0;
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2)
+    {
+        usage();
+        return 2;
+    }
+
+    try
+    {
+        const fs::path in = positional[0];
+        const fs::path out = positional[1];
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t files = 0;
+        std::size_t skipped = 0;
+        std::size_t failed = 0;
+        double audio_seconds = 0.0;
+        if (fs::is_directory(in))
+        {
+            failed = process_directory(opt, in, out, files, skipped, audio_seconds);
+        }
+        else
+        {
+            extractor_cache cache(opt.config);
+            audio_seconds = process_file(opt, cache, in, out, in.filename().generic_string());
+            files = 1;
+        }
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%zu file(s) extracted, %zu up to date, %.1f s of audio in %.3f s\n",
+                    files, skipped, audio_seconds, elapsed);
+        if (files > 0 && elapsed > 0.0)
+        {
+            std::printf("%.1f files/s, %.2f audio hours per wall-clock hour\n", files / elapsed, audio_seconds / elapsed);
+        }
+        if (failed > 0)
+        {
+            std::fprintf(stderr, "hmm_gmm_extract: %zu file(s) failed\n", failed);
+            return 1;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_extract: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
+
+/* [] END OF FILE */
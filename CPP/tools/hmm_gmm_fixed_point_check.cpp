@@ -0,0 +1,489 @@
+/******************************************************************************
+* File Name:   hmm_gmm_fixed_point_check.cpp
+*
+* Description: Host harness for the PSoC6 fixed-point front-end
+*              (gmm_hmm/fixed_point_mfcc.c). Every stage is fed the output of
+*              the previous fixed-point stage and compared with the floating
+*              point computation of the same stage; the complete frame is
+*              compared with mfcc_extractor. Exits with status 1 if any error
+*              exceeds the bound documented in fixed_point_mfcc.h, or if
+*              the linked constant tables differ from freshly computed ones.
+*
+*              hmm_gmm_fixed_point_check [file.wav ...]
+*              hmm_gmm_fixed_point_check --tables fixed_point_mfcc_tables.c
+*
+*              --tables writes the const tables of the front-end as C
+*              source (the file committed next to fixed_point_mfcc.c).
+*
+*              Recordings at other rates are resampled to 16 kHz first.
+*
+*              Without arguments a set of synthetic 16 kHz signals is used
+*              (tones, chirp, noise at several levels, clipped square wave).
+*
+*******************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fixed_point_mfcc.h"
+#include "fixed_point_mfcc_tables.h"
+#include "hmm_gmm/mfcc.hpp"
+#include "hmm_gmm/real_fft.hpp"
+#include "hmm_gmm/resampler.hpp"
+#include "hmm_gmm/wav_file.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct stage_error
+{
+    const char *name;
+    double bound;
+    double max_error = 0.0;
+    std::size_t frames = 0;
+};
+
+struct test_signal
+{
+    std::string name;
+    std::vector<int16_t> samples;
+};
+
+/* The constant tables of fixed_point_mfcc.c */
+struct mfcc_tables
+{
+    std::vector<int32_t> hamming;
+    std::vector<int32_t> twiddle_re;
+    std::vector<int32_t> twiddle_im;
+    std::vector<int32_t> split_re;
+    std::vector<int32_t> split_im;
+    std::vector<int32_t> bit_reverse;
+    std::vector<int32_t> filter_first_bin;
+    std::vector<int32_t> filter_length;
+    std::vector<int32_t> filter_offset;
+    std::vector<int32_t> filter_weight;
+    std::vector<int32_t> log2_table;
+    std::vector<int32_t> dct_lifter;
+};
+
+int32_t to_fixed(double value, int frac_bits)
+{
+    const double scaled = std::floor(value * (double)(1LL << frac_bits) + 0.5);
+    return (int32_t)std::clamp(scaled, -2147483648.0, 2147483647.0);
+}
+
+/* The mel filter bank follows wav2mfcc.m and mfcc_extractor exactly, only the weights are rounded to Q24 */
+mfcc_tables compute_tables()
+{
+    const double pi = std::acos(-1.0);
+    const double fs = FXP_MFCC_SAMPLE_RATE_HZ;
+    const double fft_n = FXP_MFCC_FFT_SIZE;
+    const std::size_t half = FXP_MFCC_FFT_HALF;
+    mfcc_tables t;
+
+    for (std::size_t k = 0; k < FXP_MFCC_FRAME_SIZE; k++)
+    {
+        t.hamming.push_back(to_fixed(0.54 - 0.46 * std::cos(2.0 * pi * k / (FXP_MFCC_FRAME_SIZE - 1.0)),
+                                     FXP_MFCC_HAMMING_FRAC_BITS));
+    }
+    for (std::size_t k = 0; k < half / 2; k++)
+    {
+        t.twiddle_re.push_back(to_fixed(std::cos(2.0 * pi * k / half), FXP_MFCC_TWIDDLE_FRAC_BITS));
+        t.twiddle_im.push_back(to_fixed(-std::sin(2.0 * pi * k / half), FXP_MFCC_TWIDDLE_FRAC_BITS));
+    }
+    for (std::size_t k = 0; k <= half; k++)
+    {
+        t.split_re.push_back(to_fixed(std::cos(2.0 * pi * k / fft_n), FXP_MFCC_TWIDDLE_FRAC_BITS));
+        t.split_im.push_back(to_fixed(-std::sin(2.0 * pi * k / fft_n), FXP_MFCC_TWIDDLE_FRAC_BITS));
+    }
+    for (std::size_t i = 0; i < half; i++)
+    {
+        int32_t r = 0;
+        for (std::size_t k = 0; k < FXP_MFCC_FFT_HALF_BITS; k++)
+        {
+            r |= (int32_t)((i >> k) & 1u) << (FXP_MFCC_FFT_HALF_BITS - 1u - k);
+        }
+        t.bit_reverse.push_back(r);
+    }
+
+    const double max_mf = 2595.0 * std::log10(1.0 + 0.5 * fs / 700.0);
+    const double delta_mf = max_mf / (FXP_MFCC_BANK_NO + 1.0);
+    std::vector<double> f(FXP_MFCC_BANK_NO + 2);
+    for (std::size_t m = 0; m < f.size(); m++)
+    {
+        f[m] = (std::pow(10.0, m * delta_mf / 2595.0) - 1.0) * 700.0;
+    }
+    for (std::size_t m = 0; m < FXP_MFCC_BANK_NO; m++)
+    {
+        const double kmin = f[m] / fs * fft_n + 1.0;
+        const double kcen = f[m + 1] / fs * fft_n + 1.0;
+        const double kmax = f[m + 2] / fs * fft_n + 1.0;
+        const long k_first = (long)std::ceil(kmin);
+        const long k_last = std::min((long)std::floor(kmax), (long)FXP_MFCC_NUM_BINS);
+
+        t.filter_first_bin.push_back((int32_t)(k_first - 1));
+        t.filter_offset.push_back((int32_t)t.filter_weight.size());
+        for (long k = k_first; k <= k_last; k++)
+        {
+            const double mel_k = 2595.0 * std::log10(1.0 + (k - 1) / fft_n * fs / 700.0);
+            const double w = (k < kcen) ? (mel_k - m * delta_mf) / delta_mf
+                                        : 1.0 - (mel_k - delta_mf * (m + 1.0)) / delta_mf;
+            t.filter_weight.push_back(to_fixed(w, FXP_MFCC_FILTER_WEIGHT_FRAC_BITS));
+        }
+        t.filter_length.push_back((int32_t)t.filter_weight.size() - t.filter_offset.back());
+    }
+
+    for (std::size_t i = 0; i < FXP_MFCC_LOG2_TABLE_SIZE; i++)
+    {
+        t.log2_table.push_back(to_fixed(std::log2(1.0 + (double)i / (1u << FXP_MFCC_LOG2_TABLE_BITS)),
+                                        FXP_MFCC_LOG2_TABLE_FRAC_BITS));
+    }
+
+    /* inverse cosine transform with the lifter weighting folded in */
+    for (std::size_t k = 0; k < FXP_MFCC_CEP_ORDER; k++)
+    {
+        const double lifter = 1.0 + (FXP_MFCC_LIFTER / 2.0) * std::sin(pi * (k + 1.0) / FXP_MFCC_LIFTER);
+        for (std::size_t m = 0; m < FXP_MFCC_BANK_NO; m++)
+        {
+            const double c = std::sqrt(2.0 / FXP_MFCC_BANK_NO) * std::cos((k + 1.0) * pi / FXP_MFCC_BANK_NO * (m + 0.5));
+            t.dct_lifter.push_back(to_fixed(lifter * c, FXP_MFCC_DCT_FRAC_BITS));
+        }
+    }
+    return t;
+}
+
+void write_table(std::ostream &out, const char *type, const char *name, const std::vector<int32_t> &values)
+{
+    out << "\nconst " << type << " " << name << "[" << values.size() << "] =\n{\n";
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        /* -2147483648 is not an int literal */
+        const std::string v = (values[i] == INT32_MIN) ? "INT32_MIN" : std::to_string(values[i]);
+        out << ((i % 8 == 0) ? "    " : " ") << v << "," << ((i % 8 == 7 || i + 1 == values.size()) ? "\n" : "");
+    }
+    out << "};\n";
+}
+
+void write_tables(const std::string &filename, const mfcc_tables &t)
+{
+    std::ofstream out(filename, std::ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error("cannot create " + filename);
+    }
+    out << "/* Generated by hmm_gmm_fixed_point_check --tables. Do not edit. */\n"
+        << "#include \"fixed_point_mfcc_tables.h\"\n";
+    write_table(out, "int32_t", "fxp_mfcc_hamming_q31", t.hamming);
+    write_table(out, "int32_t", "fxp_mfcc_twiddle_re_q31", t.twiddle_re);
+    write_table(out, "int32_t", "fxp_mfcc_twiddle_im_q31", t.twiddle_im);
+    write_table(out, "int32_t", "fxp_mfcc_split_re_q31", t.split_re);
+    write_table(out, "int32_t", "fxp_mfcc_split_im_q31", t.split_im);
+    write_table(out, "uint16_t", "fxp_mfcc_bit_reverse", t.bit_reverse);
+    write_table(out, "uint16_t", "fxp_mfcc_filter_first_bin", t.filter_first_bin);
+    write_table(out, "uint16_t", "fxp_mfcc_filter_length", t.filter_length);
+    write_table(out, "uint16_t", "fxp_mfcc_filter_offset", t.filter_offset);
+    write_table(out, "uint32_t", "fxp_mfcc_filter_weight_q24", t.filter_weight);
+    write_table(out, "int32_t", "fxp_mfcc_log2_table_q30", t.log2_table);
+    write_table(out, "int32_t", "fxp_mfcc_dct_lifter_q28", t.dct_lifter);
+    if (!out)
+    {
+        throw std::runtime_error("cannot write " + filename);
+    }
+}
+
+template <typename T>
+bool same_table(const char *name, const T *linked, const std::vector<int32_t> &expected)
+{
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        if ((int32_t)linked[i] != expected[i])
+        {
+            std::printf("table %s differs at %zu: %ld, expected %ld\n", name, i, (long)linked[i], (long)expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* The linked fixed_point_mfcc_tables.c against freshly computed tables */
+bool check_tables(const mfcc_tables &t)
+{
+    bool same = same_table("hamming", fxp_mfcc_hamming_q31, t.hamming);
+    same = same_table("twiddle_re", fxp_mfcc_twiddle_re_q31, t.twiddle_re) && same;
+    same = same_table("twiddle_im", fxp_mfcc_twiddle_im_q31, t.twiddle_im) && same;
+    same = same_table("split_re", fxp_mfcc_split_re_q31, t.split_re) && same;
+    same = same_table("split_im", fxp_mfcc_split_im_q31, t.split_im) && same;
+    same = same_table("bit_reverse", fxp_mfcc_bit_reverse, t.bit_reverse) && same;
+    same = same_table("filter_first_bin", fxp_mfcc_filter_first_bin, t.filter_first_bin) && same;
+    same = same_table("filter_length", fxp_mfcc_filter_length, t.filter_length) && same;
+    same = same_table("filter_offset", fxp_mfcc_filter_offset, t.filter_offset) && same;
+    same = same_table("filter_weight", fxp_mfcc_filter_weight_q24, t.filter_weight) && same;
+    same = same_table("log2_table", fxp_mfcc_log2_table_q30, t.log2_table) && same;
+    same = same_table("dct_lifter", fxp_mfcc_dct_lifter_q28, t.dct_lifter) && same;
+    std::printf("constant tables %s\n", same ? "ok" : "FAIL (regenerate with --tables)");
+    return same;
+}
+
+int16_t clip16(double v)
+{
+    return (int16_t)std::lround(std::clamp(v, -32768.0, 32767.0));
+}
+
+std::vector<test_signal> synthetic_signals()
+{
+    const double pi = std::acos(-1.0);
+    const double fs = FXP_MFCC_SAMPLE_RATE_HZ;
+    const std::size_t n = FXP_MFCC_SAMPLE_RATE_HZ;
+    std::mt19937 rng(5110);
+    std::normal_distribution<double> gauss(0.0, 1.0);
+    std::vector<test_signal> signals;
+
+    auto make = [&](const char *name, auto generator) {
+        test_signal s{name, std::vector<int16_t>(n)};
+        for (std::size_t i = 0; i < n; i++)
+        {
+            s.samples[i] = clip16(generator((double)i / fs));
+        }
+        signals.push_back(s);
+    };
+
+    make("tone 440 Hz, -10 dBFS", [&](double t) { return 10000.0 * std::sin(2 * pi * 440 * t) + gauss(rng); });
+    make("tone 3 kHz, -50 dBFS", [&](double t) { return 100.0 * std::sin(2 * pi * 3000 * t) + gauss(rng); });
+    make("chirp 100-7000 Hz", [&](double t) { return 8000.0 * std::sin(2 * pi * (100 * t + 3450 * t * t)); });
+    make("white noise, -20 dBFS", [&](double) { return 3000.0 * gauss(rng); });
+    make("white noise, -80 dBFS", [&](double) { return 3.0 * gauss(rng); });
+    make("clipped square 250 Hz", [&](double t) { return (std::sin(2 * pi * 250 * t) >= 0.0) ? 32767.0 : -32768.0; });
+    make("harmonic vowel", [&](double t) {
+        double v = 0.0;
+        for (int h = 1; h <= 20; h++)
+        {
+            v += 4000.0 / h * std::sin(2 * pi * 120 * h * t) * (1.0 + 0.5 * std::sin(2 * pi * 3 * t));
+        }
+        return v + 30.0 * gauss(rng);
+    });
+    return signals;
+}
+
+void check_signal(const test_signal &signal, mfcc_extractor &reference, real_fft &fft, std::vector<stage_error> &errors)
+{
+    const std::size_t frame_size = FXP_MFCC_FRAME_SIZE;
+    const std::size_t bins = FXP_MFCC_NUM_BINS;
+    const std::size_t bank_no = FXP_MFCC_BANK_NO;
+    const std::size_t cep_order = FXP_MFCC_CEP_ORDER;
+    const double q16 = 65536.0;
+
+    std::vector<int32_t> windowed(frame_size);
+    std::vector<uint32_t> magnitude(bins);
+    std::vector<int32_t> log_mel(bank_no);
+    std::vector<int32_t> cepstra(cep_order);
+    std::vector<int32_t> fixed_frame(FXP_MFCC_STATIC_DIM);
+    std::vector<double> fft_in(FXP_MFCC_FFT_SIZE, 0.0);
+    std::vector<double> fft_out(bins);
+    std::vector<double> static_ref(FXP_MFCC_STATIC_DIM);
+    std::vector<float> frame_float(frame_size);
+
+    const std::vector<double> &window = reference.window();
+    const auto &filters = reference.mel_filters();
+    const std::vector<double> &dct = reference.dct_matrix();
+    const std::vector<double> &lifter = reference.lifter_weights();
+
+    const std::size_t frame_no = reference.frame_count(signal.samples.size());
+    for (std::size_t fr = 0; fr < frame_no; fr++)
+    {
+        const int16_t *frame = &signal.samples[fr * FXP_MFCC_FRAME_SHIFT];
+
+        /* window */
+        fxp_mfcc_window(frame, windowed.data());
+        for (std::size_t k = 0; k < frame_size; k++)
+        {
+            const double fixed = windowed[k] / 32768.0;
+            errors[0].max_error = std::max(errors[0].max_error, std::fabs(fixed - frame[k] * window[k]));
+            fft_in[k] = fixed;
+        }
+
+        /* FFT, relative to the largest bin */
+        const int32_t exponent = fxp_mfcc_fft_magnitude(windowed.data(), magnitude.data());
+        fft.magnitude(fft_in.data(), fft_out.data());
+        const double peak = *std::max_element(fft_out.begin(), fft_out.end());
+        if (peak > 0.0)
+        {
+            for (std::size_t k = 0; k < bins; k++)
+            {
+                const double fixed = std::ldexp((double)magnitude[k], exponent);
+                errors[1].max_error = std::max(errors[1].max_error, std::fabs(fixed - fft_out[k]) / peak);
+            }
+        }
+
+        /* filter bank + log */
+        fxp_mfcc_filter_bank(magnitude.data(), exponent, log_mel.data());
+        for (std::size_t m = 0; m < bank_no; m++)
+        {
+            double mel_power = 0.0;
+            for (std::size_t k = 0; k < filters[m].weights.size(); k++)
+            {
+                mel_power += std::ldexp((double)magnitude[filters[m].first_bin + k], exponent) * filters[m].weights[k];
+            }
+            if (mel_power > 0.0)
+            {
+                errors[2].max_error = std::max(errors[2].max_error, std::fabs(log_mel[m] / q16 - std::log(mel_power)));
+            }
+        }
+
+        /* log energy */
+        double energy = 0.0;
+        for (std::size_t k = 0; k < frame_size; k++)
+        {
+            energy += (double)frame[k] * frame[k];
+        }
+        if (energy > 0.0)
+        {
+            errors[3].max_error = std::max(errors[3].max_error,
+                                           std::fabs(fxp_mfcc_log_energy(frame) / q16 - std::log(energy)));
+        }
+
+        /* DCT + lifter */
+        fxp_mfcc_dct(log_mel.data(), cepstra.data());
+        for (std::size_t k = 0; k < cep_order; k++)
+        {
+            double c = 0.0;
+            for (std::size_t m = 0; m < bank_no; m++)
+            {
+                c += dct[k * bank_no + m] * (log_mel[m] / q16);
+            }
+            errors[4].max_error = std::max(errors[4].max_error, std::fabs(cepstra[k] / q16 - lifter[k] * c));
+        }
+
+        /* end to end against the floating point front-end */
+        fxp_mfcc_compute_frame(frame, fixed_frame.data());
+        if (energy > 1.0)
+        {
+            std::copy(frame, frame + frame_size, frame_float.begin());
+            reference.compute_static_frame(frame_float.data(), 0.0f, static_ref.data());
+            for (std::size_t d = 0; d < FXP_MFCC_STATIC_DIM; d++)
+            {
+                errors[5].max_error = std::max(errors[5].max_error, std::fabs(fixed_frame[d] / q16 - static_ref[d]));
+            }
+            errors[5].frames++;
+        }
+        for (std::size_t s = 0; s < 5; s++)
+        {
+            errors[s].frames++;
+        }
+    }
+}
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_fixed_point_check [file.wav ...]\n"
+        "       hmm_gmm_fixed_point_check --tables <fixed_point_mfcc_tables.c>\n"
+        "  without files, a set of synthetic 16 kHz signals is checked\n"
+        "  exits with 1 if a stage exceeds its error bound, the linked tables are stale\n"
+        "  or a file cannot be read\n"
+        "  --tables <file>  write the const tables of the front-end as C source\n");
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> paths;
+    std::string tables_file;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help")
+        {
+            usage();
+            return 0;
+        }
+        else if (arg == "--tables" && i + 1 < argc)
+        {
+            tables_file = argv[++i];
+            continue;
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        paths.push_back(arg);
+    }
+
+    try
+    {
+        const mfcc_tables tables = compute_tables();
+        if (!tables_file.empty())
+        {
+            write_tables(tables_file, tables);
+            return 0;
+        }
+
+        mfcc_config config;
+        config.sample_rate = FXP_MFCC_SAMPLE_RATE_HZ;
+        mfcc_extractor reference(config);
+        real_fft fft(FXP_MFCC_FFT_SIZE);
+
+        std::vector<test_signal> signals;
+        for (const std::string &path : paths)
+        {
+            wav_data wav = read_wav_file(path);
+            if (wav.sample_rate != FXP_MFCC_SAMPLE_RATE_HZ)
+            {
+                polyphase_resampler resampler(wav.sample_rate, FXP_MFCC_SAMPLE_RATE_HZ);
+                wav.samples = resampler.resample(wav.samples.data(), wav.samples.size());
+            }
+            test_signal s{path, std::vector<int16_t>(wav.samples.size())};
+            std::transform(wav.samples.begin(), wav.samples.end(), s.samples.begin(),
+                           [](float v) { return clip16(v); });
+            signals.push_back(s);
+        }
+        if (paths.empty())
+        {
+            signals = synthetic_signals();
+        }
+
+        bool pass = check_tables(tables);
+        for (const test_signal &signal : signals)
+        {
+            std::vector<stage_error> errors = {
+                {"window", 1e-4},
+                {"fft (rel. peak)", std::ldexp(1.0, -23)},
+                {"filter bank log", 5e-5},
+                {"log energy", 5e-5},
+                {"dct + lifter", 5e-5},
+                {"end to end", 2e-3},
+            };
+            check_signal(signal, reference, fft, errors);
+
+            std::printf("%s\n", signal.name.c_str());
+            for (const stage_error &e : errors)
+            {
+                const bool ok = e.max_error <= e.bound;
+                pass = pass && ok;
+                std::printf("  %-18s max error %.3e  bound %.1e  %zu frames  %s\n",
+                            e.name, e.max_error, e.bound, e.frames, ok ? "ok" : "FAIL");
+            }
+        }
+        std::printf("%s\n", pass ? "PASS" : "FAIL");
+        return pass ? 0 : 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_fixed_point_check: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
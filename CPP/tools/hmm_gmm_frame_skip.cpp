@@ -0,0 +1,150 @@
+/******************************************************************************
+* File Name:   hmm_gmm_frame_skip.cpp
+*
+* Description: Accuracy and speed of frame-skipping decoding
+*              (recognise_frame_skip in viterbi.hpp). The corpus is decoded
+*              once per skip factor:
+*
+*              hmm_gmm_frame_skip [--skip 1,2,3] [--repeat n] <model.hmmb> <test.feat>
+*
+*              Reports per factor the time, real-time factor and speed-up
+*              over every frame, the accuracy, the emissions computed and the
+*              decisions changed against skip 1.
+*
+*******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_frame_skip [--skip 1,2,3] [--repeat n] <model.hmmb> <test.feat>\n"
+        "  --skip <list>   skip factors, 1 = every frame (1,2,3)\n"
+        "  --repeat <n>    timed passes over the corpus, the fastest is reported (3)\n");
+}
+
+std::vector<std::size_t> parse_list(const std::string &text)
+{
+    std::vector<std::size_t> values;
+    std::size_t start = 0;
+    while (start <= text.size())
+    {
+        const std::size_t end = std::min(text.find(',', start), text.size());
+        char *stop = nullptr;
+        const std::string item = text.substr(start, end - start);
+        const unsigned long value = std::strtoul(item.c_str(), &stop, 10);
+        if (item.empty() || *stop != '\0' || value == 0)
+        {
+            throw std::invalid_argument("bad skip factor list " + text);
+        }
+        values.push_back(value);
+        start = end + 1;
+    }
+    return values;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    std::string skip_list = "1,2,3";
+    std::size_t repeat = 3;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--skip" && i + 1 < argc)         skip_list = argv[++i];
+        else if (arg == "--repeat" && i + 1 < argc)  repeat = std::strtoul(argv[++i], nullptr, 10);
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2 || repeat == 0)
+    {
+        usage();
+        return 2;
+    }
+
+    try
+    {
+        const std::vector<std::size_t> skips = parse_list(skip_list);
+        const compiled_model model(positional[0]);
+        const feature_corpus corpus(positional[1]);
+        emission_cache cache(model);
+
+        /* samp_period is in HTK units of 100 ns */
+        const double audio = (double)corpus.total_frames() * corpus.samp_period() * 1e-7;
+        const double matrix = (double)corpus.total_frames() * model.model_no() * model.state_no() * repeat;
+        std::printf("%zu utterances, %zu frames, %zu models x %zu states x %zu mixtures\n\n", corpus.size(),
+                    corpus.total_frames(), model.model_no(), model.state_no(), model.mix_no());
+        std::printf("%6s %10s %10s %8s %10s %10s %8s\n", "skip", "time [s]", "real-time", "speed-up", "accuracy",
+                    "emissions", "changed");
+
+        std::vector<int> every_frame, decisions;
+        double every_frame_time = 0.0;
+        for (std::size_t skip : skips)
+        {
+            const std::size_t evaluations = cache.evaluations();
+            double best = 0.0;
+            for (std::size_t r = 0; r < repeat; r++)
+            {
+                decisions.clear();
+                const auto start = std::chrono::steady_clock::now();
+                for (std::size_t u = 0; u < corpus.size(); u++)
+                {
+                    decisions.push_back(recognise_frame_skip(cache, corpus[u].features, skip).model);
+                }
+                const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                best = (r == 0 || elapsed < best) ? elapsed : best;
+            }
+            if (every_frame.empty())
+            {
+                /* the first factor is the reference, skip 1 unless the list says otherwise */
+                every_frame = decisions;
+                every_frame_time = best;
+            }
+
+            std::size_t correct = 0, changed = 0;
+            for (std::size_t u = 0; u < corpus.size(); u++)
+            {
+                correct += (decisions[u] + 1 == corpus[u].label);
+                changed += (decisions[u] != every_frame[u]);
+            }
+            std::printf("%6zu %10.4f %10.5f %7.2fx %9.2f%% %9.1f%% %8zu\n", skip, best,
+                        audio > 0.0 ? best / audio : 0.0, best > 0.0 ? every_frame_time / best : 0.0,
+                        corpus.size() ? 100.0 * correct / corpus.size() : 0.0,
+                        matrix > 0.0 ? 100.0 * (cache.evaluations() - evaluations) / matrix : 0.0, changed);
+        }
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_frame_skip: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,204 @@
+/******************************************************************************
+* File Name:   hmm_gmm_gaussian_selection.cpp
+*
+* Description: Builds the VQ Gaussian selection of a compiled model set and
+*              measures what it costs in accuracy:
+*
+*              hmm_gmm_gaussian_selection build [--codebook-size n] [--shortlist n] <model.hmmb> <gs.mat>
+*              hmm_gmm_gaussian_selection report [--codebook-sizes a,b,..] [--shortlists a,b,..]
+*                                                <model.hmmb> <test.feat>
+*
+*              report decodes the corpus with every combination of codebook
+*              size and shortlist length and prints the fraction of
+*              Gaussians evaluated (with and without the codebook search),
+*              the accuracy and its difference to full evaluation, the
+*              decisions that changed and the decoding time.
+*
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/gaussian_selection.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    gaussian_selection_config config;
+    std::vector<std::size_t> codebook_sizes = {16, 32, 64, 128};
+    std::vector<std::size_t> shortlists = {8, 16, 32, 64};
+    std::vector<std::string> positional;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_gaussian_selection build [--codebook-size n] [--shortlist n] <model.hmmb> <gs.mat>\n"
+        "       hmm_gmm_gaussian_selection report [--codebook-sizes a,b,..] [--shortlists a,b,..]\n"
+        "                                         <model.hmmb> <test.feat>\n"
+        "  --codebook-size <n>    codewords (64)\n"
+        "  --shortlist <n>        Gaussians evaluated per frame (32)\n"
+        "  --codebook-sizes <l>   codebook sizes of the report (16,32,64,128)\n"
+        "  --shortlists <l>       shortlist lengths of the report (8,16,32,64)\n");
+}
+
+std::vector<std::size_t> parse_list(const std::string &text)
+{
+    std::vector<std::size_t> values;
+    std::size_t begin = 0;
+    while (begin <= text.size())
+    {
+        std::size_t end = text.find(',', begin);
+        end = (end == std::string::npos) ? text.size() : end;
+        const std::size_t value = std::strtoul(text.substr(begin, end - begin).c_str(), nullptr, 10);
+        if (value == 0)
+        {
+            throw std::invalid_argument("bad list " + text);
+        }
+        values.push_back(value);
+        begin = end + 1;
+    }
+    return values;
+}
+
+int build(const options &opt)
+{
+    const compiled_model model(opt.positional[0]);
+    const auto start = std::chrono::steady_clock::now();
+    const gaussian_selection selection(model, opt.config);
+    selection.save(opt.positional[1]);
+    std::printf("%zu codewords, %zu of %zu Gaussians per frame, built in %.3f s\n", selection.codebook_size(),
+                selection.shortlist_size(0), selection.gaussian_no(),
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return 0;
+}
+
+struct decode_result
+{
+    std::vector<int> decisions;
+    std::size_t correct = 0;
+    double seconds = 0.0;
+};
+
+decode_result decode(emission_cache &cache, const feature_corpus &corpus)
+{
+    decode_result result;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        const corpus_utterance utterance = corpus[u];
+        result.decisions.push_back(recognise(cache, utterance.features).model);
+        result.correct += (result.decisions.back() + 1 == utterance.label);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+int report(const options &opt)
+{
+    const compiled_model model(opt.positional[0]);
+    const feature_corpus corpus(opt.positional[1]);
+    const double n = corpus.size() ? (double)corpus.size() : 1.0;
+    const double all = (double)corpus.total_frames() * model.model_no() * model.state_no() * model.mix_no();
+
+    emission_cache full_cache(model);
+    const decode_result full = decode(full_cache, corpus);
+    std::printf("%zu models x %zu states x %zu mixtures = %zu Gaussians, %zu utterances\n", model.model_no(),
+                model.state_no(), model.mix_no(), model.model_no() * model.state_no() * model.mix_no(),
+                corpus.size());
+    std::printf("full evaluation: accuracy %.2f %%, %.4f s\n\n", 100.0 * full.correct / n, full.seconds);
+    std::printf("%9s %9s %10s %10s %10s %10s %10s\n", "codebook", "shortlist", "evaluated", "+search", "accuracy",
+                "delta", "changed");
+
+    for (std::size_t size : opt.codebook_sizes)
+    {
+        for (std::size_t shortlist : opt.shortlists)
+        {
+            gaussian_selection_config config = opt.config;
+            config.codebook_size = size;
+            config.shortlist = shortlist;
+            const gaussian_selection selection(model, config);
+            emission_cache cache(model, selection);
+            const decode_result selected = decode(cache, corpus);
+            std::size_t changed = 0;
+            for (std::size_t u = 0; u < corpus.size(); u++)
+            {
+                changed += (selected.decisions[u] != full.decisions[u]);
+            }
+            const double evaluated = (double)cache.gaussian_evaluations() / all;
+            const double search = (double)corpus.total_frames() * selection.codebook_size() / all;
+            std::printf("%9zu %9zu %9.1f%% %9.1f%% %9.2f%% %+9.2f%% %10zu\n", selection.codebook_size(),
+                        selection.shortlist_size(0), 100.0 * evaluated, 100.0 * (evaluated + search),
+                        100.0 * selected.correct / n, 100.0 * ((double)selected.correct - full.correct) / n, changed);
+        }
+    }
+    return 0;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        usage();
+        return 2;
+    }
+    const std::string command = argv[1];
+    options opt;
+    try
+    {
+        for (int i = 2; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--codebook-size" && i + 1 < argc)       opt.config.codebook_size = std::strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--shortlist" && i + 1 < argc)      opt.config.shortlist = std::strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--codebook-sizes" && i + 1 < argc) opt.codebook_sizes = parse_list(argv[++i]);
+            else if (arg == "--shortlists" && i + 1 < argc)     opt.shortlists = parse_list(argv[++i]);
+            else if (!arg.empty() && arg[0] == '-')
+            {
+                std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+                usage();
+                return 2;
+            }
+            else
+            {
+                opt.positional.push_back(arg);
+            }
+        }
+        if (opt.positional.size() != 2)
+        {
+            usage();
+            return 2;
+        }
+        if (command == "build")
+        {
+            return build(opt);
+        }
+        if (command == "report")
+        {
+            return report(opt);
+        }
+        usage();
+        return 2;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_gaussian_selection: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
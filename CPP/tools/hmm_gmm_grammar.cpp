@@ -0,0 +1,258 @@
+/******************************************************************************
+* File Name:   hmm_gmm_grammar.cpp
+*
+* Description: Wakeword --> [silence] --> command phrases recognised in one
+*              pass of a composite grammar network (command_grammar.hpp)
+*              against the firmware's two windows:
+*
+*              hmm_gmm_grammar --wakeword 5 --commands 1,2,3,4 [options] <model.hmmb> <test.feat>
+*
+*              Phrases are built from the corpus by joining every utterance
+*              of the wakeword with every utterance of a command, with an
+*              utterance of the silence model between them if one is given.
+*              The two-window reference recognises the wakeword part and the
+*              command part separately over all models, as main.c does with
+*              two 1 s blocks, and is given the true word boundary.
+*
+*              The grammar search runs with a beam of 15 unless --beam is
+*              given; --beam inf is the exhaustive search, which scores
+*              every command state in the feasible band and is slower than
+*              the two windows.
+*
+*******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/command_grammar.hpp"
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/feature_matrix.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    std::size_t wakeword = 0;       /* 1-based, 0 = not given */
+    std::string commands;
+    std::size_t silence = 0;        /* 1-based, 0 = no silence slot */
+    double beam = 15.0;             /* kept every decision on the test sets, 10 did not */
+    double block_ms = 1000.0;
+    std::size_t phrases = 0;        /* 0 = all */
+    std::vector<std::string> positional;
+};
+
+struct phrase
+{
+    feature_matrix features;
+    std::size_t wakeword;           /* corpus utterances */
+    std::size_t command;
+    std::size_t boundary;           /* first frame after the wakeword */
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_grammar --wakeword <k> --commands <list> [options] <model.hmmb> <test.feat>\n"
+        "  --wakeword <k>     model of the wakeword (1-based)\n"
+        "  --commands <list>  models of the commands (1-based)\n"
+        "  --silence <k>      model of the optional silence between them (none)\n"
+        "  --beam <b>         log-likelihood beam of the grammar search, inf = off (15)\n"
+        "  --block <ms>       block length of the two-window reference (1000)\n"
+        "  --phrases <n>      phrases to build, 0 = every wakeword x command pair (0)\n");
+}
+
+std::vector<std::size_t> parse_models(const std::string &text)
+{
+    std::vector<std::size_t> values;
+    std::size_t start = 0;
+    while (start <= text.size())
+    {
+        const std::size_t end = std::min(text.find(',', start), text.size());
+        char *stop = nullptr;
+        const std::string item = text.substr(start, end - start);
+        const unsigned long value = std::strtoul(item.c_str(), &stop, 10);
+        if (item.empty() || *stop != '\0' || value == 0)
+        {
+            throw std::invalid_argument("bad model list " + text);
+        }
+        values.push_back(value - 1);
+        start = end + 1;
+    }
+    return values;
+}
+
+void append(feature_matrix &m, const feature_view &v)
+{
+    m.dim = v.dim;
+    m.data.insert(m.data.end(), v.data, v.data + v.dim * v.frame_no);
+    m.frame_no += v.frame_no;
+}
+
+std::vector<phrase> build_phrases(const feature_corpus &corpus, const options &opt,
+                                  const std::vector<std::size_t> &commands)
+{
+    std::vector<std::size_t> wakewords, spoken, silences;
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        const std::size_t label = (std::size_t)std::max(corpus[u].label, 0);
+        if (label == opt.wakeword)
+        {
+            wakewords.push_back(u);
+        }
+        else if (std::find(commands.begin(), commands.end(), label - 1) != commands.end())
+        {
+            spoken.push_back(u);
+        }
+        else if (opt.silence != 0 && label == opt.silence)
+        {
+            silences.push_back(u);
+        }
+    }
+    if (wakewords.empty() || spoken.empty())
+    {
+        throw std::runtime_error("the corpus has no utterance of the wakeword or of a command");
+    }
+
+    std::vector<phrase> phrases;
+    for (std::size_t c = 0; c < spoken.size(); c++)
+    {
+        for (std::size_t w = 0; w < wakewords.size(); w++)
+        {
+            if (opt.phrases != 0 && phrases.size() == opt.phrases)
+            {
+                return phrases;
+            }
+            phrase p;
+            p.wakeword = wakewords[w];
+            p.command = spoken[c];
+            append(p.features, corpus[p.wakeword].features);
+            p.boundary = p.features.frame_no;
+            if (!silences.empty())
+            {
+                append(p.features, corpus[silences[(w + c) % silences.size()]].features);
+            }
+            append(p.features, corpus[p.command].features);
+            phrases.push_back(std::move(p));
+        }
+    }
+    return phrases;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    options opt;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--wakeword" && i + 1 < argc)       opt.wakeword = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--commands" && i + 1 < argc)  opt.commands = argv[++i];
+        else if (arg == "--silence" && i + 1 < argc)   opt.silence = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--beam" && i + 1 < argc)      opt.beam = std::strtod(argv[++i], nullptr);
+        else if (arg == "--block" && i + 1 < argc)     opt.block_ms = std::strtod(argv[++i], nullptr);
+        else if (arg == "--phrases" && i + 1 < argc)   opt.phrases = std::strtoul(argv[++i], nullptr, 10);
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            opt.positional.push_back(arg);
+        }
+    }
+    if (opt.positional.size() != 2 || opt.wakeword == 0 || opt.commands.empty())
+    {
+        usage();
+        return 2;
+    }
+
+    try
+    {
+        const std::vector<std::size_t> commands = parse_models(opt.commands);
+        const compiled_model model(opt.positional[0]);
+        const feature_corpus corpus(opt.positional[1]);
+        const command_grammar grammar = command_grammar::wakeword_command(
+            model, opt.wakeword - 1, opt.silence != 0 ? opt.silence - 1 : GRAMMAR_NO_WORD, commands);
+        const std::vector<phrase> phrases = build_phrases(corpus, opt, commands);
+        emission_cache cache(model);
+        /* samp_period is in HTK units of 100 ns */
+        const double frame_ms = corpus.samp_period() * 1e-4;
+
+        std::size_t frames = 0;
+        for (const phrase &p : phrases)
+        {
+            frames += p.features.frame_no;
+        }
+        std::printf("%zu phrases, %zu frames, %zu models x %zu states x %zu mixtures\n", phrases.size(), frames,
+                    model.model_no(), model.state_no(), model.mix_no());
+
+        /* one pass of the grammar per phrase */
+        std::size_t correct = 0, rejected = 0, command_scored = 0, command_matrix = 0;
+        double boundary_error = 0.0;
+        std::size_t evaluations = cache.evaluations();
+        grammar_trace trace;
+        auto start = std::chrono::steady_clock::now();
+        for (const phrase &p : phrases)
+        {
+            const grammar_result r = recognise_grammar(cache, p.features, grammar, opt.beam, &trace);
+            command_scored += trace.scored.back();
+            command_matrix += commands.size() * model.state_no() * p.features.frame_no;
+            if (r.words.empty())
+            {
+                rejected++;
+                continue;
+            }
+            correct += (r.words.back().model + 1 == (std::size_t)corpus[p.command].label);
+            boundary_error += std::fabs((double)r.words.front().end_frame + 1.0 - (double)p.boundary);
+        }
+        const double grammar_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const std::size_t grammar_evaluations = cache.evaluations() - evaluations;
+
+        /* the firmware: the wakeword block, then the command block, over all models */
+        std::size_t reference_correct = 0;
+        evaluations = cache.evaluations();
+        start = std::chrono::steady_clock::now();
+        for (const phrase &p : phrases)
+        {
+            const int first = recognise(cache, corpus[p.wakeword].features).model;
+            const int second = recognise(cache, corpus[p.command].features).model;
+            reference_correct += (first + 1 == (int)opt.wakeword && second + 1 == corpus[p.command].label);
+        }
+        const double reference_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const std::size_t reference_evaluations = cache.evaluations() - evaluations;
+
+        const double count = phrases.empty() ? 1.0 : (double)phrases.size();
+        std::printf("\n%-12s %10s %12s %15s %15s %12s\n", "", "accuracy", "emissions", "command states",
+                    "decision [ms]", "time [ms]");
+        std::printf("%-12s %9.2f%% %12zu %14.1f%% %15.0f %12.3f\n", "grammar", 100.0 * correct / count,
+                    grammar_evaluations, command_matrix ? 100.0 * command_scored / command_matrix : 0.0,
+                    frame_ms * frames / count, 1e3 * grammar_time / count);
+        std::printf("%-12s %9.2f%% %12zu %15s %15.0f %12.3f\n", "two windows", 100.0 * reference_correct / count,
+                    reference_evaluations, "all", 2.0 * opt.block_ms, 1e3 * reference_time / count);
+        std::printf("\ngrammar (beam %g): %zu phrases without a path, wakeword end %.1f ms from the true boundary "
+                    "on average\n", opt.beam, rejected, frame_ms * boundary_error / std::max(1.0, count - (double)rejected));
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_grammar: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,260 @@
+/******************************************************************************
+* File Name:   hmm_gmm_log_add_check.cpp
+*
+* Description: Checks the log-add tiers of log_math.hpp:
+*
+*              hmm_gmm_log_add_check [<model.hmmb> <test.feat>]
+*
+*              - error of log_add() and log_sum_exp_groups() of every tier
+*                and kernel against a double precision reference, over a
+*                sweep of differences, offsets, group sizes and -Inf terms;
+*                fails if a documented bound is exceeded
+*              - throughput of log_sum_exp_groups() in ns per term
+*              - with a compiled model and a corpus: recognition with the
+*                mixtures of every state combined by each tier; fails if a
+*                decision differs from the exact tier
+*
+*******************************************************************************/
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/gaussian_scorer.hpp"
+#include "hmm_gmm/log_math.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+const float NEG_INF = -std::numeric_limits<float>::infinity();
+const log_add_tier TIERS[] = {log_add_tier::exact, log_add_tier::polynomial, log_add_tier::table};
+const simd_isa ISAS[] = {simd_isa::scalar, simd_isa::avx2, simd_isa::avx512};
+
+/* log sum exp in double; log1p keeps the tiny results of large differences */
+double reference_sum(const float *y, std::size_t n)
+{
+    std::size_t imax = 0;
+    for (std::size_t i = 1; i < n; i++)
+    {
+        imax = (y[i] > y[imax]) ? i : imax;
+    }
+    const double ymax = y[imax];
+    if (std::isinf(ymax))
+    {
+        return ymax;
+    }
+    double others = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        others += (i == imax) ? 0.0 : std::exp((double)y[i] - ymax);
+    }
+    return ymax + std::log1p(others);
+}
+
+/* largest error / bound ratio; -Inf must be reproduced exactly */
+double error_ratio(log_add_tier tier, std::size_t terms, double reference, float value)
+{
+    if (std::isinf(reference) || std::isinf(value))
+    {
+        return (reference == (double)value) ? 0.0 : HUGE_VAL;
+    }
+    return std::fabs((double)value - reference) / log_add_error_bound(tier, terms, reference);
+}
+
+/* test values: differences 0..40 in 1/1000 steps at several offsets, random groups with -Inf terms */
+struct sweep
+{
+    std::vector<float> a, b;
+    std::vector<std::vector<float>> groups;     /* per group size, group_no * size values */
+    std::vector<std::size_t> sizes{2, 3, 4, 8, 16, 300};
+};
+
+sweep make_sweep()
+{
+    sweep s;
+    for (float offset : {0.0f, -37.5f, 1234.5f, -5000.25f})
+    {
+        for (int k = 0; k <= 40000; k++)
+        {
+            s.a.push_back(offset);
+            s.b.push_back(offset - (float)k * 1e-3f);
+        }
+    }
+    s.a.insert(s.a.end(), {NEG_INF, NEG_INF, -3.0f});
+    s.b.insert(s.b.end(), {NEG_INF, 2.0f, NEG_INF});
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> spread(-30.0f, 0.0f), offset(-3000.0f, 100.0f), unit(0.0f, 1.0f);
+    for (std::size_t size : s.sizes)
+    {
+        const std::size_t group_no = std::max<std::size_t>(1, 80000 / size);
+        std::vector<float> values(group_no * size);
+        for (std::size_t g = 0; g < group_no; g++)
+        {
+            const float o = offset(rng);
+            for (std::size_t m = 0; m < size; m++)
+            {
+                values[g * size + m] = (unit(rng) < 0.05f) ? NEG_INF : o + spread(rng);
+            }
+        }
+        std::fill(values.begin(), values.begin() + size, NEG_INF);      /* no finite term at all */
+        s.groups.push_back(std::move(values));
+    }
+    return s;
+}
+
+bool check_errors(const sweep &s)
+{
+    bool ok = true;
+    std::printf("%-11s %-7s %14s %14s %16s\n", "tier", "kernel", "log_add err", "groups err", "worst/bound");
+    for (log_add_tier tier : TIERS)
+    {
+        for (simd_isa isa : ISAS)
+        {
+            if (!simd_isa_supported(isa) || (tier != log_add_tier::polynomial && isa != simd_isa::scalar))
+            {
+                continue;
+            }
+            double worst_ratio = 0.0, pair_error = 0.0, group_error = 0.0;
+            std::vector<float> out(s.a.size());
+            log_add(tier, s.a.data(), s.b.data(), out.data(), out.size(), isa);
+            for (std::size_t i = 0; i < out.size(); i++)
+            {
+                const float pair[2] = {s.a[i], s.b[i]};
+                const double reference = reference_sum(pair, 2);
+                worst_ratio = std::fmax(worst_ratio, error_ratio(tier, 2, reference, out[i]));
+                if (std::isfinite(reference))
+                {
+                    pair_error = std::fmax(pair_error, std::fabs(out[i] - reference));
+                }
+            }
+            for (std::size_t k = 0; k < s.sizes.size(); k++)
+            {
+                const std::size_t size = s.sizes[k];
+                const std::vector<float> &values = s.groups[k];
+                std::vector<float> sums(values.size() / size);
+                log_sum_exp_groups(tier, values.data(), size, sums.size(), sums.data(), isa);
+                for (std::size_t g = 0; g < sums.size(); g++)
+                {
+                    const double reference = reference_sum(&values[g * size], size);
+                    worst_ratio = std::fmax(worst_ratio, error_ratio(tier, size, reference, sums[g]));
+                    if (std::isfinite(reference))
+                    {
+                        group_error = std::fmax(group_error, std::fabs(sums[g] - reference));
+                    }
+                }
+            }
+            std::printf("%-11s %-7s %14.3g %14.3g %16.3f%s\n", log_add_tier_name(tier), simd_isa_name(isa),
+                        pair_error, group_error, worst_ratio, worst_ratio <= 1.0 ? "" : "  BOUND EXCEEDED");
+            ok = ok && worst_ratio <= 1.0;
+        }
+    }
+    return ok;
+}
+
+void benchmark()
+{
+    const std::size_t group = 4, group_no = 1 << 18;
+    std::vector<float> values(group * group_no), sums(group_no);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> spread(-40.0f, 0.0f);
+    for (float &v : values)
+    {
+        v = spread(rng);
+    }
+    std::printf("\nlog_sum_exp_groups, %zu groups of %zu terms:\n", group_no, group);
+    for (log_add_tier tier : TIERS)
+    {
+        for (simd_isa isa : ISAS)
+        {
+            if (!simd_isa_supported(isa) || (tier != log_add_tier::polynomial && isa != simd_isa::scalar))
+            {
+                continue;
+            }
+            double best = HUGE_VAL;
+            for (int r = 0; r < 5; r++)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                log_sum_exp_groups(tier, values.data(), group, group_no, sums.data(), isa);
+                best = std::fmin(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            }
+            std::printf("  %-11s %-7s %8.3f ns/term\n", log_add_tier_name(tier), simd_isa_name(isa),
+                        1e9 * best / (double)values.size());
+        }
+    }
+}
+
+bool check_decisions(const std::string &model_file, const std::string &corpus_file)
+{
+    const compiled_model model(model_file);
+    const feature_corpus corpus(corpus_file);
+    const gaussian_scorer scorer(model);
+    std::vector<recognition_result> exact(corpus.size());
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        exact[u] = recognise(model, scorer, corpus[u].features, log_add_tier::exact);
+    }
+
+    bool ok = true;
+    std::printf("\ndecisions on %zu utterances (%s scorer):\n", corpus.size(), simd_isa_name(scorer.isa()));
+    for (log_add_tier tier : TIERS)
+    {
+        std::size_t changed = 0, hits = 0;
+        double max_difference = 0.0;
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            const recognition_result r = recognise(model, scorer, corpus[u].features, tier);
+            changed += (r.model != exact[u].model);
+            hits += (r.model + 1 == corpus[u].label);
+            for (std::size_t k = 0; k < r.scores.size(); k++)
+            {
+                if (std::isfinite(r.scores[k]) && std::isfinite(exact[u].scores[k]))
+                {
+                    max_difference = std::fmax(max_difference, std::fabs(r.scores[k] - exact[u].scores[k]));
+                }
+            }
+        }
+        std::printf("  %-11s accuracy %6.2f%%, %zu changed, max |fopt - exact| %.3g\n", log_add_tier_name(tier),
+                    corpus.size() ? 100.0 * hits / corpus.size() : 0.0, changed, max_difference);
+        ok = ok && changed == 0;
+    }
+    return ok;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    if (argc != 1 && argc != 3)
+    {
+        std::fprintf(stderr, "usage: hmm_gmm_log_add_check [<model.hmmb> <test.feat>]\n");
+        return 2;
+    }
+    try
+    {
+        bool ok = check_errors(make_sweep());
+        benchmark();
+        if (argc == 3)
+        {
+            ok = check_decisions(argv[1], argv[2]) && ok;
+        }
+        std::printf("\n%s\n", ok ? "PASS" : "FAIL");
+        return ok ? 0 : 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_log_add_check: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
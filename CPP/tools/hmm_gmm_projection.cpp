@@ -0,0 +1,311 @@
+/******************************************************************************
+* File Name:   hmm_gmm_projection.cpp
+*
+* Description: Estimates and applies PCA / LDA feature projections and reports
+*              recognition accuracy against Gaussian scoring cost.
+*
+*              hmm_gmm_projection estimate pca --dim n <train.feat> <out.mat>
+*              hmm_gmm_projection estimate lda --dim n --model HMM.mat <train.feat> <out.mat>
+*              hmm_gmm_projection apply <projection.mat> <in.feat> <out.feat>
+*              hmm_gmm_projection project-model <projection.mat> <HMM.mat> <out.mat>
+*              hmm_gmm_projection report <test.feat> <HMM.mat> [<projection.mat> <HMM.mat>]...
+*              hmm_gmm_projection export-c <projection.mat> <out.c>
+*
+*              LDA classes are the states of every word model; each training
+*              utterance is aligned to the model of its label with Viterbi.
+*
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/feature_projection.hpp"
+#include "hmm_gmm/hmm_model.hpp"
+#include "hmm_gmm/parallel.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    std::size_t dim = 20;
+    std::string model;
+    std::size_t threads = 0;
+    std::vector<std::string> positional;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_projection estimate pca|lda [--dim n] [--model HMM.mat] <train.feat> <out.mat>\n"
+        "       hmm_gmm_projection apply <projection.mat> <in.feat> <out.feat>\n"
+        "       hmm_gmm_projection project-model <projection.mat> <HMM.mat> <out.mat>\n"
+        "       hmm_gmm_projection report <test.feat> <HMM.mat> [<projection.mat> <HMM.mat>]...\n"
+        "       hmm_gmm_projection export-c <projection.mat> <out.c>\n"
+        "  --dim <n>        projected dimension (20)\n"
+        "  --model <file>   HMM_<iter>.mat used for the LDA state alignments\n"
+        "  --threads <n>    worker threads (all hardware threads)\n");
+}
+
+std::size_t thread_count(const options &opt)
+{
+    return opt.threads ? opt.threads : hardware_threads();
+}
+
+int estimate(const options &opt)
+{
+    const std::string &method = opt.positional[0];
+    const feature_corpus corpus(opt.positional[1]);
+    const auto start = std::chrono::steady_clock::now();
+
+    feature_projection projection;
+    if (method == "pca")
+    {
+        projection_statistics stats(corpus.dim(), 0);
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            const feature_view f = corpus[u].features;
+            for (std::size_t t = 0; t < f.frame_no; t++)
+            {
+                stats.add(f.frame(t), -1);
+            }
+        }
+        projection = stats.estimate_pca(opt.dim);
+    }
+    else if (method == "lda")
+    {
+        if (opt.model.empty())
+        {
+            throw std::invalid_argument("LDA needs --model for the state alignments");
+        }
+        const hmm_set hmm = read_hmm_mat(opt.model);
+        if (hmm.dim() != corpus.dim())
+        {
+            throw std::invalid_argument("model and corpus dimensions differ");
+        }
+        /* alignments in parallel, accumulation in corpus order so the result is deterministic */
+        std::vector<std::vector<int>> alignments(corpus.size());
+        parallel_for(corpus.size(), thread_count(opt), [&](std::size_t u, std::size_t) {
+            const corpus_utterance utt = corpus[u];
+            if (utt.label >= 1 && (std::size_t)utt.label <= hmm.models.size())
+            {
+                viterbi_decode(hmm.models[utt.label - 1], utt.features, &alignments[u]);
+            }
+        });
+
+        const std::size_t state_no = hmm.state_no();
+        projection_statistics stats(corpus.dim(), hmm.models.size() * state_no);
+        std::size_t unaligned = 0;
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            const corpus_utterance utt = corpus[u];
+            const std::vector<int> &states = alignments[u];
+            if (states.empty() || states[0] < 0)
+            {
+                unaligned++;
+                continue;
+            }
+            for (std::size_t t = 0; t < utt.features.frame_no; t++)
+            {
+                stats.add(utt.features.frame(t), (int)((utt.label - 1) * state_no + states[t]));
+            }
+        }
+        if (unaligned > 0)
+        {
+            std::fprintf(stderr, "hmm_gmm_projection: %zu utterance(s) without alignment skipped\n", unaligned);
+        }
+        projection = stats.estimate_lda(opt.dim);
+    }
+    else
+    {
+        throw std::invalid_argument("unknown projection method " + method);
+    }
+    write_feature_projection(opt.positional[2], projection);
+
+    double kept = 0.0, total = 0.0;
+    for (std::size_t k = 0; k < projection.eigenvalues.size(); k++)
+    {
+        total += projection.eigenvalues[k];
+        kept += (k < projection.out_dim) ? projection.eigenvalues[k] : 0.0;
+    }
+    std::printf("%s %zu -> %zu from %zu utterance(s) in %.3f s, %.1f%% of the %s kept\n",
+                projection.type.c_str(), projection.in_dim, projection.out_dim, corpus.size(),
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+                total > 0.0 ? 100.0 * kept / total : 0.0,
+                method == "pca" ? "variance" : "class separation (sum of eigenvalues)");
+    return 0;
+}
+
+int apply(const options &opt)
+{
+    const feature_projection projection = read_feature_projection(opt.positional[0]);
+    const feature_corpus corpus(opt.positional[1]);
+    feature_corpus_writer writer(opt.positional[2], projection.out_dim, corpus.samp_period(), corpus.parm_kind());
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        const corpus_utterance utt = corpus[u];
+        writer.add(utt.label, std::string(utt.id), projection.apply(utt.features));
+    }
+    writer.finish();
+    std::printf("%zu utterance(s) projected to %zu dimensions\n", corpus.size(), projection.out_dim);
+    return 0;
+}
+
+int project_model(const options &opt)
+{
+    const feature_projection projection = read_feature_projection(opt.positional[0]);
+    write_hmm_mat(opt.positional[2], projection.project_model(read_hmm_mat(opt.positional[1])));
+    return 0;
+}
+
+/* Accuracy, Gaussian cost and decoding time of each (projection, model) configuration */
+int report(const options &opt)
+{
+    const feature_corpus corpus(opt.positional[0]);
+    struct configuration
+    {
+        std::string name;
+        bool projected;
+        feature_projection projection;
+        hmm_set hmm;
+    };
+    std::vector<configuration> configurations;
+    configurations.push_back({opt.positional[1], false, {}, read_hmm_mat(opt.positional[1])});
+    for (std::size_t i = 2; i + 1 < opt.positional.size(); i += 2)
+    {
+        configuration c{opt.positional[i + 1], true, read_feature_projection(opt.positional[i]),
+                        read_hmm_mat(opt.positional[i + 1])};
+        if (c.projection.out_dim != c.hmm.dim())
+        {
+            throw std::invalid_argument(c.name + " does not match the dimension of " + opt.positional[i]);
+        }
+        configurations.push_back(std::move(c));
+    }
+
+    std::printf("%-32s %5s %10s %14s %10s %9s\n", "model", "dim", "accuracy", "MACs/frame", "cost", "time [s]");
+    double reference_cost = 0.0;
+    for (const configuration &c : configurations)
+    {
+        std::vector<int> correct(corpus.size(), 0);
+        const auto start = std::chrono::steady_clock::now();
+        parallel_for(corpus.size(), thread_count(opt), [&](std::size_t u, std::size_t) {
+            const corpus_utterance utt = corpus[u];
+            const recognition_result r = c.projected ? recognise(c.hmm, c.projection.apply(utt.features))
+                                                     : recognise(c.hmm, utt.features);
+            correct[u] = (r.model + 1 == utt.label);
+        });
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::size_t hits = 0;
+        for (int v : correct)
+        {
+            hits += (std::size_t)v;
+        }
+        /* per frame: every mixture of every state of every model, plus the projection itself */
+        double cost = (double)c.hmm.models.size() * c.hmm.state_no() * c.hmm.mix_no() * c.hmm.dim();
+        if (c.projected)
+        {
+            cost += (double)c.projection.in_dim * c.projection.out_dim;
+        }
+        if (reference_cost == 0.0)
+        {
+            reference_cost = cost;
+        }
+        std::printf("%-32s %5zu %9.2f%% %14.0f %9.2fx %9.3f\n", c.name.c_str(), c.hmm.dim(),
+                    corpus.size() ? 100.0 * hits / corpus.size() : 0.0, cost, cost / reference_cost, elapsed);
+    }
+    return 0;
+}
+
+/* Projection tables for gmm_hmm/feature_projection.h on the PSoC6 */
+int export_c(const options &opt)
+{
+    const feature_projection p = read_feature_projection(opt.positional[0]);
+    std::ofstream out(opt.positional[1]);
+    if (!out)
+    {
+        throw std::runtime_error("cannot create " + opt.positional[1]);
+    }
+    char line[64];
+    out << "/* Generated by hmm_gmm_projection export-c from " << opt.positional[0] << ". Do not edit. */\n"
+        << "#include \"feature_projection.h\"\n\n"
+        << "static const float projection_mean[" << p.in_dim << "] =\n{\n";
+    for (std::size_t d = 0; d < p.in_dim; d++)
+    {
+        std::snprintf(line, sizeof(line), "    %.9ef,\n", p.mean[d]);
+        out << line;
+    }
+    out << "};\n\nstatic const float projection_matrix[" << p.out_dim << " * " << p.in_dim << "] =\n{\n";
+    for (std::size_t k = 0; k < p.out_dim; k++)
+    {
+        out << "    /* row " << k << " */\n";
+        for (std::size_t d = 0; d < p.in_dim; d++)
+        {
+            std::snprintf(line, sizeof(line), "    %.9ef,\n", p.matrix[k * p.in_dim + d]);
+            out << line;
+        }
+    }
+    out << "};\n\nconst feature_projection_t feature_projection =\n{\n"
+        << "    .in_dim = " << p.in_dim << "u,\n"
+        << "    .out_dim = " << p.out_dim << "u,\n"
+        << "    .mean = projection_mean,\n"
+        << "    .matrix = projection_matrix,\n};\n";
+    return out.good() ? 0 : 1;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        usage();
+        return 2;
+    }
+    const std::string command = argv[1];
+    options opt;
+    for (int i = 2; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--dim" && i + 1 < argc)          opt.dim = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--model" && i + 1 < argc)   opt.model = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) opt.threads = std::strtoul(argv[++i], nullptr, 10);
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            opt.positional.push_back(arg);
+        }
+    }
+
+    const std::size_t n = opt.positional.size();
+    try
+    {
+        if (command == "estimate" && n == 3)                    return estimate(opt);
+        if (command == "apply" && n == 3)                       return apply(opt);
+        if (command == "project-model" && n == 3)               return project_model(opt);
+        if (command == "report" && n >= 2 && n % 2 == 0)        return report(opt);
+        if (command == "export-c" && n == 2)                    return export_c(opt);
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_projection: %s\n", e.what());
+        return 1;
+    }
+    usage();
+    return 2;
+}
+
+/* [] END OF FILE */
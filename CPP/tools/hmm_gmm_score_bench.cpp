@@ -0,0 +1,171 @@
+/******************************************************************************
+* File Name:   hmm_gmm_score_bench.cpp
+*
+* Description: Throughput and accuracy of the batched Gaussian scorer. Every
+*              utterance of a corpus is scored against every Gaussian of a
+*              compiled model set with each available kernel (scalar, AVX2,
+*              AVX-512), and compared with the per-Gaussian direct form of
+*              compiled_model::log_emission:
+*
+*              hmm_gmm_score_bench [--repeat n] [--isa name] <model.hmmb> <test.feat>
+*
+*              Reports GFLOP/s of the matrix product (2 flops per multiply-
+*              add), the speed-up over the direct form, the largest state
+*              log-likelihood difference and the number of changed decisions.
+*
+*******************************************************************************/
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/gaussian_scorer.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_score_bench [--repeat n] [--isa scalar|avx2|avx512] <model.hmmb> <test.feat>\n"
+        "  --repeat <n>   timed passes over the corpus (3)\n"
+        "  --isa <name>   only this kernel (every supported one)\n");
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    std::size_t repeat = 3;
+    std::string only;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc)    repeat = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--isa" && i + 1 < argc)  only = argv[++i];
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2 || repeat == 0)
+    {
+        usage();
+        return 2;
+    }
+
+    try
+    {
+        const compiled_model model(positional[0]);
+        const feature_corpus corpus(positional[1]);
+        const std::size_t states = model.model_no() * model.state_no();
+        std::printf("%zu models x %zu states x %zu mixtures, dim %zu; %zu utterances, %zu frames\n",
+                    model.model_no(), model.state_no(), model.mix_no(), model.dim(), corpus.size(),
+                    corpus.total_frames());
+
+        /* direct form: every state of every model at every frame, one Gaussian at a time */
+        std::vector<std::vector<float>> direct(corpus.size());
+        std::vector<int> direct_decision(corpus.size());
+        std::vector<float> x(model.stride(), 0.0f);
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            const feature_view f = corpus[u].features;
+            direct[u].resize(f.frame_no * states);
+            for (std::size_t t = 0; t < f.frame_no; t++)
+            {
+                model.prepare_frame(f.frame(t), x.data());
+                for (std::size_t k = 0; k < model.model_no(); k++)
+                {
+                    for (std::size_t s = 0; s < model.state_no(); s++)
+                    {
+                        direct[u][t * states + k * model.state_no() + s] = (float)model.log_emission(k, s, x.data());
+                    }
+                }
+            }
+        }
+        const double direct_time = seconds_since(start);
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            direct_decision[u] = recognise(model, corpus[u].features).model;
+        }
+        std::printf("%-8s %10s %10s %10s %12s %10s\n", "kernel", "time [s]", "GFLOP/s", "speed-up", "max |error|",
+                    "decisions");
+        std::printf("%-8s %10.4f %10s %10s %12s %10s\n", "direct", direct_time, "-", "1.00x", "-", "-");
+
+        int status = 0;
+        for (simd_isa isa : {simd_isa::scalar, simd_isa::avx2, simd_isa::avx512})
+        {
+            if (!simd_isa_supported(isa) || (!only.empty() && only != simd_isa_name(isa)))
+            {
+                continue;
+            }
+            const gaussian_scorer scorer(model, isa);
+            const std::size_t stride = scorer.padded_gaussian_no();
+            std::vector<float> gaussians;
+
+            double best = 0.0;
+            for (std::size_t r = 0; r < repeat; r++)
+            {
+                start = std::chrono::steady_clock::now();
+                for (std::size_t u = 0; u < corpus.size(); u++)
+                {
+                    const feature_view f = corpus[u].features;
+                    gaussians.resize(f.frame_no * stride);
+                    scorer.score_gaussians(f, gaussians.data(), stride);
+                }
+                const double elapsed = seconds_since(start);
+                best = (r == 0 || elapsed < best) ? elapsed : best;
+            }
+
+            double max_error = 0.0;
+            std::size_t changed = 0;
+            std::vector<float> scores;
+            for (std::size_t u = 0; u < corpus.size(); u++)
+            {
+                const feature_view f = corpus[u].features;
+                scores.resize(f.frame_no * states);
+                scorer.score_states(f, scores.data(), states);
+                for (std::size_t i = 0; i < scores.size(); i++)
+                {
+                    max_error = std::fmax(max_error, std::fabs((double)scores[i] - direct[u][i]));
+                }
+                changed += (recognise(model, scorer, f).model != direct_decision[u]);
+            }
+            const double flops = 2.0 * scorer.multiply_adds(corpus.total_frames());
+            std::printf("%-8s %10.4f %10.2f %9.2fx %12.3g %10zu\n", simd_isa_name(isa), best,
+                        best > 0.0 ? flops / best * 1e-9 : 0.0, best > 0.0 ? direct_time / best : 0.0, max_error,
+                        changed);
+            status |= (changed != 0);
+        }
+        return status;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_score_bench: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,495 @@
+/******************************************************************************
+* File Name:   hmm_gmm_search.cpp
+*
+* Description: Offline keyword search over a long recording:
+*
+*              hmm_gmm_search --filler <k> [options] <model.hmmb> <in.wav|in.mfc|test.feat>
+*
+*              hmm_gmm_spot streams audio the way the firmware does; an
+*              archive of hours of audio does not need to. The recording is
+*              resampled to 16 kHz once and cut into segments of --segment
+*              seconds. Per segment the MFCC_E_D_A vectors are computed once
+*              (mfcc_extractor::compute_frames), every state emission of
+*              every model is scored in bulk (gaussian_scorer::score_states)
+*              and the looped filler network of keyword_spotter runs over
+*              the cached scores (push_emissions). The front-end and the
+*              scoring, nearly all of the work, run in parallel with one
+*              extractor per worker and one shared scorer. A single spotter
+*              takes the scored segments in recording order as they are
+*              done, so the hits are those of one continuous pass and equal
+*              those of hmm_gmm_spot. A feature file, or a packed corpus
+*              concatenated into one stream, is searched the same way
+*              without the front-end.
+*
+*              Prints the hits with their times and the audio-hours searched
+*              per CPU-hour; --clip-hop adds the throughput of recognising
+*              overlapping 1 s clips, the way main.c classifies its blocks.
+*
+*******************************************************************************/
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/feature_matrix.hpp"
+#include "hmm_gmm/gaussian_scorer.hpp"
+#include "hmm_gmm/htk_file.hpp"
+#include "hmm_gmm/keyword_spotter.hpp"
+#include "hmm_gmm/mfcc.hpp"
+#include "hmm_gmm/parallel.hpp"
+#include "hmm_gmm/resampler.hpp"
+#include "hmm_gmm/viterbi.hpp"
+#include "hmm_gmm/wav_file.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    spotter_config spotter;
+    std::size_t filler = 0;         /* 1-based as the labels, 0 = not given */
+    double segment_sec = 60.0;
+    std::size_t threads = 0;        /* 0 = all hardware threads */
+    double clip_hop_ms = 0.0;       /* 0 = no clip baseline */
+    std::string hits;
+    std::vector<std::string> positional;
+};
+
+/* The recording as 16 kHz samples, or the features of a feature file */
+struct recording
+{
+    std::vector<float> samples;
+    feature_matrix features;
+    bool audio = false;
+    std::size_t frame_no = 0;
+    double frame_sec = 0.0;
+};
+
+/* log b_s(o_t) of a segment, in the row layout of gaussian_scorer::score_states() */
+struct segment_scores
+{
+    std::vector<float> emissions;
+    bool ready = false;
+    double front_end = 0.0;         /* seconds of the worker per stage */
+    double scoring = 0.0;
+};
+
+struct search_stats
+{
+    double front_end = 0.0;         /* summed over the workers */
+    double scoring = 0.0;
+    double search = 0.0;
+    std::size_t evaluations = 0;
+};
+
+using clock_type = std::chrono::steady_clock;
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_search --filler <k> [options] <model.hmmb> <in.wav|in.mfc|test.feat>\n"
+        "  --filler <k>        model (1-based label) trained on non-keyword audio, required\n"
+        "  --threshold <x>     minimum log-likelihood ratio of a detection (0)\n"
+        "  --penalty <x>       added to the log score of every background frame, < 0 favours keywords (0)\n"
+        "  --beam <x>          drop keyword states more than x below the background (off)\n"
+        "  --hold <n>          frames the best keyword END must stay the best before it is emitted (5)\n"
+        "  --max-frames <n>    longest keyword in frames, 0 = unlimited (100)\n"
+        "  --segment <s>       seconds of audio per segment (60)\n"
+        "  --threads <n>       worker threads, 0 = all hardware threads (0)\n"
+        "  --clip-hop <ms>     also time recognising 1 s clips every <ms>, 0 = off (0)\n"
+        "  --hits <f>          write keyword, start frame, end frame and score per hit\n");
+}
+
+bool has_suffix(const std::string &name, const char *suffix)
+{
+    const std::size_t n = std::char_traits<char>::length(suffix);
+    if (name.size() < n)
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < n; i++)
+    {
+        if (std::tolower((unsigned char)name[name.size() - n + i]) != suffix[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+double seconds_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+/* hh:mm:ss.cc */
+std::string timestamp(double sec)
+{
+    const long centi = std::lround(sec * 100.0);
+    char text[32];
+    std::snprintf(text, sizeof(text), "%02ld:%02ld:%02ld.%02ld", centi / 360000, centi / 6000 % 60, centi / 100 % 60,
+                  centi % 100);
+    return text;
+}
+
+recording load(const std::string &path, const mfcc_extractor &extractor)
+{
+    recording r;
+    if (has_suffix(path, ".wav"))
+    {
+        wav_data wav = read_wav_file(path);
+        const mfcc_config &config = extractor.config();
+        if (wav.sample_rate != config.sample_rate)
+        {
+            r.samples = polyphase_resampler(wav.sample_rate, config.sample_rate)
+                            .resample(wav.samples.data(), wav.samples.size());
+        }
+        else
+        {
+            r.samples = std::move(wav.samples);
+        }
+        r.audio = true;
+        r.frame_no = extractor.frame_count(r.samples.size());
+        r.frame_sec = config.frame_shift_sec;
+    }
+    else if (has_suffix(path, ".feat"))
+    {
+        const feature_corpus corpus(path);
+        r.features.dim = corpus.dim();
+        r.features.data.reserve(corpus.total_frames() * corpus.dim());
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            const feature_view v = corpus[u].features;
+            r.features.data.insert(r.features.data.end(), v.data, v.data + v.dim * v.frame_no);
+            r.features.frame_no += v.frame_no;
+        }
+        r.frame_no = r.features.frame_no;
+        r.frame_sec = corpus.samp_period() * 1e-7;
+    }
+    else
+    {
+        htk_header header;
+        r.features = read_htk_file(path, &header);
+        r.frame_no = r.features.frame_no;
+        r.frame_sec = header.samp_period * 1e-7;
+    }
+    return r;
+}
+
+void write_hits(const std::string &filename, const std::vector<keyword_detection> &hits)
+{
+    std::ofstream out(filename, std::ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error("cannot create " + filename);
+    }
+    char line[128];
+    for (const keyword_detection &d : hits)
+    {
+        std::snprintf(line, sizeof(line), "%zu %zu %zu %.6f\n", d.keyword + 1, d.start_frame, d.end_frame, d.score);
+        out << line;
+    }
+    if (!out)
+    {
+        throw std::runtime_error("cannot write " + filename);
+    }
+}
+
+/* Front-end and state emissions of frames [first, last) of the recording */
+void score_segment(const recording &r, mfcc_extractor &extractor, const gaussian_scorer &scorer, std::size_t first,
+                   std::size_t last, segment_scores &out)
+{
+    auto start = clock_type::now();
+    feature_matrix computed;
+    feature_view features;
+    if (r.audio)
+    {
+        computed = extractor.compute_frames(r.samples.data(), r.samples.size(), first, last - first);
+        features = computed;
+    }
+    else
+    {
+        features = feature_view(r.features.dim, last - first, r.features.frame(first));
+    }
+    out.front_end = seconds_since(start);
+
+    start = clock_type::now();
+    out.emissions.resize(features.frame_no * scorer.state_count());
+    scorer.score_states(features, out.emissions.data(), scorer.state_count());
+    out.scoring = seconds_since(start);
+}
+
+/*******************************************************************************
+* Function Name: search_recording
+********************************************************************************
+* Summary:
+*  The workers score the segments, handed out in recording order; a search
+*  thread waits for each segment in turn, pushes its rows to one spotter and
+*  releases them. The spotter never restarts, so the segment boundaries need
+*  no context frames and the hits depend on neither the segment length nor
+*  the number of threads. The spotter costs a fraction of the scoring, so it
+*  keeps up and only a few segments are held at a time.
+*
+* Parameters:
+*  r:       the recording
+*  model:   the model set of the scorer
+*  scorer:  shared bulk scorer
+*  config:  front-end settings of a recording
+*  spotter: spotter configuration
+*  segment: frames per segment
+*  threads: scoring workers
+*  stats:   receives the time per stage
+*
+* Return:
+*  The hits, in recording order
+*
+*******************************************************************************/
+std::vector<keyword_detection> search_recording(const recording &r, const compiled_model &model,
+                                                const gaussian_scorer &scorer, const mfcc_config &config,
+                                                const spotter_config &spotter, std::size_t segment,
+                                                std::size_t threads, search_stats &stats)
+{
+    const std::size_t segment_no = (r.frame_no + segment - 1) / segment;
+    const std::size_t stride = scorer.state_count();
+    std::vector<segment_scores> segments(segment_no);
+    std::mutex mutex;
+    std::condition_variable scored;
+    bool failed = false;
+
+    keyword_spotter network(model, spotter);
+    std::vector<keyword_detection> hits;
+    std::thread search([&]() {
+        for (std::size_t s = 0; s < segment_no; s++)
+        {
+            std::vector<float> emissions;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                scored.wait(lock, [&]() { return segments[s].ready || failed; });
+                if (!segments[s].ready)
+                {
+                    return;
+                }
+                emissions.swap(segments[s].emissions);
+            }
+            const auto start = clock_type::now();
+            for (std::size_t row = 0; row < emissions.size(); row += stride)
+            {
+                network.push_emissions(&emissions[row], hits);
+            }
+            stats.search += seconds_since(start);
+        }
+        network.finish(hits);
+    });
+
+    std::vector<std::unique_ptr<mfcc_extractor>> extractors;
+    for (std::size_t w = 0; w < threads; w++)
+    {
+        extractors.push_back(std::make_unique<mfcc_extractor>(config));
+    }
+    try
+    {
+        parallel_for(segment_no, threads, [&](std::size_t s, std::size_t worker) {
+            segment_scores done;
+            score_segment(r, *extractors[worker], scorer, s * segment, std::min(r.frame_no, (s + 1) * segment), done);
+            done.ready = true;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stats.front_end += done.front_end;
+                stats.scoring += done.scoring;
+                segments[s] = std::move(done);
+            }
+            scored.notify_all();
+        });
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed = true;
+        }
+        scored.notify_all();
+        search.join();
+        throw;
+    }
+    search.join();
+    stats.evaluations = network.evaluations();
+    return hits;
+}
+
+/*
+ * The baseline: a 1 s clip every hop, front-end and a full recognise() over
+ * every model per clip, as main.c classifies its blocks. Returns the clips.
+ */
+std::size_t recognise_clips(const recording &r, const compiled_model &model, const gaussian_scorer &scorer,
+                            const mfcc_config &config, double hop_ms, std::size_t threads)
+{
+    const std::size_t clip_frames = (std::size_t)std::lround(1.0 / r.frame_sec);
+    const std::size_t clip_samples = (std::size_t)std::lround(config.sample_rate);
+    const std::size_t hop = std::max<std::size_t>(1, (std::size_t)std::lround(hop_ms * 1e-3 / r.frame_sec));
+    const std::size_t clip_no = (r.frame_no > clip_frames) ? (r.frame_no - clip_frames) / hop + 1 : 1;
+
+    std::vector<std::unique_ptr<mfcc_extractor>> extractors;
+    std::vector<std::unique_ptr<emission_cache>> caches;
+    for (std::size_t w = 0; w < threads; w++)
+    {
+        extractors.push_back(std::make_unique<mfcc_extractor>(config));
+        caches.push_back(std::make_unique<emission_cache>(model, scorer));
+    }
+    parallel_for(clip_no, threads, [&](std::size_t c, std::size_t worker) {
+        const std::size_t first = c * hop;
+        if (r.audio)
+        {
+            const std::size_t offset = std::min(first * config.frame_shift(), r.samples.size());
+            const feature_matrix clip = extractors[worker]->compute(
+                r.samples.data() + offset, std::min(clip_samples, r.samples.size() - offset));
+            recognise(*caches[worker], clip);
+        }
+        else
+        {
+            recognise(*caches[worker], feature_view(r.features.dim, std::min(clip_frames, r.frame_no - first),
+                                                    r.features.frame(first)));
+        }
+    });
+    return clip_no;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    options opt;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--filler" && i + 1 < argc)           opt.filler = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--threshold" && i + 1 < argc)   opt.spotter.threshold = std::atof(argv[++i]);
+        else if (arg == "--penalty" && i + 1 < argc)     opt.spotter.filler_penalty = std::atof(argv[++i]);
+        else if (arg == "--beam" && i + 1 < argc)        opt.spotter.beam = std::atof(argv[++i]);
+        else if (arg == "--hold" && i + 1 < argc)        opt.spotter.hold_frames = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--max-frames" && i + 1 < argc)  opt.spotter.max_frames = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--segment" && i + 1 < argc)     opt.segment_sec = std::atof(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)     opt.threads = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--clip-hop" && i + 1 < argc)    opt.clip_hop_ms = std::atof(argv[++i]);
+        else if (arg == "--hits" && i + 1 < argc)        opt.hits = argv[++i];
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            opt.positional.push_back(arg);
+        }
+    }
+    if (opt.positional.size() != 2 || opt.filler == 0 || !(opt.segment_sec > 0.0) || opt.clip_hop_ms < 0.0)
+    {
+        usage();
+        return 2;
+    }
+    opt.spotter.filler = opt.filler - 1;
+
+    try
+    {
+        const std::clock_t cpu_start = std::clock();
+        const auto wall_start = clock_type::now();
+        const compiled_model model(opt.positional[0]);
+        const mfcc_config config;
+        const gaussian_scorer scorer(model);
+        /* throws for a bad filler before any audio is read */
+        const keyword_spotter validated(model, opt.spotter);
+
+        auto start = clock_type::now();
+        const recording r = load(opt.positional[1], mfcc_extractor(config));
+        const double load_time = seconds_since(start);
+        const std::size_t dim = r.audio ? config.feature_dim() : r.features.dim;
+        if (dim != model.dim())
+        {
+            throw std::invalid_argument(opt.positional[1] + " gives " + std::to_string(dim) +
+                                        " dimensions, the model has " + std::to_string(model.dim()));
+        }
+
+        const std::size_t segment = std::max<std::size_t>(1, (std::size_t)std::lround(opt.segment_sec / r.frame_sec));
+        const std::size_t segment_no = (r.frame_no + segment - 1) / segment;
+        const std::size_t threads = std::max<std::size_t>(1, std::min(opt.threads ? opt.threads : hardware_threads(),
+                                                                      segment_no));
+        search_stats stats;
+        start = clock_type::now();
+        const std::vector<keyword_detection> hits = search_recording(r, model, scorer, config, opt.spotter, segment,
+                                                                     threads, stats);
+        const double search_wall = seconds_since(start);
+
+        for (const keyword_detection &d : hits)
+        {
+            std::printf("%s - %s  keyword %zu  score %8.2f\n", timestamp(r.frame_sec * d.start_frame).c_str(),
+                        timestamp(r.frame_sec * (d.end_frame + 1)).c_str(), d.keyword + 1, d.score);
+        }
+        if (!opt.hits.empty())
+        {
+            write_hits(opt.hits, hits);
+        }
+        const double wall = seconds_since(wall_start);
+        const double cpu = (double)(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+        const double audio = r.frame_no * r.frame_sec;
+        std::printf("\n%zu hit(s) in %s of %s (%zu frames), %zu models x %zu states x %zu mixtures\n", hits.size(),
+                    timestamp(audio).c_str(), r.audio ? "audio" : "features", r.frame_no, model.model_no(),
+                    model.state_no(), model.mix_no());
+        std::printf("%zu segment(s) of %zu frames scored on %zu thread(s), searched in order on one more\n", segment_no,
+                    segment, threads);
+        std::printf("stage [s]       load %.3f, front-end %.3f, emissions %.3f, search %.3f (summed over workers)\n",
+                    load_time, stats.front_end, stats.scoring, stats.search);
+        std::printf("keyword states  %.1f %% read by the spotter\n",
+                    r.frame_no ? 100.0 * stats.evaluations / ((double)r.frame_no * (model.model_no() - 1) *
+                                                              model.state_no())
+                               : 0.0);
+        std::printf("time            %.3f s wall (search %.3f s), %.3f s CPU\n", wall, search_wall, cpu);
+        if (cpu > 0.0 && wall > 0.0)
+        {
+            std::printf("throughput      %.1f audio-hours per CPU-hour, %.1f per wall-hour\n", audio / cpu,
+                        audio / wall);
+        }
+
+        if (opt.clip_hop_ms > 0.0)
+        {
+            const std::clock_t clip_cpu_start = std::clock();
+            start = clock_type::now();
+            const std::size_t clips = recognise_clips(r, model, scorer, config, opt.clip_hop_ms, threads);
+            const double clip_wall = seconds_since(start);
+            const double clip_cpu = (double)(std::clock() - clip_cpu_start) / CLOCKS_PER_SEC;
+            std::printf("\n1 s clips       %zu every %g ms: %.3f s wall, %.3f s CPU", clips, opt.clip_hop_ms, clip_wall,
+                        clip_cpu);
+            if (clip_cpu > 0.0)
+            {
+                std::printf(", %.1f audio-hours per CPU-hour (%.1fx slower)", audio / clip_cpu,
+                            cpu > 0.0 ? clip_cpu / cpu : 0.0);
+            }
+            std::printf("\n");
+        }
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_search: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
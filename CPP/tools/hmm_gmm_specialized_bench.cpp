@@ -0,0 +1,156 @@
+/******************************************************************************
+* File Name:   hmm_gmm_specialized_bench.cpp
+*
+* Description: Gain of the compile-time specialised decoder
+*              (specialized_decoder.hpp). A corpus is decoded with the same
+*              frame-synchronous decoder instantiated for the model's sizes
+*              and with the sizes read at run time, and with the reference
+*              decoder on the lazy emission cache:
+*
+*              hmm_gmm_specialized_bench [--repeat n] <model.hmmb> <test.feat>
+*
+*              Reports time, real-time factor and speed-up over the
+*              run-time sizes, the accuracy, and the largest score
+*              difference and the decisions changed against the reference.
+*
+*******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/specialized_decoder.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_specialized_bench [--repeat n] <model.hmmb> <test.feat>\n"
+        "  --repeat <n>   timed passes over the corpus, the fastest is reported (3)\n");
+}
+
+/* The fastest of 'repeat' passes; results of the last one */
+template <typename Decode>
+double timed(const feature_corpus &corpus, std::size_t repeat, Decode decode, std::vector<recognition_result> &results)
+{
+    double best = 0.0;
+    for (std::size_t r = 0; r < repeat; r++)
+    {
+        results.clear();
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            results.push_back(decode(corpus[u].features));
+        }
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = (r == 0 || elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    std::size_t repeat = 3;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc)  repeat = std::strtoul(argv[++i], nullptr, 10);
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2 || repeat == 0)
+    {
+        usage();
+        return 2;
+    }
+
+    try
+    {
+        const compiled_model model(positional[0]);
+        const feature_corpus corpus(positional[1]);
+        const specialized_decoder generic(model, true);
+        const specialized_decoder specialized(model);
+        emission_cache cache(model);
+
+        std::printf("%zu utterances, %zu frames, %zu models x %zu states x %zu mixtures, dim %zu\n", corpus.size(),
+                    corpus.total_frames(), model.model_no(), model.state_no(), model.mix_no(), model.dim());
+        std::printf("instantiated shapes (dim x states x mixtures):");
+        for (const model_shape &shape : specialized_shapes())
+        {
+            std::printf(" %zux%zux%zu", shape.dim, shape.state_no, shape.mix_no);
+        }
+        std::printf("\n");
+        if (!specialized.specialized())
+        {
+            std::printf("no instantiation for this model: both runs use the run-time sizes\n");
+        }
+
+        std::vector<recognition_result> reference, results;
+        const double reference_time = timed(corpus, repeat,
+                                            [&](const feature_view &f) { return recognise(cache, f); }, reference);
+        /* samp_period is in HTK units of 100 ns */
+        const double audio = (double)corpus.total_frames() * corpus.samp_period() * 1e-7;
+        double generic_time = 0.0;
+        std::printf("\n%-28s %10s %10s %8s %10s %12s %8s\n", "decoder", "time [s]", "real-time", "speed-up",
+                    "accuracy", "max |diff|", "changed");
+        auto report = [&](const char *name, double time, const std::vector<recognition_result> &r) {
+            std::size_t correct = 0, changed = 0;
+            double max_diff = 0.0;
+            for (std::size_t u = 0; u < corpus.size(); u++)
+            {
+                correct += (r[u].model + 1 == corpus[u].label);
+                changed += (r[u].model != reference[u].model);
+                for (std::size_t k = 0; k < r[u].scores.size(); k++)
+                {
+                    if (std::isfinite(r[u].scores[k]) || std::isfinite(reference[u].scores[k]))
+                    {
+                        max_diff = std::max(max_diff, std::fabs(r[u].scores[k] - reference[u].scores[k]));
+                    }
+                }
+            }
+            std::printf("%-28s %10.4f %10.5f %7.2fx %9.2f%% %12.3g %8zu\n", name, time,
+                        audio > 0.0 ? time / audio : 0.0, (generic_time > 0.0 && time > 0.0) ? generic_time / time : 1.0,
+                        corpus.size() ? 100.0 * correct / corpus.size() : 0.0, max_diff, changed);
+        };
+
+        generic_time = timed(corpus, repeat, [&](const feature_view &f) { return generic.recognise(f); }, results);
+        report("run-time sizes", generic_time, results);
+        const double specialized_time =
+            timed(corpus, repeat, [&](const feature_view &f) { return specialized.recognise(f); }, results);
+        report(specialized.specialized() ? "compile-time sizes" : "compile-time sizes (n/a)", specialized_time,
+               results);
+        report("reference (emission cache)", reference_time, reference);
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_specialized_bench: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,385 @@
+/******************************************************************************
+* File Name:   hmm_gmm_spot.cpp
+*
+* Description: Continuous keyword spotting with a filler model
+*              (keyword_spotter.hpp):
+*
+*              hmm_gmm_spot [options] <model.hmmb> <in.wav|in.mfc|test.feat>
+*
+*              A recording is resampled to 16 kHz and streamed through the
+*              MFCC_E_D_A front-end in chunks, the way the firmware receives
+*              its PDM blocks; every vector is pushed to the spotter as soon
+*              as it exists. A feature file is pushed frame by frame.
+*              Detections are printed with their start and end times.
+*
+*              A packed corpus is concatenated into one stream. Its
+*              utterances labelled with the filler are background, every
+*              other utterance is a keyword occurrence. A detection whose
+*              middle frame lies in an utterance of the same label is a hit
+*              (the first one only), any other detection a false alarm.
+*              Reports hits, misses, false alarms per hour and how long after
+*              the end of its utterance each hit was emitted.
+*
+*******************************************************************************/
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/htk_file.hpp"
+#include "hmm_gmm/keyword_spotter.hpp"
+#include "hmm_gmm/resampler.hpp"
+#include "hmm_gmm/streaming_mfcc.hpp"
+#include "hmm_gmm/wav_file.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    spotter_config spotter;
+    std::size_t filler = 0;         /* 1-based as the labels, 0 = not given */
+    std::size_t chunk = 1600;       /* samples per push of a recording (100 ms) */
+    std::string detections;
+    std::vector<std::string> positional;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_spot [options] <model.hmmb> <in.wav|in.mfc|test.feat>\n"
+        "  --filler <k>        model (1-based label) trained on non-keyword audio, required\n"
+        "  --threshold <x>     minimum log-likelihood ratio of a detection (0)\n"
+        "  --penalty <x>       added to the log score of every background frame, < 0 favours keywords (0)\n"
+        "  --beam <x>          drop keyword states more than x below the background (off)\n"
+        "  --hold <n>          frames the best keyword END must stay the best before it is emitted (5)\n"
+        "  --max-frames <n>    longest keyword in frames, 0 = unlimited (100)\n"
+        "  --chunk <n>         samples per push when streaming a recording (1600)\n"
+        "  --detections <f>    write keyword, start frame, end frame and score per detection\n");
+}
+
+bool has_suffix(const std::string &name, const char *suffix)
+{
+    const std::size_t n = std::char_traits<char>::length(suffix);
+    if (name.size() < n)
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < n; i++)
+    {
+        if (std::tolower((unsigned char)name[name.size() - n + i]) != suffix[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Nearest-rank percentile of sorted values */
+double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    const std::size_t rank = (std::size_t)std::ceil(p / 100.0 * (double)sorted.size());
+    return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+void print_detection(const keyword_detection &d, double frame_sec)
+{
+    std::printf("keyword %zu  %8.2f s - %8.2f s  score %8.2f\n", d.keyword + 1, frame_sec * d.start_frame,
+                frame_sec * (d.end_frame + 1), d.score);
+}
+
+void write_detections(const std::string &filename, const std::vector<keyword_detection> &detections)
+{
+    std::ofstream out(filename, std::ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error("cannot create " + filename);
+    }
+    char line[128];
+    for (const keyword_detection &d : detections)
+    {
+        std::snprintf(line, sizeof(line), "%zu %zu %zu %.6f\n", d.keyword + 1, d.start_frame, d.end_frame, d.score);
+        out << line;
+    }
+    if (!out)
+    {
+        throw std::runtime_error("cannot write " + filename);
+    }
+}
+
+/*
+ * Streams a recording in chunks of opt.chunk samples: resampler, front-end
+ * and spotter all keep their state between the chunks. Each detection is
+ * printed with the amount of audio consumed when it was emitted.
+ */
+std::vector<keyword_detection> spot_recording(const options &opt, keyword_spotter &spotter, const std::string &path)
+{
+    const wav_data wav = read_wav_file(path);
+    mfcc_config config;
+    streaming_mfcc front_end(config);
+    std::unique_ptr<polyphase_resampler> resampler;
+    if (wav.sample_rate != config.sample_rate)
+    {
+        resampler = std::make_unique<polyphase_resampler>(wav.sample_rate, config.sample_rate);
+    }
+
+    const double frame_sec = config.frame_shift_sec;
+    const std::size_t dim = front_end.feature_dim();
+    if (dim != spotter.dim())
+    {
+        throw std::invalid_argument("the front-end gives " + std::to_string(dim) + " dimensions, the model has " +
+                                    std::to_string(spotter.dim()));
+    }
+    std::vector<keyword_detection> detections;
+    std::vector<float> resampled, features;
+    std::size_t pushed = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t first = 0; first <= wav.samples.size(); first += opt.chunk)
+    {
+        const std::size_t count = std::min(opt.chunk, wav.samples.size() - std::min(first, wav.samples.size()));
+        const bool last = (first + count >= wav.samples.size());
+        const float *samples = wav.samples.data() + first;
+        if (resampler)
+        {
+            resampled.clear();
+            resampler->process(samples, count, resampled);
+            if (last)
+            {
+                resampler->finish(resampled);
+            }
+            samples = resampled.data();
+        }
+        front_end.push(samples, resampler ? resampled.size() : count, features);
+        if (last)
+        {
+            front_end.finish(features);
+        }
+        for (; pushed < features.size() / dim; pushed++)
+        {
+            for (std::size_t added = spotter.push(&features[pushed * dim], detections); added > 0; added--)
+            {
+                print_detection(detections[detections.size() - added], frame_sec);
+                std::printf("  emitted after %.2f s of audio\n", (double)(first + count) / wav.sample_rate);
+            }
+        }
+        if (last)
+        {
+            if (spotter.finish(detections))
+            {
+                print_detection(detections.back(), frame_sec);
+                std::printf("  emitted at the end of the recording\n");
+            }
+            break;
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double audio = (double)wav.samples.size() / wav.sample_rate;
+    std::printf("%zu detection(s) in %.2f s of audio, %zu frames, real-time %.5f (front-end included)\n",
+                detections.size(), audio, spotter.frame_no(), audio > 0.0 ? elapsed / audio : 0.0);
+    return detections;
+}
+
+std::vector<keyword_detection> spot_features(keyword_spotter &spotter, const std::string &path)
+{
+    htk_header header;
+    const feature_matrix features = read_htk_file(path, &header);
+    const double frame_sec = header.samp_period * 1e-7;
+    if (features.dim != spotter.dim())
+    {
+        throw std::invalid_argument(path + " has " + std::to_string(features.dim) + " dimensions, the model " +
+                                    std::to_string(spotter.dim()));
+    }
+    std::vector<keyword_detection> detections;
+    for (std::size_t t = 0; t < features.frame_no; t++)
+    {
+        for (std::size_t added = spotter.push(feature_view(features).frame(t), detections); added > 0; added--)
+        {
+            print_detection(detections[detections.size() - added], frame_sec);
+        }
+    }
+    if (spotter.finish(detections))
+    {
+        print_detection(detections.back(), frame_sec);
+    }
+    std::printf("%zu detection(s) in %zu frames\n", detections.size(), features.frame_no);
+    return detections;
+}
+
+std::vector<keyword_detection> spot_corpus(const options &opt, const compiled_model &model, keyword_spotter &spotter,
+                                           const std::string &path)
+{
+    const feature_corpus corpus(path);
+    if (corpus.dim() != model.dim())
+    {
+        throw std::invalid_argument(path + " has " + std::to_string(corpus.dim()) + " dimensions, the model " +
+                                    std::to_string(model.dim()));
+    }
+    const double frame_sec = corpus.samp_period() * 1e-7;
+
+    /* the stream: utterance u covers frames [begin[u], begin[u + 1]) */
+    std::vector<std::size_t> begin(corpus.size() + 1, 0);
+    std::vector<keyword_detection> detections;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        const feature_view features = corpus[u].features;
+        begin[u + 1] = begin[u] + features.frame_no;
+        for (std::size_t t = 0; t < features.frame_no; t++)
+        {
+            spotter.push(features.frame(t), detections);
+        }
+    }
+    spotter.finish(detections);
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t keywords = 0, background_frames = 0;
+    std::vector<std::size_t> occurrences(model.model_no(), 0), found(model.model_no(), 0);
+    for (std::size_t u = 0; u < corpus.size(); u++)
+    {
+        const int32_t label = corpus[u].label;
+        if (label == (int32_t)opt.filler)
+        {
+            background_frames += corpus[u].features.frame_no;
+        }
+        else if (label >= 1 && (std::size_t)label <= model.model_no())
+        {
+            occurrences[label - 1]++;
+            keywords++;
+        }
+    }
+
+    std::vector<bool> hit(corpus.size(), false);
+    std::vector<double> latency;
+    std::size_t false_alarms = 0, in_background = 0;
+    for (const keyword_detection &d : detections)
+    {
+        const std::size_t middle = (d.start_frame + d.end_frame) / 2;
+        const std::size_t u = (std::size_t)(std::upper_bound(begin.begin(), begin.end(), middle) - begin.begin()) - 1;
+        if (u < corpus.size() && corpus[u].label == (int32_t)(d.keyword + 1) && !hit[u])
+        {
+            hit[u] = true;
+            found[d.keyword]++;
+            /* emitted hold_frames after its end frame */
+            latency.push_back(((double)(d.end_frame + opt.spotter.hold_frames) + 1.0 - (double)begin[u + 1]) * frame_sec);
+        }
+        else
+        {
+            false_alarms++;
+            in_background += (u < corpus.size() && corpus[u].label == (int32_t)opt.filler);
+        }
+    }
+    std::sort(latency.begin(), latency.end());
+
+    const std::size_t hits = latency.size();
+    const double hours = (double)begin.back() * frame_sec / 3600.0;
+    std::printf("%zu utterances as one stream of %zu frames (%.1f s), %zu keyword occurrences, %.1f s of background\n",
+                corpus.size(), begin.back(), begin.back() * frame_sec, keywords, background_frames * frame_sec);
+    std::printf("filler model %zu, threshold %g, penalty %g, beam %g, hold %zu frames, at most %zu frames\n",
+                opt.filler, opt.spotter.threshold, opt.spotter.filler_penalty, opt.spotter.beam,
+                opt.spotter.hold_frames, opt.spotter.max_frames);
+    std::printf("hits            %zu / %zu (%.2f %%), %zu missed\n", hits, keywords,
+                keywords ? 100.0 * hits / keywords : 0.0, keywords - hits);
+    std::printf("false alarms    %zu (%zu in background, %zu over other keywords or repeated), %.1f per hour\n",
+                false_alarms, in_background, false_alarms - in_background, hours > 0.0 ? false_alarms / hours : 0.0);
+    std::printf("latency [ms]    p50 %.0f, p90 %.0f, max %.0f, min %.0f of the emission behind the end of the utterance\n",
+                1e3 * percentile(latency, 50.0), 1e3 * percentile(latency, 90.0),
+                latency.empty() ? 0.0 : 1e3 * latency.back(), latency.empty() ? 0.0 : 1e3 * latency.front());
+    const double states = (double)begin.back() * (model.model_no() - 1) * model.state_no();
+    std::printf("keyword states  %.1f %% of the emissions computed, real-time %.5f\n",
+                states > 0.0 ? 100.0 * spotter.evaluations() / states : 0.0,
+                begin.back() ? elapsed / (begin.back() * frame_sec) : 0.0);
+
+    std::printf("\n%8s %8s %8s %8s\n", "keyword", "spoken", "found", "rate");
+    for (std::size_t k = 0; k < model.model_no(); k++)
+    {
+        if (k + 1 != opt.filler)
+        {
+            std::printf("%8zu %8zu %8zu %7.2f%%\n", k + 1, occurrences[k], found[k],
+                        occurrences[k] ? 100.0 * found[k] / occurrences[k] : 0.0);
+        }
+    }
+    return detections;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    options opt;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--filler" && i + 1 < argc)           opt.filler = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--threshold" && i + 1 < argc)   opt.spotter.threshold = std::atof(argv[++i]);
+        else if (arg == "--penalty" && i + 1 < argc)     opt.spotter.filler_penalty = std::atof(argv[++i]);
+        else if (arg == "--beam" && i + 1 < argc)        opt.spotter.beam = std::atof(argv[++i]);
+        else if (arg == "--hold" && i + 1 < argc)        opt.spotter.hold_frames = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--max-frames" && i + 1 < argc)  opt.spotter.max_frames = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--chunk" && i + 1 < argc)       opt.chunk = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--detections" && i + 1 < argc)  opt.detections = argv[++i];
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+        else
+        {
+            opt.positional.push_back(arg);
+        }
+    }
+    if (opt.positional.size() != 2 || opt.filler == 0 || opt.chunk == 0)
+    {
+        usage();
+        return 2;
+    }
+    opt.spotter.filler = opt.filler - 1;
+
+    try
+    {
+        const compiled_model model(opt.positional[0]);
+        keyword_spotter spotter(model, opt.spotter);
+        const std::string &input = opt.positional[1];
+        std::vector<keyword_detection> detections;
+        if (has_suffix(input, ".wav"))
+        {
+            detections = spot_recording(opt, spotter, input);
+        }
+        else if (has_suffix(input, ".feat"))
+        {
+            detections = spot_corpus(opt, model, spotter, input);
+        }
+        else
+        {
+            detections = spot_features(spotter, input);
+        }
+        if (!opt.detections.empty())
+        {
+            write_detections(opt.detections, detections);
+        }
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_spot: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
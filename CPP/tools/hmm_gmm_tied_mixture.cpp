@@ -0,0 +1,198 @@
+/******************************************************************************
+* File Name:   hmm_gmm_tied_mixture.cpp
+*
+* Description: Decodes a packed feature corpus with a tied-mixture model set
+*              (HMM_tied_<iter>.mat from hmm_gmm_tied_mixture_training.m):
+*
+*              hmm_gmm_tied_mixture [--top-k a,b,..] [--compare model.hmmb] [--repeat n]
+*                                   <HMM_tied.mat> <test.feat>
+*
+*              For every top-k (pool Gaussians combined per state and frame,
+*              0 = the whole pool) it prints the accuracy, the decisions
+*              that differ from the first top-k, the decoding time and
+*              real-time factor and the work per frame. --compare decodes
+*              the corpus with a compiled continuous model set as well and
+*              prints both parameter counts.
+*
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmm_gmm/compiled_model.hpp"
+#include "hmm_gmm/emission_cache.hpp"
+#include "hmm_gmm/feature_corpus.hpp"
+#include "hmm_gmm/tied_mixture_model.hpp"
+#include "hmm_gmm/viterbi.hpp"
+
+using namespace hmm_gmm;
+
+namespace
+{
+
+struct options
+{
+    std::vector<std::size_t> top_ks = {0, 32, 8};
+    std::string compare;
+    std::size_t repeat = 1;
+    std::vector<std::string> positional;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: hmm_gmm_tied_mixture [--top-k a,b,..] [--compare model.hmmb] [--repeat n]\n"
+        "                            <HMM_tied.mat> <test.feat>\n"
+        "  --top-k <l>        pool Gaussians combined per frame, 0 = whole pool (0,32,8)\n"
+        "  --compare <f>      also decode with this compiled continuous model set\n"
+        "  --repeat <n>       timed passes over the corpus, the fastest is reported (1)\n");
+}
+
+std::vector<std::size_t> parse_list(const std::string &text)
+{
+    std::vector<std::size_t> values;
+    std::size_t begin = 0;
+    while (begin <= text.size())
+    {
+        std::size_t end = text.find(',', begin);
+        end = (end == std::string::npos) ? text.size() : end;
+        const std::string item = text.substr(begin, end - begin);
+        char *rest = nullptr;
+        const std::size_t value = std::strtoul(item.c_str(), &rest, 10);
+        if (item.empty() || *rest != '\0')
+        {
+            throw std::invalid_argument("bad list " + text);
+        }
+        values.push_back(value);
+        begin = end + 1;
+    }
+    return values;
+}
+
+/* The fastest of 'repeat' passes over the corpus */
+template <typename Decide>
+double timed(const feature_corpus &corpus, std::size_t repeat, Decide decide, std::vector<int> &decisions)
+{
+    double best = 0.0;
+    for (std::size_t r = 0; r < repeat; r++)
+    {
+        decisions.clear();
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            decisions.push_back(decide(corpus[u].features));
+        }
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = (r == 0 || elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+int run(const options &opt)
+{
+    const tied_mixture_model model(read_tied_mixture_mat(opt.positional[0]));
+    const feature_corpus corpus(opt.positional[1]);
+    const double n = corpus.size() ? (double)corpus.size() : 1.0;
+    const double frames = corpus.total_frames() ? (double)corpus.total_frames() : 1.0;
+    /* samp_period is in HTK units of 100 ns */
+    const double audio = (double)corpus.total_frames() * corpus.samp_period() * 1e-7;
+    auto correct = [&](const std::vector<int> &decisions) {
+        std::size_t hits = 0;
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            hits += (decisions[u] + 1 == corpus[u].label);
+        }
+        return hits;
+    };
+
+    std::printf("%zu models x %zu states, pool of %zu Gaussians, dim %zu; %zu utterances, %zu frames\n",
+                model.model_no(), model.state_no(), model.pool_size(), model.dim(), corpus.size(),
+                corpus.total_frames());
+    std::printf("parameters: %zu floats (pool %zu, state weights %zu)\n\n", model.parameter_count(),
+                model.pool_size() * (2 * model.dim() + 1), model.state_count() * model.pool_size());
+    std::printf("%10s %10s %8s %10s %10s %12s %12s\n", "top-k", "accuracy", "changed", "time [s]", "real-time",
+                "Gaussians/fr", "log-adds/fr");
+
+    std::vector<int> first, decisions;
+    for (std::size_t top_k : opt.top_ks)
+    {
+        const double best = timed(corpus, opt.repeat,
+                                  [&](const feature_view &f) { return recognise(model, f, top_k).model; },
+                                  decisions);
+        if (first.empty())
+        {
+            first = decisions;
+        }
+        std::size_t changed = 0;
+        for (std::size_t u = 0; u < corpus.size(); u++)
+        {
+            changed += (decisions[u] != first[u]);
+        }
+        const std::size_t combined = (top_k == 0 || top_k > model.pool_size()) ? model.pool_size() : top_k;
+        std::printf("%10s %9.2f%% %8zu %10.4f %10.5f %12zu %12zu\n",
+                    top_k ? std::to_string(top_k).c_str() : "all", 100.0 * correct(decisions) / n, changed, best,
+                    audio > 0.0 ? best / audio : 0.0, model.pool_size(), combined * model.state_count());
+    }
+
+    if (!opt.compare.empty())
+    {
+        const compiled_model continuous(opt.compare);
+        if (continuous.model_no() != model.model_no() || continuous.dim() != model.dim())
+        {
+            throw std::invalid_argument(opt.compare + " has other models than " + opt.positional[0]);
+        }
+        emission_cache cache(continuous);
+        const double best = timed(corpus, opt.repeat,
+                                  [&](const feature_view &f) { return recognise(cache, f).model; }, decisions);
+        const std::size_t gaussians = continuous.model_no() * continuous.state_no() * continuous.mix_no();
+        std::printf("\ncontinuous %zu mixture(s): %zu Gaussians, %zu floats\n", continuous.mix_no(), gaussians,
+                    gaussians * (2 * continuous.dim() + 2));
+        std::printf("%10s %9.2f%% %8s %10.4f %10.5f %12.0f %12s\n", "-", 100.0 * correct(decisions) / n, "-", best,
+                    audio > 0.0 ? best / audio : 0.0, cache.gaussian_evaluations() / (frames * opt.repeat), "-");
+    }
+    return 0;
+}
+
+} /* namespace */
+
+
+int main(int argc, char **argv)
+{
+    options opt;
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--top-k" && i + 1 < argc)         opt.top_ks = parse_list(argv[++i]);
+            else if (arg == "--compare" && i + 1 < argc)  opt.compare = argv[++i];
+            else if (arg == "--repeat" && i + 1 < argc)   opt.repeat = std::strtoul(argv[++i], nullptr, 10);
+            else if (!arg.empty() && arg[0] == '-')
+            {
+                std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+                usage();
+                return 2;
+            }
+            else
+            {
+                opt.positional.push_back(arg);
+            }
+        }
+        if (opt.positional.size() != 2 || opt.repeat == 0)
+        {
+            usage();
+            return 2;
+        }
+        return run(opt);
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "hmm_gmm_tied_mixture: %s\n", e.what());
+        return 1;
+    }
+}
+
+/* [] END OF FILE */
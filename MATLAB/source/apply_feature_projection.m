@@ -0,0 +1,65 @@
+function [out_list_file, out_dim] = apply_feature_projection(projection_file, list_file, list_var, outdir)
+    % Projects every HTK feature file of a training / testing list with the PCA or
+    % LDA projection estimated by CPP/tools/hmm_gmm_projection (y = W*(x - m)),
+    % writes the projected files below outdir and saves a list of them under the
+    % same variable name (list_var: 'trainingfile' or 'testingfile').
+    %
+    % Train on the projected list with DIM = out_dim to get models that are
+    % evaluated in the reduced dimension.
+
+    load(projection_file, 'projection_matrix', 'projection_mean');
+    out_dim = size(projection_matrix, 1);
+
+    if ~exist(outdir, 'dir')
+        mkdir(outdir);
+    end
+
+    file_list = load(list_file, list_var);
+    file_list = file_list.(list_var);
+    num_of_uter = size(file_list, 1);
+
+    for u = 1:num_of_uter
+        filename = file_list{u,2};
+        mfcfile = fopen(filename, 'r', 'b');
+        if mfcfile == -1
+            error('apply_feature_projection: cannot open %s', filename);
+        end
+        nSamples = fread(mfcfile, 1, 'int32');
+        sampPeriod = fread(mfcfile, 1, 'int32');
+        sampSize = fread(mfcfile, 1, 'int16');
+        dim = 0.25*sampSize;
+        parmKind = fread(mfcfile, 1, 'int16');
+        features = fread(mfcfile, [dim, nSamples], 'float');
+        fclose(mfcfile);
+
+        if dim ~= size(projection_matrix, 2)
+            error('apply_feature_projection: %s has dimension %d, the projection expects %d', ...
+                  filename, dim, size(projection_matrix, 2));
+        end
+        projected = projection_matrix*(features - repmat(projection_mean, 1, nSamples));
+
+        % keep the label directory so the file names stay unique
+        [labeldir, name, ext] = fileparts(filename);
+        [~, label] = fileparts(labeldir);
+        projected_dir = fullfile(outdir, label);
+        if ~exist(projected_dir, 'dir')
+            mkdir(projected_dir);
+        end
+        out_filename = fullfile(projected_dir, [name ext]);
+
+        mfcfile = fopen(out_filename, 'w', 'b');
+        fwrite(mfcfile, nSamples, 'int32');
+        fwrite(mfcfile, sampPeriod, 'int32');
+        fwrite(mfcfile, 4*out_dim, 'int16');
+        fwrite(mfcfile, parmKind, 'int16');
+        fwrite(mfcfile, projected, 'float');
+        fclose(mfcfile);
+
+        file_list{u,2} = out_filename;
+    end
+
+    [listdir, listname, listext] = fileparts(list_file);
+    out_list_file = fullfile(listdir, [listname '_projected' listext]);
+    eval([list_var ' = file_list;']);
+    save(out_list_file, list_var);
+end
@@ -0,0 +1,6 @@
+function features = feature_corpus_utterance(corpus, u)
+    % [dim, frame_no] features of utterance u of a corpus opened with read_feature_corpus(),
+    % the same matrix fread(mfcfile, [dim, nSamples], 'float') returns for the HTK file.
+    count = corpus.dim * corpus.frame_no(u);
+    features = double(reshape(corpus.data.Data(corpus.first(u) : corpus.first(u) + count - 1), corpus.dim, corpus.frame_no(u)));
+end
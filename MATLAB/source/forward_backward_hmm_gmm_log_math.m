@@ -29,13 +29,15 @@ log_alpha = -Inf(num_of_state, T+1); % initialization
 log_beta = -Inf(num_of_state, T+1);  % initialization 
 %% calculate log_N_jkt(j,k,t)
 log_N_jkt = -Inf(num_of_state,num_of_mix,T); % log single Gaussian for each mixture k in each state j at time step t
-for j = 1:num_of_state
-    for k = 1:num_of_mix
-        for t = 1:T
-            log_N_jkt(j,k,t) = -1/2*(dim*log(2*pi) + sum(log(var(:,k,j))) + sum((obs(:,t) - mean(:,k,j)).*(obs(:,t) - mean(:,k,j))./var(:,k,j)));
-        end
-    end
-end
+% The quadratic form is expanded so that all Gaussians of all frames are one
+% matrix product: log N = [-1/2*ivar; mean.*ivar; gconst]' * [obs.^2; obs; 1]
+% with gconst = -1/2*(dim*log(2*pi) + sum(log(var)) + sum(mean.^2.*ivar)).
+emitting = 2:num_of_state-1;
+ivar = 1./reshape(var(:,:,emitting), dim, []);      % column g = k + num_of_mix*(j-2)
+mu = reshape(mean(:,:,emitting), dim, []);
+gconst = -1/2*(dim*log(2*pi) - sum(log(ivar), 1) + sum(mu.*mu.*ivar, 1));
+log_N = [-1/2*ivar; mu.*ivar; gconst]' * [obs.*obs; obs; ones(1,T)];
+log_N_jkt(emitting,:,:) = permute(reshape(log_N, num_of_mix, num_of_state-2, T), [2 1 3]);
 
 %% calculate alpha ( log(alpha), in fact), !!! notice alpha(1:state_NO, 1:T+1)
 for i = 2:num_of_state-1 % from state 1 (START) to END at time step 1
@@ -0,0 +1,79 @@
+function [mean_numerator, var_numerator, pool_denominator, wei_numerator, occupancy, aij_numerator, log_likelihood] = ...
+    forward_backward_tied_mixture(pool_mean, pool_var, aij, weight, obs)
+% Baum-Welch statistics of one utterance for a tied-mixture model (see
+% hmm_gmm_tied_mixture_training). The pool is evaluated once for all states with
+% the matrix product of forward_backward_hmm_gmm_log_math; the states then mix the
+% pool in the linear domain, scaled by the best pool Gaussian of every frame:
+%   b(j,t) = sum_p weight(j,p) N_p(o_t) = exp(m_t) * sum_p weight(j,p) exp(log N_p(o_t) - m_t)
+%
+% Outputs are sums over the frames:
+%   mean_numerator, var_numerator [DIM, pool] : sum of gamma_p(t) o_t, gamma_p(t) o_t.^2
+%   pool_denominator [1, pool]                : sum of gamma_p(t)
+%   wei_numerator [state, pool]               : sum of gamma_jp(t)
+%   occupancy [state, 1]                      : sum of gamma_j(t)
+%   aij_numerator [state, state]              : sum of xi_ij(t), emitting states only
+
+[dim, T] = size(obs);
+[num_of_state, pool_size] = size(weight);
+
+ivar = 1./pool_var;
+gconst = -1/2*(dim*log(2*pi) - sum(log(ivar), 1) + sum(pool_mean.*pool_mean.*ivar, 1));
+log_N = [-1/2*ivar; pool_mean.*ivar; gconst]' * [obs.*obs; obs; ones(1,T)];    % [pool, T]
+log_N_max = max(log_N, [], 1);
+N_scaled = exp(bsxfun(@minus, log_N, log_N_max));
+b_scaled = max(weight*N_scaled, realmin);                                       % [state, T]
+log_b = bsxfun(@plus, log(b_scaled), log_N_max);
+
+emitting = 2:num_of_state+1;
+log_a = log(aij(emitting, emitting));
+log_entry = log(aij(1, emitting))';
+log_exit = log(aij(emitting, end));
+
+log_alpha = -Inf(num_of_state, T);
+log_alpha(:,1) = log_entry + log_b(:,1);
+for t = 2:T
+    log_alpha(:,t) = log_sum_exp_columns(bsxfun(@plus, log_alpha(:,t-1), log_a))' + log_b(:,t);
+end
+log_beta = -Inf(num_of_state, T);
+log_beta(:,T) = log_exit;
+for t = (T-1):-1:1
+    log_beta(:,t) = log_sum_exp_columns(bsxfun(@plus, log_a, (log_b(:,t+1) + log_beta(:,t+1))')')';
+end
+log_likelihood = log_sum_exp_columns(log_alpha(:,T) + log_exit);
+
+if ~isfinite(log_likelihood)
+    % the utterance is shorter than the model: it contributes nothing
+    mean_numerator = zeros(dim, pool_size);
+    var_numerator = zeros(dim, pool_size);
+    pool_denominator = zeros(1, pool_size);
+    wei_numerator = zeros(num_of_state, pool_size);
+    occupancy = zeros(num_of_state, 1);
+    aij_numerator = zeros(num_of_state, num_of_state);
+    log_likelihood = 0;
+    return;
+end
+
+% gamma_jp(t) = gamma_j(t) weight(j,p) N_p(o_t) / b(j,t); the exp(m_t) cancel
+gamma = exp(log_alpha + log_beta - log_likelihood);
+G = gamma./b_scaled;
+occupancy = sum(gamma, 2);
+wei_numerator = weight.*(G*N_scaled');
+post = N_scaled.*(weight'*G);                                                   % gamma_p(t), [pool, T]
+pool_denominator = sum(post, 2)';
+mean_numerator = obs*post';
+var_numerator = (obs.*obs)*post';
+
+aij_numerator = zeros(num_of_state, num_of_state);
+for t = 1:T-1
+    aij_numerator = aij_numerator + exp(bsxfun(@plus, log_alpha(:,t), ...
+        bsxfun(@plus, log_a, (log_b(:,t+1) + log_beta(:,t+1))')) - log_likelihood);
+end
+end
+
+%%
+function s = log_sum_exp_columns(x)
+% log(sum(exp(x), 1)) without overflow; columns of -Inf give -Inf
+m = max(x, [], 1);
+m(~isfinite(m)) = 0;
+s = m + log(sum(exp(bsxfun(@minus, x, m)), 1));
+end
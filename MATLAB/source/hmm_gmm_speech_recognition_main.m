@@ -61,6 +61,17 @@ function hmm_gmm_speech_recognition_main()
 
     
     DIM = 39;                                       % dimension of the feature vector
+
+    % Optional PCA / LDA projection from CPP/tools/hmm_gmm_projection estimate;
+    % the models are then trained and evaluated in the projected dimension.
+    projection_file = '';
+    if ~isempty(projection_file)
+        fprintf('%s | Projecting the features with %s\n', datestr(now, 0), projection_file);
+        training_file_list_name = apply_feature_projection(projection_file, training_file_list_name, ...
+                                                           'trainingfile', '..\output\projected\train');
+        [testing_file_list_name, DIM] = apply_feature_projection(projection_file, testing_file_list_name, ...
+                                                                 'testingfile', '..\output\projected\test');
+    end
     [~, num_of_model] = size(keywords_list);        % number of models: 'marvin', 'off', 'on', 'up', 'down'
     num_of_hmm_states = 13;                         % Note: number of states does not including START and END node in HMM
     max_iterations = 30;
@@ -77,7 +88,29 @@ function hmm_gmm_speech_recognition_main()
                            output_likelihood_iter_path, output_log_likelihood_iter_path, hmm_model_output_dir);     % training phase
     
     fprintf('%s | Starting testing phase...\n\n', datestr(now, 0));
-    accuracy_rate = hmm_gmm_testing(HMM, testing_file_list_name, testing_output_dir, false);                        % testing phase
+    % Optional two-pass decoding: pre-score with a single-mixture checkpoint and rescore
+    % only the first_pass_top_k best models with the final model.
+    first_pass_model = '';                          % e.g. fullfile(hmm_model_output_dir, 'HMM_5.mat')
+    first_pass_top_k = 2;
+    % Optional frame skipping: score and search only every frame_skip-th frame (1, 2 or 3).
+    frame_skip = 1;
+    if isempty(first_pass_model)
+        accuracy_rate = hmm_gmm_testing(HMM, testing_file_list_name, testing_output_dir, false, [], first_pass_top_k, frame_skip); % testing phase
+    else
+        first_pass = load(first_pass_model, 'HMM');
+        accuracy_rate = hmm_gmm_testing(HMM, testing_file_list_name, testing_output_dir, false, first_pass.HMM, first_pass_top_k, frame_skip);
+    end
     fprintf('accuracy_rate: %f\n', accuracy_rate);
     save(fullfile(testing_output_dir, 'accuracy_rate.mat'), 'accuracy_rate');
+
+    % Optional tied-mixture models: one pool of tied_mixture_pool_size Gaussians shared by
+    % all states of all keywords, trained and tested next to the continuous models.
+    tied_mixture_pool_size = 0;                     % e.g. 256
+    if tied_mixture_pool_size > 0
+        fprintf('%s | Starting tied-mixture training phase...\n\n', datestr(now, 0));
+        HMM_tied = hmm_gmm_tied_mixture_training(training_file_list_name, DIM, num_of_model, num_of_hmm_states, ...
+                                                 tied_mixture_pool_size, 10, fullfile(hmm_model_output_dir, 'tied'));
+        tied_accuracy_rate = hmm_gmm_testing(HMM_tied, testing_file_list_name, fullfile(testing_output_dir, 'tied'), false);
+        fprintf('tied-mixture accuracy_rate: %f\n', tied_accuracy_rate);
+    end
 end
\ No newline at end of file
@@ -1,12 +1,28 @@
-function accuracy_rate = hmm_gmm_testing(HMM, testing_file_list, testing_output_dir, save_test_results)
+%% Optional two-pass decoding: every model is first scored with HMM_first_pass (a cheaper
+%% model of the same topology, e.g. the single-mixture HMM_5.mat) and only the top_k
+%% models (default 2) are rescored with HMM.
+%% Optional frame skipping: only every frame_skip-th frame (1, 2 or 3; default 1) is scored
+%% and searched, and the search jumps over the skipped frames with aij^frame_skip.
+function accuracy_rate = hmm_gmm_testing(HMM, testing_file_list, testing_output_dir, save_test_results, HMM_first_pass, top_k, frame_skip)
 
+    if nargin < 5
+        HMM_first_pass = [];                                    % defined for the parfor body
+    end
+    two_pass = ~isempty(HMM_first_pass);
+    if nargin < 6
+        top_k = 2;
+    end
+    if nargin < 7
+        frame_skip = 1;
+    end
     if ~exist(testing_output_dir, 'dir')
         mkdir(testing_output_dir);
     end
 
-    [~, ~, ~, num_of_model] = size(HMM.mean);
+    num_of_model = size(HMM.Aij, 3);
     num_of_error = 0;
     num_of_testing = 0;
+    num_of_rescored = 0;
 
     load (testing_file_list, 'testingfile');
     num_of_uter = size(testingfile,1);
@@ -25,12 +41,26 @@ function accuracy_rate = hmm_gmm_testing(HMM, testing_file_list, testing_output_
             
             features = fread(mfcfile, [dim, nSamples], 'float');
             fclose(mfcfile);
+            features = features(:, 1:frame_skip:end);                  % the frames searched
             
             num_of_testing = num_of_testing + 1;
             % predict which the digit is.......
             fopt_max = -Inf; digit = -1;
-            for p = 1:num_of_model
-                fopt = hmm_gmm_viterbi_decoding_algorithm(HMM.mean(:,:,:,p), HMM.var(:,:,:,p), HMM.weight(:,:,p), HMM.Aij(:,:,p), features, filename, save_test_results); % model k_th
+            candidates = 1:num_of_model;
+            if two_pass
+                log_b = hmm_gmm_emission_matrix(HMM_first_pass, features, candidates);
+                fopt_first = -Inf(1, num_of_model);
+                for p = 1:num_of_model
+                    fopt_first(p) = hmm_gmm_viterbi_decoding_algorithm(log_b(:,:,p), HMM_first_pass.Aij(:,:,p), filename, false, frame_skip);
+                end
+                [~, order] = sort(fopt_first, 'descend');                  % stable: ties keep the lower model id
+                candidates = sort(order(1:min(top_k, num_of_model)));     % model order, so ties are resolved as before
+            end
+            num_of_rescored = num_of_rescored + numel(candidates);
+            log_b = hmm_gmm_emission_matrix(HMM, features, candidates);    % every emission of every candidate, once per utterance
+            for c = 1:numel(candidates)
+                p = candidates(c);
+                fopt = hmm_gmm_viterbi_decoding_algorithm(log_b(:,:,c), HMM.Aij(:,:,p), filename, save_test_results, frame_skip); % model k_th
                 if fopt > fopt_max
                     digit = p;
                     fopt_max = fopt;
@@ -48,46 +78,112 @@ function accuracy_rate = hmm_gmm_testing(HMM, testing_file_list, testing_output_
     t = datestr(now,'mmmm dd, yyyy HH:MM:SS.FFF AM');
     fprintf(fileID,'\n============================================================\n');
     fprintf(fileID,'%s\t\taccuracy rate: %f', t, accuracy_rate);
+    if frame_skip > 1
+        fprintf(fileID,'\tframe skip: %d', frame_skip);
+    end
+    if two_pass
+        pruning_ratio = 1 - num_of_rescored / (num_of_testing * num_of_model);
+        fprintf('two-pass decoding: %d of %d models rescored, pruning ratio %f\n', num_of_rescored, num_of_testing * num_of_model, pruning_ratio);
+        fprintf(fileID,'\ttwo-pass top_k %d, pruning ratio: %f', top_k, pruning_ratio);
+    end
     fclose(fileID);
 end
 
-function fopt = hmm_gmm_viterbi_decoding_algorithm(mean, var, weight, aij, obs, filename, save_test_results)
+%% log b_j(o_t) of every emitting state of the given models: log_b(j, t, c) for model
+%% models(c), j = 1..num_of_state (START and END excluded). Computed once per utterance
+%% and shared by the Viterbi recursion of all models; the Gaussians are one matrix
+%% product as in forward_backward_hmm_gmm_log_math.m, the mixtures are combined with
+%% the max trick. Tied-mixture models (hmm_gmm_tied_mixture_training.m) evaluate their
+%% pool once and mix it with the state weights.
+function log_b = hmm_gmm_emission_matrix(HMM, obs, models)
+    [dim, T] = size(obs);
+    if isfield(HMM, 'pool_mean')
+        ivar = 1./HMM.pool_var;
+        gconst = -1/2*(dim*log(2*pi) - sum(log(ivar), 1) + sum(HMM.pool_mean.*HMM.pool_mean.*ivar, 1));
+        log_N = [-1/2*ivar; HMM.pool_mean.*ivar; gconst]' * [obs.*obs; obs; ones(1,T)];
+        log_N_max = max(log_N, [], 1);
+        N_scaled = exp(log_N - log_N_max);
+        log_b = zeros(size(HMM.weight, 1), T, numel(models));
+        for c = 1:numel(models)
+            log_b(:,:,c) = log(max(HMM.weight(:,:,models(c))*N_scaled, realmin)) + log_N_max;
+        end
+        return;
+    end
+    [~, num_of_mix, num_of_state, ~] = size(HMM.mean);
+    num_of_model = numel(models);
+    ivar = 1./reshape(HMM.var(:,:,:,models), dim, []);     % column g = k + num_of_mix*((j-1) + num_of_state*(c-1))
+    mu = reshape(HMM.mean(:,:,:,models), dim, []);
+    gconst = -1/2*(dim*log(2*pi) - sum(log(ivar), 1) + sum(mu.*mu.*ivar, 1));
+    log_c = reshape(permute(log(HMM.weight(:,:,models)), [2 1 3]), 1, []);   % same column order as ivar
+    y = ([-1/2*ivar; mu.*ivar; gconst + log_c]' * [obs.*obs; obs; ones(1,T)]);
+    y = reshape(y, num_of_mix, num_of_state*num_of_model*T);
+    ymax = max(y, [], 1);
+    finite = isfinite(ymax);
+    log_b = ymax;
+    log_b(finite) = ymax(finite) + log(sum(exp(y(:,finite) - ymax(finite)), 1));
+    log_b = permute(reshape(log_b, num_of_state, num_of_model, T), [1 3 2]);
+end
+
+%% Viterbi search over the emitting states of one model. Only two rows of scores are kept;
+%% the best predecessor of every state and frame (psi, uint8, 1 = START, 0 = no path) is
+%% stored only when save_test_results asks for the best path, which is then recovered by
+%% traceback from iopt. Score-only decoding stores no backpointers. Only the nonzero
+%% transitions are visited, and states outside the feasible band of the frame (see
+%% hmm_gmm_sparse_topology) are skipped without reading their emission.
+%% log_b holds every frame_skip-th frame; the search moves between them with
+%% aij^frame_skip, and each emission is weighted by frame_skip to stand for the
+%% frames skipped after it.
+function fopt = hmm_gmm_viterbi_decoding_algorithm(log_b, aij, filename, save_test_results, frame_skip)
     aij = cat(3,aij,aij*aij,aij*aij*aij);                       % in case frame loss
-    [DIM, T] = size(obs);                                       % T: length of observations or number of observation frames
-    [~, num_of_mix, num_of_state, ~] = size(mean);              % num_of_state: NOT including START and END states (nodes) in HMM
+    if frame_skip > size(aij, 3)
+        error('hmm_gmm_viterbi_decoding_algorithm: frame_skip %d, at most %d', frame_skip, size(aij, 3));
+    end
+    [num_of_state, T] = size(log_b);                            % num_of_state: NOT including START and END states (nodes) in HMM
     num_of_state = num_of_state + 2;                            % number of states, including START and END states (nodes) in HMM
-    mean_temp = NaN(DIM, num_of_mix, num_of_state);
-    var_temp = NaN(DIM, num_of_mix, num_of_state);
-    for i = 1:num_of_state-2
-        mean_temp(:,:,i+1) = mean(:,:,i);
-        var_temp(:,:,i+1) = var(:,:,i);
-    end
-    mean = mean_temp; var = var_temp;                           % insert value NaN for the state START and END
-    weight = [NaN(1,num_of_mix); weight; NaN(1,num_of_mix)];
+    log_b = [NaN(1,T); frame_skip*log_b; NaN(1,T)];             % insert value NaN for the state START and END
     aij(end,end) = 1;
-    timing = 1:T+1;
-    num_of_state = size(mean, 3);
-    fjt = -Inf(num_of_state, T);
-    s_chain = cell(num_of_state, T);
+    timing = [1+frame_skip*(0:T-1), frame_skip*(T-1)+2];        % the frames searched, END one step after the last
+    a_step = aij(:,:,frame_skip);                               % moves between searched frames,
+    a_step(1,:) = aij(1,:,1);                                   % entry and exit in one step
+    a_step(:,end) = aij(:,end,1);
+    [pred, earliest, to_end] = hmm_gmm_sparse_topology(a_step);
+    f_prev = -Inf(num_of_state, 1);                             % fjt(:, t-1)
+    if save_test_results
+        if num_of_state > intmax('uint8')
+            error('hmm_gmm_viterbi_decoding_algorithm: more than %d states', intmax('uint8'));
+        end
+        fjt = -Inf(num_of_state, T);
+        psi = zeros(num_of_state, T, 'uint8');
+    end
     
     %%%%%% at t = 1
     dt = timing(1);
     for j=2:num_of_state-1 % 2->14
-        fjt(j,1) = log(aij(1,j,dt)) + log_hmm_gmm(mean(:,:,j),var(:,:,j),weight(j,:), obs(:,1));
-        if fjt(j,1) > -Inf
-            s_chain{j,1} = [1 j];
+        if earliest(j) > 1 || to_end(j) > T-1
+            continue;
+        end
+        f_prev(j) = log(aij(1,j,dt)) + log_b(j,1);
+        if save_test_results && f_prev(j) > -Inf
+            psi(j,1) = 1;
         end
     end
+    if save_test_results
+        fjt(:,1) = f_prev;
+    end
     
     for t=2:T
         dt = timing(t)-timing(t-1); % in case frame loss and dt = 2, 3, 4,...
+        f_cur = -Inf(num_of_state, 1);
         for j=2:num_of_state-1 %(2->14)
+            if earliest(j) > t || to_end(j) > T-t               % no complete path through j at t
+                continue;
+            end
             f_max = -Inf;
             i_max = -1;
             f = -Inf;
-            for i=2:j
-                if(fjt(i,t-1) > -Inf)
-                    f = fjt(i,t-1) + log(aij(i,j,dt)) + log_hmm_gmm(mean(:,:,j),var(:,:,j),weight(j,:), obs(:,t));
+            for i=pred{j}
+                if(f_prev(i) > -Inf)
+                    f = f_prev(i) + log(aij(i,j,dt)) + log_b(j,t);
                 end
                 if f > f_max % finding the f max
                     f_max = f;
@@ -95,17 +191,23 @@ function fopt = hmm_gmm_viterbi_decoding_algorithm(mean, var, weight, aij, obs,
                 end
             end
             if i_max ~= -1
-                s_chain{j,t} = [s_chain{i_max,t-1} j];
-                fjt(j,t) = f_max;
+                f_cur(j) = f_max;
+                if save_test_results
+                    psi(j,t) = i_max;
+                end
             end
         end
+        f_prev = f_cur;
+        if save_test_results
+            fjt(:,t) = f_cur;
+        end
     end
     %%%%%% at t = end
     dt = timing(end) - timing(end - 1); % in case frame loss and dt = 2, 3, 4,...
     fopt = -Inf;
     iopt = -1;
     for i=2:num_of_state-1
-        f = fjt(i, T) + log(aij(i, num_of_state, dt));
+        f = f_prev(i) + log(aij(i, num_of_state, dt));
         if f > fopt
             fopt = f;
             iopt = i;
@@ -113,43 +215,49 @@ function fopt = hmm_gmm_viterbi_decoding_algorithm(mean, var, weight, aij, obs,
     end
 
     if save_test_results
+        % best path: START, then the state of every frame
+        s_opt = [];
+        if iopt ~= -1
+            s_opt = zeros(1, T+1);
+            s_opt(T+1) = iopt;
+            for t = T:-1:1
+                s_opt(t) = psi(s_opt(t+1), t);
+            end
+        end
         [pathstr, filename, ext] = fileparts(filename);
         save(fullfile('..\output\testing_results', sprintf('fjt_%s.mat', filename)), 'fjt');
         save(fullfile('..\output\testing_results', sprintf('fopt_%s.mat', filename)), 'fopt');
-        save(fullfile('..\output\testing_results', sprintf('s_chain_%s.mat', filename)), 's_chain');
+        save(fullfile('..\output\testing_results', sprintf('s_opt_%s.mat', filename)), 's_opt', 'psi');
         save(fullfile('..\output\testing_results', sprintf('iopt_%s.mat', filename)), 'iopt');
     end
 end
 
-%% this function is for the case of multiple Gaussian HMM
-function log_b = log_hmm_gmm(mean_i, var_i, c_j, o_i)
-    [dim, num_of_mix] = size(mean_i);
-    log_N = -Inf(1,num_of_mix);
-    log_c = -Inf(1,num_of_mix);
-    for m = 1:num_of_mix
-        log_N(m) = -1/2*(dim*log(2*pi) + sum(log(var_i(:,m))) + sum((o_i - mean_i(:,m)).*(o_i - mean_i(:,m))./var_i(:,m)));
-        log_c(m) = log(c_j(m));
-    end
-    y = -Inf(1,num_of_mix);
-    ymax = -Inf;
-    for m = 1:num_of_mix
-        y(m) = log_N(m) + log_c(m);
-        if y(m) > ymax
-            ymax = y(m);
+%% Predecessor lists of the emitting nodes 2..num_of_state-1 (forward moves i <= j with
+%% aij > 0, in increasing order) and their feasible band: earliest(j) is the first frame a
+%% path can be in node j, to_end(j) the fewest frames that must follow before the path can
+%% leave to END (Inf: never). For the strict left-to-right models of hmm_gmm_training.m,
+%% node j is feasible at frame t of T for max(1, N-(T-t)) <= j-1 <= min(t, N).
+function [pred, earliest, to_end] = hmm_gmm_sparse_topology(aij)
+    num_of_state = size(aij, 1);
+    pred = cell(num_of_state, 1);
+    earliest = Inf(num_of_state, 1);
+    to_end = Inf(num_of_state, 1);
+    for j = 2:num_of_state-1
+        pred{j} = 1 + find(aij(2:j, j) > 0)';
+        if aij(1, j) > 0
+            earliest(j) = 1;
+        end
+        for i = pred{j}(pred{j} < j)
+            earliest(j) = min(earliest(j), earliest(i) + 1);
         end
     end
-    if ymax == Inf
-        log_b = Inf;
-    else
-        sum_exp = 0;
-        for m = 1:num_of_mix
-            if ymax == -Inf && y(m) == -Inf
-                sum_exp = sum_exp + 1;
-            else
-                sum_exp = sum_exp + exp(y(m) - ymax);
-            end
+    for j = num_of_state-1:-1:2
+        if aij(j, num_of_state) > 0
+            to_end(j) = 0;
+        end
+        for i = pred{j}(pred{j} < j)
+            to_end(i) = min(to_end(i), to_end(j) + 1);
         end
-        log_b = ymax + log(sum_exp);
     end
 end
     
\ No newline at end of file
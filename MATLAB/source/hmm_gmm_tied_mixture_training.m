@@ -0,0 +1,189 @@
+function HMM = hmm_gmm_tied_mixture_training(training_file_list, DIM, num_of_model, num_of_state, pool_size, ...
+    max_iterations, hmm_model_output_dir)
+
+    % Tied-mixture (semi-continuous) counterpart of hmm_gmm_training: all states of all
+    % models share one pool of pool_size diagonal Gaussians and keep only their own
+    % weights over it.
+    %
+    %   HMM.pool_mean [DIM, pool_size]
+    %   HMM.pool_var  [DIM, pool_size]
+    %   HMM.weight    [num_of_state, pool_size, num_of_model]
+    %   HMM.Aij       [num_of_state+2, num_of_state+2, num_of_model]
+    %
+    % The pool is initialised by k-means over all training frames, the weights by a
+    % uniform segmentation of every utterance into the states of its model; then
+    % max_iterations Baum-Welch re-estimations follow, with the pool statistics summed
+    % over all states of all models. HMM_tied_<iter>.mat is saved after every
+    % iteration; hmm_gmm_testing and CPP/tools/hmm_gmm_tied_mixture decode it.
+
+    if exist(hmm_model_output_dir, 'dir')
+        fprintf('%s | Removing existing models directory...\n', datestr(now, 0));
+        rmdir(hmm_model_output_dir, 's');
+    end
+    mkdir(hmm_model_output_dir);
+
+    load (training_file_list, 'trainingfile');
+    [features, model_ids] = load_training_features(trainingfile, DIM);
+
+    % variances are floored at 1 % of the global variance of the training frames
+    all_features = [features{:}];
+    var_floor = 0.01*var(all_features, 1, 2);
+    clear all_features
+
+    HMM = initialize_tied_mixture_model(features, model_ids, num_of_model, num_of_state, pool_size, var_floor);
+    save_tied_mixture_model_to_file(HMM, hmm_model_output_dir, 0);
+
+    for iter = 1:max_iterations
+        fprintf('%s | Starting tied-mixture training iteration %d\n', datestr(now, 0), iter);
+        [HMM, log_likelihood] = tied_mixture_baum_welch_algorithm(HMM, features, model_ids, var_floor);
+        fprintf('%s | log likelihood %f\n', datestr(now, 0), log_likelihood);
+        save_tied_mixture_model_to_file(HMM, hmm_model_output_dir, iter);
+    end
+    fprintf('%s | Tied-mixture training phase complete !!\n', datestr(now, 0));
+end
+
+%%
+function [features, model_ids] = load_training_features(trainingfile, DIM)
+    num_of_uter = size(trainingfile,1);
+    features = cell(num_of_uter, 1);
+    model_ids = zeros(num_of_uter, 1);
+    for u = 1:num_of_uter
+        model_ids(u) = trainingfile{u,1};
+        features{u} = zeros(DIM, 0);
+        mfcfile = fopen(trainingfile{u,2}, 'r', 'b');
+        if mfcfile ~= -1
+            nSamples = fread(mfcfile, 1, 'int32');
+            sampPeriod = fread(mfcfile, 1, 'int32')*1E-7;
+            sampSize = fread(mfcfile, 1, 'int16');
+            dim = 0.25*sampSize;
+            parmKind = fread(mfcfile, 1, 'int16');
+            features{u} = fread(mfcfile, [dim, nSamples], 'float');
+            fclose(mfcfile);
+        end
+    end
+end
+
+
+function HMM = initialize_tied_mixture_model(features, model_ids, num_of_model, num_of_state, pool_size, var_floor)
+    all_features = [features{:}];
+    num_of_frame = size(all_features, 2);
+    global_var = var(all_features, 1, 2);
+
+    % k-means in the metric of the global variances; the centres start at evenly
+    % spaced frames so that the result does not depend on a random seed
+    centres = all_features(:, round(linspace(1, num_of_frame, pool_size)));
+    scale = 1./global_var;
+    for iter = 1:10
+        assignment = nearest_centre(all_features, centres, scale);
+        for p = 1:pool_size
+            members = (assignment == p);
+            if any(members)
+                centres(:,p) = mean(all_features(:,members), 2);
+            end
+        end
+    end
+    assignment = nearest_centre(all_features, centres, scale);
+
+    HMM.pool_mean = centres;
+    HMM.pool_var = repmat(global_var, 1, pool_size);
+    for p = 1:pool_size
+        members = (assignment == p);
+        if any(members)
+            HMM.pool_var(:,p) = max(var(all_features(:,members), 1, 2), var_floor);
+        end
+    end
+
+    % every utterance is cut into num_of_state equal segments; a state starts with the
+    % histogram of the pool Gaussians its frames were assigned to
+    HMM.weight = zeros(num_of_state, pool_size, num_of_model);
+    first = 1;
+    for u = 1:numel(features)
+        T = size(features{u}, 2);
+        state = floor((0:T-1)*num_of_state/T) + 1;
+        p = assignment(first:first+T-1);
+        HMM.weight(:,:,model_ids(u)) = HMM.weight(:,:,model_ids(u)) + accumarray([state(:) p(:)], 1, [num_of_state pool_size]);
+        first = first + T;
+    end
+    HMM.weight = normalise_weights(HMM.weight);
+
+    HMM.Aij = zeros(num_of_state+2, num_of_state+2, num_of_model);
+    for k = 1:num_of_model
+        for i = 2:num_of_state+1
+            HMM.Aij(i,i+1,k) = 0.4;
+            HMM.Aij(i,i,k) = 1-HMM.Aij(i,i+1,k);
+        end
+        HMM.Aij(1,2,k) = 1;
+    end
+end
+
+
+function assignment = nearest_centre(x, centres, scale)
+    % processed in chunks of frames to bound the distance matrix
+    assignment = zeros(1, size(x,2));
+    weighted = bsxfun(@times, centres, scale);
+    norms = sum(centres.*weighted, 1)';
+    for first = 1:4096:size(x,2)
+        last = min(first+4095, size(x,2));
+        distance = bsxfun(@minus, norms, 2*(weighted'*x(:,first:last)));
+        [~, assignment(first:last)] = min(distance, [], 1);
+    end
+end
+
+
+function weight = normalise_weights(weight)
+    % a floor keeps every pool Gaussian reachable from every state
+    weight = max(weight, 1e-5);
+    weight = bsxfun(@rdivide, weight, sum(weight, 2));
+end
+
+
+function save_tied_mixture_model_to_file(HMM, hmm_model_output_dir, iter)
+    hmm_output_file = sprintf('HMM_tied_%d.mat', iter);
+    save(fullfile(hmm_model_output_dir, hmm_output_file), 'HMM');
+end
+
+
+function [HMM, log_likelihood] = tied_mixture_baum_welch_algorithm(HMM, features, model_ids, var_floor)
+    [DIM, pool_size] = size(HMM.pool_mean);
+    [num_of_state, ~, num_of_model] = size(HMM.weight);
+    sum_mean_numerator = zeros(DIM, pool_size);
+    sum_var_numerator = zeros(DIM, pool_size);
+    sum_pool_denominator = zeros(1, pool_size);
+    sum_wei_numerator = zeros(num_of_state, pool_size, num_of_model);
+    sum_occupancy = zeros(num_of_state, num_of_model);
+    sum_aij_numerator = zeros(num_of_state, num_of_state, num_of_model);
+    log_likelihood = 0;
+
+    for u = 1:numel(features)
+        k = model_ids(u);
+        [mean_numerator, var_numerator, pool_denominator, wei_numerator, occupancy, aij_numerator, log_likelihood_i] = ...
+            forward_backward_tied_mixture(HMM.pool_mean, HMM.pool_var, HMM.Aij(:,:,k), HMM.weight(:,:,k), features{u});
+        sum_mean_numerator = sum_mean_numerator + mean_numerator;
+        sum_var_numerator = sum_var_numerator + var_numerator;
+        sum_pool_denominator = sum_pool_denominator + pool_denominator;
+        sum_wei_numerator(:,:,k) = sum_wei_numerator(:,:,k) + wei_numerator;
+        sum_occupancy(:,k) = sum_occupancy(:,k) + occupancy;
+        sum_aij_numerator(:,:,k) = sum_aij_numerator(:,:,k) + aij_numerator;
+        log_likelihood = log_likelihood + log_likelihood_i;
+    end
+
+    % pool Gaussians no frame was assigned to keep their parameters
+    for p = find(sum_pool_denominator > 1e-3)
+        HMM.pool_mean(:,p) = sum_mean_numerator(:,p) / sum_pool_denominator(p);
+        HMM.pool_var(:,p) = max(sum_var_numerator(:,p) / sum_pool_denominator(p) - HMM.pool_mean(:,p).^2, var_floor);
+    end
+    for k = 1:num_of_model
+        for n = 1:num_of_state
+            if sum_occupancy(n,k) > 0
+                HMM.weight(n,:,k) = sum_wei_numerator(n,:,k) / sum_occupancy(n,k);
+            end
+        end
+        for i = 2:num_of_state+1
+            if sum_occupancy(i-1,k) > 0
+                HMM.Aij(i,2:num_of_state+1,k) = sum_aij_numerator(i-1,:,k) / sum_occupancy(i-1,k);
+            end
+        end
+        HMM.Aij(num_of_state+1,num_of_state+2,k) = 1 - HMM.Aij(num_of_state+1,num_of_state+1,k);
+    end
+    HMM.weight = normalise_weights(HMM.weight);
+end
@@ -0,0 +1,52 @@
+function corpus = read_feature_corpus(filename)
+    % Reads the manifest of a packed feature corpus written by CPP/tools/hmm_gmm_corpus
+    % and maps the feature data with memmapfile, so no per-utterance fopen or byte
+    % swapping is needed. Layout: CPP/include/hmm_gmm/feature_corpus.hpp.
+    %
+    % corpus.label(u), corpus.id{u}, corpus.frame_no(u): manifest of utterance u
+    % feature_corpus_utterance(corpus, u): [dim, frame_no] features of utterance u
+
+    fid = fopen(filename, 'r', 'l');
+    if fid == -1
+        error('read_feature_corpus: cannot open %s', filename);
+    end
+    magic = fread(fid, [1 8], 'char=>char');
+    if ~strcmp(magic, 'HMMGFEAT')
+        fclose(fid);
+        error('read_feature_corpus: %s is not a feature corpus', filename);
+    end
+    version = fread(fid, 1, 'uint32');
+    corpus.dim = fread(fid, 1, 'uint32');
+    num_of_uter = fread(fid, 1, 'uint64');
+    manifest_offset = fread(fid, 1, 'uint64');
+    fread(fid, 1, 'uint64');                            % manifest size
+    corpus.samp_period = fread(fid, 1, 'int32')*1E-7;
+    corpus.parm_kind = fread(fid, 1, 'uint16');
+    if version ~= 1
+        fclose(fid);
+        error('read_feature_corpus: unsupported version %d', version);
+    end
+
+    % manifest records: u64 data_offset, u32 frame_no, i32 label, u32 id_offset, u32 id_length, 8 reserved bytes
+    fseek(fid, manifest_offset, 'bof');
+    records = fread(fid, [32, num_of_uter], 'uint8=>uint8');
+    ids = fread(fid, Inf, 'char=>char')';
+    fclose(fid);
+
+    corpus.first = zeros(num_of_uter, 1);               % 1-based index of the first value in corpus.data.Data
+    corpus.frame_no = zeros(num_of_uter, 1);
+    corpus.label = zeros(num_of_uter, 1);
+    corpus.id = cell(num_of_uter, 1);
+    for u = 1:num_of_uter
+        r = records(:, u);
+        corpus.first(u) = double(typecast(r(1:8), 'uint64'))/4 + 1;
+        corpus.frame_no(u) = double(typecast(r(9:12), 'uint32'));
+        corpus.label(u) = double(typecast(r(13:16), 'int32'));
+        id_offset = double(typecast(r(17:20), 'uint32'));
+        id_length = double(typecast(r(21:24), 'uint32'));
+        corpus.id{u} = ids(id_offset+1 : id_offset+id_length);
+    end
+
+    % the file is padded to 64 bytes, so it maps as one float32 array
+    corpus.data = memmapfile(filename, 'Format', 'single');
+end
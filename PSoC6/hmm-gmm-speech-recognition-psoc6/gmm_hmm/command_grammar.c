@@ -0,0 +1,351 @@
+/******************************************************************************
+* File Name:   command_grammar.c
+*
+* Description: Composite wakeword / command grammar, see command_grammar.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#include "command_grammar.h"
+
+#include <math.h>
+#include <stddef.h>
+
+/***************************Macro Declarations*******************************/
+#define UNREACHABLE             (0xFFFFu)
+
+/****************************************************************************/
+
+/**************************Function Declarations*****************************/
+static void no_words(command_grammar_words_t *words);
+/****************************************************************************/
+
+
+void command_grammar_wakeword_config(command_grammar_config_t *config, uint8_t wakeword, uint8_t silence,
+                                     const uint8_t *commands, uint32_t command_no)
+{
+    uint32_t s = 0u;
+    uint32_t i;
+
+    config->models[s][0] = wakeword;
+    config->model_no[s] = 1u;
+    config->optional[s] = false;
+    s++;
+    if (silence != COMMAND_GRAMMAR_NO_WORD)
+    {
+        config->models[s][0] = silence;
+        config->model_no[s] = 1u;
+        config->optional[s] = true;
+        s++;
+    }
+    for (i = 0u; (i < command_no) && (i < COMMAND_GRAMMAR_MAX_NODES); i++)
+    {
+        config->models[s][i] = commands[i];
+    }
+    config->model_no[s] = command_no;
+    config->optional[s] = false;
+    config->slot_no = s + 1u;
+    config->beam = COMMAND_GRAMMAR_DEFAULT_BEAM;
+}
+
+
+/*******************************************************************************
+* Function Name: command_grammar_init
+********************************************************************************
+* Summary:
+*  Lays the models of the slots out as nodes and derives from each model's
+*  transitions the fewest frames from a state to its END (to_end) and, per
+*  slot, the fewest frames the required slots after it need (tail), the
+*  shortest word of a slot being min over exit states of earliest + 1.
+*
+* Parameters:
+*  grammar: receives the network
+*  model:   opened image
+*  config:  slots and beam
+*
+* Return:
+*  false if the grammar does not fit the macros or the image
+*
+*******************************************************************************/
+bool command_grammar_init(command_grammar_t *grammar, const compiled_model_t *model,
+                          const command_grammar_config_t *config)
+{
+    const uint32_t n = model->state_no;
+    const uint32_t node_no = n + 2u;
+    uint16_t shortest[COMMAND_GRAMMAR_MAX_SLOTS];
+    bool required = false;
+    uint32_t s;
+    uint32_t m;
+    uint32_t i;
+    uint32_t j;
+
+    if ((config->slot_no == 0u) || (config->slot_no > COMMAND_GRAMMAR_MAX_SLOTS) ||
+        (n > COMMAND_GRAMMAR_MAX_STATES) || (model->stride > COMMAND_GRAMMAR_MAX_STRIDE))
+    {
+        return false;
+    }
+    grammar->model = model;
+    grammar->config = *config;
+    grammar->node_no = 0u;
+    for (s = 0u; s < config->slot_no; s++)
+    {
+        if ((config->model_no[s] == 0u) || (grammar->node_no + config->model_no[s] > COMMAND_GRAMMAR_MAX_NODES))
+        {
+            return false;
+        }
+        required = required || !config->optional[s];
+        shortest[s] = UNREACHABLE;
+        for (m = 0u; m < config->model_no[s]; m++)
+        {
+            const uint32_t v = grammar->node_no;
+            const uint32_t k = config->models[s][m];
+            const float *a;
+            uint16_t earliest[COMMAND_GRAMMAR_MAX_STATES];
+
+            if (k >= model->model_no)
+            {
+                return false;
+            }
+            a = compiled_model_log_transitions(model, k);
+            grammar->node_slot[v] = (uint8_t)s;
+            grammar->node_model[v] = (uint8_t)k;
+            for (j = 0u; j < n; j++)
+            {
+                earliest[j] = isinf(a[j + 1u]) ? UNREACHABLE : 0u;
+                for (i = 0u; i < j; i++)
+                {
+                    if (!isinf(a[(i + 1u) * node_no + j + 1u]) && (earliest[i] != UNREACHABLE) &&
+                        (earliest[i] + 1u < earliest[j]))
+                    {
+                        earliest[j] = (uint16_t)(earliest[i] + 1u);
+                    }
+                }
+            }
+            for (j = n; j-- > 0u;)
+            {
+                grammar->to_end[v][j] = isinf(a[(j + 1u) * node_no + n + 1u]) ? UNREACHABLE : 0u;
+                for (i = j + 1u; i < n; i++)
+                {
+                    if (!isinf(a[(j + 1u) * node_no + i + 1u]) && (grammar->to_end[v][i] != UNREACHABLE) &&
+                        (grammar->to_end[v][i] + 1u < grammar->to_end[v][j]))
+                    {
+                        grammar->to_end[v][j] = (uint16_t)(grammar->to_end[v][i] + 1u);
+                    }
+                }
+                if ((grammar->to_end[v][j] == 0u) && (earliest[j] != UNREACHABLE) && (earliest[j] + 1u < shortest[s]))
+                {
+                    shortest[s] = (uint16_t)(earliest[j] + 1u);
+                }
+            }
+            grammar->node_no++;
+        }
+    }
+    if (!required)
+    {
+        return false;
+    }
+    grammar->tail[config->slot_no - 1u] = 0u;
+    for (s = config->slot_no - 1u; s-- > 0u;)
+    {
+        const bool passed = config->optional[s + 1u] || (shortest[s + 1u] == UNREACHABLE);
+        grammar->tail[s] = (uint16_t)(grammar->tail[s + 1u] + (passed ? 0u : shortest[s + 1u]));
+    }
+    command_grammar_reset(grammar, 0u);
+    return true;
+}
+
+
+void command_grammar_reset(command_grammar_t *grammar, uint32_t frame_no)
+{
+    uint32_t s;
+
+    for (s = 0u; s < grammar->config.slot_no; s++)
+    {
+        /* X_s before the first frame: START, passed over the leading optional slots */
+        grammar->exit[0][s] = ((s == 0u) || (grammar->exit[0][s - 1u] == 0.0f)) && grammar->config.optional[s]
+                              ? 0.0f : -INFINITY;
+        no_words(&grammar->exit_words[0][s]);
+    }
+    grammar->row = 0u;
+    grammar->frame = 0u;
+    grammar->frame_no = frame_no;
+}
+
+
+/*******************************************************************************
+* Function Name: command_grammar_push
+********************************************************************************
+* Summary:
+*  One frame of token passing. Inside a word f_j(t) = max_{i <= j} f_i(t-1)
+*  + log aij + log b_j(o_t); a state may also be entered from the exit of the
+*  slot before it at the previous frame (the START of the network at the
+*  first frame) with log a_START,j, and the token then records the word and
+*  frame of that slot. With a known utterance length a state is searched only
+*  if to_end + tail fits into the remaining frames. States and exits below
+*  the best state minus the beam are dropped. The exit of a slot is its best
+*  END, or the exit of the slot before it if the slot is optional.
+*
+* Parameters:
+*  grammar: initialised grammar
+*  frame:   model->dim floats
+*
+*******************************************************************************/
+void command_grammar_push(command_grammar_t *grammar, const float *frame)
+{
+    const compiled_model_t *model = grammar->model;
+    const command_grammar_config_t *config = &grammar->config;
+    const uint32_t n = model->state_no;
+    const uint32_t node_no = n + 2u;
+    const uint32_t from = grammar->row;
+    const uint32_t to = grammar->row ^ 1u;
+    const uint32_t remaining = ((grammar->frame_no > grammar->frame) ? grammar->frame_no - 1u - grammar->frame
+                                                                     : 0u);
+    const float *prev = grammar->score[from];
+    float *cur = grammar->score[to];
+    command_grammar_words_t entry_words;
+    float best = -INFINITY;
+    float threshold;
+    uint32_t v;
+    uint32_t s;
+    uint32_t i;
+    uint32_t j;
+
+    compiled_model_prepare_frame(model, frame, grammar->x);
+    no_words(&entry_words);
+    for (v = 0u; v < grammar->node_no; v++)
+    {
+        const uint32_t slot = grammar->node_slot[v];
+        const uint32_t k = grammar->node_model[v];
+        const float *a = compiled_model_log_transitions(model, k);
+        const float entry = (slot > 0u) ? grammar->exit[from][slot - 1u] : ((grammar->frame == 0u) ? 0.0f : -INFINITY);
+        const command_grammar_words_t *entry_from = (slot > 0u) ? &grammar->exit_words[from][slot - 1u] : &entry_words;
+
+        for (j = 0u; j < n; j++)
+        {
+            const uint32_t state = v * COMMAND_GRAMMAR_MAX_STATES + j;
+            const command_grammar_words_t *source = NULL;
+            float value = -INFINITY;
+            bool entered = false;
+
+            cur[state] = -INFINITY;
+            if ((grammar->to_end[v][j] == UNREACHABLE) ||
+                ((grammar->frame_no > 0u) && (grammar->to_end[v][j] + grammar->tail[slot] > remaining)))
+            {
+                continue;
+            }
+            for (i = 0u; (i <= j) && (grammar->frame > 0u); i++)
+            {
+                const float candidate = prev[v * COMMAND_GRAMMAR_MAX_STATES + i] + a[(i + 1u) * node_no + j + 1u];
+                if (candidate > value)
+                {
+                    value = candidate;
+                    source = &grammar->words[from][v * COMMAND_GRAMMAR_MAX_STATES + i];
+                }
+            }
+            if (entry + a[j + 1u] > value)
+            {
+                value = entry + a[j + 1u];
+                source = entry_from;
+                entered = true;
+            }
+            if (isinf(value))
+            {
+                continue;
+            }
+            cur[state] = value + compiled_model_log_emission(model, k, j, grammar->x);
+            grammar->words[to][state] = *source;
+            if (entered)
+            {
+                grammar->words[to][state].model[slot] = (uint8_t)k;
+                grammar->words[to][state].start[slot] = (uint16_t)grammar->frame;
+            }
+            best = fmaxf(best, cur[state]);
+        }
+    }
+
+    threshold = best - config->beam;
+    for (s = 0u; s < config->slot_no; s++)
+    {
+        float exit_score = -INFINITY;
+        const command_grammar_words_t *source = NULL;
+
+        for (v = 0u; v < grammar->node_no; v++)
+        {
+            const float *a = compiled_model_log_transitions(model, grammar->node_model[v]);
+            if (grammar->node_slot[v] != s)
+            {
+                continue;
+            }
+            for (j = 0u; j < n; j++)
+            {
+                const uint32_t state = v * COMMAND_GRAMMAR_MAX_STATES + j;
+                if (cur[state] < threshold)
+                {
+                    cur[state] = -INFINITY;
+                }
+                if (cur[state] + a[(j + 1u) * node_no + n + 1u] > exit_score)
+                {
+                    exit_score = cur[state] + a[(j + 1u) * node_no + n + 1u];
+                    source = &grammar->words[to][state];
+                }
+            }
+        }
+        if (config->optional[s] && (s > 0u) && (grammar->exit[to][s - 1u] > exit_score))
+        {
+            exit_score = grammar->exit[to][s - 1u];
+            source = &grammar->exit_words[to][s - 1u];
+        }
+        grammar->exit[to][s] = (exit_score >= threshold) ? exit_score : -INFINITY;
+        if (!isinf(grammar->exit[to][s]))
+        {
+            grammar->exit_words[to][s] = *source;
+        }
+    }
+
+    grammar->row = to;
+    grammar->frame++;
+}
+
+
+int32_t command_grammar_result(const command_grammar_t *grammar, command_grammar_words_t *words, float *score)
+{
+    const uint32_t last = grammar->config.slot_no - 1u;
+    const float best = grammar->exit[grammar->row][last];
+    int32_t command = -1;
+    uint32_t s;
+
+    if ((grammar->frame > 0u) && !isinf(best))
+    {
+        /* the word of the last slot the phrase did not pass over */
+        for (s = last + 1u; (s-- > 0u) && (command < 0);)
+        {
+            if (grammar->exit_words[grammar->row][last].model[s] != COMMAND_GRAMMAR_NO_WORD)
+            {
+                command = (int32_t)grammar->exit_words[grammar->row][last].model[s];
+            }
+        }
+        if (words != NULL)
+        {
+            *words = grammar->exit_words[grammar->row][last];
+        }
+    }
+    if (score != NULL)
+    {
+        *score = (command >= 0) ? best : -INFINITY;
+    }
+    return command;
+}
+
+
+static void no_words(command_grammar_words_t *words)
+{
+    uint32_t s;
+
+    for (s = 0u; s < COMMAND_GRAMMAR_MAX_SLOTS; s++)
+    {
+        words->model[s] = COMMAND_GRAMMAR_NO_WORD;
+        words->start[s] = 0u;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,118 @@
+/******************************************************************************
+* File Name:   command_grammar.h
+*
+* Description: Wakeword --> [silence] --> command phrases recognised in one
+*              frame-synchronous pass over a compiled model image
+*              (compiled_model.h). main.c recognises "marvin" in one block,
+*              sets wakeword_flag and recognises the command in the next
+*              block, searching every model twice. The grammar chains the
+*              word models into one network instead: the END of every model
+*              of a slot enters the START of every model of the next slot,
+*              an optional slot may be passed over, and the command models
+*              are only searched once a token has left the wakeword. The
+*              algorithm is that of CPP/include/hmm_gmm/command_grammar.hpp,
+*              in float.
+*
+*              RAM: two rows of COMMAND_GRAMMAR_MAX_NODES *
+*              COMMAND_GRAMMAR_MAX_STATES scores and word records, 8 KB.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#if !defined(COMMAND_GRAMMAR_H)
+#define COMMAND_GRAMMAR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "compiled_model.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************Macro Declarations*******************************/
+#define COMMAND_GRAMMAR_MAX_SLOTS       (3u)
+#define COMMAND_GRAMMAR_MAX_NODES       (16u)       /* models over all slots */
+#define COMMAND_GRAMMAR_MAX_STATES      (16u)
+#define COMMAND_GRAMMAR_MAX_STRIDE      (48u)       /* 39 dimensions rounded up to 16 floats */
+
+/* beam of command_grammar_wakeword_config(), the default of hmm_gmm_grammar on the host */
+#define COMMAND_GRAMMAR_DEFAULT_BEAM    (15.0f)
+
+/* model of a slot the phrase passed over; also "no silence slot" for command_grammar_wakeword_config() */
+#define COMMAND_GRAMMAR_NO_WORD         (0xFFu)
+
+/****************************************************************************/
+
+/***************************Type Definitions*********************************/
+typedef struct
+{
+    uint32_t slot_no;
+    uint32_t model_no[COMMAND_GRAMMAR_MAX_SLOTS];                           /* alternatives per slot */
+    uint8_t models[COMMAND_GRAMMAR_MAX_SLOTS][COMMAND_GRAMMAR_MAX_NODES];   /* 0-based model indices */
+    bool optional[COMMAND_GRAMMAR_MAX_SLOTS];
+    float beam;                 /* log-likelihood below the best state, INFINITY = off */
+} command_grammar_config_t;
+
+/* The words of a phrase, per slot */
+typedef struct
+{
+    uint8_t model[COMMAND_GRAMMAR_MAX_SLOTS];       /* COMMAND_GRAMMAR_NO_WORD if passed over */
+    uint16_t start[COMMAND_GRAMMAR_MAX_SLOTS];      /* first frame of the word */
+} command_grammar_words_t;
+
+typedef struct
+{
+    const compiled_model_t *model;
+    command_grammar_config_t config;
+    uint32_t node_no;
+    uint8_t node_slot[COMMAND_GRAMMAR_MAX_NODES];
+    uint8_t node_model[COMMAND_GRAMMAR_MAX_NODES];
+    uint16_t to_end[COMMAND_GRAMMAR_MAX_NODES][COMMAND_GRAMMAR_MAX_STATES];
+    uint16_t tail[COMMAND_GRAMMAR_MAX_SLOTS];       /* fewest frames the slots after a slot need */
+    float x[COMMAND_GRAMMAR_MAX_STRIDE] COMPILED_MODEL_ALIGNED;
+    float score[2][COMMAND_GRAMMAR_MAX_NODES * COMMAND_GRAMMAR_MAX_STATES];
+    command_grammar_words_t words[2][COMMAND_GRAMMAR_MAX_NODES * COMMAND_GRAMMAR_MAX_STATES];
+    float exit[2][COMMAND_GRAMMAR_MAX_SLOTS];
+    command_grammar_words_t exit_words[2][COMMAND_GRAMMAR_MAX_SLOTS];
+    uint32_t row;               /* score[row] holds the previous frame */
+    uint32_t frame;             /* frames pushed */
+    uint32_t frame_no;          /* frames of the utterance, 0 = unknown */
+} command_grammar_t;
+
+/****************************************************************************/
+
+/**************************Function Declarations*****************************/
+/* wakeword --> [silence] --> one of command_no commands; beam COMMAND_GRAMMAR_DEFAULT_BEAM */
+void command_grammar_wakeword_config(command_grammar_config_t *config, uint8_t wakeword, uint8_t silence,
+                                     const uint8_t *commands, uint32_t command_no);
+
+/* Binds an opened image; false if the grammar does not fit the macros above or names a model outside the image */
+bool command_grammar_init(command_grammar_t *grammar, const compiled_model_t *model,
+                          const command_grammar_config_t *config);
+
+/*
+ * Starts an utterance of frame_no frames (the FRAME_SIZE block); states that
+ * cannot finish the phrase within it are not searched. 0 if the length is
+ * not known, which leaves every state searched.
+ */
+void command_grammar_reset(command_grammar_t *grammar, uint32_t frame_no);
+
+/* Advances the search by one frame of model->dim floats */
+void command_grammar_push(command_grammar_t *grammar, const float *frame);
+
+/*
+ * Best phrase after the frames pushed so far: returns the 0-based model of
+ * its last word (the command), -1 if no path reached the END. words and
+ * score may be NULL.
+ */
+int32_t command_grammar_result(const command_grammar_t *grammar, command_grammar_words_t *words, float *score);
+/****************************************************************************/
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* #include COMMAND_GRAMMAR_H */
+/* [] END OF FILE */
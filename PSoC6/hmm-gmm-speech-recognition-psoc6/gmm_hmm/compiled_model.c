@@ -0,0 +1,275 @@
+/******************************************************************************
+* File Name:   compiled_model.c
+*
+* Description: Compiled GMM-HMM model image, see compiled_model.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#include "compiled_model.h"
+
+#include <math.h>
+#include <string.h>
+
+/***************************Macro Declarations*******************************/
+#define HEADER_WORDS            (16u)
+#define VECTOR_FLOATS           (16u)       /* 64 bytes */
+#define BLOCK_BYTES             (64u)
+
+#define ROUND_UP(v, m)          ((((v) + (m) - 1u) / (m)) * (m))
+
+/****************************************************************************/
+
+/**************************Function Declarations*****************************/
+static float half_to_float(uint16_t h);
+static float mahalanobis_float32(const float *x, const float *mean, const float *ivar, uint32_t stride);
+static float mahalanobis_float16(const float *x, const uint16_t *mean, const uint16_t *ivar, uint32_t stride);
+static float mahalanobis_int8(const float *x, const int8_t *q, const uint8_t *r, const float *base,
+                              const float *step, uint32_t stride);
+/****************************************************************************/
+
+
+/*******************************************************************************
+* Function Name: compiled_model_open
+********************************************************************************
+* Summary:
+*  Reads the header words (magic "HMMGMODL", version, dimensions, section
+*  offsets) and checks that they describe a consistent image. Version 2
+*  images carry the precision and the int8 scale section in a second block.
+*
+* Parameters:
+*  image: start of the image, 64-byte aligned
+*  model: receives the dimensions and section pointers
+*
+* Return:
+*  true if the image is valid
+*
+*******************************************************************************/
+bool compiled_model_open(const uint32_t *image, compiled_model_t *model)
+{
+    uint32_t state_bytes;
+    uint32_t node_no;
+    uint32_t element;
+    uint32_t state_offset;
+    uint32_t scale_offset = 0u;
+
+    /* "HMMG" "MODL" read as little-endian words */
+    if ((image[0] != 0x474D4D48u) || (image[1] != 0x4C444F4Du) ||
+        ((image[2] != COMPILED_MODEL_VERSION) && (image[2] != COMPILED_MODEL_QUANTISED_VERSION)))
+    {
+        return false;
+    }
+    model->precision = COMPILED_MODEL_FLOAT32;
+    state_offset = HEADER_WORDS * sizeof(uint32_t);
+    if (image[2] == COMPILED_MODEL_QUANTISED_VERSION)
+    {
+        if ((image[HEADER_WORDS] != (uint32_t)COMPILED_MODEL_FLOAT16) &&
+            (image[HEADER_WORDS] != (uint32_t)COMPILED_MODEL_INT8))
+        {
+            return false;
+        }
+        model->precision = (compiled_model_precision_t)image[HEADER_WORDS];
+        scale_offset = image[HEADER_WORDS + 2u];
+        state_offset = 2u * BLOCK_BYTES + ((model->precision == COMPILED_MODEL_INT8) ? 4u * image[4] * sizeof(float) : 0u);
+    }
+    model->dim = image[3];
+    model->stride = image[4];
+    model->mix_no = image[5];
+    model->mix_stride = image[6];
+    model->state_no = image[7];
+    model->model_no = image[8];
+    state_bytes = image[9];
+
+    node_no = model->state_no + 2u;
+    element = (model->precision == COMPILED_MODEL_FLOAT32) ? 4u : ((model->precision == COMPILED_MODEL_FLOAT16) ? 2u : 1u);
+    model->state_bytes = ROUND_UP(2u * model->mix_stride * sizeof(float) + 2u * model->mix_no * model->stride * element,
+                                  BLOCK_BYTES);
+    model->transition_floats = ROUND_UP(node_no * node_no, VECTOR_FLOATS);
+    if ((model->mix_no == 0u) || (model->mix_no > COMPILED_MODEL_MAX_MIX) ||
+        (model->stride != ROUND_UP(model->dim, VECTOR_FLOATS)) || (state_bytes != model->state_bytes) ||
+        (image[10] != state_offset) || (image[11] != 0u) || (image[13] != 0u) ||
+        (scale_offset != ((model->precision == COMPILED_MODEL_INT8) ? 2u * BLOCK_BYTES : 0u)))
+    {
+        return false;
+    }
+    model->states = (const uint8_t *)image + state_offset;
+    model->scales = (scale_offset != 0u) ? (const float *)&image[scale_offset / sizeof(uint32_t)] : NULL;
+    model->transitions = (const float *)&image[image[12] / sizeof(uint32_t)];
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: compiled_model_prepare_frame
+********************************************************************************
+* Summary:
+*  Zero pads a frame to model->stride floats; for int8 images every
+*  dimension is also mapped onto the mean codes, x'_d = (x_d - o_d) / s_d.
+*
+* Parameters:
+*  model: opened image
+*  frame: model->dim floats
+*  x:     receives model->stride floats, may not alias frame
+*
+*******************************************************************************/
+void compiled_model_prepare_frame(const compiled_model_t *model, const float *frame, float *x)
+{
+    uint32_t d;
+
+    for (d = 0u; d < model->dim; d++)
+    {
+        x[d] = (model->precision == COMPILED_MODEL_INT8)
+            ? (frame[d] - model->scales[d]) * model->scales[model->stride + d] : frame[d];
+    }
+    for (; d < model->stride; d++)
+    {
+        x[d] = 0.0f;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: compiled_model_log_emission
+********************************************************************************
+* Summary:
+*  Per Gaussian, gconst - 1/2 sum_d (x_d - mean_d)^2 ivar_d with the kernel
+*  of the stored precision; the mixtures are combined with the
+*  max-subtraction of log_hmm_gmm().
+*
+* Parameters:
+*  model:       opened image
+*  model_index: 0-based model
+*  state:       0-based emitting state
+*  x:           model->stride floats from compiled_model_prepare_frame()
+*
+* Return:
+*  log b_j(x)
+*
+*******************************************************************************/
+float compiled_model_log_emission(const compiled_model_t *model, uint32_t model_index, uint32_t state,
+                                  const float *x)
+{
+    const uint8_t *block = &model->states[(model_index * model->state_no + state) * model->state_bytes];
+    const float *log_weight = (const float *)block;
+    const float *gconst = log_weight + model->mix_stride;
+    const uint8_t *gaussian = block + 2u * model->mix_stride * sizeof(float);
+    float y[COMPILED_MODEL_MAX_MIX];
+    float ymax = -INFINITY;
+    float sum_exp = 0.0f;
+    float mahalanobis;
+    uint32_t m;
+
+    for (m = 0u; m < model->mix_no; m++)
+    {
+        if (model->precision == COMPILED_MODEL_FLOAT32)
+        {
+            const float *mean = (const float *)gaussian;
+            mahalanobis = mahalanobis_float32(x, mean, mean + model->stride, model->stride);
+            gaussian += 2u * model->stride * sizeof(float);
+        }
+        else if (model->precision == COMPILED_MODEL_FLOAT16)
+        {
+            const uint16_t *mean = (const uint16_t *)gaussian;
+            mahalanobis = mahalanobis_float16(x, mean, mean + model->stride, model->stride);
+            gaussian += 2u * model->stride * sizeof(uint16_t);
+        }
+        else
+        {
+            mahalanobis = mahalanobis_int8(x, (const int8_t *)gaussian, gaussian + model->stride,
+                                           model->scales + 2u * model->stride, model->scales + 3u * model->stride,
+                                           model->stride);
+            gaussian += 2u * model->stride;
+        }
+        y[m] = log_weight[m] + gconst[m] - 0.5f * mahalanobis;
+        if (y[m] > ymax)
+        {
+            ymax = y[m];
+        }
+    }
+    if (isinf(ymax))
+    {
+        return ymax;
+    }
+    for (m = 0u; m < model->mix_no; m++)
+    {
+        sum_exp += expf(y[m] - ymax);
+    }
+    return ymax + logf(sum_exp);
+}
+
+
+const float *compiled_model_log_transitions(const compiled_model_t *model, uint32_t model_index)
+{
+    return &model->transitions[model_index * model->transition_floats];
+}
+
+
+/* IEEE half to float: the magnitude moved into the float fields and rebiased by 2^112 */
+static float half_to_float(uint16_t h)
+{
+    uint32_t bits = (uint32_t)(h & 0x7FFFu) << 13;
+    float v;
+
+    memcpy(&v, &bits, sizeof(v));
+    v *= 5.192296858534828e33f;     /* 2^112 */
+    memcpy(&bits, &v, sizeof(bits));
+    bits |= (uint32_t)(h & 0x8000u) << 16;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+
+/* sum_d (x_d - mean_d)^2 ivar_d with two accumulators so consecutive VFMA instructions of the CM4 do not wait on each other */
+static float mahalanobis_float32(const float *x, const float *mean, const float *ivar, uint32_t stride)
+{
+    float acc0 = 0.0f;
+    float acc1 = 0.0f;
+    uint32_t d;
+
+    for (d = 0u; d < stride; d += 2u)
+    {
+        const float diff0 = x[d] - mean[d];
+        const float diff1 = x[d + 1u] - mean[d + 1u];
+        acc0 += diff0 * diff0 * ivar[d];
+        acc1 += diff1 * diff1 * ivar[d + 1u];
+    }
+    return acc0 + acc1;
+}
+
+
+static float mahalanobis_float16(const float *x, const uint16_t *mean, const uint16_t *ivar, uint32_t stride)
+{
+    float acc0 = 0.0f;
+    float acc1 = 0.0f;
+    uint32_t d;
+
+    for (d = 0u; d < stride; d += 2u)
+    {
+        const float diff0 = x[d] - half_to_float(mean[d]);
+        const float diff1 = x[d + 1u] - half_to_float(mean[d + 1u]);
+        acc0 += diff0 * diff0 * half_to_float(ivar[d]);
+        acc1 += diff1 * diff1 * half_to_float(ivar[d + 1u]);
+    }
+    return acc0 + acc1;
+}
+
+
+/* x prepared for the codes: z_d = (x'_d - q_d) (A_d + B_d r_d) = (x_d - mean_d) sqrt(ivar_d) */
+static float mahalanobis_int8(const float *x, const int8_t *q, const uint8_t *r, const float *base,
+                              const float *step, uint32_t stride)
+{
+    float acc0 = 0.0f;
+    float acc1 = 0.0f;
+    uint32_t d;
+
+    for (d = 0u; d < stride; d += 2u)
+    {
+        const float z0 = (x[d] - (float)q[d]) * (base[d] + step[d] * (float)r[d]);
+        const float z1 = (x[d + 1u] - (float)q[d + 1u]) * (base[d + 1u] + step[d + 1u] * (float)r[d + 1u]);
+        acc0 += z0 * z0;
+        acc1 += z1 * z1;
+    }
+    return acc0 + acc1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,100 @@
+/******************************************************************************
+* File Name:   compiled_model.h
+*
+* Description: Compiled GMM-HMM model image in flash. The image is generated
+*              on the host from HMM_<iter>.mat with
+*                  hmm_gmm_compile_model compile --c-source compiled_model_data.c HMM_30.mat HMM_30.hmmb
+*              and holds inverse variances, per-mixture gconst, log mixture
+*              weights and log transitions, so a Gaussian costs one
+*              multiply-add per dimension:
+*
+*              log N(x) = gconst - 1/2 sum_d (x_d - mean_d)^2 ivar_d
+*
+*              The layout is documented in CPP/include/hmm_gmm/compiled_model.hpp;
+*              the CM4 is little-endian, so the float sections are used in
+*              place.
+*
+*              Images compiled with --precision float16 or int8 hold the
+*              means and inverse variances in 16 or 8 bits (about 2x / 3.5x
+*              less flash) and are scored in that form; frames must then be
+*              passed through compiled_model_prepare_frame() first.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#if !defined(COMPILED_MODEL_H)
+#define COMPILED_MODEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************Macro Declarations*******************************/
+#define COMPILED_MODEL_VERSION          (1u)
+#define COMPILED_MODEL_QUANTISED_VERSION (2u)
+#define COMPILED_MODEL_MAX_MIX          (64u)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define COMPILED_MODEL_ALIGNED          __attribute__((aligned(64)))
+#else
+#define COMPILED_MODEL_ALIGNED
+#endif
+
+/****************************************************************************/
+
+/***************************Type Definitions*********************************/
+typedef enum
+{
+    COMPILED_MODEL_FLOAT32 = 0,
+    COMPILED_MODEL_FLOAT16 = 1,
+    COMPILED_MODEL_INT8 = 2
+} compiled_model_precision_t;
+
+typedef struct
+{
+    uint32_t dim;
+    uint32_t stride;            /* floats per mean / ivar vector */
+    uint32_t mix_no;
+    uint32_t mix_stride;        /* floats per log_weight / gconst row */
+    uint32_t state_no;          /* emitting states, START / END excluded */
+    uint32_t model_no;
+    compiled_model_precision_t precision;
+    const uint8_t *states;      /* model_no * state_no state blocks */
+    const float *scales;        /* int8: frame offset, frame scale, precision base, precision step */
+    const float *transitions;   /* model_no * (state_no + 2)^2 log aij */
+    uint32_t state_bytes;
+    uint32_t transition_floats;
+} compiled_model_t;
+
+/****************************************************************************/
+
+/**************************Global Variables**********************************/
+/* defined in the generated compiled_model_data.c */
+extern const uint32_t hmm_gmm_model_image[];
+
+/****************************************************************************/
+
+/**************************Function Declarations*****************************/
+/* Checks the header of an image and fills model; false if it is not a valid image */
+bool compiled_model_open(const uint32_t *image, compiled_model_t *model);
+
+/* Copies a frame of model->dim floats into the model->stride floats compiled_model_log_emission() takes */
+void compiled_model_prepare_frame(const compiled_model_t *model, const float *frame, float *x);
+
+/* log b_j(x) of emitting state 'state' (0-based) of model 'model'; x as prepared by compiled_model_prepare_frame() */
+float compiled_model_log_emission(const compiled_model_t *model, uint32_t model_index, uint32_t state,
+                                  const float *x);
+
+/* (state_no + 2)^2 log transitions of a model, row-major, START = 0, END = state_no + 1 */
+const float *compiled_model_log_transitions(const compiled_model_t *model, uint32_t model_index);
+/****************************************************************************/
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* #include COMPILED_MODEL_H */
+/* [] END OF FILE */
@@ -0,0 +1,76 @@
+/******************************************************************************
+* File Name:   early_decision.c
+*
+* Description: Early decision on partial scores, see early_decision.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#include "early_decision.h"
+
+#include <math.h>
+
+
+void early_decision_init(early_decision_t *policy, const early_decision_config_t *config)
+{
+    policy->config = *config;
+    early_decision_reset(policy);
+}
+
+
+void early_decision_reset(early_decision_t *policy)
+{
+    policy->leader = -1;
+    policy->streak = 0u;
+}
+
+
+/*******************************************************************************
+* Function Name: early_decision_update
+********************************************************************************
+* Summary:
+*  Finds the leader and the runner-up of the partial scores (ties to the
+*  lower model). A lead below the margin ends the streak; a runner-up
+*  without a path counts as an infinite lead. The policy commits once the
+*  same model has led by the margin for config.frames consecutive frames.
+*
+* Parameters:
+*  policy:   initialised policy
+*  scores:   partial scores of the frame, model_no floats
+*  model_no: number of models
+*
+* Return:
+*  0-based committed model, -1 while undecided
+*
+*******************************************************************************/
+int32_t early_decision_update(early_decision_t *policy, const float *scores, uint32_t model_no)
+{
+    float best = -INFINITY;
+    float second = -INFINITY;
+    int32_t leader = -1;
+    uint32_t k;
+
+    for (k = 0u; k < model_no; k++)
+    {
+        if (scores[k] > best)
+        {
+            second = best;
+            best = scores[k];
+            leader = (int32_t)k;
+        }
+        else if (scores[k] > second)
+        {
+            second = scores[k];
+        }
+    }
+    if ((leader < 0) || isinf(policy->config.margin) || (best - second < policy->config.margin))
+    {
+        early_decision_reset(policy);
+        return -1;
+    }
+    policy->streak = (leader == policy->leader) ? policy->streak + 1u : 1u;
+    policy->leader = leader;
+    return (policy->streak >= ((policy->config.frames > 0u) ? policy->config.frames : 1u)) ? leader : -1;
+}
+
+/* [] END OF FILE */
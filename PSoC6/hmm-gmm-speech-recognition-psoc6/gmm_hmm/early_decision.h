@@ -0,0 +1,64 @@
+/******************************************************************************
+* File Name:   early_decision.h
+*
+* Description: Early decision on the partial scores of a frame-synchronous
+*              search (specialized_model_partial_scores() in
+*              specialized_model.h). main.c waits for the whole FRAME_SIZE
+*              block before it reads the result; the policy instead commits
+*              to a model once it has led the runner-up by at least margin
+*              for frames consecutive frames, so the command can be sent and
+*              the rest of the block left unscored. The policy is that of
+*              early_decision_policy in CPP/include/hmm_gmm/viterbi.hpp.
+*
+*              Reset it with the search, then after each
+*              specialized_model_push_frame():
+*
+*                  specialized_model_partial_scores(scores);
+*                  model = early_decision_update(&policy, scores, specialized_model_info.model_no);
+*
+*              and stop pushing frames once model >= 0.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#if !defined(EARLY_DECISION_H)
+#define EARLY_DECISION_H
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************Type Definitions*********************************/
+typedef struct
+{
+    float margin;               /* log-likelihood over the runner-up, INFINITY = never commit */
+    uint32_t frames;            /* consecutive frames in the lead */
+} early_decision_config_t;
+
+typedef struct
+{
+    early_decision_config_t config;
+    int32_t leader;             /* model in the lead by margin at the last frame, -1 = none */
+    uint32_t streak;            /* consecutive frames of that lead */
+} early_decision_t;
+
+/****************************************************************************/
+
+/**************************Function Declarations*****************************/
+void early_decision_init(early_decision_t *policy, const early_decision_config_t *config);
+
+/* Starts a new utterance */
+void early_decision_reset(early_decision_t *policy);
+
+/* Takes the partial scores of the next frame; returns the 0-based committed model, or -1 */
+int32_t early_decision_update(early_decision_t *policy, const float *scores, uint32_t model_no);
+/****************************************************************************/
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* #include EARLY_DECISION_H */
+/* [] END OF FILE */
@@ -0,0 +1,98 @@
+/******************************************************************************
+* File Name:   feature_projection.c
+*
+* Description: Linear PCA / LDA feature projection, see feature_projection.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#include "feature_projection.h"
+
+/***************************Macro Declarations*******************************/
+/* largest supported input dimension (MFCC_E_D_A) */
+#define FEATURE_PROJECTION_MAX_IN_DIM   (39u)
+
+/****************************************************************************/
+
+
+/*******************************************************************************
+* Function Name: feature_projection_apply
+********************************************************************************
+* Summary:
+*  Centres the input once and computes every output as a dot product with one
+*  row of the matrix. Two accumulators per row let the FPU of the CM4 overlap
+*  consecutive multiply-adds.
+*
+* Parameters:
+*  projection: projection tables
+*  in:         in_dim input features
+*  out:        out_dim projected features
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void feature_projection_apply(const feature_projection_t *projection, const float *in, float *out)
+{
+    float centred[FEATURE_PROJECTION_MAX_IN_DIM];
+    uint32_t in_dim = projection->in_dim;
+    uint32_t d;
+    uint32_t k;
+
+    if (in_dim > FEATURE_PROJECTION_MAX_IN_DIM)
+    {
+        in_dim = FEATURE_PROJECTION_MAX_IN_DIM;
+    }
+    for (d = 0u; d < in_dim; d++)
+    {
+        centred[d] = in[d] - projection->mean[d];
+    }
+
+    for (k = 0u; k < projection->out_dim; k++)
+    {
+        const float *row = &projection->matrix[k * projection->in_dim];
+        float acc0 = 0.0f;
+        float acc1 = 0.0f;
+
+        for (d = 0u; d + 1u < in_dim; d += 2u)
+        {
+            acc0 += row[d] * centred[d];
+            acc1 += row[d + 1u] * centred[d + 1u];
+        }
+        if (d < in_dim)
+        {
+            acc0 += row[d] * centred[d];
+        }
+        out[k] = acc0 + acc1;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: feature_projection_apply_frames
+********************************************************************************
+* Summary:
+*  Projects a block of consecutive feature vectors.
+*
+* Parameters:
+*  projection: projection tables
+*  in:         frame_no * in_dim input features
+*  frame_no:   number of vectors
+*  out:        frame_no * out_dim projected features
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void feature_projection_apply_frames(const feature_projection_t *projection, const float *in,
+                                     uint32_t frame_no, float *out)
+{
+    uint32_t t;
+
+    for (t = 0u; t < frame_no; t++)
+    {
+        feature_projection_apply(projection, &in[t * projection->in_dim], &out[t * projection->out_dim]);
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,56 @@
+/******************************************************************************
+* File Name:   feature_projection.h
+*
+* Description: Linear PCA / LDA projection of the MFCC_E_D_A vectors,
+*              y = W (x - m), applied before the Gaussian scoring so the
+*              models are evaluated in out_dim instead of in_dim dimensions.
+*
+*              The constant tables live in flash and are generated on the
+*              host with
+*                  hmm_gmm_projection export-c <projection.mat> feature_projection_data.c
+*              from a projection estimated by hmm_gmm_projection estimate.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#if !defined(FEATURE_PROJECTION_H)
+#define FEATURE_PROJECTION_H
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************Type Definitions*********************************/
+typedef struct
+{
+    uint32_t in_dim;
+    uint32_t out_dim;
+    const float *mean;      /* [in_dim] */
+    const float *matrix;    /* [out_dim][in_dim], row major */
+} feature_projection_t;
+
+/****************************************************************************/
+
+/**************************Global Variables**********************************/
+/* defined in the generated feature_projection_data.c */
+extern const feature_projection_t feature_projection;
+
+/****************************************************************************/
+
+/**************************Function Declarations*****************************/
+/* out[k] = sum_d matrix[k][d] * (in[d] - mean[d]), k = 0..out_dim-1 */
+void feature_projection_apply(const feature_projection_t *projection, const float *in, float *out);
+
+/* Projects frame_no vectors stored consecutively; in and out must not overlap */
+void feature_projection_apply_frames(const feature_projection_t *projection, const float *in,
+                                     uint32_t frame_no, float *out);
+/****************************************************************************/
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* #include FEATURE_PROJECTION_H */
+/* [] END OF FILE */
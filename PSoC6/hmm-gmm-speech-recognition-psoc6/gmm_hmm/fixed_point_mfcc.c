@@ -0,0 +1,351 @@
+/******************************************************************************
+* File Name:   fixed_point_mfcc.c
+*
+* Description: Integer MFCC front-end, see fixed_point_mfcc.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#include "fixed_point_mfcc.h"
+#include "fixed_point_mfcc_tables.h"
+
+#include <string.h>
+
+#if defined(__ARM_FEATURE_DSP)
+#include <arm_acle.h>
+#endif
+
+/***************************Macro Declarations*******************************/
+/* block floating point: keep |data| < 2^(FFT_HEADROOM_MSB+1) before every stage */
+#define FFT_HEADROOM_MSB        (28)
+
+#define LN2_Q30                 (744261118LL)               /* round(log(2) * 2^30) */
+/****************************************************************************/
+
+/**************************Variable Declarations*****************************/
+/* FFT work buffers; the front-end is not reentrant */
+static int32_t  fft_re[FXP_MFCC_FFT_HALF];
+static int32_t  fft_im[FXP_MFCC_FFT_HALF];
+/****************************************************************************/
+
+
+static int msb32(uint32_t x)
+{
+    return (x == 0u) ? -1 : 31 - __builtin_clz(x);
+}
+
+static int msb64(uint64_t x)
+{
+    return (x == 0u) ? -1 : 63 - __builtin_clzll(x);
+}
+
+static uint32_t abs_or(const int32_t *re, const int32_t *im, uint32_t n)
+{
+    uint32_t bits = 0u;
+    for (uint32_t i = 0u; i < n; i++)
+    {
+        bits |= (uint32_t)((re[i] < 0) ? -re[i] : re[i]);
+        bits |= (uint32_t)((im[i] < 0) ? -im[i] : im[i]);
+    }
+    return bits;
+}
+
+static void shift_right(int32_t *re, int32_t *im, uint32_t n, int shift)
+{
+    const int32_t round = 1 << (shift - 1);
+    for (uint32_t i = 0u; i < n; i++)
+    {
+        re[i] = (re[i] + round) >> shift;
+        im[i] = (im[i] + round) >> shift;
+    }
+}
+
+static uint32_t isqrt64(uint64_t x)
+{
+    uint64_t root = 0u;
+    uint64_t bit = 1ULL << 62;
+    while (bit > x)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0u)
+    {
+        if (x >= root + bit)
+        {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+
+/*******************************************************************************
+* Function Name: fxp_mfcc_log
+********************************************************************************
+* Summary:
+*  log(value * 2^exponent) = (msb + exponent + log2(mantissa)) * log(2). The
+*  mantissa log2 comes from a 257 entry table with linear interpolation
+*  (|error| < 3e-6).
+*
+* Parameters:
+*  value:    unsigned mantissa
+*  exponent: power of two scale of value
+*
+* Return:
+*  Q16 natural log, FXP_MFCC_LOG_ZERO for value == 0
+*
+*******************************************************************************/
+int32_t fxp_mfcc_log(uint64_t value, int32_t exponent)
+{
+    const int p = msb64(value);
+    uint32_t mantissa;
+    uint32_t frac, index, t;
+    int64_t log2_q24, ln_q16;
+
+    if (p < 0)
+    {
+        return FXP_MFCC_LOG_ZERO;
+    }
+
+    /* mantissa in [2^30, 2^31) */
+    mantissa = (p >= 30) ? (uint32_t)(value >> (p - 30)) : (uint32_t)(value << (30 - p));
+    frac = mantissa - (1u << 30);
+    index = frac >> (30u - FXP_MFCC_LOG2_TABLE_BITS);
+    t = frac & ((1u << (30u - FXP_MFCC_LOG2_TABLE_BITS)) - 1u);
+
+    {
+        const int64_t y0 = fxp_mfcc_log2_table_q30[index];
+        const int64_t y1 = fxp_mfcc_log2_table_q30[index + 1u];
+        const int64_t log2_mantissa_q30 = y0 + (((y1 - y0) * (int64_t)t) >> (30u - FXP_MFCC_LOG2_TABLE_BITS));
+        log2_q24 = (int64_t)(p + exponent) * (1LL << 24) + (log2_mantissa_q30 >> 6);
+    }
+
+    ln_q16 = (log2_q24 * LN2_Q30 + (1LL << 37)) >> 38;
+    if (ln_q16 < FXP_MFCC_LOG_ZERO)
+    {
+        ln_q16 = FXP_MFCC_LOG_ZERO;
+    }
+    return (int32_t)ln_q16;
+}
+
+
+void fxp_mfcc_window(const int16_t *frame, int32_t *windowed)
+{
+    /* (int16 * Q31) >> 16 keeps the product in Q15 with 2^-16 sample resolution */
+    const int shift = FXP_MFCC_HAMMING_FRAC_BITS - FXP_MFCC_WINDOW_FRAC_BITS;
+    for (uint32_t k = 0u; k < FXP_MFCC_FRAME_SIZE; k++)
+    {
+#if defined(__ARM_FEATURE_DSP)
+        /* SMMULR (a * b + 2^31) >> 32 of a = frame * 2^(32 - shift) is the same rounded shift */
+        const int32_t sample = (int32_t)frame[k] * (1 << (32 - shift));
+        int32_t product;
+        __asm__ ("smmulr %0, %1, %2" : "=r" (product) : "r" (sample), "r" (fxp_mfcc_hamming_q31[k]));
+        windowed[k] = product;
+#else
+        windowed[k] = (int32_t)(((int64_t)frame[k] * fxp_mfcc_hamming_q31[k] + (1LL << (shift - 1))) >> shift);
+#endif
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: fxp_mfcc_fft_magnitude
+********************************************************************************
+* Summary:
+*  The 512 real samples are packed as 256 complex values z(n) = x(2n) +
+*  i*x(2n+1), normalized to |z| < 2^29 and transformed with a radix-2 DIT
+*  FFT. Before every stage the block is shifted right if it could overflow
+*  (block floating point). The split X(k) = E(k) + W^k O(k) and the 64-bit
+*  integer square root give the magnitude.
+*
+* Parameters:
+*  windowed:  FXP_MFCC_FRAME_SIZE Q15 samples from fxp_mfcc_window()
+*  magnitude: FXP_MFCC_NUM_BINS output values
+*
+* Return:
+*  exponent of the magnitude values
+*
+*******************************************************************************/
+int32_t fxp_mfcc_fft_magnitude(const int32_t *windowed, uint32_t *magnitude)
+{
+    int32_t exponent = -FXP_MFCC_WINDOW_FRAC_BITS;
+    uint32_t i, k;
+    int top;
+
+    for (i = 0u; i < FXP_MFCC_FFT_HALF; i++)
+    {
+        const uint32_t r = fxp_mfcc_bit_reverse[i];
+        fft_re[r] = (2u * i < FXP_MFCC_FRAME_SIZE) ? windowed[2u * i] : 0;
+        fft_im[r] = (2u * i + 1u < FXP_MFCC_FRAME_SIZE) ? windowed[2u * i + 1u] : 0;
+    }
+
+    /* normalize: most significant bit of the block at FFT_HEADROOM_MSB */
+    top = msb32(abs_or(fft_re, fft_im, FXP_MFCC_FFT_HALF));
+    if (top < 0)
+    {
+        memset(magnitude, 0, FXP_MFCC_NUM_BINS * sizeof(uint32_t));
+        return 0;
+    }
+    if (top < FFT_HEADROOM_MSB)
+    {
+        const int shift = FFT_HEADROOM_MSB - top;
+        for (i = 0u; i < FXP_MFCC_FFT_HALF; i++)
+        {
+            fft_re[i] = (int32_t)((uint32_t)fft_re[i] << shift);
+            fft_im[i] = (int32_t)((uint32_t)fft_im[i] << shift);
+        }
+        exponent -= shift;
+    }
+    else if (top > FFT_HEADROOM_MSB)
+    {
+        shift_right(fft_re, fft_im, FXP_MFCC_FFT_HALF, top - FFT_HEADROOM_MSB);
+        exponent += top - FFT_HEADROOM_MSB;
+    }
+
+    for (uint32_t len = 2u; len <= FXP_MFCC_FFT_HALF; len <<= 1)
+    {
+        const uint32_t step = FXP_MFCC_FFT_HALF / len;
+        const uint32_t half_len = len / 2u;
+
+        /* a butterfly grows a component by at most 1 + sqrt(2) */
+        top = msb32(abs_or(fft_re, fft_im, FXP_MFCC_FFT_HALF));
+        if (top > FFT_HEADROOM_MSB)
+        {
+            shift_right(fft_re, fft_im, FXP_MFCC_FFT_HALF, top - FFT_HEADROOM_MSB);
+            exponent += top - FFT_HEADROOM_MSB;
+        }
+
+        for (uint32_t start = 0u; start < FXP_MFCC_FFT_HALF; start += len)
+        {
+            for (k = 0u; k < half_len; k++)
+            {
+                const int64_t wr = fxp_mfcc_twiddle_re_q31[k * step];
+                const int64_t wi = fxp_mfcc_twiddle_im_q31[k * step];
+                const uint32_t a = start + k;
+                const uint32_t b = a + half_len;
+                const int32_t tr = (int32_t)(((int64_t)fft_re[b] * wr - (int64_t)fft_im[b] * wi + (1LL << 30)) >> 31);
+                const int32_t ti = (int32_t)(((int64_t)fft_re[b] * wi + (int64_t)fft_im[b] * wr + (1LL << 30)) >> 31);
+                fft_re[b] = fft_re[a] - tr;
+                fft_im[b] = fft_im[a] - ti;
+                fft_re[a] += tr;
+                fft_im[a] += ti;
+            }
+        }
+    }
+
+    /* the split grows a component by at most 1 + sqrt(2) as well */
+    top = msb32(abs_or(fft_re, fft_im, FXP_MFCC_FFT_HALF));
+    if (top > FFT_HEADROOM_MSB)
+    {
+        shift_right(fft_re, fft_im, FXP_MFCC_FFT_HALF, top - FFT_HEADROOM_MSB);
+        exponent += top - FFT_HEADROOM_MSB;
+    }
+
+    for (k = 0u; k <= FXP_MFCC_FFT_HALF; k++)
+    {
+        const uint32_t k1 = (k == FXP_MFCC_FFT_HALF) ? 0u : k;
+        const uint32_t k2 = (k == 0u) ? 0u : FXP_MFCC_FFT_HALF - k;
+        /* even part E = (Z(k) + conj(Z(N/2-k)))/2, odd part O = (Z(k) - conj(Z(N/2-k)))/(2i) */
+        const int64_t er = ((int64_t)fft_re[k1] + fft_re[k2]) >> 1;
+        const int64_t ei = ((int64_t)fft_im[k1] - fft_im[k2]) >> 1;
+        const int64_t odd_r = ((int64_t)fft_im[k1] + fft_im[k2]) >> 1;
+        const int64_t odd_i = -(((int64_t)fft_re[k1] - fft_re[k2]) >> 1);
+        const int64_t xr = er + ((fxp_mfcc_split_re_q31[k] * odd_r - fxp_mfcc_split_im_q31[k] * odd_i + (1LL << 30)) >> 31);
+        const int64_t xi = ei + ((fxp_mfcc_split_re_q31[k] * odd_i + fxp_mfcc_split_im_q31[k] * odd_r + (1LL << 30)) >> 31);
+        magnitude[k] = isqrt64((uint64_t)(xr * xr) + (uint64_t)(xi * xi));
+    }
+    return exponent;
+}
+
+
+void fxp_mfcc_filter_bank(const uint32_t *magnitude, int32_t exponent, int32_t *log_mel)
+{
+    for (uint32_t m = 0u; m < FXP_MFCC_BANK_NO; m++)
+    {
+        const uint32_t *power = &magnitude[fxp_mfcc_filter_first_bin[m]];
+        const uint32_t *weight = &fxp_mfcc_filter_weight_q24[fxp_mfcc_filter_offset[m]];
+        uint64_t acc = 0u;
+        for (uint32_t k = 0u; k < fxp_mfcc_filter_length[m]; k++)
+        {
+            acc += (uint64_t)power[k] * weight[k];
+        }
+        log_mel[m] = fxp_mfcc_log(acc, exponent - FXP_MFCC_FILTER_WEIGHT_FRAC_BITS);
+    }
+}
+
+
+void fxp_mfcc_dct(const int32_t *log_mel, int32_t *cepstra)
+{
+    for (uint32_t k = 0u; k < FXP_MFCC_CEP_ORDER; k++)
+    {
+        const int32_t *row = &fxp_mfcc_dct_lifter_q28[k * FXP_MFCC_BANK_NO];
+        int64_t acc = 0;
+        for (uint32_t m = 0u; m < FXP_MFCC_BANK_NO; m++)
+        {
+            acc += (int64_t)row[m] * log_mel[m];
+        }
+        cepstra[k] = (int32_t)((acc + (1LL << (FXP_MFCC_DCT_FRAC_BITS - 1))) >> FXP_MFCC_DCT_FRAC_BITS);
+    }
+}
+
+
+int32_t fxp_mfcc_log_energy(const int16_t *frame)
+{
+    uint64_t energy = 0u;
+    uint32_t k = 0u;
+#if defined(__ARM_FEATURE_DSP)
+    int64_t acc = 0;
+    for (; k + 1u < FXP_MFCC_FRAME_SIZE; k += 2u)
+    {
+        int16x2_t pair;
+        memcpy(&pair, &frame[k], sizeof(pair));
+        acc = __smlald(pair, pair, acc);
+    }
+    energy = (uint64_t)acc;
+#endif
+    for (; k < FXP_MFCC_FRAME_SIZE; k++)
+    {
+        energy += (uint64_t)((int32_t)frame[k] * (int32_t)frame[k]);
+    }
+    return fxp_mfcc_log(energy, 0);
+}
+
+
+void fxp_mfcc_compute_frame(const int16_t *frame, int32_t *features)
+{
+    static int32_t windowed[FXP_MFCC_FRAME_SIZE];
+    static uint32_t magnitude[FXP_MFCC_NUM_BINS];
+    static int32_t log_mel[FXP_MFCC_BANK_NO];
+    int32_t exponent;
+
+    fxp_mfcc_window(frame, windowed);
+    exponent = fxp_mfcc_fft_magnitude(windowed, magnitude);
+    fxp_mfcc_filter_bank(magnitude, exponent, log_mel);
+    fxp_mfcc_dct(log_mel, features);
+    features[FXP_MFCC_CEP_ORDER] = fxp_mfcc_log_energy(frame);
+}
+
+
+uint32_t fxp_mfcc_compute(const int16_t *samples, uint32_t num_samples, int32_t *features)
+{
+    uint32_t frame_no, fr;
+
+    if (num_samples < FXP_MFCC_FRAME_SIZE)
+    {
+        return 0u;
+    }
+    frame_no = 1u + (num_samples - FXP_MFCC_FRAME_SIZE) / FXP_MFCC_FRAME_SHIFT;
+    for (fr = 0u; fr < frame_no; fr++)
+    {
+        fxp_mfcc_compute_frame(&samples[fr * FXP_MFCC_FRAME_SHIFT], &features[fr * FXP_MFCC_STATIC_DIM]);
+    }
+    return frame_no;
+}
+
+/* [] END OF FILE */
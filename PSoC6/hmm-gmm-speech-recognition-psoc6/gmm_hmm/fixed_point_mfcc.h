@@ -0,0 +1,118 @@
+/******************************************************************************
+* File Name:   fixed_point_mfcc.h
+*
+* Description: Integer MFCC front-end for the Cortex-M4. Computes the static
+*              part of the MFCC_E_D_A vector (12 liftered cepstra and the log
+*              energy) of wav2mfcc.m / wav2logpow.m for 16 kHz input without
+*              floating point in the per-frame path:
+*
+*              - Q31 hamming window, windowed samples in Q15 (32-bit)
+*              - 512 point real FFT computed as a 256 point complex FFT on
+*                block floating point Q31 data with Q31 twiddles
+*              - mel filter bank with sparse Q24 weights and 64-bit MACs
+*              - table based natural log, Q16 output
+*              - DCT with the lifter folded into a Q28 matrix
+*
+*              The window, twiddle, filter bank, log and DCT tables are
+*              const arrays generated on the host (fixed_point_mfcc_tables.h),
+*              so nothing is built at start-up and libm is not linked.
+*
+*              DSP extension (__ARM_FEATURE_DSP) instructions:
+*              - window:      SMMULR, the rounded high word of int16 << 16
+*                             times the Q31 window
+*              - log energy:  SMLALD, two int16 squares per instruction
+*              The FFT butterflies, the filter bank and the DCT stay on
+*              the single cycle 32x32->64 MACs SMULL/SMLAL/UMLAL: their
+*              operands are full 32-bit Q31/Q24/Q16 values, which the dual
+*              16-bit MACs (SMLAD) cannot take, and SMMLA/SMMULR keep only
+*              the high word of each product, which is one bit short of the
+*              Q31 twiddle products and drops the sum of the low words the
+*              filter bank and DCT bounds rely on.
+*
+*              The code is plain C99 and builds on the host, where
+*              CPP/tools/hmm_gmm_fixed_point_check compares every stage with
+*              the floating point reference.
+*
+*              Error bounds (checked by the host harness):
+*              - window:      |error| <= 1e-4 (int16 sample units)
+*              - FFT:         |error| <= 2^-23 * max_k |X(k)|
+*              - filter bank: |error| <= 5e-5 on log(mel_power)
+*              - log energy:  |error| <= 5e-5
+*              - DCT:         |error| <= 5e-5 per cepstrum
+*              - end to end:  |error| <= 2e-3 per cepstrum / log energy
+*                             for frames with energy above 1 (int16 units)
+*
+*              Frame settings are fixed to the values of
+*              run_feature_extraction.m (pre_emp = 0, hamming window).
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#if !defined(FIXED_POINT_MFCC_H)
+#define FIXED_POINT_MFCC_H
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************Macro Declarations*******************************/
+#define FXP_MFCC_SAMPLE_RATE_HZ         (16000u)
+#define FXP_MFCC_FRAME_SIZE             (400u)      /* 25 ms */
+#define FXP_MFCC_FRAME_SHIFT            (160u)      /* 10 ms */
+#define FXP_MFCC_FFT_SIZE               (512u)
+#define FXP_MFCC_NUM_BINS               (FXP_MFCC_FFT_SIZE / 2u + 1u)
+#define FXP_MFCC_BANK_NO                (26u)
+#define FXP_MFCC_CEP_ORDER              (12u)
+#define FXP_MFCC_LIFTER                 (22u)
+#define FXP_MFCC_STATIC_DIM             (FXP_MFCC_CEP_ORDER + 1u)
+
+#define FXP_MFCC_LOG_FRAC_BITS          (16)        /* log, cepstra: Q16 */
+#define FXP_MFCC_WINDOW_FRAC_BITS       (15)        /* windowed samples: Q15 */
+
+/* log(0): floor returned instead of -Inf, -100 in Q16 */
+#define FXP_MFCC_LOG_ZERO               (-(int32_t)(100L << FXP_MFCC_LOG_FRAC_BITS))
+
+/****************************************************************************/
+
+/**************************Function Declarations*****************************/
+/* Stage 1: windowed[k] = frame[k] * hamming[k] in Q15 */
+void fxp_mfcc_window(const int16_t *frame, int32_t *windowed);
+
+/*
+ * Stage 2: |X(k)|, k = 0..FXP_MFCC_FFT_SIZE/2, of the zero padded windowed
+ * frame. The true magnitude (int16 sample units) is magnitude[k] * 2^exponent;
+ * the exponent is returned.
+ */
+int32_t fxp_mfcc_fft_magnitude(const int32_t *windowed, uint32_t *magnitude);
+
+/* Stage 3: Q16 log(mel_power) of the magnitude spectrum returned by stage 2 */
+void fxp_mfcc_filter_bank(const uint32_t *magnitude, int32_t exponent, int32_t *log_mel);
+
+/* Stage 4: Q16 liftered cepstra c(1..FXP_MFCC_CEP_ORDER) */
+void fxp_mfcc_dct(const int32_t *log_mel, int32_t *cepstra);
+
+/* Q16 log(sum(frame.^2)) of the raw samples, as wav2logpow.m */
+int32_t fxp_mfcc_log_energy(const int16_t *frame);
+
+/* Q16 natural log of value * 2^exponent */
+int32_t fxp_mfcc_log(uint64_t value, int32_t exponent);
+
+/* All stages: Q16 [c(1..12); logpow] of one FXP_MFCC_FRAME_SIZE frame */
+void fxp_mfcc_compute_frame(const int16_t *frame, int32_t *features);
+
+/*
+ * Static features of every frame of a block, frame_no = floor(1 + (len -
+ * FXP_MFCC_FRAME_SIZE)/FXP_MFCC_FRAME_SHIFT). features must hold frame_no *
+ * FXP_MFCC_STATIC_DIM values. Returns frame_no.
+ */
+uint32_t fxp_mfcc_compute(const int16_t *samples, uint32_t num_samples, int32_t *features);
+/****************************************************************************/
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* #include FIXED_POINT_MFCC_H */
+/* [] END OF FILE */
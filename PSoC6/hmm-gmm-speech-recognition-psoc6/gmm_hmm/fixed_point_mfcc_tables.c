@@ -0,0 +1,375 @@
+/* Generated by hmm_gmm_fixed_point_check --tables. Do not edit. */
+#include "fixed_point_mfcc_tables.h"
+
+const int32_t fxp_mfcc_hamming_q31[400] =
+{
+    171798692, 171921171, 172288579, 172900823, 173757753, 174859156, 176204758, 177794227,
+    179627167, 181703124, 184021584, 186581972, 189383653, 192425931, 195708053, 199229205,
+    202988513, 206985046, 211217812, 215685761, 220387787, 225322722, 230489343, 235886369,
+    241512462, 247366226, 253446210, 259750906, 266278751, 273028126, 279997358, 287184717,
+    294588423, 302206638, 310037475, 318078990, 326329190, 334786030, 343447412, 352311188,
+    361375160, 370637081, 380094654, 389745533, 399587326, 409617593, 419833845, 430233549,
+    440814128, 451572956, 462507366, 473614647, 484892044, 496336761, 507945960, 519716761,
+    531646247, 543731459, 555969400, 568357036, 580891294, 593569067, 606387210, 619342546,
+    632431861, 645651911, 658999416, 672471066, 686063522, 699773413, 713597338, 727531871,
+    741573555, 755718908, 769964424, 784306569, 798741787, 813266498, 827877102, 842569973,
+    857341470, 872187929, 887105669, 902090991, 917140178, 932249499, 947415207, 962633541,
+    977900728, 993212982, 1008566505, 1023957491, 1039382123, 1054836576, 1070317017, 1085819609,
+    1101340507, 1116875861, 1132421820, 1147974529, 1163530131, 1179084768, 1194634584, 1210175723,
+    1225704330, 1241216555, 1256708552, 1272176479, 1287616500, 1303024786, 1318397518, 1333730881,
+    1349021076, 1364264309, 1379456801, 1394594784, 1409674506, 1424692225, 1439644220, 1454526781,
+    1469336218, 1484068859, 1498721050, 1513289159, 1527769573, 1542158700, 1556452974, 1570648848,
+    1584742804, 1598731346, 1612611005, 1626378340, 1640029936, 1653562409, 1666972402, 1680256591,
+    1693411681, 1706434411, 1719321550, 1732069903, 1744676310, 1757137643, 1769450813, 1781612766,
+    1793620487, 1805470998, 1817161361, 1828688676, 1840050085, 1851242771, 1862263958, 1873110914,
+    1883780948, 1894271414, 1904579712, 1914703285, 1924639623, 1934386261, 1943940784, 1953300821,
+    1962464051, 1971428203, 1980191054, 1988750430, 1997104209, 2005250319, 2013186741, 2020911506,
+    2028422700, 2035718458, 2042796973, 2049656489, 2056295305, 2062711774, 2068904306, 2074871365,
+    2080611472, 2086123202, 2091405189, 2096456124, 2101274754, 2105859883, 2110210376, 2114325153,
+    2118203193, 2121843536, 2125245279, 2128407577, 2131329647, 2134010764, 2136450264, 2138647541,
+    2140602050, 2142313307, 2143780888, 2145004429, 2145983625, 2146718235, 2147208077, 2147453028,
+    2147453028, 2147208077, 2146718235, 2145983625, 2145004429, 2143780888, 2142313307, 2140602050,
+    2138647541, 2136450264, 2134010764, 2131329647, 2128407577, 2125245279, 2121843536, 2118203193,
+    2114325153, 2110210376, 2105859883, 2101274754, 2096456124, 2091405189, 2086123202, 2080611472,
+    2074871365, 2068904306, 2062711774, 2056295305, 2049656489, 2042796973, 2035718458, 2028422700,
+    2020911506, 2013186741, 2005250319, 1997104209, 1988750430, 1980191054, 1971428203, 1962464051,
+    1953300821, 1943940784, 1934386261, 1924639623, 1914703285, 1904579712, 1894271414, 1883780948,
+    1873110914, 1862263958, 1851242771, 1840050085, 1828688676, 1817161361, 1805470998, 1793620487,
+    1781612766, 1769450813, 1757137643, 1744676310, 1732069903, 1719321550, 1706434411, 1693411681,
+    1680256591, 1666972402, 1653562409, 1640029936, 1626378340, 1612611005, 1598731346, 1584742804,
+    1570648848, 1556452974, 1542158700, 1527769573, 1513289159, 1498721050, 1484068859, 1469336218,
+    1454526781, 1439644220, 1424692225, 1409674506, 1394594784, 1379456801, 1364264309, 1349021076,
+    1333730881, 1318397518, 1303024786, 1287616500, 1272176479, 1256708552, 1241216555, 1225704330,
+    1210175723, 1194634584, 1179084768, 1163530131, 1147974529, 1132421820, 1116875861, 1101340507,
+    1085819609, 1070317017, 1054836576, 1039382123, 1023957491, 1008566505, 993212982, 977900728,
+    962633541, 947415207, 932249499, 917140178, 902090991, 887105669, 872187929, 857341470,
+    842569973, 827877102, 813266498, 798741787, 784306569, 769964424, 755718908, 741573555,
+    727531871, 713597338, 699773413, 686063522, 672471066, 658999416, 645651911, 632431861,
+    619342546, 606387210, 593569067, 580891294, 568357036, 555969400, 543731459, 531646247,
+    519716761, 507945960, 496336761, 484892044, 473614647, 462507366, 451572956, 440814128,
+    430233549, 419833845, 409617593, 399587326, 389745533, 380094654, 370637081, 361375160,
+    352311188, 343447412, 334786030, 326329190, 318078990, 310037475, 302206638, 294588423,
+    287184717, 279997358, 273028126, 266278751, 259750906, 253446210, 247366226, 241512462,
+    235886369, 230489343, 225322722, 220387787, 215685761, 211217812, 206985046, 202988513,
+    199229205, 195708053, 192425931, 189383653, 186581972, 184021584, 181703124, 179627167,
+    177794227, 176204758, 174859156, 173757753, 172900823, 172288579, 171921171, 171798692,
+};
+
+const int32_t fxp_mfcc_twiddle_re_q31[128] =
+{
+    2147483647, 2146836866, 2144896910, 2141664948, 2137142927, 2131333572, 2124240380, 2115867626,
+    2106220352, 2095304370, 2083126254, 2069693342, 2055013723, 2039096241, 2021950484, 2003586779,
+    1984016189, 1963250501, 1941302225, 1918184581, 1893911494, 1868497586, 1841958164, 1814309216,
+    1785567396, 1755750017, 1724875040, 1692961062, 1660027308, 1626093616, 1591180426, 1555308768,
+    1518500250, 1480777044, 1442161874, 1402678000, 1362349204, 1321199781, 1279254516, 1236538675,
+    1193077991, 1148898640, 1104027237, 1058490808, 1012316784, 965532978, 918167572, 870249095,
+    821806413, 772868706, 723465451, 673626408, 623381598, 572761285, 521795963, 470516330,
+    418953276, 367137861, 315101295, 262874923, 210490206, 157978697, 105372028, 52701887,
+    0, -52701887, -105372028, -157978697, -210490206, -262874923, -315101295, -367137861,
+    -418953276, -470516330, -521795963, -572761285, -623381598, -673626408, -723465451, -772868706,
+    -821806413, -870249095, -918167572, -965532978, -1012316784, -1058490808, -1104027237, -1148898640,
+    -1193077991, -1236538675, -1279254516, -1321199781, -1362349204, -1402678000, -1442161874, -1480777044,
+    -1518500250, -1555308768, -1591180426, -1626093616, -1660027308, -1692961062, -1724875040, -1755750017,
+    -1785567396, -1814309216, -1841958164, -1868497586, -1893911494, -1918184581, -1941302225, -1963250501,
+    -1984016189, -2003586779, -2021950484, -2039096241, -2055013723, -2069693342, -2083126254, -2095304370,
+    -2106220352, -2115867626, -2124240380, -2131333572, -2137142927, -2141664948, -2144896910, -2146836866,
+};
+
+const int32_t fxp_mfcc_twiddle_im_q31[128] =
+{
+    0, -52701887, -105372028, -157978697, -210490206, -262874923, -315101295, -367137861,
+    -418953276, -470516330, -521795963, -572761285, -623381598, -673626408, -723465451, -772868706,
+    -821806413, -870249095, -918167572, -965532978, -1012316784, -1058490808, -1104027237, -1148898640,
+    -1193077991, -1236538675, -1279254516, -1321199781, -1362349204, -1402678000, -1442161874, -1480777044,
+    -1518500250, -1555308768, -1591180426, -1626093616, -1660027308, -1692961062, -1724875040, -1755750017,
+    -1785567396, -1814309216, -1841958164, -1868497586, -1893911494, -1918184581, -1941302225, -1963250501,
+    -1984016189, -2003586779, -2021950484, -2039096241, -2055013723, -2069693342, -2083126254, -2095304370,
+    -2106220352, -2115867626, -2124240380, -2131333572, -2137142927, -2141664948, -2144896910, -2146836866,
+    INT32_MIN, -2146836866, -2144896910, -2141664948, -2137142927, -2131333572, -2124240380, -2115867626,
+    -2106220352, -2095304370, -2083126254, -2069693342, -2055013723, -2039096241, -2021950484, -2003586779,
+    -1984016189, -1963250501, -1941302225, -1918184581, -1893911494, -1868497586, -1841958164, -1814309216,
+    -1785567396, -1755750017, -1724875040, -1692961062, -1660027308, -1626093616, -1591180426, -1555308768,
+    -1518500250, -1480777044, -1442161874, -1402678000, -1362349204, -1321199781, -1279254516, -1236538675,
+    -1193077991, -1148898640, -1104027237, -1058490808, -1012316784, -965532978, -918167572, -870249095,
+    -821806413, -772868706, -723465451, -673626408, -623381598, -572761285, -521795963, -470516330,
+    -418953276, -367137861, -315101295, -262874923, -210490206, -157978697, -105372028, -52701887,
+};
+
+const int32_t fxp_mfcc_split_re_q31[257] =
+{
+    2147483647, 2147321946, 2146836866, 2146028480, 2144896910, 2143442326, 2141664948, 2139565043,
+    2137142927, 2134398966, 2131333572, 2127947206, 2124240380, 2120213651, 2115867626, 2111202959,
+    2106220352, 2100920556, 2095304370, 2089372638, 2083126254, 2076566160, 2069693342, 2062508835,
+    2055013723, 2047209133, 2039096241, 2030676269, 2021950484, 2012920201, 2003586779, 1993951625,
+    1984016189, 1973781967, 1963250501, 1952423377, 1941302225, 1929888720, 1918184581, 1906191570,
+    1893911494, 1881346202, 1868497586, 1855367581, 1841958164, 1828271356, 1814309216, 1800073849,
+    1785567396, 1770792044, 1755750017, 1740443581, 1724875040, 1709046739, 1692961062, 1676620432,
+    1660027308, 1643184191, 1626093616, 1608758157, 1591180426, 1573363068, 1555308768, 1537020244,
+    1518500250, 1499751576, 1480777044, 1461579514, 1442161874, 1422527051, 1402678000, 1382617710,
+    1362349204, 1341875533, 1321199781, 1300325060, 1279254516, 1257991320, 1236538675, 1214899813,
+    1193077991, 1171076495, 1148898640, 1126547765, 1104027237, 1081340445, 1058490808, 1035481766,
+    1012316784, 988999351, 965532978, 941921200, 918167572, 894275671, 870249095, 846091463,
+    821806413, 797397602, 772868706, 748223418, 723465451, 698598533, 673626408, 648552838,
+    623381598, 598116479, 572761285, 547319836, 521795963, 496193509, 470516330, 444768294,
+    418953276, 393075166, 367137861, 341145265, 315101295, 289009871, 262874923, 236700388,
+    210490206, 184248325, 157978697, 131685278, 105372028, 79042909, 52701887, 26352928,
+    0, -26352928, -52701887, -79042909, -105372028, -131685278, -157978697, -184248325,
+    -210490206, -236700388, -262874923, -289009871, -315101295, -341145265, -367137861, -393075166,
+    -418953276, -444768294, -470516330, -496193509, -521795963, -547319836, -572761285, -598116479,
+    -623381598, -648552838, -673626408, -698598533, -723465451, -748223418, -772868706, -797397602,
+    -821806413, -846091463, -870249095, -894275671, -918167572, -941921200, -965532978, -988999351,
+    -1012316784, -1035481766, -1058490808, -1081340445, -1104027237, -1126547765, -1148898640, -1171076495,
+    -1193077991, -1214899813, -1236538675, -1257991320, -1279254516, -1300325060, -1321199781, -1341875533,
+    -1362349204, -1382617710, -1402678000, -1422527051, -1442161874, -1461579514, -1480777044, -1499751576,
+    -1518500250, -1537020244, -1555308768, -1573363068, -1591180426, -1608758157, -1626093616, -1643184191,
+    -1660027308, -1676620432, -1692961062, -1709046739, -1724875040, -1740443581, -1755750017, -1770792044,
+    -1785567396, -1800073849, -1814309216, -1828271356, -1841958164, -1855367581, -1868497586, -1881346202,
+    -1893911494, -1906191570, -1918184581, -1929888720, -1941302225, -1952423377, -1963250501, -1973781967,
+    -1984016189, -1993951625, -2003586779, -2012920201, -2021950484, -2030676269, -2039096241, -2047209133,
+    -2055013723, -2062508835, -2069693342, -2076566160, -2083126254, -2089372638, -2095304370, -2100920556,
+    -2106220352, -2111202959, -2115867626, -2120213651, -2124240380, -2127947206, -2131333572, -2134398966,
+    -2137142927, -2139565043, -2141664948, -2143442326, -2144896910, -2146028480, -2146836866, -2147321946,
+    INT32_MIN,
+};
+
+const int32_t fxp_mfcc_split_im_q31[257] =
+{
+    0, -26352928, -52701887, -79042909, -105372028, -131685278, -157978697, -184248325,
+    -210490206, -236700388, -262874923, -289009871, -315101295, -341145265, -367137861, -393075166,
+    -418953276, -444768294, -470516330, -496193509, -521795963, -547319836, -572761285, -598116479,
+    -623381598, -648552838, -673626408, -698598533, -723465451, -748223418, -772868706, -797397602,
+    -821806413, -846091463, -870249095, -894275671, -918167572, -941921200, -965532978, -988999351,
+    -1012316784, -1035481766, -1058490808, -1081340445, -1104027237, -1126547765, -1148898640, -1171076495,
+    -1193077991, -1214899813, -1236538675, -1257991320, -1279254516, -1300325060, -1321199781, -1341875533,
+    -1362349204, -1382617710, -1402678000, -1422527051, -1442161874, -1461579514, -1480777044, -1499751576,
+    -1518500250, -1537020244, -1555308768, -1573363068, -1591180426, -1608758157, -1626093616, -1643184191,
+    -1660027308, -1676620432, -1692961062, -1709046739, -1724875040, -1740443581, -1755750017, -1770792044,
+    -1785567396, -1800073849, -1814309216, -1828271356, -1841958164, -1855367581, -1868497586, -1881346202,
+    -1893911494, -1906191570, -1918184581, -1929888720, -1941302225, -1952423377, -1963250501, -1973781967,
+    -1984016189, -1993951625, -2003586779, -2012920201, -2021950484, -2030676269, -2039096241, -2047209133,
+    -2055013723, -2062508835, -2069693342, -2076566160, -2083126254, -2089372638, -2095304370, -2100920556,
+    -2106220352, -2111202959, -2115867626, -2120213651, -2124240380, -2127947206, -2131333572, -2134398966,
+    -2137142927, -2139565043, -2141664948, -2143442326, -2144896910, -2146028480, -2146836866, -2147321946,
+    INT32_MIN, -2147321946, -2146836866, -2146028480, -2144896910, -2143442326, -2141664948, -2139565043,
+    -2137142927, -2134398966, -2131333572, -2127947206, -2124240380, -2120213651, -2115867626, -2111202959,
+    -2106220352, -2100920556, -2095304370, -2089372638, -2083126254, -2076566160, -2069693342, -2062508835,
+    -2055013723, -2047209133, -2039096241, -2030676269, -2021950484, -2012920201, -2003586779, -1993951625,
+    -1984016189, -1973781967, -1963250501, -1952423377, -1941302225, -1929888720, -1918184581, -1906191570,
+    -1893911494, -1881346202, -1868497586, -1855367581, -1841958164, -1828271356, -1814309216, -1800073849,
+    -1785567396, -1770792044, -1755750017, -1740443581, -1724875040, -1709046739, -1692961062, -1676620432,
+    -1660027308, -1643184191, -1626093616, -1608758157, -1591180426, -1573363068, -1555308768, -1537020244,
+    -1518500250, -1499751576, -1480777044, -1461579514, -1442161874, -1422527051, -1402678000, -1382617710,
+    -1362349204, -1341875533, -1321199781, -1300325060, -1279254516, -1257991320, -1236538675, -1214899813,
+    -1193077991, -1171076495, -1148898640, -1126547765, -1104027237, -1081340445, -1058490808, -1035481766,
+    -1012316784, -988999351, -965532978, -941921200, -918167572, -894275671, -870249095, -846091463,
+    -821806413, -797397602, -772868706, -748223418, -723465451, -698598533, -673626408, -648552838,
+    -623381598, -598116479, -572761285, -547319836, -521795963, -496193509, -470516330, -444768294,
+    -418953276, -393075166, -367137861, -341145265, -315101295, -289009871, -262874923, -236700388,
+    -210490206, -184248325, -157978697, -131685278, -105372028, -79042909, -52701887, -26352928,
+    0,
+};
+
+const uint16_t fxp_mfcc_bit_reverse[256] =
+{
+    0, 128, 64, 192, 32, 160, 96, 224,
+    16, 144, 80, 208, 48, 176, 112, 240,
+    8, 136, 72, 200, 40, 168, 104, 232,
+    24, 152, 88, 216, 56, 184, 120, 248,
+    4, 132, 68, 196, 36, 164, 100, 228,
+    20, 148, 84, 212, 52, 180, 116, 244,
+    12, 140, 76, 204, 44, 172, 108, 236,
+    28, 156, 92, 220, 60, 188, 124, 252,
+    2, 130, 66, 194, 34, 162, 98, 226,
+    18, 146, 82, 210, 50, 178, 114, 242,
+    10, 138, 74, 202, 42, 170, 106, 234,
+    26, 154, 90, 218, 58, 186, 122, 250,
+    6, 134, 70, 198, 38, 166, 102, 230,
+    22, 150, 86, 214, 54, 182, 118, 246,
+    14, 142, 78, 206, 46, 174, 110, 238,
+    30, 158, 94, 222, 62, 190, 126, 254,
+    1, 129, 65, 193, 33, 161, 97, 225,
+    17, 145, 81, 209, 49, 177, 113, 241,
+    9, 137, 73, 201, 41, 169, 105, 233,
+    25, 153, 89, 217, 57, 185, 121, 249,
+    5, 133, 69, 197, 37, 165, 101, 229,
+    21, 149, 85, 213, 53, 181, 117, 245,
+    13, 141, 77, 205, 45, 173, 109, 237,
+    29, 157, 93, 221, 61, 189, 125, 253,
+    3, 131, 67, 195, 35, 163, 99, 227,
+    19, 147, 83, 211, 51, 179, 115, 243,
+    11, 139, 75, 203, 43, 171, 107, 235,
+    27, 155, 91, 219, 59, 187, 123, 251,
+    7, 135, 71, 199, 39, 167, 103, 231,
+    23, 151, 87, 215, 55, 183, 119, 247,
+    15, 143, 79, 207, 47, 175, 111, 239,
+    31, 159, 95, 223, 63, 191, 127, 255,
+};
+
+const uint16_t fxp_mfcc_filter_first_bin[26] =
+{
+    0, 3, 5, 8, 11, 14, 17, 21,
+    25, 30, 35, 41, 47, 53, 61, 69,
+    78, 88, 98, 110, 123, 137, 153, 170,
+    189, 209,
+};
+
+const uint16_t fxp_mfcc_filter_length[26] =
+{
+    5, 5, 6, 6, 6, 7, 8, 9,
+    10, 11, 12, 12, 14, 16, 17, 19,
+    20, 22, 25, 27, 30, 33, 36, 39,
+    43, 48,
+};
+
+const uint16_t fxp_mfcc_filter_offset[26] =
+{
+    0, 5, 10, 16, 22, 28, 35, 43,
+    52, 62, 73, 85, 97, 111, 127, 144,
+    163, 183, 205, 230, 257, 287, 320, 356,
+    395, 438,
+};
+
+const uint32_t fxp_mfcc_filter_weight_q24[486] =
+{
+    0, 7850856, 15373126, 10961217, 4019968, 5815999, 12757248, 14114034,
+    7670475, 1449923, 2663182, 9106741, 15327293, 12214671, 6396816, 761369,
+    4562545, 10380400, 16015847, 12074455, 6771533, 1620578, 4702761, 10005683,
+    15156638, 13390338, 8518603, 3775425, 3386878, 8258613, 13001791, 15931408,
+    11426009, 7030777, 2740453, 845808, 5351207, 9746439, 14036763, 15327362,
+    11232515, 7228874, 3312466, 1449854, 5544701, 9548342, 13464750, 16256785,
+    12503914, 8827793, 5225347, 1693681, 520431, 4273302, 7949423, 11551869,
+    15083535, 15007283, 11609147, 8274060, 4999725, 1783967, 1769933, 5168069,
+    8503156, 11777491, 14993249, 15401945, 12297273, 9245315, 6244310, 3292585,
+    388547, 1375271, 4479943, 7531901, 10532906, 13484631, 16388669, 14307896,
+    11494755, 8724962, 5997200, 3310214, 662802, 2469320, 5282461, 8052254,
+    10780016, 13467002, 16114414, 14831031, 12259371, 9723983, 7223858, 4758030,
+    2325571, 1946185, 4517845, 7053233, 9553358, 12019186, 14451645, 16702804,
+    14334443, 11996880, 9689326, 7411018, 5161226, 2939245, 744394, 74412,
+    2442773, 4780336, 7087890, 9366198, 11615990, 13837971, 16032822, 15353236,
+    13210707, 11093415, 9000772, 6932210, 4887182, 2865158, 865627, 1423980,
+    3566509, 5683801, 7776444, 9845006, 11890034, 13912058, 15911589, 15665309,
+    13709293, 11774333, 9859981, 7965801, 6091372, 4236289, 2400154, 582585,
+    1111907, 3067923, 5002883, 6917235, 8811415, 10685844, 12540927, 14377062,
+    16194631, 15560426, 13778885, 12014827, 10267913, 8537813, 6824206, 5126780,
+    3445234, 1779272, 128608, 1216790, 2998331, 4762389, 6509303, 8239403,
+    9953010, 11650436, 13331982, 14997944, 16648608, 15270180, 13649285, 12042875,
+    10450695, 8872493, 7308027, 5757059, 4219359, 2694702, 1182867, 1507036,
+    3127931, 4734341, 6326521, 7904723, 9469189, 11020157, 12557857, 14082514,
+    15594349, 16460858, 14974034, 13499407, 12036779, 10585955, 9146748, 7718972,
+    6302448, 4896999, 3502453, 2118643, 745405, 316358, 1803182, 3277809,
+    4740437, 6191261, 7630468, 9058244, 10474768, 11880217, 13274763, 14658573,
+    16031811, 16159794, 14807221, 13464750, 12132231, 10809517, 9496465, 8192934,
+    6898789, 5613894, 4338118, 3071334, 1813414, 564235, 617422, 1969995,
+    3312466, 4644985, 5967699, 7280751, 8584282, 9878427, 11163322, 12439098,
+    13705882, 14963802, 16212981, 16100894, 14868840, 13645172, 12429779, 11222548,
+    10023370, 8832140, 7648751, 6473103, 5305093, 4144624, 2991599, 1845923,
+    707502, 676322, 1908376, 3132044, 4347437, 5554668, 6753846, 7945076,
+    9128465, 10304113, 11472123, 12632592, 13785617, 14931293, 16069714, 16353462,
+    15229280, 14112085, 13001791, 11898313, 10801568, 9711473, 8627950, 7550918,
+    6480301, 5416023, 4358009, 3306186, 2260482, 1220826, 187149, 423754,
+    1547936, 2665131, 3775425, 4878903, 5975648, 7065743, 8149266, 9226298,
+    10296915, 11361193, 12419207, 13471030, 14516734, 15556390, 16590067, 15936597,
+    14914673, 13898525, 12888090, 11883302, 10884100, 9890421, 8902205, 7919392,
+    6941924, 5969741, 5002789, 4041010, 3084350, 2132754, 1186169, 244543,
+    840619, 1862543, 2878691, 3889126, 4893914, 5893116, 6886795, 7875011,
+    8857824, 9835292, 10807475, 11774427, 12736206, 13692866, 14644462, 15591047,
+    16532673, 16085040, 15153177, 14226119, 13303818, 12386226, 11473293, 10564974,
+    9661221, 8761989, 7867234, 6976910, 6090974, 5209383, 4332095, 3459067,
+    2590259, 1725630, 865140, 8749, 692176, 1624039, 2551097, 3473398,
+    4390990, 5303923, 6212242, 7115995, 8015227, 8909982, 9800306, 10686242,
+    11567833, 12445121, 13318149, 14186957, 15051586, 15912076, 16768467, 15933635,
+    15085328, 14241005, 13400629, 12564164, 11731573, 10902821, 10077872, 9256692,
+    8439246, 7625501, 6815423, 6008979, 5206137, 4406865, 3611131, 2818904,
+    2030153, 1244848, 462959, 843581, 1691888, 2536211, 3376587, 4213052,
+    5045643, 5874395, 6699344, 7520524, 8337970, 9151715, 9961793, 10768237,
+    11571079, 12370351, 13166085, 13958312, 14747063, 15532368, 16314257, 16461672,
+    15686526, 14914708, 14146191, 13380945, 12618943, 11860157, 11104561, 10352128,
+    9602831, 8856645, 8113543, 7373501, 6636493, 5902494, 5171480, 4443427,
+    3718311, 2996108, 2276795, 1560350, 846748, 135968, 315544, 1090690,
+    1862508, 2631025, 3396271, 4158273, 4917059, 5672655, 6425088, 7174385,
+    7920571, 8663673, 9403715, 10140723, 10874722, 11605736, 12333789, 13058905,
+    13781108, 14500421, 15216866, 15930468, 16641248, 16205203, 15500000, 14797553,
+    14097840, 13400840, 12706533, 12014896, 11325911, 10639557, 9955813, 9274660,
+    8596078, 7920049, 7246552, 6575570, 5907082, 5241072, 4577520, 3916408,
+    3257719, 2601435, 1947538, 1296012, 646838, 0,
+};
+
+const int32_t fxp_mfcc_log2_table_q30[257] =
+{
+    0, 6039314, 12055174, 18047761, 24017256, 29963836, 35887675, 41788947,
+    47667823, 53524472, 59359063, 65171760, 70962728, 76732128, 82480119, 88206862,
+    93912511, 99597222, 105261148, 110904440, 116527248, 122129721, 127712004, 133274244,
+    138816582, 144339162, 149842124, 155325606, 160789745, 166234679, 171660541, 177067464,
+    182455581, 187825021, 193175914, 198508388, 203822568, 209118580, 214396548, 219656594,
+    224898839, 230123404, 235330407, 240519966, 245692198, 250847218, 255985140, 261106077,
+    266210141, 271297442, 276368092, 281422197, 286459867, 291481207, 296486323, 301475319,
+    306448299, 311405366, 316346620, 321272163, 326182095, 331076513, 335955515, 340819199,
+    345667660, 350500993, 355319292, 360122651, 364911162, 369684916, 374444004, 379188517,
+    383918542, 388634168, 393335482, 398022572, 402695523, 407354420, 411999347, 416630388,
+    421247625, 425851141, 430441017, 435017334, 439580170, 444129607, 448665721, 453188592,
+    457698295, 462194908, 466678506, 471149164, 475606957, 480051959, 484484242, 488903880,
+    493310944, 497705506, 502087636, 506457405, 510814882, 515160136, 519493235, 523814248,
+    528123241, 532420281, 536705435, 540978767, 545240343, 549490228, 553728485, 557955178,
+    562170370, 566374123, 570566499, 574747559, 578917365, 583075977, 587223455, 591359858,
+    595485245, 599599675, 603703206, 607795895, 611877800, 615948977, 620009483, 624059373,
+    628098702, 632127527, 636145900, 640153876, 644151509, 648138853, 652115959, 656082880,
+    660039669, 663986377, 667923055, 671849754, 675766525, 679673418, 683570481, 687457766,
+    691335320, 695203192, 699061430, 702910083, 706749198, 710578822, 714399001, 718209783,
+    722011213, 725803337, 729586201, 733359850, 737124328, 740879680, 744625951, 748363183,
+    752091421, 755810707, 759521085, 763222597, 766915285, 770599192, 774274358, 777940826,
+    781598637, 785247830, 788888448, 792520529, 796144114, 799759243, 803365955, 806964289,
+    810554283, 814135978, 817709409, 821274617, 824831638, 828380510, 831921271, 835453956,
+    838978604, 842495250, 846003931, 849504683, 852997541, 856482542, 859959719, 863429109,
+    866890747, 870344666, 873790901, 877229486, 880660455, 884083842, 887499680, 890908003,
+    894308843, 897702233, 901088206, 904466794, 907838029, 911201944, 914558569, 917907937,
+    921250079, 924585025, 927912807, 931233456, 934547002, 937853475, 941152905, 944445323,
+    947730758, 951009239, 954280797, 957545460, 960803257, 964054218, 967298370, 970535742,
+    973766362, 976990259, 980207461, 983417995, 986621888, 989819169, 993009864, 996194001,
+    999371606, 1002542707, 1005707329, 1008865499, 1012017244, 1015162589, 1018301561, 1021434185,
+    1024560487, 1027680492, 1030794226, 1033901713, 1037002979, 1040098049, 1043186948, 1046269699,
+    1049346328, 1052416858, 1055481314, 1058539720, 1061592099, 1064638476, 1067678873, 1070713315,
+    1073741824,
+};
+
+const int32_t fxp_mfcc_dct_lifter_q28[312] =
+{
+    190651807, 187871674, 182351949, 174173122, 163454459, 150352262, 135057591, 117793475,
+    98811665, 78388959, 56823165, 34428762, 11532310, -11532310, -34428762, -56823165,
+    -78388959, -98811665, -117793475, -135057591, -150352262, -163454459, -174173122, -182351949,
+    -187871674, -190651807, 302952251, 285345767, 251156025, 202370007, 141822980, 73033717,
+    0, -73033717, -141822980, -202370007, -251156025, -285345767, -302952251, -302952251,
+    -285345767, -251156025, -202370007, -141822980, -73033717, 0, 73033717, 141822980,
+    202370007, 251156025, 285345767, 302952251, 407865339, 354856095, 255727086, 123361863,
+    -25036395, -170180734, -293207107, -378126080, -413900947, -395882136, -326411508, -214517988,
+    -74744097, 74744097, 214517988, 326411508, 395882136, 413900947, 378126080, 293207107,
+    170180734, 25036395, -123361863, -255727086, -354856095, -407865339, 502182726, 387138716,
+    183405891, -62343013, -293809885, -457968452, -517211966, -457968452, -293809885, -62343013,
+    183405891, 387138716, 502182726, 502182726, 387138716, 183405891, -62343013, -293809885,
+    -457968452, -517211966, -457968452, -293809885, -62343013, 183405891, 387138716, 502182726,
+    583098749, 376662976, 36876356, -315965684, -556945677, -600748928, -431867673, -110091327,
+    250660902, 522671083, 609638835, 480774767, 181700919, -181700919, -480774767, -609638835,
+    -522671083, -250660902, 110091327, 431867673, 600748928, 556945677, 315965684, -36876356,
+    -376662976, -583098749, 648318479, 322228221, -165935906, -570637839, -688321206, -459793802,
+    0, 459793802, 688321206, 570637839, 165935906, -322228221, -648318479, -648318479,
+    -322228221, 165935906, 570637839, 688321206, 459793802, 0, -459793802, -688321206,
+    -570637839, -165935906, 322228221, 648318479, 696145011, 227114050, -394936067, -750896159,
+    -600936447, -46092989, 539805835, 762007950, 470803640, -137606828, -653304051, -728834610,
+    -313309437, 313309437, 728834610, 653304051, 137606828, -470803640, -762007950, -539805835,
+    46092989, 600936447, 750896159, 394936067, -227114050, -696145011, 725542426, 98767723,
+    -613329503, -795589460, -290563148, 465472098, 819399727, 465472098, -290563148, -795589460,
+    -613329503, 98767723, 725542426, 725542426, 98767723, -613329503, -795589460, -290563148,
+    465472098, 819399727, 465472098, -290563148, -795589460, -613329503, 98767723, 725542426,
+    736171894, -51939618, -784446982, -677161761, 155061459, 821283067, 608277086, -255922154,
+    -846142996, -530522360, 353050928, 858664254, 445031424, -445031424, -858664254, -353050928,
+    530522360, 846142996, 255922154, -608277086, -821283067, -155061459, 677161761, 784446982,
+    51939618, -736171894, 728399485, -211811451, -878618236, -411313190, 586910902, 827556138,
+    0, -827556138, -586910902, 411313190, 878618236, 211811451, -728399485, -728399485,
+    211811451, 878618236, 411313190, -586910902, -827556138, 0, 827556138, 586910902,
+    -411313190, -878618236, -211811451, 728399485, 703275390, -366665756, -878773108, -53942584,
+    852954497, 462193328, -631734290, -764561151, 265791371, 891777228, 161041149, -814697889,
+    -550981082, 550981082, 814697889, -161041149, -891777228, -265791371, 764561151, 631734290,
+    -462193328, -852954497, 53942584, 878773108, 366665756, -703275390, 662485458, -502777863,
+    -783691807, 313850645, 859352837, -106683569, -885071403, -106683569, 859352837, 313850645,
+    -783691807, -502777863, 662485458, 662485458, -502777863, -783691807, 313850645, 859352837,
+    -106683569, -885071403, -106683569, 859352837, 313850645, -783691807, -502777863, 662485458,
+};
@@ -0,0 +1,63 @@
+/******************************************************************************
+* File Name:   fixed_point_mfcc_tables.h
+*
+* Description: Constant tables of the integer MFCC front-end. The tables are
+*              defined in fixed_point_mfcc_tables.c, which is generated on
+*              the host by
+*
+*                  hmm_gmm_fixed_point_check --tables fixed_point_mfcc_tables.c
+*
+*              so they are placed in flash and the firmware needs neither
+*              libm nor RAM for them. hmm_gmm_fixed_point_check fails if the
+*              linked tables differ from the ones it would generate.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#if !defined(FIXED_POINT_MFCC_TABLES_H)
+#define FIXED_POINT_MFCC_TABLES_H
+
+#include "fixed_point_mfcc.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************Macro Declarations*******************************/
+#define FXP_MFCC_FFT_HALF                   (FXP_MFCC_FFT_SIZE / 2u)    /* complex FFT size */
+#define FXP_MFCC_FFT_HALF_BITS              (8u)
+
+#define FXP_MFCC_LOG2_TABLE_BITS            (8u)
+#define FXP_MFCC_LOG2_TABLE_SIZE            ((1u << FXP_MFCC_LOG2_TABLE_BITS) + 1u)
+
+#define FXP_MFCC_HAMMING_FRAC_BITS          (31)
+#define FXP_MFCC_TWIDDLE_FRAC_BITS          (31)
+#define FXP_MFCC_FILTER_WEIGHT_FRAC_BITS    (24)
+#define FXP_MFCC_LOG2_TABLE_FRAC_BITS       (30)
+#define FXP_MFCC_DCT_FRAC_BITS              (28)
+/****************************************************************************/
+
+/**************************Variable Declarations*****************************/
+extern const int32_t  fxp_mfcc_hamming_q31[FXP_MFCC_FRAME_SIZE];
+extern const int32_t  fxp_mfcc_twiddle_re_q31[FXP_MFCC_FFT_HALF / 2u];     /* exp(-2*pi*i*k/256) */
+extern const int32_t  fxp_mfcc_twiddle_im_q31[FXP_MFCC_FFT_HALF / 2u];
+extern const int32_t  fxp_mfcc_split_re_q31[FXP_MFCC_FFT_HALF + 1u];       /* exp(-2*pi*i*k/512) */
+extern const int32_t  fxp_mfcc_split_im_q31[FXP_MFCC_FFT_HALF + 1u];
+extern const uint16_t fxp_mfcc_bit_reverse[FXP_MFCC_FFT_HALF];
+
+/* filter m: filter_length[m] weights from filter_offset[m], applied from bin filter_first_bin[m] */
+extern const uint16_t fxp_mfcc_filter_first_bin[FXP_MFCC_BANK_NO];
+extern const uint16_t fxp_mfcc_filter_length[FXP_MFCC_BANK_NO];
+extern const uint16_t fxp_mfcc_filter_offset[FXP_MFCC_BANK_NO];
+extern const uint32_t fxp_mfcc_filter_weight_q24[];
+
+extern const int32_t  fxp_mfcc_log2_table_q30[FXP_MFCC_LOG2_TABLE_SIZE];   /* log2(1 + i/256) */
+extern const int32_t  fxp_mfcc_dct_lifter_q28[FXP_MFCC_CEP_ORDER * FXP_MFCC_BANK_NO];
+/****************************************************************************/
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* #include FIXED_POINT_MFCC_TABLES_H */
+/* [] END OF FILE */
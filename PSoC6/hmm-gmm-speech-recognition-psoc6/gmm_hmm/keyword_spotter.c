@@ -0,0 +1,230 @@
+/******************************************************************************
+* File Name:   keyword_spotter.c
+*
+* Description: Frame-synchronous keyword spotter, see keyword_spotter.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#include "keyword_spotter.h"
+
+#include <math.h>
+
+/***************************Macro Declarations*******************************/
+#define DEFAULT_HOLD_FRAMES     (5u)
+#define DEFAULT_MAX_FRAMES      (100u)      /* 1 s clips at 10 ms per frame */
+
+/****************************************************************************/
+
+/**************************Function Declarations*****************************/
+static uint32_t emit(keyword_spotter_t *spotter, float *score, const uint32_t *start, keyword_detection_t *out);
+/****************************************************************************/
+
+
+void keyword_spotter_default_config(const compiled_model_t *model, keyword_spotter_config_t *config)
+{
+    config->filler = model->model_no - 1u;
+    config->filler_penalty = 0.0f;
+    config->threshold = 0.0f;
+    config->beam = INFINITY;
+    config->hold_frames = DEFAULT_HOLD_FRAMES;
+    config->max_frames = DEFAULT_MAX_FRAMES;
+}
+
+
+bool keyword_spotter_init(keyword_spotter_t *spotter, const compiled_model_t *model,
+                          const keyword_spotter_config_t *config)
+{
+    if ((model->model_no < 2u) || (model->model_no > KEYWORD_SPOTTER_MAX_MODELS) ||
+        (model->state_no > KEYWORD_SPOTTER_MAX_STATES) || (model->stride > KEYWORD_SPOTTER_MAX_STRIDE) ||
+        (config->filler >= model->model_no))
+    {
+        return false;
+    }
+    spotter->model = model;
+    spotter->config = *config;
+    keyword_spotter_reset(spotter);
+    return true;
+}
+
+
+void keyword_spotter_reset(keyword_spotter_t *spotter)
+{
+    uint32_t i;
+
+    for (i = 0u; i < KEYWORD_SPOTTER_MAX_MODELS * KEYWORD_SPOTTER_MAX_STATES; i++)
+    {
+        spotter->score[0][i] = -INFINITY;
+        spotter->score[1][i] = -INFINITY;
+        spotter->start[0][i] = 0u;
+        spotter->start[1][i] = 0u;
+    }
+    spotter->row = 0u;
+    spotter->holding = false;
+    spotter->frame_no = 0u;
+}
+
+
+/*******************************************************************************
+* Function Name: keyword_spotter_push
+********************************************************************************
+* Summary:
+*  One frame of the looped network. Scores are relative to the background
+*  of the previous frame, so a keyword START entered now scores
+*  log a_START,j. Inside a keyword f_j(t) = max_{i <= j} f_i(t-1) + log aij
+*  + log b_j(o_t), carrying the entry frame of the winning token; a state
+*  without a live predecessor or with a token older than max_frames is not
+*  scored. With B(t) = max_j log b_filler,j(o_t) + filler_penalty and
+*  E_k(t) = max_j f_k,j(t) + log a_j,END, the best E_k(t) - B(t) above the
+*  threshold replaces the held detection if the two overlap and it scores
+*  higher. The held detection is reported when a winning END starts after
+*  it or hold_frames have passed. Finally the row is made relative to B(t).
+*
+* Parameters:
+*  spotter: initialised spotter
+*  frame:   model->dim floats
+*  out:     receives up to KEYWORD_SPOTTER_MAX_DETECTIONS detections
+*
+* Return:
+*  Number of detections written
+*
+*******************************************************************************/
+uint32_t keyword_spotter_push(keyword_spotter_t *spotter, const float *frame, keyword_detection_t *out)
+{
+    const compiled_model_t *model = spotter->model;
+    const keyword_spotter_config_t *config = &spotter->config;
+    const uint32_t n = model->state_no;
+    const uint32_t node_no = n + 2u;
+    const float *prev = spotter->score[spotter->row];
+    const uint32_t *prev_start = spotter->start[spotter->row];
+    float *cur = spotter->score[spotter->row ^ 1u];
+    uint32_t *cur_start = spotter->start[spotter->row ^ 1u];
+    const uint32_t oldest = ((config->max_frames > 0u) && (spotter->frame_no + 1u >= config->max_frames))
+                            ? spotter->frame_no + 1u - config->max_frames : 0u;
+    float background = -INFINITY;
+    float floor_score;
+    float best_end = -INFINITY;
+    keyword_detection_t best = {0u, 0u, 0u, 0.0f};
+    uint32_t detections = 0u;
+    uint32_t k;
+    uint32_t i;
+    uint32_t j;
+
+    compiled_model_prepare_frame(model, frame, spotter->x);
+    for (j = 0u; j < n; j++)
+    {
+        background = fmaxf(background, compiled_model_log_emission(model, config->filler, j, spotter->x));
+    }
+    background += config->filler_penalty;
+    floor_score = background - config->beam;
+
+    for (k = 0u; k < model->model_no; k++)
+    {
+        const float *a = compiled_model_log_transitions(model, k);
+        const uint32_t base = k * n;
+
+        if (k == config->filler)
+        {
+            continue;
+        }
+        for (j = 0u; j < n; j++)
+        {
+            float value = a[j + 1u];                            /* START -> j */
+            uint32_t start = spotter->frame_no;
+            float exit_score;
+
+            for (i = 0u; i <= j; i++)
+            {
+                const float candidate = prev[base + i] + a[(i + 1u) * node_no + j + 1u];
+                if (candidate > value)
+                {
+                    value = candidate;
+                    start = prev_start[base + i];
+                }
+            }
+            if (!isinf(value) && (start >= oldest))
+            {
+                value += compiled_model_log_emission(model, k, j, spotter->x);
+                if (value < floor_score)
+                {
+                    value = -INFINITY;
+                }
+            }
+            else
+            {
+                value = -INFINITY;
+            }
+            cur[base + j] = value;
+            cur_start[base + j] = start;
+
+            exit_score = value + a[(j + 1u) * node_no + n + 1u];    /* j -> END */
+            if (exit_score > best_end)
+            {
+                best_end = exit_score;
+                best.keyword = k;
+                best.start_frame = start;
+            }
+        }
+    }
+
+    if (!isinf(best_end) && (best_end - background > config->threshold))
+    {
+        best.end_frame = spotter->frame_no;
+        best.score = best_end - background;
+        if (spotter->holding && (best.start_frame > spotter->held.end_frame))
+        {
+            /* a later word: the held one cannot change any more */
+            detections += emit(spotter, cur, cur_start, &out[detections]);
+        }
+        if (!spotter->holding || (best.score > spotter->held.score))
+        {
+            spotter->held = best;
+            spotter->holding = true;
+        }
+    }
+    if (spotter->holding && (spotter->frame_no - spotter->held.end_frame >= config->hold_frames))
+    {
+        detections += emit(spotter, cur, cur_start, &out[detections]);
+    }
+
+    if (!isinf(background))
+    {
+        for (i = 0u; i < model->model_no * n; i++)
+        {
+            cur[i] -= background;
+        }
+    }
+    spotter->row ^= 1u;
+    spotter->frame_no++;
+    return detections;
+}
+
+
+uint32_t keyword_spotter_finish(keyword_spotter_t *spotter, keyword_detection_t *out)
+{
+    if (!spotter->holding)
+    {
+        return 0u;
+    }
+    return emit(spotter, spotter->score[spotter->row], spotter->start[spotter->row], out);
+}
+
+
+/* Reports the held detection and clears the tokens that entered before its end, which would spot it again */
+static uint32_t emit(keyword_spotter_t *spotter, float *score, const uint32_t *start, keyword_detection_t *out)
+{
+    uint32_t i;
+
+    *out = spotter->held;
+    spotter->holding = false;
+    for (i = 0u; i < spotter->model->model_no * spotter->model->state_no; i++)
+    {
+        if (start[i] <= spotter->held.end_frame)
+        {
+            score[i] = -INFINITY;
+        }
+    }
+    return 1u;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,109 @@
+/******************************************************************************
+* File Name:   keyword_spotter.h
+*
+* Description: Frame-synchronous keyword spotting over the unbounded
+*              microphone stream, on a compiled model image
+*              (compiled_model.h). The fixed FRAME_SIZE blocks of main.c
+*              force every block onto one keyword and lose words across a
+*              block boundary; the spotter instead takes one feature vector
+*              at a time and keeps its state between the PDM blocks.
+*
+*              One model of the image is a filler trained on non-keyword
+*              audio. A background frame scores the best of its states plus
+*              a penalty; every other model is a keyword entered from the
+*              background at any frame. The best keyword END that beats the
+*              background by the threshold is held while overlapping
+*              hypotheses improve on it and reported hold_frames after its
+*              end, with its start and end frame. The algorithm is that of
+*              CPP/include/hmm_gmm/keyword_spotter.hpp, in float.
+*
+*              RAM: two rows of KEYWORD_SPOTTER_MAX_MODELS *
+*              KEYWORD_SPOTTER_MAX_STATES scores and entry frames, 4 KB.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#if !defined(KEYWORD_SPOTTER_H)
+#define KEYWORD_SPOTTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "compiled_model.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************Macro Declarations*******************************/
+#define KEYWORD_SPOTTER_MAX_MODELS      (16u)       /* filler included */
+#define KEYWORD_SPOTTER_MAX_STATES      (16u)
+#define KEYWORD_SPOTTER_MAX_STRIDE      (48u)       /* 39 dimensions rounded up to 16 floats */
+
+/* keyword_spotter_push() reports at most this many detections per frame */
+#define KEYWORD_SPOTTER_MAX_DETECTIONS  (2u)
+
+/****************************************************************************/
+
+/***************************Type Definitions*********************************/
+typedef struct
+{
+    uint32_t filler;            /* 0-based model index of the filler */
+    float filler_penalty;       /* added to the background score per frame */
+    float threshold;            /* minimum log-likelihood ratio of a detection */
+    float beam;                 /* keyword states below background - beam are dropped, INFINITY = off */
+    uint32_t hold_frames;       /* frames a winning END must stay the best before it is reported */
+    uint32_t max_frames;        /* longest keyword in frames, 0 = unlimited */
+} keyword_spotter_config_t;
+
+typedef struct
+{
+    uint32_t keyword;           /* 0-based model index */
+    uint32_t start_frame;       /* first frame of the keyword since keyword_spotter_reset() */
+    uint32_t end_frame;         /* last frame */
+    float score;                /* log-likelihood ratio against the background */
+} keyword_detection_t;
+
+typedef struct
+{
+    const compiled_model_t *model;
+    keyword_spotter_config_t config;
+    float x[KEYWORD_SPOTTER_MAX_STRIDE] COMPILED_MODEL_ALIGNED;
+    float score[2][KEYWORD_SPOTTER_MAX_MODELS * KEYWORD_SPOTTER_MAX_STATES];
+    uint32_t start[2][KEYWORD_SPOTTER_MAX_MODELS * KEYWORD_SPOTTER_MAX_STATES];
+    uint32_t row;               /* score[row] holds the previous frame */
+    keyword_detection_t held;
+    bool holding;
+    uint32_t frame_no;
+} keyword_spotter_t;
+
+/****************************************************************************/
+
+/**************************Function Declarations*****************************/
+/* Defaults: filler = last model, no penalty, threshold 0, no beam, hold 5 frames, at most 100 frames */
+void keyword_spotter_default_config(const compiled_model_t *model, keyword_spotter_config_t *config);
+
+/* Binds an opened image and starts a stream; false if the model does not fit the macros above */
+bool keyword_spotter_init(keyword_spotter_t *spotter, const compiled_model_t *model,
+                          const keyword_spotter_config_t *config);
+
+/* Starts a new stream */
+void keyword_spotter_reset(keyword_spotter_t *spotter);
+
+/*
+ * Advances the search by one frame of model->dim floats. Detections that
+ * became final are written to out (KEYWORD_SPOTTER_MAX_DETECTIONS entries);
+ * returns their number.
+ */
+uint32_t keyword_spotter_push(keyword_spotter_t *spotter, const float *frame, keyword_detection_t *out);
+
+/* End of stream: writes the held detection, if any, to out; returns 0 or 1 */
+uint32_t keyword_spotter_finish(keyword_spotter_t *spotter, keyword_detection_t *out);
+/****************************************************************************/
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* #include KEYWORD_SPOTTER_H */
+/* [] END OF FILE */
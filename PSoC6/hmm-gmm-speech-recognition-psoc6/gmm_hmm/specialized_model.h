@@ -0,0 +1,72 @@
+/******************************************************************************
+* File Name:   specialized_model.h
+*
+* Description: GMM-HMM decoder specialised for one model set. The source,
+*              specialized_model.c, is generated on the host with
+*                  hmm_gmm_compile_model compile --specialized-c specialized_model.c HMM_30.mat HMM_30.hmmb
+*              and holds the model as const arrays in flash together with
+*              the decoder, whose loop bounds (DIM, states, mixtures,
+*              models) are compile-time constants. Use it instead of
+*              compiled_model.c when the firmware ships a single float32
+*              model; compiled_model.c stays the size-generic decoder.
+*
+*              The search is frame-synchronous: reset, push every frame of
+*              the utterance as it comes from the front-end, then read the
+*              result. Two rows of models * states floats are kept in RAM.
+*
+* Related Document: See README.md
+*
+*******************************************************************************/
+#if !defined(SPECIALIZED_MODEL_H)
+#define SPECIALIZED_MODEL_H
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************Type Definitions*********************************/
+typedef struct
+{
+    uint32_t dim;
+    uint32_t state_no;          /* emitting states, START / END excluded */
+    uint32_t mix_no;
+    uint32_t model_no;
+} specialized_model_info_t;
+
+/****************************************************************************/
+
+/**************************Global Variables**********************************/
+/* sizes the generated decoder was built for */
+extern const specialized_model_info_t specialized_model_info;
+
+/****************************************************************************/
+
+/**************************Function Declarations*****************************/
+/* log b_j(frame) of emitting state 'state' (0-based) of model 'model_index'; frame holds dim floats */
+float specialized_model_log_emission(uint32_t model_index, uint32_t state, const float *frame);
+
+/* Starts a new utterance */
+void specialized_model_reset(void);
+
+/* Advances the Viterbi search of every model by one frame of dim floats */
+void specialized_model_push_frame(const float *frame);
+
+/*
+ * Best END score of every model after the frames pushed so far, the partial
+ * scores an early decision (early_decision.h) is taken on; scores receives
+ * model_no floats, -INFINITY where a model has no path yet
+ */
+void specialized_model_partial_scores(float *scores);
+
+/* 0-based best model after the frames pushed so far, -1 if no model has a path; score may be NULL */
+int32_t specialized_model_result(float *score);
+/****************************************************************************/
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* #include SPECIALIZED_MODEL_H */
+/* [] END OF FILE */